@@ -0,0 +1,166 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_EVENTLOG_BIN_H
+#define INCLUDED_EVENTLOG_BIN_H
+
+/*
+ * Binary event log format.  A file is a gzip stream that starts with
+ * EVB_MAGIC, followed by records of the form
+ *
+ *      <varint length> <items...> EVB_END
+ *
+ * Each record is one event, i.e. one JSON object of the text event log.
+ * An item is a type byte, a key (only inside objects) and a value:
+ *
+ *      key      one byte from EVB_KEYS, or EVB_KEY_INLINE followed by
+ *               <varint length> <name>
+ *      EVB_INT  zigzag varint
+ *      EVB_DBL  IEEE double, 8 bytes big-endian
+ *      EVB_STR  <varint length> <bytes>
+ *      EVB_JSON <varint length> <json text>, inserted verbatim
+ *      EVB_BOOL one byte
+ *      EVB_NULL nothing
+ *      EVB_OBJ, EVB_ARR
+ *               nested items up to a matching EVB_END
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define EVB_MAGIC "cdb2evb1"
+#define EVB_MAGIC_LEN 8
+
+enum {
+    EVB_END = 0,
+    EVB_INT = 1,
+    EVB_DBL = 2,
+    EVB_STR = 3,
+    EVB_JSON = 4,
+    EVB_OBJ = 5,
+    EVB_ARR = 6,
+    EVB_BOOL = 7,
+    EVB_NULL = 8
+};
+
+#define EVB_KEYS(X)                                                            \
+    X(TIME, "time")                                                            \
+    X(TYPE, "type")                                                            \
+    X(SQL, "sql")                                                              \
+    X(BOUND_PARAMETERS, "bound_parameters")                                    \
+    X(CNONCE, "cnonce")                                                        \
+    X(ID, "id")                                                                \
+    X(COST, "cost")                                                            \
+    X(ROWS, "rows")                                                            \
+    X(REPLAYS, "replays")                                                      \
+    X(RC, "rc")                                                                \
+    X(ERROR_CODE, "error_code")                                                \
+    X(ERROR, "error")                                                          \
+    X(DEADLOCKRETRIES, "deadlockretries")                                      \
+    X(HOST, "host")                                                            \
+    X(FINGERPRINT, "fingerprint")                                              \
+    X(STARTLAG, "startlag")                                                    \
+    X(CLIENTRETRIES, "clientretries")                                          \
+    X(CONNID, "connid")                                                        \
+    X(PID, "pid")                                                              \
+    X(CLIENT, "client")                                                        \
+    X(NWRITES, "nwrites")                                                      \
+    X(CASC_NWRITES, "casc_nwrites")                                            \
+    X(CONTEXT, "context")                                                      \
+    X(PERF, "perf")                                                            \
+    X(TOTTIME, "tottime")                                                      \
+    X(PROCESSINGTIME, "processingtime")                                        \
+    X(NETWAITUS, "netwaitus")                                                  \
+    X(QTIME, "qtime")                                                          \
+    X(LOCKWAITS, "lockwaits")                                                  \
+    X(LOCKWAITTIME, "lockwaittime")                                            \
+    X(READS, "reads")                                                          \
+    X(READTIME, "readtime")                                                    \
+    X(WRITES, "writes")                                                        \
+    X(WRITETIME, "writetime")                                                  \
+    X(TABLES, "tables")                                                        \
+    X(PATH, "path")                                                            \
+    X(TABLE, "table")                                                          \
+    X(INDEX, "index")                                                          \
+    X(FIND, "find")                                                            \
+    X(NEXT, "next")                                                            \
+    X(WRITE, "write")                                                          \
+    X(DEBUG, "debug")                                                          \
+    X(DEADLOCK_CYCLE, "deadlock_cycle")                                        \
+    X(LID, "lid")                                                              \
+    X(LCOUNT, "lcount")                                                        \
+    X(VICTIM, "victim")
+
+#define EVB_KEY_ENUM(k, name) EVB_KEY_##k,
+enum { EVB_KEY_INLINE = 0, EVB_KEYS(EVB_KEY_ENUM) EVB_KEY_MAX };
+#undef EVB_KEY_ENUM
+
+/* Items inside arrays carry no key */
+#define EVB_KEY_NONE (-1)
+
+static inline const char *evb_key_name(int key)
+{
+#define EVB_KEY_CASE(k, name)                                                  \
+    case EVB_KEY_##k:                                                          \
+        return name;
+    switch (key) {
+        EVB_KEYS(EVB_KEY_CASE)
+    default:
+        return NULL;
+    }
+#undef EVB_KEY_CASE
+}
+
+/* Encode v at p, which must have room for 10 bytes; returns bytes used */
+static inline int evb_put_varint(uint8_t *p, uint64_t v)
+{
+    int n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+/* Decode a varint from [p, end); returns bytes used, 0 if malformed */
+static inline int evb_get_varint(const uint8_t *p, const uint8_t *end,
+                                 uint64_t *v)
+{
+    uint64_t r = 0;
+    int n = 0;
+    for (int shift = 0; p + n < end && shift < 64; shift += 7) {
+        uint8_t c = p[n++];
+        r |= (uint64_t)(c & 0x7f) << shift;
+        if (c < 0x80) {
+            *v = r;
+            return n;
+        }
+    }
+    return 0;
+}
+
+static inline uint64_t evb_zigzag(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t evb_unzigzag(uint64_t v)
+{
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_LATENCY_HIST_H
+#define INCLUDED_LATENCY_HIST_H
+
+/*
+ * Log-linear latency histogram (HDR style).  Values are microseconds;
+ * values below 16 get a bucket each, above that every power of two is
+ * split into 8 buckets, so a reported percentile is within 12.5% of the
+ * real value.  Recording is a couple of atomic adds and takes no lock.
+ *
+ * Besides the lifetime counts, a histogram keeps a ring of one minute
+ * slots so percentiles can be read over a sliding window.  A window of N
+ * minutes covers the current, partial, minute and the N - 1 before it.
+ */
+
+#include <stdint.h>
+
+#define LATENCY_HIST_SUB_BITS 3
+#define LATENCY_HIST_LINEAR 16
+#define LATENCY_HIST_MAX_BIT 35 /* about 9.5 hours */
+#define LATENCY_HIST_NBUCKETS                                                  \
+    (LATENCY_HIST_LINEAR +                                                     \
+     (LATENCY_HIST_MAX_BIT - 3) * (1 << LATENCY_HIST_SUB_BITS))
+#define LATENCY_HIST_SLOT_SEC 60
+#define LATENCY_HIST_NSLOTS 10
+
+struct latency_hist;
+
+/* Merged counts, for reading */
+struct latency_snap {
+    uint64_t count;
+    uint64_t counts[LATENCY_HIST_NBUCKETS];
+};
+
+struct latency_hist *latency_hist_new(void);
+void latency_hist_free(struct latency_hist *h);
+
+/* Record one value; safe to call from any number of threads */
+void latency_hist_add(struct latency_hist *h, int64_t us);
+
+/* Add the counts of the last window_min minutes (1 to LATENCY_HIST_NSLOTS),
+ * or of the lifetime of the histogram if window_min is 0, to snap */
+void latency_hist_snap(struct latency_hist *h, int window_min,
+                       struct latency_snap *snap);
+
+/* Value in microseconds below which pct percent of the snapped values
+ * fall; 0 if nothing was recorded */
+int64_t latency_snap_percentile(const struct latency_snap *snap, double pct);
+
+#endif
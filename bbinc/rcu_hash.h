@@ -0,0 +1,77 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_RCU_HASH_H
+#define INCLUDED_RCU_HASH_H
+
+/*
+ * Read-mostly concurrent hash of user objects.
+ *
+ * rcu_hash_find takes no locks.  Writers (add, delete and the resizes they
+ * trigger) are serialized by a mutex inside the hash and publish their
+ * changes with release stores, so a reader always walks a consistent chain.
+ * Chain nodes and bucket arrays a writer unlinks are freed only once every
+ * thread that was inside a lookup at the time has left it (epoch based
+ * reclamation, one epoch for the whole process).
+ *
+ * As with plhash, the hash never frees the objects it stores: an object
+ * removed with rcu_hash_del must stay valid for as long as callers may use
+ * a pointer an earlier lookup returned.  The registries this is meant for
+ * (interned strings, machine classes) never remove entries while running.
+ */
+
+#include <plhash.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct rcu_hash rcu_hash_t;
+
+rcu_hash_t *rcu_hash_init_user(hashfunc_t *hashfunc, cmpfunc_t *cmpfunc,
+                               int keyoff, int keylen);
+rcu_hash_t *rcu_hash_init_o(int keyoff, int keylen); /* fixed len key */
+rcu_hash_t *rcu_hash_init_strptr(int keyoff);        /* string ptr at keyoff */
+rcu_hash_t *rcu_hash_init_strcaseptr(int keyoff);    /* case insensitive */
+rcu_hash_t *rcu_hash_init_i4(int keyoff);            /* int at keyoff */
+
+/* Find the object with the given key, NULL if there is none.  Lock free. */
+void *rcu_hash_find(rcu_hash_t *h, const void *key);
+
+/* Add an object; returns 0, or -1 if out of memory. */
+int rcu_hash_add(rcu_hash_t *h, void *obj);
+
+/* Add obj unless an object with the same key is already there.  Returns the
+ * object in the hash afterwards, or NULL if out of memory. */
+void *rcu_hash_add_unique(rcu_hash_t *h, void *obj);
+
+/* Remove an object; returns 0, or -1 if it is not in the hash. */
+int rcu_hash_del(rcu_hash_t *h, void *obj);
+
+/* Call func on every object with writers blocked.  func must not add to or
+ * delete from h.  Stops at, and returns, the first non-zero result. */
+int rcu_hash_for(rcu_hash_t *h, hashforfunc_t *func, void *arg);
+
+int rcu_hash_get_num_entries(rcu_hash_t *h);
+
+/* Free the hash (but not the objects).  No lookups may be running. */
+void rcu_hash_free(rcu_hash_t *h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDED_RCU_HASH_H */
@@ -31,6 +31,7 @@ extern "C" {
 #include <inttypes.h>
 
 struct thdpool;
+struct thdpool_fifo;
 struct string_ref;
 
 enum thdpool_ioctl_op { THD_RUN, THD_FREE };
@@ -58,6 +59,15 @@ struct workitem {
     LINKC_T(struct workitem) linkv;
     int available;
     struct string_ref *ref_persistent_info;
+
+    /* fair queuing, see thdpool_enqueue_sched() */
+    int sched;
+    int cls;
+    unsigned maxrun;
+    double tag;
+    uint64_t seq;               /* orders equal tags by arrival */
+    struct thdpool_fifo *fifo;  /* where it waits besides the pool queue */
+    LINKC_T(struct workitem) fifov;
 };
 
 typedef void (*thdpool_thdinit_fn)(struct thdpool *pool, void *thddata);
@@ -98,6 +108,24 @@ enum {
 int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
                     int queue_override, struct string_ref *persistent_info,
                     uint32_t flags);
+
+/* Scheduling attributes of a work item.  Queued items are served in order
+ * of their virtual finish time: an item of flow F starts when the last
+ * item of F finishes (or now, if that is later) and takes cost units of
+ * virtual time, so cheap flows are not stuck behind expensive ones.  At
+ * most maxrun items of class cls run at once (0 means no limit).  Ignored
+ * by pools in scalable mode. */
+enum { THDPOOL_SCHED_NCLASS = 4 };
+struct thdpool_sched {
+    uint64_t flow;
+    double cost;
+    int cls;
+    unsigned maxrun;
+};
+int thdpool_enqueue_sched(struct thdpool *pool, thdpool_work_fn work_fn,
+                          void *work, int queue_override,
+                          struct string_ref *persistent_info, uint32_t flags,
+                          const struct thdpool_sched *sched);
 void thdpool_stop(struct thdpool *pool);
 void thdpool_resume(struct thdpool *pool);
 void thdpool_unset_exit(struct thdpool *pool);
@@ -135,6 +163,9 @@ int thdpool_get_dump_on_full(struct thdpool *pool);
 void thdpool_list_pools(void);
 void thdpool_command_to_all(char *line, int lline, int st);
 void thdpool_set_dump_on_full(struct thdpool *pool, int onoff);
+/* Use per-thread lock-free queues and work stealing; only honoured before
+ * the first thdpool_enqueue() */
+void thdpool_set_scalable(struct thdpool *pool, int onoff);
 /* TODO: maybe thdpool_set_event_callback, to call for various life cycle events? */
 void thdpool_set_queued_callback(struct thdpool *pool, void(*callback)(void*));
 
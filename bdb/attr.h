@@ -668,6 +668,9 @@ DEF_ATTR(TEST_IO_TIME, test_io_time, SECS, 10, "Check I/O in watchdog this often
 DEF_ATTR(TEST_SQL_TIME, test_sql_time, SECS, 0, "Check SQL in watchdog this often")
 DEF_ATTR(DELETE_OLD_FILE_DEBUG, delete_old_file_debug, BOOLEAN, 0,
          "Spew debug info about deleting old files.")
+DEF_ATTR(IX_BLOOM_BITS_PER_KEY, ix_bloom_bits_per_key, QUANTITY, 0,
+         "Bits per key of the in-memory Bloom filters that answer unique and "
+         "constraint lookups of absent keys without a btree search (0 disables)")
 
 /*
   BDB_ATTR_REPTIMEOUT
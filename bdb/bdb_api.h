@@ -559,6 +559,30 @@ uint64_t bdb_logs_size(bdb_state_type *bdb_state, unsigned *num_logs);
 uint64_t bdb_tmp_size(bdb_state_type *bdb_state, uint64_t *ptmptbls, uint64_t *psqlsorters, uint64_t *pblkseqs,
                       uint64_t *pothers);
 
+/* Bloom filters for index lookups that expect to miss (ix_bloom.c).
+ * bdb_ix_bloom_check returns 0 if key is definitely not in the index, 1 if
+ * it may be, and -1 if there is no usable filter (or on error, with
+ * *bdberr set). */
+struct bdb_ix_bloom_stat {
+    const char *state;
+    int64_t keys;
+    int64_t bits;
+    int64_t checks;
+    int64_t negatives;
+    int64_t false_positives;
+};
+int bdb_ix_bloom_check(bdb_state_type *bdb_state, tran_type *tran, int ixnum,
+                       const void *key, int keylen, int *bdberr);
+void bdb_ix_bloom_false_positive(bdb_state_type *bdb_state, int ixnum);
+/* bdb_ix_bloom_add goes before the put of the key, and its return value to
+ * bdb_ix_bloom_add_done once the put is done */
+int bdb_ix_bloom_add(bdb_state_type *bdb_state, int ixnum, const void *key,
+                     int keylen);
+void bdb_ix_bloom_add_done(bdb_state_type *bdb_state, int ixnum, int epoch);
+int bdb_ix_bloom_stat(bdb_state_type *bdb_state, int ixnum,
+                      struct bdb_ix_bloom_stat *st);
+void bdb_ix_bloom_free(bdb_state_type *bdb_state);
+
 /*
   bdb_close(): destroy a bdb_handle.
 */
@@ -2469,6 +2493,10 @@ void bdb_assert_notran(bdb_state_type *bdb_state);
 /* Set this node's sequence number */
 void bdb_set_seqnum(void *in_bdb_state);
 
+/* Wait for this node to apply the log up to file:offset; 1 on timeout */
+int bdb_wait_for_lsn_applied(bdb_state_type *bdb_state, uint32_t file,
+                             uint32_t offset, int timeoutms);
+
 int bdb_trans_track(bdb_state_type *bdb_state, tran_type *tran);
 
 int bdb_debug_log(bdb_state_type *bdb_state, tran_type *tran, int op);
@@ -554,6 +554,8 @@ struct bdb_cursor_impl_tag {
     enum bdbcursor_types type; /* BDBC_IX, BDBC_DT */
     int dbnum;                 /* dbnum for this bdbcursor */
     int idx;                   /* BDBC_IX:ixnum, BDBC_DT:split_dta_num */
+    int stripe_lo;             /* BDBC_DT: if stripe_hi is set, only walk */
+    int stripe_hi;             /* stripes [stripe_lo, stripe_hi) */
 
     /* transaction */
     bdb_state_type *state;  /* state for */
@@ -856,6 +858,11 @@ struct bdb_state_tag {
     signed char ixdups[MAXINDEX];     /* 1 if ix allows dupes, else 0 */
     signed char
         ixrecnum[MAXINDEX]; /* 1 if we turned on recnum mode for btrees */
+    struct ix_bloom *ix_bloom[MAXINDEX]; /* negative lookup filters, master
+                                            only; see ix_bloom.c */
+    struct ix_bloom *ix_bloom_retired;   /* replaced, freed with the handle */
+    int ix_bloom_epoch[MAXINDEX];        /* key adds in flight, by epoch */
+    int ix_bloom_adders[MAXINDEX][2];
 
     short keymaxsz; /* size of the keymax buffer */
 
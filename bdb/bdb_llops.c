@@ -115,7 +115,12 @@ int bdb_llop_add(bdb_state_type *bdb_state, void *trans, int raw, int stripe,
     if (raw) {
         /* note that this overrides any recordin the db with the same key value
          */
+        int bloom = -1;
+        if (ix != -1)
+            bloom = bdb_ix_bloom_add(bdb_state, ix, key, keylen);
         rc = dbc->c_put(dbc, &dkey, &ddata, DB_KEYFIRST);
+        if (ix != -1)
+            bdb_ix_bloom_add_done(bdb_state, ix, bloom);
     } else {
         if (ix == -1)
             rc = bdb_put_pack(bdb_state, dtafile > 0 ? 1 : 0, db, txn, &dkey,
@@ -131,6 +131,11 @@ int lkprintf(loglvl lvl, const char *fmt, ...)
     ((id) >= 0 && (((id) < cur->state->attr->dtastripe) ||                     \
                    ((id) == cur->state->attr->dtastripe && cur->addcur)))
 
+/* stripes a restricted data cursor is allowed to walk */
+#define IS_SCAN_DTA(id)                                                        \
+    (cur->stripe_hi == 0 ||                                                    \
+     ((id) >= cur->stripe_lo && (id) < cur->stripe_hi))
+
 hash_t *logfile_pglogs_repo = NULL;
 static unsigned first_logfile;
 static unsigned last_logfile;
@@ -211,6 +216,7 @@ static int bdb_cursor_find_last_dup(bdb_cursor_ifn_t *, void *key, int keylen,
                                     int keymax, bias_info *, int *bdberr);
 static int bdb_cursor_close(bdb_cursor_ifn_t *cur, int *bdberr);
 static int bdb_cursor_getpageorder(bdb_cursor_ifn_t *pcur_ifn);
+static int bdb_cursor_set_stripes(bdb_cursor_ifn_t *pcur_ifn, int lo, int hi);
 static int bdb_cursor_update_shadows(bdb_cursor_ifn_t *pcur_ifn, int *bdberr);
 static void *bdb_cursor_get_shadowtran(bdb_cursor_ifn_t *pcur_ifn);
 static int bdb_cursor_update_shadows_with_pglogs(bdb_cursor_ifn_t *pcur_ifn,
@@ -689,6 +695,7 @@ bdb_cursor_ifn_t *bdb_cursor_open(
     pcur_ifn->lock = bdb_cursor_lock;
     pcur_ifn->set_curtran = bdb_cursor_set_curtran;
     pcur_ifn->getpageorder = bdb_cursor_getpageorder;
+    pcur_ifn->setstripes = bdb_cursor_set_stripes;
 
     pcur_ifn->updateshadows = bdb_cursor_update_shadows;
     pcur_ifn->updateshadows_pglogs = bdb_cursor_update_shadows_with_pglogs;
@@ -3974,6 +3981,23 @@ static int bdb_cursor_getpageorder(bdb_cursor_ifn_t *pcur_ifn)
     return cur->pageorder;
 }
 
+/* Used by parallel scans: each sql engine walks a disjoint set of stripes.
+ * The virtual stripe holds uncommitted rows of a shadowed transaction,
+ * which parallel engines never have. */
+static int bdb_cursor_set_stripes(bdb_cursor_ifn_t *pcur_ifn, int lo, int hi)
+{
+    bdb_cursor_impl_t *cur = pcur_ifn->impl;
+
+    if (cur->type != BDBC_DT || cur->addcur || lo < 0 || lo >= hi ||
+        hi > cur->state->attr->dtastripe)
+        return -1;
+
+    cur->stripe_lo = lo;
+    cur->stripe_hi = hi;
+
+    return 0;
+}
+
 static int bdb_cursor_first(bdb_cursor_ifn_t *pcur_ifn, int *bdberr)
 {
     bdb_cursor_impl_t *cur = pcur_ifn->impl;
@@ -6213,6 +6237,9 @@ static int bdb_cursor_move_int(bdb_cursor_impl_t *cur, int how, int *bdberr)
             (how == DB_FIRST) ? 0 : (cur->state->attr->dtastripe -
                                      ((cur->addcur) ? 0 : 1)); /* last stripe */
 
+        if (cur->stripe_hi)
+            dtafile = (how == DB_FIRST) ? cur->stripe_lo : cur->stripe_hi - 1;
+
         if (cur->data) {
             /* cursor is positioned */
             if (dtafile != cur->idx) {
@@ -6302,7 +6329,7 @@ static int bdb_cursor_move_int(bdb_cursor_impl_t *cur, int how, int *bdberr)
                 return -1;
             }
 
-            if (!IS_VALID_DTA(nextstripe))
+            if (!IS_VALID_DTA(nextstripe) || !IS_SCAN_DTA(nextstripe))
                 return (how == DB_FIRST || how == DB_LAST) ? IX_EMPTY
                                                            : IX_PASTEOF;
 
@@ -6391,6 +6418,8 @@ static int bdb_cursor_find_int(bdb_cursor_ifn_t *pcur_ifn, void *key,
 
         memcpy(&genid, key, sizeof(genid));
         dtafile = get_dtafile_from_genid(genid);
+        if (!IS_SCAN_DTA(dtafile))
+            return IX_NOTFND;
         if (dtafile != cur->idx) {
             rc = bdb_switch_stripe(cur, dtafile, bdberr);
             if (rc)
@@ -3444,20 +3444,15 @@ static int get_lowfilenum_sanclist(bdb_state_type *bdb_state)
 
 static int get_filenum_from_logfile(char *str_in)
 {
-    char str_buf[80];
     char *ptr;
-    int filenum;
-
-    /* position ptr to the last '.' character in the string */
-    for (ptr = str_in + strlen(str_in); *ptr != '.' && ptr >= str_in; ptr--)
-        ;
-
-    ptr++;
-    strcpy(str_buf, ptr);
 
-    filenum = atoi(str_buf);
+    /* log.0000000012 or, compressed, log.0000000012.lz */
+    ptr = strrchr(str_in, '/');
+    ptr = ptr ? ptr + 1 : str_in;
+    if (strncmp(ptr, LFPREFIX, sizeof(LFPREFIX) - 1) == 0)
+        ptr += sizeof(LFPREFIX) - 1;
 
-    return filenum;
+    return atoi(ptr);
 }
 
 extern int gbl_new_snapisol_asof;
@@ -4078,6 +4073,13 @@ void delete_log_files(bdb_state_type *bdb_state)
     }
     logdelete_unlock(__func__, __LINE__);
     BDB_RELLOCK();
+
+    /* compress what is left, without holding up schema changes meanwhile;
+     * the logdelete lock keeps log truncation out */
+    logdelete_lock(__func__, __LINE__);
+    if (!gbl_truncating_log)
+        __log_compress_old(bdb_state->dbenv);
+    logdelete_unlock(__func__, __LINE__);
 }
 
 void bdb_print_log_files(bdb_state_type *bdb_state)
@@ -7137,6 +7139,7 @@ static int bdb_free_int(bdb_state_type *bdb_state, bdb_state_type *replace,
 
         // free bthash
         bdb_handle_dbp_drop_hash(child);
+        bdb_ix_bloom_free(child);
         memset(child, 0xff, sizeof(bdb_state_type));
 
         if (replace) {
@@ -7484,9 +7487,12 @@ uint64_t bdb_logs_size(bdb_state_type *bdb_state, unsigned *num_logs)
     dirent_buf = alloca(dirent_buf_size(bdb_env->txndir));
 
     while (bb_readdir(dh, dirent_buf, &result) == 0 && result) {
-        /* Match log.########## (log. followed by 10 digits) */
+        /* Match log.########## (log. followed by 10 digits), or the
+         * compressed log.##########.lz */
         if (strncmp(result->d_name, "log.", 4) == 0 &&
-            strlen(result->d_name) == 14) {
+            (strlen(result->d_name) == 14 ||
+             (strlen(result->d_name) == 14 + sizeof(LFZSUFFIX) - 1 &&
+              strcmp(result->d_name + 14, LFZSUFFIX) == 0))) {
             for (ii = 4; ii < 14; ii++)
                 if (!isdigit(result->d_name[ii]))
                     break;
@@ -49,6 +49,7 @@ extern void __test_last_checkpoint(DB_ENV *dbenv);
 extern void __pgdump(DB_ENV *dbenv, int32_t fileid, uint8_t *ufid, db_pgno_t pgno);
 extern void __pgtrash(DB_ENV *dbenv, int32_t fileid, db_pgno_t pgno);
 extern void __txn_commit_map_print_info(DB_ENV *dbenv, loglvl lvl, int should_lock);
+extern void __mempv_cache_print_stats(DB_ENV *dbenv, FILE *out);
 
 static void txn_stats(FILE *out, bdb_state_type *bdb_state);
 static void log_stats(FILE *out, bdb_state_type *bdb_state);
@@ -575,6 +576,9 @@ static void cache_stats(FILE *out, bdb_state_type *bdb_state, int extra)
     prn_lstat(st_alloc_max_pages);
     prn_lstat(st_ckp_pages_sync);
     prn_lstat(st_ckp_pages_skip);
+    prn_lstat(st_ckp_ms);
+    prn_lstat(st_ckp_pages_written);
+    prn_lstat(st_page_ckp_trickle);
 
     if (extra) {
         bdb_state->dbenv->memp_dump_region(bdb_state->dbenv, "A", out);
@@ -1285,6 +1289,7 @@ void bdb_process_user_command(bdb_state_type *bdb_state, char *line, int lline,
         " cachestatall   - cache stats and dump of memory pool",
         " cacheinfo      - list files, pages, & priorities of mpool buffers",
         " clminfo        - print commit lsn map internal structures",
+        "*vcachestat     - snapshot page version cache stats",
         " tempcachestat  - cache stats for temp region",
         " tempcachestatall - cache stats and dump of temp region memory pool",
         " tempcacheinfo  - list files, pages, & priorities of temp mpool "
@@ -1335,7 +1340,8 @@ void bdb_process_user_command(bdb_state_type *bdb_state, char *line, int lline,
     static char *safecmds[] = {
         "bdbstat",  "cluster",   "cachestat", "repstat",     "logstat",
         "txnstat",  "ltranstat", "sanc",      "log_archive", "help",
-        "bdbstate", "lockstat",  "attr",      "bbstat",      "bdblockdump"};
+        "bdbstate", "lockstat",  "attr",      "bbstat",      "bdblockdump",
+        "vcachestat"};
 
     /* if we were passed a child, find his parent */
     if (bdb_state->parent)
@@ -1438,6 +1444,8 @@ void bdb_process_user_command(bdb_state_type *bdb_state, char *line, int lline,
         cache_stats(out, bdb_state, 1);
     else if (tokcmp(tok, ltok, "clminfo") == 0)
         __txn_commit_map_print_info(bdb_state->dbenv, LOGMSG_USER, 1);
+    else if (tokcmp(tok, ltok, "vcachestat") == 0)
+        __mempv_cache_print_stats(bdb_state->dbenv, out);
     else if (tokcmp(tok, ltok, "repstat") == 0)
         rep_stats(out, bdb_state);
     else if (tokcmp(tok, ltok, "bdbstate") == 0)
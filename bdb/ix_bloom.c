@@ -0,0 +1,423 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Bloom filters over the keys of an index, for lookups that expect to miss:
+ * unique checks of new keys and "no child references this row" constraint
+ * checks.  A definite miss answers without descending the btree.
+ *
+ * Filters are blocked: each key sets BLOOM_K bits within a single 64 byte
+ * block, so a check touches one cache line.  They live in memory on the
+ * master only.  A filter is built on the first lookups against an index
+ * that has none, a step of keys at a time with the cursor of the
+ * transaction doing the lookup (which holds the table lock, so the index
+ * can't go away underneath us), and is then kept current by every key add
+ * made through ll_key_add.  Deletes leave bits set, which only costs false
+ * positives.
+ *
+ * A key add sets its bits before the put, in whatever filter it found.  One
+ * that found the filter being replaced (or none) won't be in the new one,
+ * so the new one must not be built until such adds have done their put;
+ * the build then finds the key in the btree, waiting on its page lock if
+ * the adding transaction is still open.  Adds count themselves in the
+ * epoch they started in, a replacement flips the epoch, and the build of
+ * the new filter waits until the adders of the old epoch are gone.
+ *
+ * Writes that don't go through ll_key_add on this node (replicated writes,
+ * rowlocks physical ops) make a filter stale.  It is dropped and rebuilt
+ * when the file it was built from changed (schema change), when mastership
+ * moved (this node may not have been master the whole time), or when more
+ * keys went in than it was sized for.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <errno.h>
+
+#include "bdb_api.h"
+#include "bdb_int.h"
+#include "comdb2_atomic.h"
+#include "crc32c.h"
+#include "logmsg.h"
+#include "sys_wrap.h"
+
+#define BLOOM_BLOCK_WORDS 8 /* one 64 byte cache line */
+#define BLOOM_K 6           /* bits per key, 9 bits of hash each */
+#define BLOOM_STEP_KEYS 512 /* keys scanned per build step */
+#define BLOOM_MIN_KEYS 1024
+
+extern int gbl_rowlocks;
+extern int gbl_master_changes;
+
+struct ix_bloom {
+    pthread_mutex_t lk; /* one build step at a time */
+    uint8_t fileid[DB_FILE_ID_LEN];
+    int master_changes;
+    int drain_epoch; /* adders of this epoch may have missed us */
+    int drained;
+    int ready;
+    int failed;
+    void *resume; /* last key scanned by the build */
+    int resumelen;
+    int64_t capacity;
+    int64_t nkeys;
+    int64_t adds;
+    int64_t checks;
+    int64_t negatives;
+    int64_t false_positives;
+    uint64_t nblocks;
+    uint64_t *blocks;
+    struct ix_bloom *next; /* on the retired list */
+};
+
+/* Filters replaced while other threads may still be looking at them */
+static pthread_mutex_t retired_lk = PTHREAD_MUTEX_INITIALIZER;
+
+static inline uint64_t bloom_mix(uint64_t h)
+{
+    /* splitmix64 finalizer */
+    h += 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+static inline uint64_t *bloom_block(struct ix_bloom *f, const void *key,
+                                    int len, uint64_t *bits)
+{
+    uint64_t h = bloom_mix(crc32c((const uint8_t *)key, len) ^
+                           ((uint64_t)len << 32));
+    *bits = bloom_mix(h);
+    /* map the high half onto [0, nblocks) without a division */
+    uint64_t b = ((h >> 32) * f->nblocks) >> 32;
+    return &f->blocks[b * BLOOM_BLOCK_WORDS];
+}
+
+static void bloom_set(struct ix_bloom *f, const void *key, int len)
+{
+    uint64_t bits;
+    uint64_t *blk = bloom_block(f, key, len, &bits);
+    for (int i = 0; i < BLOOM_K; i++, bits >>= 9) {
+        int bit = bits & 511;
+        __atomic_fetch_or(&blk[bit >> 6], 1ULL << (bit & 63),
+                          __ATOMIC_RELAXED);
+    }
+}
+
+static int bloom_maybe(struct ix_bloom *f, const void *key, int len)
+{
+    uint64_t bits;
+    uint64_t *blk = bloom_block(f, key, len, &bits);
+    for (int i = 0; i < BLOOM_K; i++, bits >>= 9) {
+        int bit = bits & 511;
+        uint64_t w = __atomic_load_n(&blk[bit >> 6], __ATOMIC_RELAXED);
+        if ((w & (1ULL << (bit & 63))) == 0)
+            return 0;
+    }
+    return 1;
+}
+
+static void bloom_free(struct ix_bloom *f)
+{
+    Pthread_mutex_destroy(&f->lk);
+    free(f->resume);
+    free(f->blocks);
+    free(f);
+}
+
+static struct ix_bloom *bloom_new(bdb_state_type *bdb_state, int ixnum,
+                                  int64_t hint)
+{
+    struct ix_bloom *f;
+    int bits_per_key = bdb_state->attr->ix_bloom_bits_per_key;
+    /* every stored key costs the key, the genid and some page overhead */
+    int64_t est = bdb_index_size(bdb_state, ixnum) /
+                  (bdb_state->ixlen[ixnum] + 2 * sizeof(unsigned long long));
+
+    if (est < hint)
+        est = hint;
+    est *= 2; /* room to grow before we need a rebuild */
+    if (est < BLOOM_MIN_KEYS)
+        est = BLOOM_MIN_KEYS;
+
+    f = calloc(1, sizeof(*f));
+    if (f == NULL)
+        return NULL;
+    f->nblocks = (est * bits_per_key + BLOOM_BLOCK_WORDS * 64 - 1) /
+                 (BLOOM_BLOCK_WORDS * 64);
+    if (posix_memalign((void **)&f->blocks, 64,
+                       f->nblocks * BLOOM_BLOCK_WORDS * sizeof(uint64_t))) {
+        free(f);
+        return NULL;
+    }
+    memset(f->blocks, 0, f->nblocks * BLOOM_BLOCK_WORDS * sizeof(uint64_t));
+    Pthread_mutex_init(&f->lk, NULL);
+    memcpy(f->fileid, bdb_state->dbp_ix[ixnum]->fileid, DB_FILE_ID_LEN);
+    f->master_changes = ATOMIC_LOAD32(gbl_master_changes);
+    f->capacity = est;
+    return f;
+}
+
+static int bloom_stale(bdb_state_type *bdb_state, int ixnum,
+                       struct ix_bloom *f)
+{
+    if (memcmp(f->fileid, bdb_state->dbp_ix[ixnum]->fileid, DB_FILE_ID_LEN))
+        return 1;
+    if (f->master_changes != ATOMIC_LOAD32(gbl_master_changes))
+        return 1;
+    return ATOMIC_LOAD64(f->nkeys) + ATOMIC_LOAD64(f->adds) > f->capacity;
+}
+
+/* Swap in a fresh filter for stale filter f (or none).  Returns the filter
+ * now installed, which may be someone else's. */
+static struct ix_bloom *bloom_replace(bdb_state_type *bdb_state, int ixnum,
+                                      struct ix_bloom *f)
+{
+    int64_t hint = f ? ATOMIC_LOAD64(f->nkeys) + ATOMIC_LOAD64(f->adds) : 0;
+    int epoch = ATOMIC_LOAD32(bdb_state->ix_bloom_epoch[ixnum]);
+
+    /* adders from before the last replacement are still at it; flipping
+     * again would mix them up with the current ones */
+    if (ATOMIC_LOAD32(bdb_state->ix_bloom_adders[ixnum][epoch ^ 1]))
+        return NULL;
+
+    struct ix_bloom *n = bloom_new(bdb_state, ixnum, hint);
+    if (n == NULL)
+        return NULL;
+    n->drain_epoch = epoch;
+
+    struct ix_bloom *old = f;
+    if (!CAS64(bdb_state->ix_bloom[ixnum], old, n)) {
+        bloom_free(n);
+        return old;
+    }
+    XCHANGE32(bdb_state->ix_bloom_epoch[ixnum], epoch ^ 1);
+    if (f) {
+        Pthread_mutex_lock(&retired_lk);
+        f->next = bdb_state->ix_bloom_retired;
+        bdb_state->ix_bloom_retired = f;
+        Pthread_mutex_unlock(&retired_lk);
+    }
+    return n;
+}
+
+/* Scan the next step of keys into f.  Called with f->lk held. */
+static int bloom_build_step(bdb_state_type *bdb_state, tran_type *tran,
+                            int ixnum, struct ix_bloom *f, int *bdberr)
+{
+    DB *dbp = bdb_state->dbp_ix[ixnum];
+    DBC *dbc = NULL;
+    DBT key = {.flags = DB_DBT_REALLOC};
+    char dumbuf;
+    DBT data = {.data = &dumbuf,
+                .ulen = 1,
+                .flags = DB_DBT_USERMEM | DB_DBT_PARTIAL};
+    int ixlen = bdb_state->ixlen[ixnum];
+    int rc, n = 0;
+
+    rc = dbp->cursor(dbp, tran->tid, &dbc, 0);
+    if (rc)
+        goto done;
+
+    if (f->resume) {
+        key.data = malloc(f->resumelen);
+        if (key.data == NULL) {
+            rc = ENOMEM;
+            goto done;
+        }
+        memcpy(key.data, f->resume, f->resumelen);
+        key.size = key.ulen = f->resumelen;
+        rc = dbc->c_get(dbc, &key, &data, DB_SET_RANGE);
+        /* the resume key itself is already in */
+        if (rc == 0 && key.size == f->resumelen &&
+            memcmp(key.data, f->resume, key.size) == 0)
+            rc = dbc->c_get(dbc, &key, &data, DB_NEXT);
+    } else {
+        rc = dbc->c_get(dbc, &key, &data, DB_FIRST);
+    }
+
+    while (rc == 0) {
+        if (key.size >= ixlen) {
+            bloom_set(f, key.data, ixlen);
+            n++;
+        }
+        if (n >= BLOOM_STEP_KEYS)
+            break;
+        rc = dbc->c_get(dbc, &key, &data, DB_NEXT);
+    }
+
+done:
+    if (dbc)
+        dbc->c_close(dbc);
+    ATOMIC_ADD64(f->nkeys, n);
+
+    if (rc == 0) {
+        /* more to go: remember where we stopped */
+        free(f->resume);
+        f->resume = key.data;
+        f->resumelen = key.size;
+        return 0;
+    }
+    free(key.data);
+
+    if (rc == DB_NOTFOUND) {
+        free(f->resume);
+        f->resume = NULL;
+        __atomic_store_n(&f->ready, 1, __ATOMIC_RELEASE);
+        return 0;
+    }
+    if (rc == DB_LOCK_DEADLOCK || rc == DB_REP_HANDLE_DEAD) {
+        *bdberr = BDBERR_DEADLOCK;
+        return -1;
+    }
+    logmsg(LOGMSG_ERROR, "%s: %s ix %d build failed rc %d, not using filter\n",
+           __func__, bdb_state->name, ixnum, rc);
+    f->failed = 1;
+    return 0;
+}
+
+static int bloom_usable(bdb_state_type *bdb_state, int ixnum, int keylen)
+{
+    if (bdb_state->attr->ix_bloom_bits_per_key <= 0 || gbl_rowlocks)
+        return 0;
+    if (ixnum < 0 || ixnum >= bdb_state->numix ||
+        keylen != bdb_state->ixlen[ixnum] || !bdb_state->dbp_ix[ixnum])
+        return 0;
+    return bdb_amimaster(bdb_state);
+}
+
+int bdb_ix_bloom_check(bdb_state_type *bdb_state, tran_type *tran, int ixnum,
+                       const void *key, int keylen, int *bdberr)
+{
+    struct ix_bloom *f;
+
+    *bdberr = BDBERR_NOERROR;
+    if (!bloom_usable(bdb_state, ixnum, keylen))
+        return -1;
+
+    f = __atomic_load_n(&bdb_state->ix_bloom[ixnum], __ATOMIC_ACQUIRE);
+    if (f == NULL || bloom_stale(bdb_state, ixnum, f)) {
+        f = bloom_replace(bdb_state, ixnum, f);
+        if (f == NULL)
+            return -1;
+    }
+
+    if (!__atomic_load_n(&f->ready, __ATOMIC_ACQUIRE)) {
+        /* help the build along, unless another lookup already is */
+        if (f->failed || tran == NULL || pthread_mutex_trylock(&f->lk))
+            return -1;
+        int rc = 0;
+        if (!f->drained) {
+            if (ATOMIC_LOAD32(
+                    bdb_state->ix_bloom_adders[ixnum][f->drain_epoch])) {
+                Pthread_mutex_unlock(&f->lk);
+                return -1;
+            }
+            f->drained = 1;
+        }
+        if (!f->ready && !f->failed)
+            rc = bloom_build_step(bdb_state, tran, ixnum, f, bdberr);
+        Pthread_mutex_unlock(&f->lk);
+        if (rc || !__atomic_load_n(&f->ready, __ATOMIC_ACQUIRE))
+            return rc;
+    }
+
+    ATOMIC_ADD64(f->checks, 1);
+    if (bloom_maybe(f, key, keylen))
+        return 1;
+    ATOMIC_ADD64(f->negatives, 1);
+    return 0;
+}
+
+void bdb_ix_bloom_false_positive(bdb_state_type *bdb_state, int ixnum)
+{
+    struct ix_bloom *f =
+        __atomic_load_n(&bdb_state->ix_bloom[ixnum], __ATOMIC_ACQUIRE);
+    if (f)
+        ATOMIC_ADD64(f->false_positives, 1);
+}
+
+int bdb_ix_bloom_add(bdb_state_type *bdb_state, int ixnum, const void *key,
+                     int keylen)
+{
+    struct ix_bloom *f;
+    int epoch;
+
+    if (keylen < bdb_state->ixlen[ixnum])
+        return -1;
+
+    /* counted before we look, see bloom_replace */
+    epoch = ATOMIC_LOAD32(bdb_state->ix_bloom_epoch[ixnum]);
+    ATOMIC_ADD32(bdb_state->ix_bloom_adders[ixnum][epoch], 1);
+
+    f = __atomic_load_n(&bdb_state->ix_bloom[ixnum], __ATOMIC_ACQUIRE);
+    if (f) {
+        bloom_set(f, key, bdb_state->ixlen[ixnum]);
+        ATOMIC_ADD64(f->adds, 1);
+    }
+    return epoch;
+}
+
+void bdb_ix_bloom_add_done(bdb_state_type *bdb_state, int ixnum, int epoch)
+{
+    if (epoch >= 0)
+        ATOMIC_ADD32(bdb_state->ix_bloom_adders[ixnum][epoch], -1);
+}
+
+int bdb_ix_bloom_stat(bdb_state_type *bdb_state, int ixnum,
+                      struct bdb_ix_bloom_stat *st)
+{
+    struct ix_bloom *f;
+
+    if (ixnum < 0 || ixnum >= bdb_state->numix)
+        return -1;
+    f = __atomic_load_n(&bdb_state->ix_bloom[ixnum], __ATOMIC_ACQUIRE);
+    if (f == NULL)
+        return -1;
+
+    if (f->failed)
+        st->state = "failed";
+    else if (!f->ready)
+        st->state = "building";
+    else if (bloom_stale(bdb_state, ixnum, f))
+        st->state = "stale";
+    else
+        st->state = "ready";
+    st->keys = ATOMIC_LOAD64(f->nkeys) + ATOMIC_LOAD64(f->adds);
+    st->bits = f->nblocks * BLOOM_BLOCK_WORDS * 64;
+    st->checks = ATOMIC_LOAD64(f->checks);
+    st->negatives = ATOMIC_LOAD64(f->negatives);
+    st->false_positives = ATOMIC_LOAD64(f->false_positives);
+    return 0;
+}
+
+void bdb_ix_bloom_free(bdb_state_type *bdb_state)
+{
+    for (int i = 0; i < MAXINDEX; i++) {
+        if (bdb_state->ix_bloom[i])
+            bloom_free(bdb_state->ix_bloom[i]);
+        bdb_state->ix_bloom[i] = NULL;
+    }
+    Pthread_mutex_lock(&retired_lk);
+    while (bdb_state->ix_bloom_retired) {
+        struct ix_bloom *f = bdb_state->ix_bloom_retired;
+        bdb_state->ix_bloom_retired = f->next;
+        bloom_free(f);
+    }
+    Pthread_mutex_unlock(&retired_lk);
+}
@@ -833,7 +833,7 @@ done:
 int ll_key_add(bdb_state_type *bdb_state, unsigned long long ingenid,
                tran_type *tran, int ixnum, DBT *dbt_key, DBT *dbt_data)
 {
-    int rc;
+    int rc, bloom;
 
     switch (tran->tranclass) {
     case TRANCLASS_BERK:
@@ -856,8 +856,13 @@ int ll_key_add(bdb_state_type *bdb_state, unsigned long long ingenid,
             }
         }
 
+        /* before the put, so no lookup can miss a key that is in */
+        bloom = bdb_ix_bloom_add(bdb_state, ixnum, dbt_key->data,
+                                 dbt_key->size);
+
         rc = bdb_state->dbp_ix[ixnum]->put(bdb_state->dbp_ix[ixnum], tran->tid,
                                            dbt_key, dbt_data, DB_NOOVERWRITE);
+        bdb_ix_bloom_add_done(bdb_state, ixnum, bloom);
         if (rc) {
             return rc;
         }
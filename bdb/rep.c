@@ -3727,6 +3727,7 @@ void bdb_set_seqnum(void *in_bdb_state)
         Pthread_mutex_lock(&(bdb_state->seqnum_info->lock));
         h->seqnum.lsn = lastlsn;
         h->seqnum.generation = mygen;
+        Pthread_cond_broadcast(&(bdb_state->seqnum_info->cond));
 
         if (gbl_set_seqnum_trace && (now = time(NULL)) - lastpr) {
             logmsg(LOGMSG_USER, "%s line %d set %s seqnum to %d:%d gen %d\n",
@@ -3738,6 +3739,37 @@ void bdb_set_seqnum(void *in_bdb_state)
     }
 }
 
+/* Wait for this node to apply the log up to file:offset.  The master has
+ * applied everything it has written.  Returns 0 once the lsn is applied, 1
+ * if it isn't within timeoutms. */
+int bdb_wait_for_lsn_applied(bdb_state_type *bdb_state, uint32_t file,
+                             uint32_t offset, int timeoutms)
+{
+    DB_LSN lsn = {.file = file, .offset = offset};
+    struct timespec waittime;
+    struct hostinfo *h;
+    int behind;
+
+    if (bdb_state->parent)
+        bdb_state = bdb_state->parent;
+    if (bdb_state->repinfo->master_host == bdb_state->repinfo->myhost)
+        return 0;
+
+    h = retrieve_hostinfo(bdb_state->repinfo->myhost_interned);
+    setup_waittime(&waittime, timeoutms);
+    Pthread_mutex_lock(&(bdb_state->seqnum_info->lock));
+    while ((behind = log_compare(&h->seqnum.lsn, &lsn) < 0)) {
+        if (pthread_cond_timedwait(&(bdb_state->seqnum_info->cond),
+                                   &(bdb_state->seqnum_info->lock),
+                                   &waittime) == ETIMEDOUT) {
+            behind = log_compare(&h->seqnum.lsn, &lsn) < 0;
+            break;
+        }
+    }
+    Pthread_mutex_unlock(&(bdb_state->seqnum_info->lock));
+    return behind;
+}
+
 int gbl_online_recovery = 1;
 
 static pthread_mutex_t rep_mon_lk = PTHREAD_MUTEX_INITIALIZER;
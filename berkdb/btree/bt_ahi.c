@@ -0,0 +1,166 @@
+/*
+ * Adaptive hash index for point lookups.
+ *
+ * Each btree gets, once it has seen enough searches, a fixed table of
+ * bt_ahi_slots entries mapping the hash of a key to the leaf page it was
+ * found on and that page's LSN.  A key earns an entry after being found
+ * bt_ahi_threshold times by a full descent; a slot holding another key is
+ * only taken over once its own count has decayed, so the table keeps the
+ * keys probed most often.  A search with an entry locks and reads the leaf
+ * directly, without touching the internal pages.
+ *
+ * An entry is used only if the leaf still has the LSN we recorded, i.e. is
+ * unchanged since, and only if the key is then found on it: a key lives on
+ * exactly one leaf, so finding it there is proof we are on the right page.
+ * Anything else invalidates the entry and falls back to the descent.  This
+ * also makes torn reads of a slot harmless, so slots are read and written
+ * without a lock.
+ */
+
+#include "db_config.h"
+
+#include <sys/types.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "db_int.h"
+#include "dbinc/db_page.h"
+#include "dbinc/btree.h"
+
+#include <btree/bt_ahi.h>
+#include <crc32c.h>
+
+/* searches of a file before it gets a table */
+#define AHI_MIN_SEARCHES 1024
+
+u_int64_t bt_ahi_hits;
+u_int64_t bt_ahi_misses;
+u_int64_t bt_ahi_saved;
+u_int64_t bt_ahi_invalid;
+
+typedef struct {
+	u_int32_t hash;
+	db_pgno_t pgno;		/* PGNO_INVALID until the key is hot */
+	DB_LSN lsn;
+	u_int32_t count;
+} AhiSlot;
+
+struct bt_ahi {
+	u_int32_t nslots;
+	AhiSlot slots[];
+};
+
+static struct bt_ahi *
+ahi_get(DB *dbp)
+{
+	struct bt_ahi *ahi, *cur = NULL;
+	int nslots;
+
+	if ((ahi = dbp->ahi) != NULL)
+		return ahi;
+	nslots = dbp->dbenv->attr.bt_ahi_slots;
+	if (nslots <= 0 || dbp->pg_hash_stat.n_bt_search < AHI_MIN_SEARCHES)
+		return NULL;
+	if ((ahi = calloc(1, sizeof(*ahi) + nslots * sizeof(AhiSlot))) == NULL)
+		return NULL;
+	ahi->nslots = nslots;
+	if (!__atomic_compare_exchange_n(&dbp->ahi, &cur, ahi, 0,
+	    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+		free(ahi);
+		return cur;
+	}
+	return ahi;
+}
+
+static inline u_int32_t
+ahi_hash(const DBT *key)
+{
+	u_int32_t h = crc32c(key->data, key->size);
+
+	/* 0 marks an empty slot */
+	return h ? h : 1;
+}
+
+int
+bt_ahi_find(dbp, key, hashp, pgnop, lsnp)
+	DB *dbp;
+	const DBT *key;
+	u_int32_t *hashp;
+	db_pgno_t *pgnop;
+	DB_LSN *lsnp;
+{
+	struct bt_ahi *ahi;
+	AhiSlot *s;
+	u_int32_t hash;
+
+	if ((ahi = ahi_get(dbp)) == NULL)
+		return (-1);
+	*hashp = hash = ahi_hash(key);
+	s = &ahi->slots[hash % ahi->nslots];
+	if (s->hash != hash)
+		return (-1);
+	*pgnop = s->pgno;
+	*lsnp = s->lsn;
+	if (*pgnop == PGNO_INVALID)
+		return (-1);
+	return (0);
+}
+
+/* Key with hash was found on leaf h by a full descent */
+void
+bt_ahi_found(dbp, hash, h)
+	DB *dbp;
+	u_int32_t hash;
+	PAGE *h;
+{
+	struct bt_ahi *ahi;
+	AhiSlot *s;
+
+	if (hash == 0 || (ahi = dbp->ahi) == NULL)
+		return;
+	s = &ahi->slots[hash % ahi->nslots];
+	if (s->hash != hash) {
+		/* the slot goes to whichever key is probed more */
+		if (s->count > 1) {
+			--s->count;
+			return;
+		}
+		s->pgno = PGNO_INVALID;
+		s->hash = hash;
+		s->count = 0;
+	}
+	if (s->count < (u_int32_t)dbp->dbenv->attr.bt_ahi_threshold) {
+		++s->count;
+		if (s->count < (u_int32_t)dbp->dbenv->attr.bt_ahi_threshold)
+			return;
+	}
+	s->pgno = PGNO_INVALID;
+	s->lsn = LSN(h);
+	s->pgno = PGNO(h);
+	++bt_ahi_saved;
+}
+
+void
+bt_ahi_invalidate(dbp, hash)
+	DB *dbp;
+	u_int32_t hash;
+{
+	struct bt_ahi *ahi;
+	AhiSlot *s;
+
+	if ((ahi = dbp->ahi) == NULL)
+		return;
+	s = &ahi->slots[hash % ahi->nslots];
+	/* keep the count: the next descent records the key again */
+	if (s->hash == hash)
+		s->pgno = PGNO_INVALID;
+	++bt_ahi_invalid;
+}
+
+void
+bt_ahi_free(dbp)
+	DB *dbp;
+{
+	free(dbp->ahi);
+	dbp->ahi = NULL;
+}
@@ -0,0 +1,21 @@
+#ifndef INCLUDE_BT_AHI_H
+#define INCLUDE_BT_AHI_H
+
+extern u_int64_t bt_ahi_hits;
+extern u_int64_t bt_ahi_misses;
+extern u_int64_t bt_ahi_saved;
+extern u_int64_t bt_ahi_invalid;
+
+/*
+ * Adaptive hash index: key hash to the leaf page (and its LSN) the key was
+ * last found on, for keys looked up often enough.  bt_ahi_find returns 0
+ * and the candidate leaf if the key has an entry; the caller must confirm
+ * the key on that page.
+ */
+int bt_ahi_find(DB *, const DBT *key, u_int32_t *hashp, db_pgno_t *pgnop,
+	DB_LSN *lsnp);
+void bt_ahi_found(DB *, u_int32_t hash, PAGE *h);
+void bt_ahi_invalidate(DB *, u_int32_t hash);
+void bt_ahi_free(DB *);
+
+#endif //INCLUDE_BT_AHI_H
@@ -0,0 +1,203 @@
+/*
+ * Per-thread cache of key prefixes for internal btree pages.
+ *
+ * Every lookup binary searches the same few internal pages near the root,
+ * calling memcmp for each probe.  For a page seen more than once we keep
+ * the first 8 bytes of each of its keys as a big-endian integer; a search
+ * first narrows the page to the entries whose prefix equals that of the
+ * key with integer compares only, and leaves just those few entries to the
+ * full comparison.
+ *
+ * A page image is fully determined by its LSN, so entries are keyed by
+ * file, page number and LSN and need no invalidation.  Pages that are not
+ * logged don't get a meaningful LSN and are never cached.
+ */
+
+#include "db_config.h"
+
+#include <sys/types.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "db_int.h"
+#include "dbinc/db_page.h"
+#include "dbinc/btree.h"
+
+#include <btree/bt_keypfx.h>
+#include <flibc.h>
+#include <sys_wrap.h>
+
+typedef struct {
+	u_int8_t fileid[DB_FILE_ID_LEN];
+	db_pgno_t pgno;
+	DB_LSN lsn;
+	int built;		/* 0 if only seen once, -1 if not usable */
+	db_indx_t nent;
+	db_indx_t cap;
+	u_int64_t *pfx;
+} PfxSlot;
+
+typedef struct {
+	int count;
+	PfxSlot slots[];
+} PfxCache;
+
+u_int64_t bt_keypfx_hits;
+u_int64_t bt_keypfx_narrowed;
+
+static pthread_once_t keypfx_once = PTHREAD_ONCE_INIT;
+static pthread_key_t keypfx_key;
+
+static void
+keypfx_free(void *arg)
+{
+	PfxCache *c = arg;
+	int i;
+
+	if (c == NULL)
+		return;
+	for (i = 0; i < c->count; i++)
+		free(c->slots[i].pfx);
+	free(c);
+}
+
+static void
+keypfx_key_init(void)
+{
+	Pthread_key_create(&keypfx_key, keypfx_free);
+}
+
+static PfxCache *
+keypfx_cache(int count)
+{
+	PfxCache *c;
+
+	Pthread_once(&keypfx_once, keypfx_key_init);
+	c = pthread_getspecific(keypfx_key);
+	if (c != NULL && c->count == count)
+		return c;
+	keypfx_free(c);
+	c = NULL;
+	if (count > 0)
+		c = calloc(1, sizeof(PfxCache) + count * sizeof(PfxSlot));
+	if (c != NULL)
+		c->count = count;
+	Pthread_setspecific(keypfx_key, c);
+	return c;
+}
+
+/* First 8 bytes of a key, zero padded, as an integer.  Keys whose prefixes
+ * differ compare like their prefixes. */
+static inline u_int64_t
+keypfx(const void *data, u_int32_t len)
+{
+	u_int64_t v = 0;
+
+	memcpy(&v, data, len < sizeof(v) ? len : sizeof(v));
+	return flibc_ntohll(v);
+}
+
+static int
+keypfx_build(DB *dbp, PAGE *h, PfxSlot *s)
+{
+	BINTERNAL *bi;
+	db_indx_t i, n = NUM_ENT(h);
+
+	if (n > s->cap) {
+		u_int64_t *p = realloc(s->pfx, n * sizeof(*p));
+		if (p == NULL)
+			return -1;
+		s->pfx = p;
+		s->cap = n;
+	}
+	/* the first key of an internal page sorts below everything */
+	s->pfx[0] = 0;
+	for (i = 1; i < n; i++) {
+		bi = GET_BINTERNAL(dbp, h, i);
+		if (B_TYPE(bi) == B_OVERFLOW)
+			return -1;
+		s->pfx[i] = keypfx(bi->data, bi->len);
+	}
+	s->nent = n;
+	return 0;
+}
+
+static PfxSlot *
+keypfx_find(DB *dbp, PAGE *h)
+{
+	PfxCache *c;
+	PfxSlot *s;
+	u_int32_t hash;
+
+	c = keypfx_cache(dbp->dbenv->attr.bt_keypfx_cache);
+	if (c == NULL)
+		return NULL;
+
+	memcpy(&hash, dbp->fileid, sizeof(hash));
+	hash = (hash ^ PGNO(h)) * 2654435761U;
+	s = &c->slots[hash % c->count];
+
+	if (s->pgno == PGNO(h) && log_compare(&s->lsn, &LSN(h)) == 0 &&
+	    memcmp(s->fileid, dbp->fileid, DB_FILE_ID_LEN) == 0) {
+		if (s->built == 0)
+			/* second visit: worth the prefixes */
+			s->built = keypfx_build(dbp, h, s) == 0 ? 1 : -1;
+		return s->built == 1 ? s : NULL;
+	}
+
+	memcpy(s->fileid, dbp->fileid, DB_FILE_ID_LEN);
+	s->pgno = PGNO(h);
+	s->lsn = LSN(h);
+	s->built = 0;
+	return NULL;
+}
+
+void
+keypfx_bound(DB *dbp, PAGE *h, const DBT *key, db_indx_t *basep,
+	db_indx_t *limp)
+{
+	PfxSlot *s;
+	const u_int64_t *p;
+	u_int64_t k;
+	db_indx_t lo, hi, len, half;
+
+	if (NUM_ENT(h) < 2 || !LOGGING_ON(dbp->dbenv) ||
+	    IS_ZERO_LSN(LSN(h)) || IS_NOT_LOGGED_LSN(LSN(h)) ||
+	    F_ISSET(dbp, DB_AM_DUP))
+		return;
+	if ((s = keypfx_find(dbp, h)) == NULL)
+		return;
+
+	p = s->pfx;
+	k = keypfx(key->data, key->size);
+
+	/* first entry with a prefix >= k ... */
+	lo = 1;
+	len = s->nent - 1;
+	while (len > 0) {
+		half = len >> 1;
+		if (p[lo + half] < k) {
+			lo += half + 1;
+			len -= half + 1;
+		} else
+			len = half;
+	}
+	/* ... and the first one with a prefix > k */
+	hi = lo;
+	len = s->nent - lo;
+	while (len > 0) {
+		half = len >> 1;
+		if (p[hi + half] <= k) {
+			hi += half + 1;
+			len -= half + 1;
+		} else
+			len = half;
+	}
+
+	*basep = lo;
+	*limp = hi - lo;
+	++bt_keypfx_hits;
+	if (*limp < s->nent - 1)
+		++bt_keypfx_narrowed;
+}
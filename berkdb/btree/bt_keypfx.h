@@ -0,0 +1,17 @@
+#ifndef INCLUDE_BT_KEYPFX_H
+#define INCLUDE_BT_KEYPFX_H
+
+/* searches that used cached prefixes, and those the prefixes narrowed */
+extern u_int64_t bt_keypfx_hits;
+extern u_int64_t bt_keypfx_narrowed;
+
+/*
+ * Narrow the binary search of internal page h for key to the entries
+ * [*basep, *basep + *limp).  Entries before that range sort below key and
+ * entries from its end on sort above it.  Only valid with the default
+ * comparator.
+ */
+void keypfx_bound(DB *, PAGE *h, const DBT *key, db_indx_t *basep,
+	db_indx_t *limp);
+
+#endif //INCLUDE_BT_KEYPFX_H
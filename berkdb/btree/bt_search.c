@@ -63,6 +63,8 @@ static const char revid[] = "$Id: bt_search.c,v 11.47 2003/06/30 17:19:35 bostic
 #include <thread_util.h>
 #include <btree/bt_prefix.h>
 #include <btree/bt_cache.h>
+#include <btree/bt_keypfx.h>
+#include <btree/bt_ahi.h>
 
 #include <btree/bt_pf.h>
 
@@ -347,6 +349,10 @@ __bam_search(dbc, root_pgno, key, flags, stop, recnop, exactp)
 	int add_to_hash = 0;
 	db_pgno_t hash_pg = 0;
 	db_pgno_t pg_copy = 0;
+	int ahi_ok, ahi_jumped = 0;
+	u_int32_t ahi_hash = 0;
+	db_pgno_t ahi_pg;
+	DB_LSN ahi_lsn;
 
 	struct timeval before, after, diff;
 
@@ -356,6 +362,13 @@ __bam_search(dbc, root_pgno, key, flags, stop, recnop, exactp)
 	t = dbp->bt_internal;
 	recno = 0;
 
+	/* Point reads of the main tree can use the adaptive hash index */
+	ahi_ok = dbp->dbenv->attr.bt_ahi_slots > 0 &&
+	    root_pgno == PGNO_INVALID && recnop == NULL &&
+	    LF_ISSET(S_READ) &&
+	    !LF_ISSET(S_WRITE | S_PARENT | S_STACK | S_STK_ONLY) &&
+	    !F_ISSET(dbp, DB_AM_HASH | DB_AM_DUP | DB_AM_RECNUM) &&
+	    !F_ISSET(dbc, DBC_SNAPSHOT) && LOGGING_ON(dbp->dbenv);
 
 	BT_STK_CLR(cp);
 
@@ -388,6 +401,32 @@ try_again:
 	dbp->pg_hash_stat.n_bt_search++;
 	gettimeofday(&before, NULL);
 
+	if (ahi_ok) {
+		if (bt_ahi_find(dbp, key, &ahi_hash, &ahi_pg, &ahi_lsn) == 0) {
+			if ((ret = __db_lget(dbc,
+			    0, ahi_pg, DB_LOCK_READ, 0, &lock)) != 0)
+				return (ret);
+			if (PAGEGET(dbc, mpf, &ahi_pg, 0, &h) != 0) {
+				(void)__LPUT(dbc, lock);
+			} else if (TYPE(h) != P_LBTREE ||
+			    log_compare(&LSN(h), &ahi_lsn) != 0) {
+				PAGEPUT(dbc, mpf, h, 0);
+				(void)__LPUT(dbc, lock);
+			} else {
+				/* confirmed or undone at the leaf below */
+				ahi_jumped = 1;
+				ahi_ok = 0;
+				pg = ahi_pg;
+				lock_mode = DB_LOCK_READ;
+				goto got_pg;
+			}
+			bt_ahi_invalidate(dbp, ahi_hash);
+		} else if (dbp->ahi)
+			++bt_ahi_misses;
+		/* one try per search */
+		ahi_ok = 0;
+	}
+
 	extern int gbl_rcache;
 
 	if (gbl_rcache && pg == 1 && bfpool_pg == NULL &&
@@ -581,9 +620,12 @@ got_pg:func = t->bt_compare;
 		adjust = TYPE(h) == P_LBTREE ? P_INDX : O_INDX;
 		uint8_t buf[KEYBUF];
 
-		for (base = 0,
-		    lim = NUM_ENT(h) / (db_indx_t) adjust; lim != 0;
-		    lim >>= 1) {
+		base = 0;
+		lim = NUM_ENT(h) / (db_indx_t) adjust;
+		if (TYPE(h) == P_IBTREE && func == __bam_defcmp &&
+		    dbp->dbenv->attr.bt_keypfx_cache > 0)
+			keypfx_bound(dbp, h, key, &base, &lim);
+		for (; lim != 0; lim >>= 1) {
 			indx = base + ((lim >> 1) * adjust);
 
 			if ((ret =
@@ -609,6 +651,15 @@ got_pg:func = t->bt_compare;
 		 * Delete only deletes exact matches.
 		 */
 		if (TYPE(h) == P_LBTREE || TYPE(h) == P_LDUP) {
+			if (ahi_jumped) {
+				/* not here: the entry is of no use, descend */
+				ahi_jumped = 0;
+				PAGEPUT(dbc, mpf, h, 0);
+				(void)__LPUT(dbc, lock);
+				bt_ahi_invalidate(dbp, ahi_hash);
+				goto try_again;
+			}
+
 			*exactp = 0;
 
 			if (LF_ISSET(S_EXACT))
@@ -906,6 +957,11 @@ found:	*exactp = 1;
 	// ########################################
 #endif
 
+	if (ahi_jumped)
+		++bt_ahi_hits;
+	else if (ahi_hash != 0 && TYPE(h) == P_LBTREE)
+		bt_ahi_found(dbp, ahi_hash, h);
+
 	// only save non-root page
 	if (add_to_hash && h->pgno != 1) {
 		Pthread_mutex_lock(&(hash->mutex));
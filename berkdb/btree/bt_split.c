@@ -46,6 +46,7 @@ static const char revid[] = "$Id: bt_split.c,v 11.60 2003/06/30 17:19:35 bostic
 #ifndef NO_SYSTEM_INCLUDES
 #include <sys/types.h>
 #include <limits.h>
+#include <stdint.h>
 #include <string.h>
 #endif
 
@@ -70,6 +71,7 @@ static int __bam_broot __P((DBC *, PAGE *, PAGE *, PAGE *));
 static int __bam_page __P((DBC *, EPG *, EPG *));
 static int __bam_pinsert __P((DBC *, EPG *, PAGE *, PAGE *, int));
 static int __bam_psplit __P((DBC *, EPG *, PAGE *, PAGE *, db_indx_t *));
+static db_indx_t __bam_shortsep __P((DBC *, PAGE *, db_indx_t));
 static int __bam_root __P((DBC *, EPG *));
 static int __ram_root __P((DBC *, PAGE *, PAGE *, PAGE *));
 
@@ -1036,7 +1038,7 @@ __bam_psplit(dbc, cp, lp, rp, splitret)
 	DB *dbp;
 	PAGE *pp;
 	db_indx_t half, *inp, nbytes, off, splitp, top;
-	int adjust, cnt, iflag, isbigkey, ret;
+	int adjust, cnt, iflag, isbigkey, ret, sorted;
 
 	dbp = dbc->dbp;
 	pp = cp->page;
@@ -1081,8 +1083,11 @@ __bam_psplit(dbc, cp, lp, rp, splitret)
 		off = NUM_ENT(pp) - adjust;
 	else if (PREV_PGNO(pp) == PGNO_INVALID && cp->indx == 0)
 		off = adjust;
-	if (off != 0)
+	if (off != 0) {
+		sorted = 1;
 		goto sort;
+	}
+	sorted = 0;
 
 	/*
 	 * Split the data to the left and right pages.  Try not to split on
@@ -1187,6 +1192,15 @@ sort:	splitp = off;
 			}
 		}
 
+	/*
+	 * The key promoted to the parent is truncated to what's needed to tell
+	 * the last key on the left page from the first key on the right page
+	 * (see __bam_pinsert).  Look around the optimum for a split point that
+	 * gives a shorter separator, so more of them fit on internal pages.
+	 */
+	if (!sorted && TYPE(pp) == P_LBTREE)
+		splitp = __bam_shortsep(dbc, pp, splitp);
+
 	/*
 	 * We can't split in the middle a set of duplicates.  We know that
 	 * no duplicate set can take up more than about 25% of the page,
@@ -1230,6 +1244,93 @@ sort:	splitp = off;
 	return (0);
 }
 
+/*
+ * __bam_seplen --
+ *	Length of the separator __bam_pinsert would build if leaf page pp
+ *	were split at indx, or SIZE_MAX if it can't be truncated there.
+ */
+static size_t
+__bam_seplen(dbp, pp, indx, func)
+	DB *dbp;
+	PAGE *pp;
+	db_indx_t indx;
+	size_t (*func) __P((DB *, const DBT *, const DBT *));
+{
+	BKEYDATA *lbk, *rbk;
+	DBT a, b;
+	db_indx_t *inp;
+
+	inp = P_INP(dbp, pp);
+	if (indx < P_INDX || indx >= NUM_ENT(pp) || inp[indx] == inp[indx - P_INDX])
+		return (SIZE_MAX);
+
+	lbk = GET_BKEYDATA(dbp, pp, indx - P_INDX);
+	rbk = GET_BKEYDATA(dbp, pp, indx);
+	if (bk_decompress(dbp, pp, &lbk, alloca(KEYBUF), KEYBUF) != 0 ||
+	    bk_decompress(dbp, pp, &rbk, alloca(KEYBUF), KEYBUF) != 0)
+		return (SIZE_MAX);
+	if (B_TYPE(lbk) != B_KEYDATA || B_TYPE(rbk) != B_KEYDATA)
+		return (SIZE_MAX);
+
+	memset(&a, 0, sizeof(a));
+	a.data = lbk->data;
+	ASSIGN_ALIGN_DIFF(u_int32_t, a.size, db_indx_t, lbk->len);
+	memset(&b, 0, sizeof(b));
+	b.data = rbk->data;
+	ASSIGN_ALIGN_DIFF(u_int32_t, b.size, db_indx_t, rbk->len);
+	return (func(dbp, &a, &b));
+}
+
+/*
+ * __bam_shortsep --
+ *	Pick the split point within bt_sep_window key/data pairs of splitp
+ *	that yields the shortest separator.  Ties go to the candidate closest
+ *	to splitp, and we never stray further than an eighth of the page so
+ *	the two halves stay reasonably balanced.
+ */
+static db_indx_t
+__bam_shortsep(dbc, pp, splitp)
+	DBC *dbc;
+	PAGE *pp;
+	db_indx_t splitp;
+{
+	DB *dbp;
+	BTREE *t;
+	size_t (*func) __P((DB *, const DBT *, const DBT *));
+	size_t bestlen, len;
+	db_indx_t best, off;
+	int cnt, window;
+
+	dbp = dbc->dbp;
+	t = dbp->bt_internal;
+
+	window = dbp->dbenv->attr.bt_sep_window;
+	if (window > NUM_ENT(pp) / (8 * P_INDX))
+		window = NUM_ENT(pp) / (8 * P_INDX);
+	if (window <= 0 || F_ISSET(dbc, DBC_OPD) ||
+	    (func = t->bt_prefix) == NULL)
+		return (splitp);
+
+	best = splitp;
+	bestlen = __bam_seplen(dbp, pp, splitp, func);
+	for (cnt = 1; cnt <= window && bestlen > 1; ++cnt) {
+		off = splitp + cnt * P_INDX;
+		if (off < NUM_ENT(pp) &&
+		    (len = __bam_seplen(dbp, pp, off, func)) < bestlen) {
+			best = off;
+			bestlen = len;
+		}
+		if (splitp <= cnt * P_INDX)
+			continue;
+		off = splitp - cnt * P_INDX;
+		if ((len = __bam_seplen(dbp, pp, off, func)) < bestlen) {
+			best = off;
+			bestlen = len;
+		}
+	}
+	return (best);
+}
+
 /*
  * __bam_copy --
  *	Copy a set of records from one page to another.
@@ -2049,6 +2049,18 @@ __bam_vrfy_treeorder(dbp, pgno, h, lp, rp, func, flags)
 	    "Page %lu: last item on page sorted greater than parent entry",
 				    (u_long)PGNO(h)));
 				ret = DB_VERIFY_BAD;
+			} else if (cmp == 0 && TYPE(h) == P_LBTREE) {
+				/*
+				 * Separators above leaf pages may be suffix
+				 * truncated, which is only safe if they sort
+				 * strictly after every key on the left page;
+				 * otherwise a search for the last key would
+				 * descend into the right sibling.
+				 */
+				EPRINT((dbenv,
+	    "Page %lu: last item on page sorted equal to parent entry",
+				    (u_long)PGNO(h)));
+				ret = DB_VERIFY_BAD;
 			}
 		} else
 			EPRINT((dbenv,
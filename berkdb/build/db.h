@@ -176,6 +176,8 @@ struct __mempv_cache; typedef struct __mempv_cache MEMPV_CACHE;
 struct __mempv_cache_page_header; typedef struct __mempv_cache_page_header MEMPV_CACHE_PAGE_HEADER;
 struct __mempv_cache_page_key; typedef struct __mempv_cache_page_key MEMPV_CACHE_PAGE_KEY;
 struct __mempv_cache_page_versions; typedef struct __mempv_cache_page_versions MEMPV_CACHE_PAGE_VERSIONS;
+struct __mempv_spill_key; typedef struct __mempv_spill_key MEMPV_SPILL_KEY;
+struct __mempv_spill_ent; typedef struct __mempv_spill_ent MEMPV_SPILL_ENT;
 
 struct txn_properties;
 
@@ -936,6 +938,9 @@ struct __db_mpool_stat {
 	u_int64_t st_alloc_max_pages;	/* Max checked during allocation. */
 	u_int64_t st_ckp_pages_sync;	/* Number of pages sync'd using perfect ckp. */
 	u_int64_t st_ckp_pages_skip;	/* Number of pages skipped using perfect ckp. */
+	u_int64_t st_ckp_ms;		/* Duration of the last checkpoint flush. */
+	u_int64_t st_ckp_pages_written;	/* Pages written by the last checkpoint. */
+	u_int64_t st_page_ckp_trickle;	/* Pages written to bound ckp distance. */
 };
 
 /* Mpool file statistics structure. */
@@ -1872,6 +1877,8 @@ struct __db {
 
 	dbp_bthash_stat pg_hash_stat;
 
+	struct bt_ahi *ahi;	/* adaptive hash index, see bt_ahi.c */
+
 	LINKC_T(DB) adjlnk;
 	int inadjlist;
 
@@ -2892,6 +2899,23 @@ struct __mempv_cache_page_key
 	u_int8_t ufid[DB_FILE_ID_LEN];
 }; 
 
+struct __mempv_spill_key
+{
+	struct __mempv_cache_page_key page;
+	DB_LSN snapshot_lsn;
+};
+
+/* A page version evicted from memory and written to the spill file */
+struct __mempv_spill_ent
+{
+	struct __mempv_spill_key key;
+	off_t offset;
+	u_int32_t len;
+	int readers;	/* reads in progress without the cache lock */
+	int dropped;	/* dropped while being read; free when readers is 0 */
+	LINKC_T(struct __mempv_spill_ent) link;
+};
+
 struct __mempv_cache
 {
 	int num_cached_pages;
@@ -2899,6 +2923,19 @@ struct __mempv_cache
 	mspace *msp;
 	pthread_mutex_t lock;
 	LISTC_T(struct __mempv_cache_page_header) evict_list;
+
+	int spill_fd;
+	off_t spill_end;
+	hash_t *spilled;
+	LISTC_T(struct __mempv_spill_ent) spill_list; /* oldest first */
+	LISTC_T(struct __mempv_spill_ent) spill_free; /* reusable slots */
+
+	u_int64_t hits;
+	u_int64_t misses;
+	u_int64_t evictions;
+	u_int64_t spills;
+	u_int64_t spill_hits;
+	u_int64_t spill_drops;
 };
 
 struct __mempv {
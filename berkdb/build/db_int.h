@@ -441,6 +441,7 @@ typedef struct __dbpginfo {
  * Forward structure declarations.
  *******************************************************/
 struct __db_reginfo_t;	typedef struct __db_reginfo_t REGINFO;
+struct __db_predo;	typedef struct __db_predo DB_PREDO;
 struct __db_txnhead;	typedef struct __db_txnhead DB_TXNHEAD;
 struct __db_txnlist;	typedef struct __db_txnlist DB_TXNLIST;
 struct __vrfy_childinfo; typedef struct __vrfy_childinfo VRFY_CHILDINFO;
@@ -68,6 +68,7 @@ static const char revid[] = "$Id: db.c,v 11.283 2003/11/14 05:32:29 ubell Exp $"
 #include "dbinc/txn.h"
 #include "logmsg.h"
 #include <tohex.h>
+#include <btree/bt_ahi.h>
 
 static int __db_dbenv_mpool __P((DB *, const char *, u_int32_t));
 static int __db_disassociate __P((DB *));
@@ -1049,6 +1050,7 @@ __db_close(dbp, txn, flags)
 		}
 		dbp->pg_hash = NULL;
 	}
+	bt_ahi_free(dbp);
 
 	/* Free the database handle. */
 	memset(dbp, CLEAR_BYTE, sizeof(*dbp));
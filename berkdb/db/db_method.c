@@ -164,6 +164,7 @@ db_create(dbpp, dbenv, flags)
 		goto err;
 
 	dbp->pg_hash = NULL;
+	dbp->ahi = NULL;
 
 	dbp->type = DB_UNKNOWN;
 	*dbpp = dbp;
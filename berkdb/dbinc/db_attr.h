@@ -26,6 +26,9 @@ BERK_DEF_ATTR(check_applied_lsns_fatal, "Abort if check_applied_lsns fails", BER
 BERK_DEF_ATTR(check_applied_lsns_debug, "Lots of verbose trace for debugging applied LSNs.", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(sgio_enabled, "Do scatter gather I/O", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(sgio_max, "Max scatter gather I/O to do at one time", BERK_ATTR_TYPE_INTEGER, 10 * MEGABYTE)
+BERK_DEF_ATTR(ckp_target_distance_mb, "Trickle pages first dirtied more than this many MB of log ago, bounding the log a checkpoint or recovery has to cover (0 disables)", BERK_ATTR_TYPE_INTEGER, 0)
+BERK_DEF_ATTR(ckp_trickle_pages_per_sec, "Most pages a second written ahead of checkpoints for ckp_target_distance_mb (0 for no limit)", BERK_ATTR_TYPE_INTEGER, 2000)
+BERK_DEF_ATTR(ckp_split_pages, "Split the dirty pages of a file among writer threads every this many pages during a flush (0 writes each file from one thread)", BERK_ATTR_TYPE_INTEGER, 0)
 BERK_DEF_ATTR(btpf_enabled, "Enables index pages read ahead", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(btpf_wndw_min, "Minimum number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 100 )
 BERK_DEF_ATTR(btpf_wndw_max, "Maximum number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 1000 )
@@ -56,7 +59,10 @@ BERK_DEF_ATTR(latch_poll_us, "Poll latch this many microseconds before retrying"
 BERK_DEF_ATTR(latch_max_poll, "Poll latch this many times before returning deadlock", BERK_ATTR_TYPE_INTEGER, 5)
 BERK_DEF_ATTR(latch_timed_mutex, "Use a timed mutex", BERK_ATTR_TYPE_BOOLEAN, 1)
 BERK_DEF_ATTR(log_cursor_cache, "Cache log cursors", BERK_ATTR_TYPE_BOOLEAN, 0)
+BERK_DEF_ATTR(log_compress_keep, "Compress retained log files older than the newest this many; they stay readable by LSN (0 disables)", BERK_ATTR_TYPE_INTEGER, 0)
+BERK_DEF_ATTR(log_compress_chunk_kb, "Size in KB of the independently compressed chunks of a compressed log file", BERK_ATTR_TYPE_INTEGER, 64)
 BERK_DEF_ATTR(recovery_processor_poll_interval_us, "Recovery processor wakes this often to check workers", BERK_ATTR_TYPE_INTEGER, 1000)
+BERK_DEF_ATTR(recovery_redo_threads, "Redo single-page log records on this many threads in the forward pass of startup recovery (0 redoes serially; replicants catching up are not affected)", BERK_ATTR_TYPE_INTEGER, 0)
 BERK_DEF_ATTR(lsnerr_logflush, "Flush log on lsn error", BERK_ATTR_TYPE_BOOLEAN, 1)
 BERK_DEF_ATTR(tracked_locklist_init, "Initial allocation count for tracked locks", BERK_ATTR_TYPE_INTEGER, 10)
 /* This is a placeholder for now */
@@ -65,3 +71,8 @@ BERK_DEF_ATTR(elect_highest_committed_gen, "Bias election by the highest generat
 BERK_DEF_ATTR(sync_standalone, "Force a log-sync at commit for standalone instances", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(mempv_max_cache_entries, "Maximum number of cache entries in versioned memory pool", BERK_ATTR_TYPE_INTEGER, 50)
 BERK_DEF_ATTR(mempv_debug, "Produce debug output in versioned memory pool", BERK_ATTR_TYPE_BOOLEAN, 0)
+BERK_DEF_ATTR(mempv_spill_max_mb, "Spill page versions evicted from the versioned memory pool cache to a temporary file of up to this many MB (0 disables)", BERK_ATTR_TYPE_INTEGER, 0)
+BERK_DEF_ATTR(bt_sep_window, "On a leaf split, consider this many split points either side of the middle and pick the one giving the shortest separator key (0 disables)", BERK_ATTR_TYPE_INTEGER, 0)
+BERK_DEF_ATTR(bt_keypfx_cache, "Number of internal btree pages per thread for which the key prefixes are kept to narrow page searches (0 disables)", BERK_ATTR_TYPE_INTEGER, 32)
+BERK_DEF_ATTR(bt_ahi_slots, "Entries in the adaptive hash index of each busy btree, which sends point lookups of hot keys straight to their leaf page (0 disables)", BERK_ATTR_TYPE_INTEGER, 0)
+BERK_DEF_ATTR(bt_ahi_threshold, "Times a key must be found by a full btree search before it gets an adaptive hash index entry", BERK_ATTR_TYPE_INTEGER, 2)
@@ -67,6 +67,8 @@ struct __log_persist;	typedef struct __log_persist LOGP;
 #define	LFPREFIX	"log."		/* Log file name prefix. */
 #define	LFNAME		"log.%010d"	/* Log file name template. */
 #define	LFNAME_V1	"log.%05d"	/* Log file name template, rev 1. */
+#define	LFZSUFFIX	".lz"		/* Compressed log file suffix. */
+#define	LFZNAME		"log.%010d.lz"	/* Compressed log file template. */
 
 #define	LG_MAX_DEFAULT		(10 * MEGABYTE)	/* 10 MB. */
 #define	LG_BSIZE_DEFAULT	(32 * 1024)	/* 32 KB. */
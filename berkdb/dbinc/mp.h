@@ -171,6 +171,10 @@ struct __mpool {
 	 * know that none exist.
 	 */
 	DB_LSN	  trickle_lsn;		/* Maximum checkpoint LSN. */
+
+	/* Pacing of the pages written ahead of checkpoints. */
+	int	  ckp_trickle_ms;	/* Time of the last paced pass. */
+	int	  ckp_trickle_more;	/* Last pass ran out of budget. */
 };
 
 typedef SH_TAILQ_HEAD(HashTab, __bh) HashTab;
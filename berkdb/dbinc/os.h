@@ -76,7 +76,10 @@ struct __fh_t {
 #define	DB_FH_TEMP   	0x08		/* Unlink on close */
 #define DB_FH_DIRECT    0x10		/* On linux use to do direct IO */
 #define DB_FH_SYNC      0x20
+#define DB_FH_ZFILE     0x40		/* Chunk-compressed, see os_zfile.c */
 	u_int8_t flags;
+
+	struct __os_zfile *zfp;		/* DB_FH_ZFILE read state */
 };
 
 #if defined(__cplusplus)
@@ -969,6 +969,7 @@ __db_apprec(dbenv, max_lsn, trunclsn, update, flags)
 	char *p, *pass, t1[60], t2[60];
 	void *txninfo;
 	DB_LSN logged_checkpoint_lsn;
+	DB_PREDO *predo;
 	int start_recovery_at_dbregs;
 
 	COMPQUIET(nfiles, (double)0);
@@ -976,6 +977,7 @@ __db_apprec(dbenv, max_lsn, trunclsn, update, flags)
 	logc = NULL;
 	ckp_args = NULL;
 	dtab = NULL;
+	predo = NULL;
 
 	hi_txn = TXN_MAXIMUM;
 	txninfo = NULL;
@@ -1443,6 +1445,10 @@ __db_apprec(dbenv, max_lsn, trunclsn, update, flags)
 
 	logmsg(LOGMSG_WARN, "running forward pass from %u:%u -> %u:%u\n",
 		lsn.file, lsn.offset, stop_lsn.file, stop_lsn.offset);
+	if (dbenv->attr.recovery_redo_threads > 0 &&
+	    (ret = __db_predo_open(dbenv, txninfo,
+	    dbenv->attr.recovery_redo_threads, &predo)) != 0)
+		goto err;
 	for (ret = __log_c_get(logc, &lsn, &data, DB_NEXT);
 		ret == 0; ret = __log_c_get(logc, &lsn, &data, DB_NEXT)) {
 		/*
@@ -1466,9 +1472,12 @@ __db_apprec(dbenv, max_lsn, trunclsn, update, flags)
 			dbenv->db_feedback(dbenv, DB_RECOVER, progress);
 		}
 
-		ret = __db_dispatch(dbenv, dbenv->recover_dtab,
-			dbenv->recover_dtab_size, &data, &lsn,
-			DB_TXN_FORWARD_ROLL, txninfo);
+		if (predo != NULL)
+			ret = __db_predo_dispatch(predo, &data, &lsn);
+		else
+			ret = __db_dispatch(dbenv, dbenv->recover_dtab,
+				dbenv->recover_dtab_size, &data, &lsn,
+				DB_TXN_FORWARD_ROLL, txninfo);
 		if (ret != 0) {
 			if (ret != DB_TXN_CKP)
 				goto msgerr;
@@ -1480,6 +1489,12 @@ __db_apprec(dbenv, max_lsn, trunclsn, update, flags)
 
 	if (ret != 0 && ret != DB_NOTFOUND)
 		goto err;
+	if (predo != NULL) {
+		t_ret = __db_predo_close(predo);
+		predo = NULL;
+		if ((ret = t_ret) != 0)
+			goto err;
+	}
 	dbenv->recovery_pass = DB_TXN_NOT_IN_RECOVERY;
 
 	/*
@@ -1685,7 +1700,11 @@ msgerr:	__db_err(dbenv,
 #endif
 	}
 
-err:	if (logc != NULL && (t_ret = __log_c_close(logc)) != 0 && ret == 0)
+err:	if (predo != NULL &&
+	    (t_ret = __db_predo_close(predo)) != 0 && ret == 0)
+		ret = t_ret;
+
+	if (logc != NULL && (t_ret = __log_c_close(logc)) != 0 && ret == 0)
 		ret = t_ret;
 
 	if (txninfo != NULL)
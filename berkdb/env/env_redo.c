@@ -0,0 +1,353 @@
+/*
+ * Page-parallel redo for the forward pass of recovery.
+ *
+ * The log records that change a single btree page are handed to worker
+ * threads chosen by hashing the record's file and page number, so the
+ * records for one page are redone in log order by one thread while records
+ * for different pages are redone concurrently.  Workers only call the
+ * record's recovery function; the transaction list is consulted by the
+ * dispatching thread alone, before a record is queued.
+ *
+ * Any other record that recovery must apply is a barrier: the dispatching
+ * thread waits for the workers to drain and applies it itself, so page
+ * allocations and splits, file opens and closes and application records
+ * see the same state as in serial recovery.  Commit and checkpoint records
+ * only update the transaction list and are applied without draining.
+ *
+ * This is only used by the forward pass of __db_apprec, i.e. recovery at
+ * startup.  A replicant catching up does not come through here: it applies
+ * the master's log one transaction at a time in rep/rep_record.c, where
+ * processor_thd already spreads a transaction's records over the recovery
+ * workers by file and worker_thd applies them under the transaction's page
+ * locks.  Those workers rely on the locks, not on log order per page, so
+ * per-page queues do not apply there and recovery_redo_threads has no
+ * effect on a replicant.
+ */
+
+#include "db_config.h"
+
+#include <sys/types.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "db_int.h"
+#include "dbinc/db_page.h"
+#include "dbinc/btree.h"
+#include "dbinc/db_dispatch.h"
+#include "dbinc/db_swap.h"
+#include "dbinc/hash.h"
+#include "dbinc/log.h"
+#include "dbinc/txn.h"
+#include "dbinc_auto/db_auto.h"
+#include "dbinc_auto/txn_auto.h"
+
+#include <logmsg.h>
+#include <sys_wrap.h>
+
+/* Records queued per worker before the dispatcher waits. */
+#define	PREDO_QUEUE_MAX	4096
+
+struct __predo_rec {
+	struct __predo_rec *next;
+	DB_LSN lsn;
+	u_int32_t rectype;
+	DBT dbt;
+};
+
+struct __predo_queue {
+	struct __db_predo *pr;
+	pthread_t tid;
+	pthread_cond_t cond;
+	struct __predo_rec *head, *tail;
+	int n;
+};
+
+struct __db_predo {
+	DB_ENV *dbenv;
+	void *txninfo;
+	int nthreads;
+	int stop;
+	int pending;		/* Records queued or being redone. */
+	int ret;		/* First worker error. */
+	pthread_mutex_t lk;
+	pthread_cond_t cond;	/* Dispatcher waits here. */
+	struct __predo_queue *q;
+	u_int64_t nparallel, nserial, nbarriers;
+};
+
+static void *
+__predo_worker(arg)
+	void *arg;
+{
+	struct __predo_queue *q;
+	struct __db_predo *pr;
+	struct __predo_rec *rr;
+	DB_ENV *dbenv;
+	int ret;
+
+	q = arg;
+	pr = q->pr;
+	dbenv = pr->dbenv;
+
+	Pthread_mutex_lock(&pr->lk);
+	for (;;) {
+		while (q->head == NULL && !pr->stop)
+			Pthread_cond_wait(&q->cond, &pr->lk);
+		if ((rr = q->head) == NULL)
+			break;
+		if ((q->head = rr->next) == NULL)
+			q->tail = NULL;
+		Pthread_mutex_unlock(&pr->lk);
+
+		ret = dbenv->recover_dtab[rr->rectype](dbenv,
+		    &rr->dbt, &rr->lsn, DB_TXN_FORWARD_ROLL, pr->txninfo);
+		if (ret != 0)
+			__db_err(dbenv,
+			    "Recovery function for LSN %lu %lu failed on forward pass",
+			    (u_long)rr->lsn.file, (u_long)rr->lsn.offset);
+		__os_free(dbenv, rr);
+
+		Pthread_mutex_lock(&pr->lk);
+		if (ret != 0 && pr->ret == 0)
+			pr->ret = ret;
+		--q->n;
+		if (--pr->pending == 0 || q->n == PREDO_QUEUE_MAX - 1)
+			Pthread_cond_signal(&pr->cond);
+	}
+	Pthread_mutex_unlock(&pr->lk);
+	return (NULL);
+}
+
+/*
+ * __db_predo_open --
+ *	Start nthreads redo workers for the forward pass.
+ *
+ * PUBLIC: int __db_predo_open __P((DB_ENV *, void *, int, DB_PREDO **));
+ */
+int
+__db_predo_open(dbenv, txninfo, nthreads, prp)
+	DB_ENV *dbenv;
+	void *txninfo;
+	int nthreads;
+	DB_PREDO **prp;
+{
+	DB_PREDO *pr;
+	int i, ret;
+
+	if ((ret = __os_calloc(dbenv, 1, sizeof(*pr), &pr)) != 0)
+		return (ret);
+	if ((ret = __os_calloc(dbenv,
+	    nthreads, sizeof(*pr->q), &pr->q)) != 0) {
+		__os_free(dbenv, pr);
+		return (ret);
+	}
+	pr->dbenv = dbenv;
+	pr->txninfo = txninfo;
+	Pthread_mutex_init(&pr->lk, NULL);
+	Pthread_cond_init(&pr->cond, NULL);
+
+	for (i = 0; i < nthreads; i++) {
+		pr->q[i].pr = pr;
+		Pthread_cond_init(&pr->q[i].cond, NULL);
+		if ((ret = pthread_create(&pr->q[i].tid,
+		    NULL, __predo_worker, &pr->q[i])) != 0) {
+			__db_err(dbenv, "can't start redo thread: %s",
+			    strerror(ret));
+			Pthread_cond_destroy(&pr->q[i].cond);
+			break;
+		}
+		pr->nthreads++;
+	}
+	if (pr->nthreads == 0) {
+		(void)__db_predo_close(pr);
+		return (ret);
+	}
+
+	logmsg(LOGMSG_INFO, "redoing single-page records on %d threads\n",
+	    pr->nthreads);
+	*prp = pr;
+	return (0);
+}
+
+/* Wait until all queued records are redone. */
+static int
+__predo_drain(pr)
+	DB_PREDO *pr;
+{
+	int ret;
+
+	Pthread_mutex_lock(&pr->lk);
+	while (pr->pending > 0)
+		Pthread_cond_wait(&pr->cond, &pr->lk);
+	ret = pr->ret;
+	Pthread_mutex_unlock(&pr->lk);
+	return (ret);
+}
+
+/*
+ * __db_predo_close --
+ *	Redo what is still queued and stop the workers.
+ *
+ * PUBLIC: int __db_predo_close __P((DB_PREDO *));
+ */
+int
+__db_predo_close(pr)
+	DB_PREDO *pr;
+{
+	DB_ENV *dbenv;
+	int i, ret;
+
+	dbenv = pr->dbenv;
+	ret = __predo_drain(pr);
+
+	Pthread_mutex_lock(&pr->lk);
+	pr->stop = 1;
+	for (i = 0; i < pr->nthreads; i++)
+		Pthread_cond_signal(&pr->q[i].cond);
+	Pthread_mutex_unlock(&pr->lk);
+
+	for (i = 0; i < pr->nthreads; i++) {
+		Pthread_join(pr->q[i].tid, NULL);
+		Pthread_cond_destroy(&pr->q[i].cond);
+	}
+	if (pr->nthreads > 0)
+		logmsg(LOGMSG_INFO,
+		    "redo: %"PRIu64" records in parallel, %"PRIu64
+		    " serially, %"PRIu64" barriers\n",
+		    pr->nparallel, pr->nserial, pr->nbarriers);
+
+	Pthread_cond_destroy(&pr->cond);
+	Pthread_mutex_destroy(&pr->lk);
+	__os_free(dbenv, pr->q);
+	__os_free(dbenv, pr);
+	return (ret);
+}
+
+#define	PREDO_PAGE(type, readfn) do {					\
+	type *argp;							\
+	if (readfn(dbenv, data, 0, &argp) != 0)				\
+		return (0);						\
+	if (ufid)							\
+		*keyp = __ham_func4(NULL,				\
+		    argp->ufid_fileid, DB_FILE_ID_LEN);			\
+	else								\
+		*keyp = (u_int32_t)argp->fileid;			\
+	*keyp = *keyp * 0x9e3779b1 ^ argp->pgno;			\
+	__os_free(dbenv, argp);						\
+	return (1);							\
+} while (0)
+
+/*
+ * Return 1 and a key for the page if rectype only changes one page, 0 if
+ * the record has to be applied serially.
+ */
+static int
+__predo_page(dbenv, rectype, data, keyp)
+	DB_ENV *dbenv;
+	u_int32_t rectype;
+	void *data;
+	u_int32_t *keyp;
+{
+	int ufid;
+
+	if ((ufid = (rectype > 1000)))
+		rectype -= 1000;
+	switch (rectype) {
+	case DB___db_addrem:
+		PREDO_PAGE(__db_addrem_args, __db_addrem_read_int);
+	case DB___db_ovref:
+		PREDO_PAGE(__db_ovref_args, __db_ovref_read_int);
+	case DB___bam_repl:
+		PREDO_PAGE(__bam_repl_args, __bam_repl_read_int);
+	case DB___bam_cdel:
+		PREDO_PAGE(__bam_cdel_args, __bam_cdel_read_int);
+	default:
+		return (0);
+	}
+}
+
+/*
+ * __db_predo_dispatch --
+ *	Forward-roll one log record, on a worker if it changes a single page.
+ *
+ * PUBLIC: int __db_predo_dispatch __P((DB_PREDO *, DBT *, DB_LSN *));
+ */
+int
+__db_predo_dispatch(pr, data, lsnp)
+	DB_PREDO *pr;
+	DBT *data;
+	DB_LSN *lsnp;
+{
+	DB_ENV *dbenv;
+	struct __predo_queue *q;
+	struct __predo_rec *rr;
+	u_int32_t key, rectype, txnid;
+	int ret;
+
+	dbenv = pr->dbenv;
+	/* a worker's error, set under pr->lk */
+	Pthread_mutex_lock(&pr->lk);
+	ret = pr->ret;
+	Pthread_mutex_unlock(&pr->lk);
+	if (ret != 0)
+		return (ret);
+
+	LOGCOPY_32(&rectype, data->data);
+	normalize_rectype(&rectype);
+	LOGCOPY_32(&txnid, (u_int8_t *)data->data + sizeof(rectype));
+
+	if (txnid != 0 && __predo_page(dbenv, rectype, data->data, &key)) {
+		/* Uncommitted changes are not redone, as in __db_dispatch. */
+		if (__db_txnlist_find(dbenv, pr->txninfo, txnid) != TXN_COMMIT)
+			return (0);
+
+		if ((ret = __os_malloc(dbenv,
+		    sizeof(*rr) + data->size, &rr)) != 0)
+			return (ret);
+		memset(rr, 0, sizeof(*rr));
+		rr->lsn = *lsnp;
+		rr->rectype = rectype > 1000 ? rectype - 1000 : rectype;
+		rr->dbt.data = &rr[1];
+		rr->dbt.size = data->size;
+		memcpy(rr->dbt.data, data->data, data->size);
+
+		q = &pr->q[key % pr->nthreads];
+		Pthread_mutex_lock(&pr->lk);
+		while (q->n >= PREDO_QUEUE_MAX && pr->ret == 0)
+			Pthread_cond_wait(&pr->cond, &pr->lk);
+		if ((ret = pr->ret) != 0) {
+			Pthread_mutex_unlock(&pr->lk);
+			__os_free(dbenv, rr);
+			return (ret);
+		}
+		if (q->tail != NULL)
+			q->tail->next = rr;
+		else
+			q->head = rr;
+		q->tail = rr;
+		q->n++;
+		pr->pending++;
+		pr->nparallel++;
+		Pthread_cond_signal(&q->cond);
+		Pthread_mutex_unlock(&pr->lk);
+		return (0);
+	}
+
+	switch (rectype) {
+	case DB___txn_regop:
+	case DB___txn_regop_gen:
+	case DB___txn_ckp:
+	case DB___txn_ckp_recovery:
+		break;
+	default:
+		pr->nbarriers++;
+		if ((ret = __predo_drain(pr)) != 0)
+			return (ret);
+		break;
+	}
+	pr->nserial++;
+	return (__db_dispatch(dbenv, dbenv->recover_dtab,
+	    dbenv->recover_dtab_size, data, lsnp, DB_TXN_FORWARD_ROLL,
+	    pr->txninfo));
+}
@@ -518,12 +518,13 @@ retry:	/* Get the list of file names. */
 
 		/*
 		 * Names of the form log\.[0-9]* are reserved for DB.  Other
-		 * names sharing LFPREFIX, such as "log.db", are legal.
+		 * names sharing LFPREFIX, such as "log.db", are legal.  A
+		 * compressed log file has LFZSUFFIX appended.
 		 */
 		for (c = names[cnt] + sizeof(LFPREFIX) - 1; *c != '\0'; c++)
 			if (!isdigit((int)*c))
 				break;
-		if (*c != '\0')
+		if (*c != '\0' && strcmp(c, LFZSUFFIX) != 0)
 			continue;
 
 		/*
@@ -125,7 +125,7 @@ __log_archive(dbenv, listp, flags)
 	DB_LOGC *logc = NULL;
 	DB_LSN stable_lsn;
 	__txn_ckp_args *ckp_args = NULL;
-	char **array, **arrayp, *name, *p, *pref, buf[MAXPATHLEN];
+	char **array, **arrayp, *name, *zname, *p, *pref, buf[MAXPATHLEN];
 	int array_size, db_arch_abs, n, rep_check, ret;
 	u_int32_t fnum;
 	int start_recovery_at_dbregs = dbenv->attr.start_recovery_at_dbregs;
@@ -281,6 +281,15 @@ __log_archive(dbenv, listp, flags)
 	for (n = 0; fnum > 0; --fnum) {
 		if ((ret = __log_name(dblp, fnum, &name, NULL, 0)) != 0)
 			goto err;
+		/* compressed log files are listed under their own name */
+		if (__os_exists(name, NULL) != 0 &&
+		    __log_zname(dblp, fnum, &zname) == 0) {
+			if (__os_exists(zname, NULL) == 0) {
+				__os_free(dbenv, name);
+				name = zname;
+			} else
+				__os_free(dbenv, zname);
+		}
 		if (__os_exists(name, NULL) != 0) {
 			if (LF_ISSET(DB_ARCH_LOG) && fnum == stable_lsn.file)
 				continue;
@@ -0,0 +1,235 @@
+/*
+ * Compression of retained log files.
+ *
+ * Log files kept around for replicants catching up, physical replication
+ * and backups are rarely read.  Once a file is older than the newest
+ * log_compress_keep files, __log_compress_old rewrites it as LFZNAME with
+ * __os_zcompress and removes the original.  __log_name falls back to the
+ * compressed name when opening a log file read-only and hands back a
+ * handle that reads like the original file, so log cursors, and the rep
+ * log cache and physical replication which read through them, find any
+ * LSN as before.
+ *
+ * The compressed file is renamed into place before the original is
+ * removed, so a reader always finds one of the two.
+ */
+
+#include "db_config.h"
+
+#include <sys/types.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "db_int.h"
+#include "dbinc/log.h"
+#include "dbinc/txn.h"
+
+#include <logmsg.h>
+
+/*
+ * __log_zname --
+ *	Return the name of the compressed version of a log file.
+ *
+ * PUBLIC: int __log_zname __P((DB_LOG *, u_int32_t, char **));
+ */
+int
+__log_zname(dblp, filenumber, namep)
+	DB_LOG *dblp;
+	u_int32_t filenumber;
+	char **namep;
+{
+	char name[sizeof(LFPREFIX) + 10 + sizeof(LFZSUFFIX) + 20];
+
+	(void)snprintf(name, sizeof(name), LFZNAME, filenumber);
+	return (__db_appname(dblp->dbenv, DB_APP_LOG, name, 0, NULL, namep));
+}
+
+static int
+__log_tmpname(dbenv, name, tmpp)
+	DB_ENV *dbenv;
+	const char *name;
+	char **tmpp;
+{
+	size_t len;
+	int ret;
+
+	len = strlen(name) + sizeof(".tmp");
+	if ((ret = __os_malloc(dbenv, len, tmpp)) != 0)
+		return (ret);
+	(void)snprintf(*tmpp, len, "%s.tmp", name);
+	return (0);
+}
+
+/*
+ * Replace log file fnum by its compressed version (compress != 0) or the
+ * other way round.
+ */
+static int
+__log_zswap(dblp, fnum, compress)
+	DB_LOG *dblp;
+	u_int32_t fnum;
+	int compress;
+{
+	DB_ENV *dbenv;
+	LOG *lp;
+	char *name, *zname, *tmp;
+	const char *from, *to;
+	u_int32_t chunk;
+	int ret;
+
+	dbenv = dblp->dbenv;
+	lp = dblp->reginfo.primary;
+	name = zname = tmp = NULL;
+
+	if ((ret = __log_name(dblp, fnum, &name, NULL, 0)) != 0 ||
+	    (ret = __log_zname(dblp, fnum, &zname)) != 0)
+		goto err;
+	from = compress ? name : zname;
+	to = compress ? zname : name;
+	if (__os_exists(from, NULL) != 0) {
+		ret = ENOENT;
+		goto err;
+	}
+	if ((ret = __log_tmpname(dbenv, to, &tmp)) != 0)
+		goto err;
+
+	if (compress) {
+		chunk = dbenv->attr.log_compress_chunk_kb > 0 ?
+		    dbenv->attr.log_compress_chunk_kb * 1024 : 64 * 1024;
+		ret = __os_zcompress(dbenv, from, tmp, chunk, lp->persist.mode);
+	}
+	else
+		ret = __os_zexpand(dbenv, from, tmp, lp->persist.mode);
+	if (ret != 0)
+		goto err;
+	if ((ret = __os_rename(dbenv, tmp, to, 0)) != 0) {
+		(void)__os_unlink(dbenv, tmp);
+		goto err;
+	}
+	ret = __os_unlink(dbenv, from);
+
+err:	if (ret != 0 && ret != ENOENT)
+		__db_err(dbenv, "%s log file %u: %s",
+		    compress ? "compressing" : "uncompressing", fnum,
+		    db_strerror(ret));
+	if (name != NULL)
+		__os_free(dbenv, name);
+	if (zname != NULL)
+		__os_free(dbenv, zname);
+	if (tmp != NULL)
+		__os_free(dbenv, tmp);
+	return (ret);
+}
+
+/*
+ * __log_uncompress_file --
+ *	Restore a compressed log file, so that it can be written again.
+ *
+ * PUBLIC: int __log_uncompress_file __P((DB_LOG *, u_int32_t));
+ */
+int
+__log_uncompress_file(dblp, fnum)
+	DB_LOG *dblp;
+	u_int32_t fnum;
+{
+	return (__log_zswap(dblp, fnum, 0));
+}
+
+static int
+__log_plain_exists(dblp, fnum)
+	DB_LOG *dblp;
+	u_int32_t fnum;
+{
+	char *name;
+	int exists;
+
+	if (__log_name(dblp, fnum, &name, NULL, 0) != 0)
+		return (0);
+	exists = __os_exists(name, NULL) == 0;
+	__os_free(dblp->dbenv, name);
+	return (exists);
+}
+
+/*
+ * Recovery starts reading at the checkpoint LSN of the last checkpoint, or
+ * earlier with start_recovery_at_dbregs; return the file holding that
+ * point, the same one log archive keeps, or 0 if there is no checkpoint.
+ */
+static u_int32_t
+__log_compress_stable_file(dbenv)
+	DB_ENV *dbenv;
+{
+	DBT rec;
+	DB_LOGC *logc;
+	DB_LSN lsn, recover_lsn;
+	__txn_ckp_args *ckp_args;
+	u_int32_t fnum;
+
+	if (__txn_getckp(dbenv, &lsn) != 0 || __log_cursor(dbenv, &logc) != 0)
+		return (0);
+	fnum = 0;
+	memset(&rec, 0, sizeof(rec));
+	if (__log_c_get(logc, &lsn, &rec, DB_SET) == 0 &&
+	    __txn_ckp_read(dbenv, rec.data, &ckp_args) == 0) {
+		fnum = ckp_args->ckp_lsn.file;
+		__os_free(dbenv, ckp_args);
+	}
+	(void)__log_c_close(logc);
+
+	if (fnum != 0 && dbenv->attr.start_recovery_at_dbregs &&
+	    __env_find_verify_recover_start(dbenv, &recover_lsn) == 0 &&
+	    recover_lsn.file < fnum)
+		fnum = recover_lsn.file;
+	return (fnum);
+}
+
+/*
+ * __log_compress_old --
+ *	Compress the log files older than the newest log_compress_keep ones,
+ * and older than the file recovery would start from, oldest first.
+ * Returns the number of files compressed.
+ *
+ * PUBLIC: int __log_compress_old __P((DB_ENV *));
+ */
+int
+__log_compress_old(dbenv)
+	DB_ENV *dbenv;
+{
+	DB_LOG *dblp;
+	LOG *lp;
+	u_int32_t cur, hi, lo, fnum, stable;
+	int keep, n;
+
+	keep = dbenv->attr.log_compress_keep;
+	if (keep <= 0 || !LOGGING_ON(dbenv))
+		return (0);
+
+	dblp = dbenv->lg_handle;
+	lp = dblp->reginfo.primary;
+	R_LOCK(dbenv, &dblp->reginfo);
+	cur = lp->lsn.file;
+	R_UNLOCK(dbenv, &dblp->reginfo);
+
+	if (cur <= (u_int32_t)keep)
+		return (0);
+	hi = cur - keep;
+
+	if ((stable = __log_compress_stable_file(dbenv)) <= 1)
+		return (0);
+	if (hi > stable - 1)
+		hi = stable - 1;
+
+	/* files below the oldest plain one were done on earlier passes */
+	for (lo = hi + 1; lo > 1 && __log_plain_exists(dblp, lo - 1); lo--)
+		;
+
+	for (n = 0, fnum = lo; fnum <= hi; fnum++) {
+		if (__log_zswap(dblp, fnum, 1) != 0)
+			break;
+		n++;
+	}
+	if (n > 0)
+		logmsg(LOGMSG_INFO, "compressed log files %u to %u\n",
+		    lo, lo + n - 1);
+	return (n);
+}
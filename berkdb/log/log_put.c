@@ -2209,6 +2209,28 @@ __log_name(dblp, filenumber, namep, fhpp, flags)
 		return (0);
 	}
 
+	/*
+	 * A retained log file may have been compressed.  Readers get a handle
+	 * that reads the original contents; a writer (truncating the log back
+	 * into it) gets the file restored first.
+	 */
+	if (__log_zname(dblp, filenumber, &oname) == 0) {
+		if (LF_ISSET(DB_OSO_RDONLY)) {
+			if (__os_zopen(dbenv, oname, fhpp) == 0) {
+				__os_free(dbenv, *namep);
+				*namep = oname;
+				return (0);
+			}
+		} else if (__os_exists(oname, NULL) == 0 &&
+		    __log_uncompress_file(dblp, filenumber) == 0 &&
+		    __os_open_extend(dbenv, *namep, lp->log_size,
+		    0, flags, lp->persist.mode, fhpp) == 0) {
+			__os_free(dbenv, oname);
+			return (0);
+		}
+		__os_free(dbenv, oname);
+	}
+
 	/*
 	 * The open failed... if the DB_RDONLY flag isn't set, we're done,
 	 * the caller isn't interested in old-style files.
@@ -558,6 +558,7 @@ berkdb_verify_lsn_written_to_disk(DB_ENV *dbenv, DB_LSN *lsn,
 	char *logname;
 	int rc;
 	HDR hdr = { 0 };
+	size_t nr = 0;
 	uint8_t *logent = NULL;
 	u_int32_t type = 0;
 
@@ -590,11 +591,12 @@ berkdb_verify_lsn_written_to_disk(DB_ENV *dbenv, DB_LSN *lsn,
 		hdrsz = HDR_NORMAL_SZ;
 		is_hmac = 0;
 	}
-	rc = read(fh->fd, &hdr, hdrsz);
-	if (rc != hdrsz) {
+	/* __os_read, not read: the log file may be compressed */
+	rc = __os_read(dbenv, fh, &hdr, hdrsz, &nr);
+	if (rc != 0 || nr != hdrsz) {
 		__db_err(dbenv,
-		    "error reading log record header at %u:%u errno:%d expect:%d got:%d\n",
-		    lsn->file, lsn->offset, errno, (int)hdrsz, rc);
+		    "error reading log record header at %u:%u rc:%d expect:%d got:%d\n",
+		    lsn->file, lsn->offset, rc, (int)hdrsz, (int)nr);
 		__os_closehandle(dbenv, fh);
 		return 1;
 	}
@@ -619,11 +621,11 @@ berkdb_verify_lsn_written_to_disk(DB_ENV *dbenv, DB_LSN *lsn,
 		return 1;
 	}
 
-	rc = read(fh->fd, logent, len);
-	if (rc != len) {
+	rc = __os_read(dbenv, fh, logent, len, &nr);
+	if (rc != 0 || nr != len) {
 		__db_err(dbenv,
-		    "error reading log record at %u:%u errno:%d expect:%u got:%d\n",
-		    lsn->file, lsn->offset, errno, len, rc);
+		    "error reading log record at %u:%u rc:%d expect:%u got:%d\n",
+		    lsn->file, lsn->offset, rc, len, (int)nr);
 		__os_closehandle(dbenv, fh);
 		if (logent)
 			__os_free(dbenv, logent);
@@ -172,6 +172,10 @@ __memp_stat(dbenv, gspp, fspp, flags)
 				    c_mp->stat.st_alloc_max_pages;
 			sp->st_ckp_pages_sync += c_mp->stat.st_ckp_pages_sync;
 			sp->st_ckp_pages_skip += c_mp->stat.st_ckp_pages_skip;
+			sp->st_ckp_ms += c_mp->stat.st_ckp_ms;
+			sp->st_ckp_pages_written +=
+			    c_mp->stat.st_ckp_pages_written;
+			sp->st_page_ckp_trickle += c_mp->stat.st_page_ckp_trickle;
 
 			if (LF_ISSET(DB_STAT_CLEAR)) {
 				dbmp->reginfo[i].rp->mutex.mutex_set_wait = 0;
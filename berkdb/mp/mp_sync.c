@@ -1144,7 +1144,7 @@ __memp_sync_int(dbenv, dbmfp, trickle_max, op, wrotep, restartable,
 	u_int32_t n_cache;
 	int ar_cnt, ar_max, i, j, ret, t_ret;
 	int wrote;
-	int do_parallel;
+	int do_parallel, split;
 	struct trickler *pt;
 	struct writable_range *range;
 	int start, end;
@@ -1194,6 +1194,7 @@ __memp_sync_int(dbenv, dbmfp, trickle_max, op, wrotep, restartable,
 	wrote = 0;
 
 	do_parallel = gbl_parallel_memptrickle;
+	split = dbenv->attr.ckp_split_pages;
 
 	start = comdb2_time_epochms();
 
@@ -1355,8 +1356,10 @@ __memp_sync_int(dbenv, dbmfp, trickle_max, op, wrotep, restartable,
 			}
 			ar_cnt = j;
 		}
-		c_mp->stat.st_ckp_pages_skip += accum_skip;
-		c_mp->stat.st_ckp_pages_sync += accum_sync;
+		if (op == DB_SYNC_CACHE) {
+			c_mp->stat.st_ckp_pages_skip += accum_skip;
+			c_mp->stat.st_ckp_pages_sync += accum_sync;
+		}
 	}
 
 	/* If there no buffers to write, we're done. */
@@ -1425,14 +1428,20 @@ __memp_sync_int(dbenv, dbmfp, trickle_max, op, wrotep, restartable,
 
 	/*
 	 * Flush each file by passing it to a thread. This serializes writes
-	 * to a file, which may help throughput and performance.
+	 * to a file, which may help throughput and performance.  With
+	 * ckp_split_pages set, a file with more dirty pages than that is
+	 * handed out in several ranges, cut between non-adjacent pages so
+	 * that no gathered write is broken up.
 	 */
 	if (do_parallel &&
 	    (op == DB_SYNC_TRICKLE || op == DB_SYNC_LRU ||
 		op == DB_SYNC_CACHE)) {
 
 		for (i = 1, j = 0; i < ar_cnt; ++i) {
-			if (bharray[j].track_mfp != bharray[i].track_mfp) {
+			if (bharray[j].track_mfp != bharray[i].track_mfp ||
+			    (split > 0 && i - j >= split &&
+			     bharray[i].track_pgno !=
+			     bharray[i - 1].track_pgno + 1)) {
 				Pthread_mutex_lock(&pgpool_lk);
 				range = pool_getablk(pgpool);
 				Pthread_mutex_unlock(&pgpool_lk);
@@ -1575,6 +1584,11 @@ err:	__os_free(dbenv, bharray);
 
 	end = comdb2_time_epochms();
 
+	if (ret == 0 && op == DB_SYNC_CACHE && dbmfp == NULL) {
+		mp->stat.st_ckp_ms = end - start;
+		mp->stat.st_ckp_pages_written = wrote;
+	}
+
 	if (wrote && ((end - start) > memp_sync_alarm_ms))
 		ctrace("memp_sync %d pages %d ms (memp_sync_files %d ms)\n",
 		    wrote, end - start, memp_sync_files_time);
@@ -13,6 +13,7 @@ static const char revid[] = "$Id: mp_trickle.c,v 11.30 2003/09/13 19:20:41 bosti
 #ifndef NO_SYSTEM_INCLUDES
 #include <sys/types.h>
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #endif
@@ -23,8 +24,10 @@ static const char revid[] = "$Id: mp_trickle.c,v 11.30 2003/09/13 19:20:41 bosti
 #include "dbinc/mp.h"
 
 #include <time.h>
+#include <epochlib.h>
 
 static int __memp_trickle __P((DB_ENV *, int, int *, int));
+static int __memp_trickle_ckp __P((DB_ENV *, DB_LSN *, int *));
 
 /*
  * __memp_trickle_pp --
@@ -65,7 +68,7 @@ __memp_trickle(dbenv, pct, nwrotep, lru)
 	MPOOL *c_mp, *mp;
 	DB_LSN last_lsn;
 	u_int32_t dirty, i, total, dtmp;
-	int n, ret, wrote;
+	int ckp_wrote, n, ret, wrote;
 
 	dbmp = dbenv->mp_handle;
 	mp = dbmp->reginfo[0].primary;
@@ -73,12 +76,23 @@ __memp_trickle(dbenv, pct, nwrotep, lru)
 	if (nwrotep != NULL)
 		*nwrotep = 0;
 
-	if (pct < 1 || pct > 100)
+	/* 0 leaves only the pages written ahead of checkpoints */
+	if (pct < 0 || pct > 100)
 		return (EINVAL);
 
 	__log_get_last_lsn(dbenv, &last_lsn);
-	if (log_compare(&last_lsn, &mp->trickle_lsn) <= 0)
+
+	/* These may be left over from a pass that ran out of budget. */
+	ckp_wrote = 0;
+	if ((ret = __memp_trickle_ckp(dbenv, &last_lsn, &ckp_wrote)) != 0)
+		return (ret);
+	if (pct == 0 || log_compare(&last_lsn, &mp->trickle_lsn) <= 0) {
+		if (pct == 0)
+			mp->trickle_lsn = last_lsn;
+		if (nwrotep != NULL)
+			*nwrotep = ckp_wrote;
 		return (0);
+	}
 
 	/*
 	 * If there are sufficient clean buffers, no buffers or no dirty
@@ -121,6 +135,81 @@ __memp_trickle(dbenv, pct, nwrotep, lru)
 	mp->stat.st_page_trickle += *nwrotep;
 
 done:	memcpy(&mp->trickle_lsn, &last_lsn, sizeof(DB_LSN));
+	if (nwrotep != NULL)
+		*nwrotep += ckp_wrote;
+
+	return (ret);
+}
+
+/*
+ * __memp_trickle_ckp --
+ *	Write the pages first dirtied more than ckp_target_distance_mb of log
+ * before last_lsnp, so that the next checkpoint finds few pages left to
+ * write and recovery has at most about that much log to replay.  Pinned and
+ * locked pages are skipped; the next pass picks them up.
+ *
+ *	Writes are paced to ckp_trickle_pages_per_sec: a pass gets the budget
+ * accumulated since the last one, at most a second's worth, so a burst of
+ * old pages is spread out instead of written at once.
+ */
+static int
+__memp_trickle_ckp(dbenv, last_lsnp, nwrotep)
+	DB_ENV *dbenv;
+	DB_LSN *last_lsnp;
+	int *nwrotep;
+{
+	DB_LOG *dblp;
+	DB_LSN target;
+	DB_MPOOL *dbmp;
+	LOG *lp;
+	MPOOL *mp;
+	u_int64_t dist;
+	int budget, now, rate, ret, wrote;
+
+	if (dbenv->attr.ckp_target_distance_mb <= 0 || !LOGGING_ON(dbenv))
+		return (0);
+
+	dbmp = dbenv->mp_handle;
+	mp = dbmp->reginfo[0].primary;
+	if (!mp->ckp_trickle_more &&
+	    log_compare(last_lsnp, &mp->trickle_lsn) <= 0)
+		return (0);
+
+	budget = INT_MAX;
+	now = comdb2_time_epochms();
+	if ((rate = dbenv->attr.ckp_trickle_pages_per_sec) > 0) {
+		if (mp->ckp_trickle_ms == 0 || now - mp->ckp_trickle_ms >= 1000)
+			budget = rate;
+		else
+			budget =
+			    (int)((int64_t)rate * (now - mp->ckp_trickle_ms) /
+			    1000);
+		if (budget <= 0)
+			return (0);
+	}
+
+	dblp = dbenv->lg_handle;
+	lp = dblp->reginfo.primary;
+	dist = (u_int64_t)dbenv->attr.ckp_target_distance_mb * MEGABYTE;
+
+	/* Step back dist bytes, counting earlier files as full-sized. */
+	target = *last_lsnp;
+	while (dist > target.offset) {
+		if (target.file <= 1 || lp->log_size == 0)
+			return (0);
+		dist -= target.offset;
+		--target.file;
+		target.offset = lp->log_size;
+	}
+	target.offset -= (u_int32_t)dist;
+
+	wrote = 0;
+	ret = __memp_sync_int(dbenv, NULL, budget, DB_SYNC_TRICKLE, &wrote,
+	    1, &target, 1);
 
+	mp->ckp_trickle_ms = now;
+	mp->ckp_trickle_more = (wrote >= budget);
+	mp->stat.st_page_ckp_trickle += wrote;
+	*nwrotep = wrote;
 	return (ret);
 }
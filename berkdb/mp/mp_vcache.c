@@ -1,3 +1,6 @@
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "db_config.h"
 #include "db_int.h"
 #include "dbinc/btree.h"
@@ -64,6 +67,20 @@ int __mempv_cache_init(dbenv, cache)
 
 	listc_init(&cache->evict_list, offsetof(MEMPV_CACHE_PAGE_HEADER, evict_link)); 
 
+	cache->spill_fd = -1;
+	cache->spill_end = 0;
+	cache->spilled = hash_init_o(offsetof(MEMPV_SPILL_ENT, key), sizeof(MEMPV_SPILL_KEY));
+	if (cache->spilled == NULL) {
+		hash_free(cache->pages);
+		ret = ENOMEM;
+		goto done;
+	}
+	listc_init(&cache->spill_list, offsetof(MEMPV_SPILL_ENT, link));
+	listc_init(&cache->spill_free, offsetof(MEMPV_SPILL_ENT, link));
+
+	cache->hits = cache->misses = cache->evictions = 0;
+	cache->spills = cache->spill_hits = cache->spill_drops = 0;
+
 	pthread_mutex_init(&(cache->lock), NULL);
 done:
 	return ret;
@@ -82,12 +99,215 @@ done:
 void __mempv_cache_destroy(cache)
 	MEMPV_CACHE *cache;
 {
+	MEMPV_SPILL_ENT *ent;
+
 	hash_for(cache->pages, (hashforfunc_t *const) __mempv_cache_page_destroy, NULL);
 	destroy_hash(cache->pages, free_it);
 
+	hash_free(cache->spilled);
+	while ((ent = listc_rtl(&cache->spill_list)) != NULL)
+		free(ent);
+	while ((ent = listc_rtl(&cache->spill_free)) != NULL)
+		free(ent);
+	if (cache->spill_fd >= 0)
+		Close(cache->spill_fd);
+
 	pthread_mutex_destroy(&(cache->lock));
 }
 
+/*
+ * __mempv_spill_open --
+ * Lazily creates the spill file. The file is unlinked right away, so it
+ * goes away with the process.
+ *
+ * Returns 0 on success and non-0 on failure.
+ */
+static int __mempv_spill_open(dbenv, cache)
+	DB_ENV *dbenv;
+	MEMPV_CACHE *cache;
+{
+	char path[PATH_MAX];
+
+	snprintf(path, sizeof(path), "%s/mempv_spill.%d",
+	    dbenv->db_tmp_dir ? dbenv->db_tmp_dir : "/tmp", (int)getpid());
+
+	cache->spill_fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+	if (cache->spill_fd < 0) {
+		logmsg(LOGMSG_ERROR, "%s: failed to create %s: %d %s\n",
+		    __func__, path, errno, strerror(errno));
+		return errno;
+	}
+	unlink(path);
+	cache->spill_end = 0;
+
+	return 0;
+}
+
+/*
+ * __mempv_spill_drop --
+ * Forgets the oldest spilled page version; its slot in the file is reused
+ * once no reader is still copying it out.
+ * Called with the cache lock held.
+ */
+static void __mempv_spill_drop(cache)
+	MEMPV_CACHE *cache;
+{
+	MEMPV_SPILL_ENT *ent;
+
+	ent = listc_rtl(&cache->spill_list);
+	hash_del(cache->spilled, ent);
+	if (ent->readers > 0)
+		ent->dropped = 1;
+	else
+		listc_abl(&cache->spill_free, ent);
+	cache->spill_drops++;
+}
+
+/*
+ * __mempv_spill_reserve --
+ * Picks a slot in the spill file for a page version being evicted from
+ * memory, so that long running snapshots do not have to roll the page back
+ * through the log again.  The spill file is bounded by the
+ * mempv_spill_max_mb attribute; the oldest spilled versions are dropped to
+ * make room.  The page is written by __mempv_spill_write after the cache
+ * lock is released; until then readers don't see the slot.
+ * Called with the cache lock held.
+ *
+ * Returns the slot, or NULL if the page version is not to be spilled.
+ */
+static MEMPV_SPILL_ENT *__mempv_spill_reserve(dbp, cache, page_header)
+	DB *dbp;
+	MEMPV_CACHE *cache;
+	MEMPV_CACHE_PAGE_HEADER *page_header;
+{
+	MEMPV_SPILL_ENT *ent, *tmp;
+	MEMPV_SPILL_KEY key;
+	off_t max;
+	u_int32_t len;
+
+	max = (off_t)dbp->dbenv->attr.mempv_spill_max_mb << 20;
+	if (max <= 0)
+		return NULL;
+
+	if (cache->spill_fd < 0 && __mempv_spill_open(dbp->dbenv, cache) != 0)
+		return NULL;
+
+	memset(&key, 0, sizeof(key));
+	key.page = page_header->cache->key;
+	key.snapshot_lsn = page_header->snapshot_lsn;
+	if (hash_find(cache->spilled, &key) != NULL) {
+		// Page versions never change; nothing to do.
+		return NULL;
+	}
+
+	len = offsetof(BH, buf) + dbp->pgsize;
+	ent = NULL;
+	while (ent == NULL) {
+		LISTC_FOR_EACH_SAFE(&cache->spill_free, ent, tmp, link) {
+			if (ent->len == len) {
+				listc_rfl(&cache->spill_free, ent);
+				break;
+			}
+		}
+		if (ent != NULL)
+			break;
+
+		if (cache->spill_end + len <= max) {
+			if ((ent = malloc(sizeof(*ent))) == NULL)
+				return NULL;
+			ent->offset = cache->spill_end;
+			ent->len = len;
+			cache->spill_end += len;
+			break;
+		}
+
+		if (cache->spill_list.count == 0)
+			return NULL;
+		__mempv_spill_drop(cache);
+	}
+
+	ent->key = key;
+	ent->readers = 0;
+	ent->dropped = 0;
+	return ent;
+}
+
+/*
+ * __mempv_spill_write --
+ * Writes an evicted page version to the slot reserved for it and makes it
+ * visible to readers, then frees the in-memory copy.
+ * Called without the cache lock.
+ */
+static void __mempv_spill_write(dbp, cache, page_header, ent)
+	DB *dbp;
+	MEMPV_CACHE *cache;
+	MEMPV_CACHE_PAGE_HEADER *page_header;
+	MEMPV_SPILL_ENT *ent;
+{
+	int ok;
+
+	ok = pwrite(cache->spill_fd, page_header->page, ent->len,
+	    ent->offset) == ent->len;
+	if (!ok)
+		logmsg(LOGMSG_ERROR, "%s: failed to spill page %"PRIu32": %d %s\n",
+		    __func__, ent->key.page.pgno, errno, strerror(errno));
+	__os_free(dbp->dbenv, page_header);
+
+	pthread_mutex_lock(&(cache->lock));
+	// Another thread may have spilled the same version meanwhile.
+	if (!ok || hash_find(cache->spilled, &ent->key) != NULL) {
+		listc_abl(&cache->spill_free, ent);
+	} else {
+		hash_add(cache->spilled, ent);
+		listc_abl(&cache->spill_list, ent);
+		cache->spills++;
+	}
+	pthread_mutex_unlock(&(cache->lock));
+}
+
+/*
+ * __mempv_spill_get --
+ * Reads a page version back from the spill file.
+ * Called with the cache lock held; the lock is dropped during the read.
+ *
+ * Returns 0 on a hit or DB_NOTFOUND on a miss.
+ */
+static int __mempv_spill_get(dbp, cache, key, bhp)
+	DB *dbp;
+	MEMPV_CACHE *cache;
+	MEMPV_SPILL_KEY *key;
+	BH *bhp;
+{
+	MEMPV_SPILL_ENT *ent;
+	u_int32_t len;
+	int ok;
+
+	if (cache->spill_fd < 0)
+		return DB_NOTFOUND;
+
+	ent = hash_find(cache->spilled, key);
+	len = offsetof(BH, buf) + dbp->pgsize;
+	if (ent == NULL || ent->len != len)
+		return DB_NOTFOUND;
+
+	// Pin the slot so that it is not reused while we read it.
+	ent->readers++;
+	pthread_mutex_unlock(&(cache->lock));
+
+	ok = pread(cache->spill_fd, bhp, len, ent->offset) == len;
+	if (!ok)
+		logmsg(LOGMSG_ERROR, "%s: failed to read spilled page %"PRIu32": %d %s\n",
+		    __func__, key->page.pgno, errno, strerror(errno));
+
+	pthread_mutex_lock(&(cache->lock));
+	if (--ent->readers == 0 && ent->dropped) {
+		ent->dropped = 0;
+		listc_abl(&cache->spill_free, ent);
+	}
+
+	return ok ? 0 : DB_NOTFOUND;
+}
+
 /*
  * __mempv_cache_evict_page --
  * Evicts a page version from the cache and frees its resources.
@@ -97,24 +317,33 @@ void __mempv_cache_destroy(cache)
  * dbp: Open db.
  * cache: Target cache.
  * pinned_version_list: A list of versions that cannot be freed or NULL.
+ * spill_pagep, spill_entp: Set to the evicted version and its spill slot if
+ * 				it is to be spilled; the caller then calls __mempv_spill_write
+ * 				once it has released the cache lock.
  *
  * Returns 0 on success and non-0 on failure.
  *
  * PUBLIC: static int __mempv_cache_evict_page
- * PUBLIC:	__P((DB *, MEMPV_CACHE *, MEMPV_CACHE_PAGE_VERSIONS *));
+ * PUBLIC:	__P((DB *, MEMPV_CACHE *, MEMPV_CACHE_PAGE_VERSIONS *,
+ * PUBLIC:	MEMPV_CACHE_PAGE_HEADER **, MEMPV_SPILL_ENT **));
  */
-static int __mempv_cache_evict_page(dbp, cache, pinned_version_list)
+static int __mempv_cache_evict_page(dbp, cache, pinned_version_list, spill_pagep, spill_entp)
 	DB *dbp;
 	MEMPV_CACHE *cache;
 	MEMPV_CACHE_PAGE_VERSIONS *pinned_version_list;
+	MEMPV_CACHE_PAGE_HEADER **spill_pagep;
+	MEMPV_SPILL_ENT **spill_entp;
 {
 	MEMPV_CACHE_PAGE_HEADER *to_evict;
+	MEMPV_SPILL_ENT *spill_ent;
 
 	to_evict = listc_rtl(&cache->evict_list);
 	if (to_evict == NULL) {
 		return 1;
 	}
 
+	spill_ent = __mempv_spill_reserve(dbp, cache, to_evict);
+
 	// Delete this version from the list of versions for its page.
 	hash_del(to_evict->cache->versions, to_evict);
 	if ((pinned_version_list != to_evict->cache) && (hash_get_num_entries(to_evict->cache->versions) == 0)) {
@@ -126,8 +355,15 @@ static int __mempv_cache_evict_page(dbp, cache, pinned_version_list)
 		__os_free(dbp->dbenv, to_evict->cache); 
 	}
 
-	__os_free(dbp->dbenv, to_evict); 
+	if (spill_ent != NULL) {
+		// The caller writes it out after dropping the cache lock.
+		*spill_pagep = to_evict;
+		*spill_entp = spill_ent;
+	} else {
+		__os_free(dbp->dbenv, to_evict); 
+	}
 	cache->num_cached_pages--;
+	cache->evictions++;
 	
 	return 0;
 }
@@ -159,11 +395,14 @@ int __mempv_cache_put(dbp, cache, file_id, pgno, bhp, target_lsn)
 {
 	MEMPV_CACHE_PAGE_VERSIONS *versions;
 	MEMPV_CACHE_PAGE_KEY key;
-	MEMPV_CACHE_PAGE_HEADER *page_header;
+	MEMPV_CACHE_PAGE_HEADER *page_header, *spill_page;
+	MEMPV_SPILL_ENT *spill_ent;
 	int ret, allocd_versions, allocd_header;
 
 	versions = NULL;
 	page_header = NULL;
+	spill_page = NULL;
+	spill_ent = NULL;
 	ret = allocd_versions = allocd_header = 0;
 	key.pgno = pgno;
 	memcpy(key.ufid, file_id, DB_FILE_ID_LEN);
@@ -208,7 +447,7 @@ put_version:
 	// We need to allocate space for the new page version.
 
 	if(cache->num_cached_pages == dbp->dbenv->attr.mempv_max_cache_entries) {
-		if ((ret = __mempv_cache_evict_page(dbp, cache, versions)), ret != 0) {
+		if ((ret = __mempv_cache_evict_page(dbp, cache, versions, &spill_page, &spill_ent)), ret != 0) {
 			logmsg(LOGMSG_ERROR, "%s: Could not evict cache page\n", __func__);
 			goto err;
 		}
@@ -237,6 +476,8 @@ put_version:
 
 done:
 	pthread_mutex_unlock(&(cache->lock));
+	if (spill_ent != NULL)
+		__mempv_spill_write(dbp, cache, spill_page, spill_ent);
 	return ret;
 	
 err:
@@ -259,6 +500,8 @@ err:
 	}
 
 	pthread_mutex_unlock(&(cache->lock));
+	if (spill_ent != NULL)
+		__mempv_spill_write(dbp, cache, spill_page, spill_ent);
 	return ret;
 }
 
@@ -289,6 +532,7 @@ int __mempv_cache_get(dbp, cache, file_id, pgno, target_lsn, bhp)
 	MEMPV_CACHE_PAGE_VERSIONS *versions;
 	MEMPV_CACHE_PAGE_KEY key;
 	MEMPV_CACHE_PAGE_HEADER *page_header;
+	MEMPV_SPILL_KEY spill_key;
 	int ret;
 
 	versions = NULL;
@@ -302,13 +546,13 @@ int __mempv_cache_get(dbp, cache, file_id, pgno, target_lsn, bhp)
 	versions = hash_find(cache->pages, &key);
 	if (versions == NULL) {
 		ret = DB_NOTFOUND; 
-		goto done;
+		goto spilled;
 	}
 
 	page_header = hash_find(versions->versions, &target_lsn);
 	if (page_header == NULL) {
 		ret = DB_NOTFOUND;
-		goto done;
+		goto spilled;
 	}
 
 	// Found the page in the cache. Update lru and copy it out.
@@ -317,6 +561,18 @@ int __mempv_cache_get(dbp, cache, file_id, pgno, target_lsn, bhp)
 	listc_abl(&cache->evict_list, page_header);
 
 	memcpy(bhp, (char*)(page_header->page), offsetof(BH, buf) + dbp->pgsize);
+	cache->hits++;
+	goto done;
+
+spilled:
+	// Not in memory; it might have been evicted to the spill file.
+	memset(&spill_key, 0, sizeof(spill_key));
+	spill_key.page = key;
+	spill_key.snapshot_lsn = target_lsn;
+	if ((ret = __mempv_spill_get(dbp, cache, &spill_key, bhp)) == 0)
+		cache->spill_hits++;
+	else
+		cache->misses++;
 
 done:
 	pthread_mutex_unlock(&(cache->lock));
@@ -324,6 +580,40 @@ done:
 	return ret;
 }
 
+/*
+ * __mempv_cache_print_stats --
+ * Prints versioned memory pool cache statistics.
+ *
+ * PUBLIC: void __mempv_cache_print_stats
+ * PUBLIC:	__P((DB_ENV *, FILE *));
+ */
+void __mempv_cache_print_stats(dbenv, out)
+	DB_ENV *dbenv;
+	FILE *out;
+{
+	MEMPV_CACHE *cache;
+
+	if (dbenv->mempv == NULL) {
+		logmsgf(LOGMSG_USER, out, "versioned memory pool is not enabled\n");
+		return;
+	}
+	cache = &dbenv->mempv->cache;
+
+	pthread_mutex_lock(&(cache->lock));
+	logmsgf(LOGMSG_USER, out, "cached page versions: %d (max %d)\n",
+	    cache->num_cached_pages, dbenv->attr.mempv_max_cache_entries);
+	logmsgf(LOGMSG_USER, out, "memory hits: %"PRIu64"\n", cache->hits);
+	logmsgf(LOGMSG_USER, out, "spill hits: %"PRIu64"\n", cache->spill_hits);
+	logmsgf(LOGMSG_USER, out, "misses (rolled back from log): %"PRIu64"\n", cache->misses);
+	logmsgf(LOGMSG_USER, out, "evictions: %"PRIu64"\n", cache->evictions);
+	logmsgf(LOGMSG_USER, out, "spilled page versions: %d (%"PRId64" bytes, max %d MB)\n",
+	    cache->spill_list.count, (int64_t)cache->spill_end,
+	    dbenv->attr.mempv_spill_max_mb);
+	logmsgf(LOGMSG_USER, out, "spills: %"PRIu64"\n", cache->spills);
+	logmsgf(LOGMSG_USER, out, "spill drops: %"PRIu64"\n", cache->spill_drops);
+	pthread_mutex_unlock(&(cache->lock));
+}
+
 static int __mempv_cache_page_version_dump(cache_page_version, arg)
 	MEMPV_CACHE_PAGE_HEADER *cache_page_version;
 	void *arg;
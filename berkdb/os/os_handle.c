@@ -256,6 +256,8 @@ __os_closehandle(dbenv, fhp)
 	 * If we have a valid handle, close it and unlink any temporary
 	 * file.
 	 */
+	if (F_ISSET(fhp, DB_FH_ZFILE))
+		__os_zclose(dbenv, fhp);
 	if (F_ISSET(fhp, DB_FH_OPENED)) {
 		retries = 0;
 		do {
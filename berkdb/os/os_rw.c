@@ -627,6 +627,9 @@ __os_read(dbenv, fhp, addr, len, nrp)
 
 	__checkpoint_verify(dbenv);
 
+	if (F_ISSET(fhp, DB_FH_ZFILE))
+		return (__os_zread(dbenv, fhp, addr, len, nrp));
+
 	retries = 0;
 	for (taddr = addr, offset = 0; offset < len; taddr += nr, offset += nr) {
 retry:		if ((nr = DB_GLOBAL(j_read) != NULL ?
@@ -58,7 +58,10 @@ __os_seek(dbenv, fhp, pgsize, pageno, relative, isrewind, db_whence)
 		return (EINVAL);
 	}
 
-	if (DB_GLOBAL(j_seek) != NULL)
+	if (F_ISSET(fhp, DB_FH_ZFILE)) {
+		offset = (off_t)pgsize * pageno + relative;
+		ret = __os_zseek(fhp, isrewind ? -offset : offset, whence);
+	} else if (DB_GLOBAL(j_seek) != NULL)
 		ret = DB_GLOBAL(j_seek)(fhp->fd,
 		    pgsize, pageno, relative, isrewind, whence);
 	else {
@@ -85,6 +85,17 @@ ___os_ioinfo(dbenv, path, fhp, mbytesp, bytesp, iosizep)
 	int ret, retries;
 	struct stat sb;
 
+	if (fhp != NULL && F_ISSET(fhp, DB_FH_ZFILE)) {
+		u_int64_t size = __os_zsize(fhp);
+		if (mbytesp != NULL)
+			*mbytesp = (u_int32_t)(size / MEGABYTE);
+		if (bytesp != NULL)
+			*bytesp = (u_int32_t)(size % MEGABYTE);
+		if (iosizep != NULL)
+			*iosizep = DB_DEF_IOSIZE;
+		return (0);
+	}
+
 	if (DB_GLOBAL(j_ioinfo) != NULL)
 		return (DB_GLOBAL(j_ioinfo)(path,
 		    fhp->fd, mbytesp, bytesp, iosizep));
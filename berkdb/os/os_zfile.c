@@ -0,0 +1,478 @@
+/*
+ * Chunk-compressed read-only files.
+ *
+ * The file starts with a ZF_HDR, followed by nchunks + 1 offsets: chunk i
+ * of the original file (chunk bytes long, except perhaps the last) is
+ * stored LZ4 compressed between off[i] and off[i + 1], or as is when
+ * compressing didn't make it smaller.  A handle opened by __os_zopen is
+ * marked DB_FH_ZFILE, and __os_read, __os_seek and __os_ioinfo serve it
+ * the original bytes, decompressing only the chunk holding the current
+ * offset.  Offsets and sizes are in host order, like the log files this
+ * is used for.
+ */
+
+#include "db_config.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <lz4.h>
+
+#include "db_int.h"
+
+#define	ZF_MAGIC	0x5a4c4f47	/* "GOLZ" */
+#define	ZF_VERSION	1
+
+typedef struct {
+	u_int32_t magic;
+	u_int32_t version;
+	u_int32_t chunk;	/* uncompressed bytes per chunk */
+	u_int32_t nchunks;
+	u_int64_t size;		/* uncompressed file size */
+} ZF_HDR;
+
+struct __os_zfile {
+	ZF_HDR hdr;
+	u_int64_t *off;		/* nchunks + 1 file offsets */
+	u_int64_t pos;		/* current uncompressed offset */
+	u_int32_t cur;		/* chunk held in buf */
+	int have;		/* buf is valid */
+	u_int8_t *buf;
+	u_int8_t *zbuf;
+	u_int32_t zbufsz;
+};
+
+static void
+__os_zfree(dbenv, zf)
+	DB_ENV *dbenv;
+	struct __os_zfile *zf;
+{
+	if (zf == NULL)
+		return;
+	if (zf->off != NULL)
+		__os_free(dbenv, zf->off);
+	if (zf->buf != NULL)
+		__os_free(dbenv, zf->buf);
+	if (zf->zbuf != NULL)
+		__os_free(dbenv, zf->zbuf);
+	__os_free(dbenv, zf);
+}
+
+static int
+__os_zpread(dbenv, fhp, buf, len, off)
+	DB_ENV *dbenv;
+	DB_FH *fhp;
+	void *buf;
+	size_t len;
+	u_int64_t off;
+{
+	ssize_t nr;
+	size_t done;
+	int ret;
+
+	for (done = 0; done < len; done += nr) {
+		nr = pread(fhp->fd,
+		    (u_int8_t *)buf + done, len - done, (off_t)(off + done));
+		if (nr < 0) {
+			if ((ret = __os_get_errno()) == EINTR)
+				continue;
+			__db_err(dbenv, "pread: %s", strerror(ret));
+			return (ret);
+		}
+		if (nr == 0) {
+			__db_err(dbenv, "compressed file: short read at %llu",
+			    (unsigned long long)(off + done));
+			return (EIO);
+		}
+	}
+	return (0);
+}
+
+static inline u_int32_t
+__os_zchunklen(zf, i)
+	struct __os_zfile *zf;
+	u_int32_t i;
+{
+	u_int64_t start;
+
+	start = (u_int64_t)i * zf->hdr.chunk;
+	return (zf->hdr.size - start < zf->hdr.chunk ?
+	    (u_int32_t)(zf->hdr.size - start) : zf->hdr.chunk);
+}
+
+static int
+__os_zload(dbenv, fhp, i)
+	DB_ENV *dbenv;
+	DB_FH *fhp;
+	u_int32_t i;
+{
+	struct __os_zfile *zf;
+	u_int32_t rawlen, zlen;
+	int n, ret;
+
+	zf = fhp->zfp;
+	if (zf->have && zf->cur == i)
+		return (0);
+	zf->have = 0;
+
+	rawlen = __os_zchunklen(zf, i);
+	zlen = (u_int32_t)(zf->off[i + 1] - zf->off[i]);
+	if (zlen > rawlen)
+		goto corrupt;
+	if (zlen == rawlen) {
+		if ((ret = __os_zpread(dbenv,
+		    fhp, zf->buf, rawlen, zf->off[i])) != 0)
+			return (ret);
+		goto done;
+	}
+
+	if (zlen > zf->zbufsz) {
+		if ((ret = __os_realloc(dbenv, zlen, &zf->zbuf)) != 0)
+			return (ret);
+		zf->zbufsz = zlen;
+	}
+	if ((ret = __os_zpread(dbenv, fhp, zf->zbuf, zlen, zf->off[i])) != 0)
+		return (ret);
+	n = LZ4_decompress_safe((const char *)zf->zbuf, (char *)zf->buf,
+	    (int)zlen, (int)rawlen);
+	if (n != (int)rawlen)
+		goto corrupt;
+done:	zf->cur = i;
+	zf->have = 1;
+	return (0);
+
+corrupt:
+	__db_err(dbenv, "compressed file: bad chunk %u", i);
+	return (EIO);
+}
+
+/*
+ * __os_zopen --
+ *	Open a chunk-compressed file for reading.
+ *
+ * PUBLIC: int __os_zopen __P((DB_ENV *, const char *, DB_FH **));
+ */
+int
+__os_zopen(dbenv, name, fhpp)
+	DB_ENV *dbenv;
+	const char *name;
+	DB_FH **fhpp;
+{
+	struct __os_zfile *zf;
+	DB_FH *fhp;
+	size_t nr;
+	u_int32_t i;
+	int ret;
+
+	zf = NULL;
+	if ((ret = __os_open(dbenv, name, DB_OSO_RDONLY, 0, &fhp)) != 0)
+		return (ret);
+	if ((ret = __os_calloc(dbenv, 1, sizeof(*zf), &zf)) != 0)
+		goto err;
+	if ((ret = __os_read(dbenv,
+	    fhp, &zf->hdr, sizeof(zf->hdr), &nr)) != 0)
+		goto err;
+	if (nr != sizeof(zf->hdr) || zf->hdr.magic != ZF_MAGIC ||
+	    zf->hdr.version != ZF_VERSION || zf->hdr.chunk == 0 ||
+	    zf->hdr.nchunks != (zf->hdr.size + zf->hdr.chunk - 1) /
+	    zf->hdr.chunk)
+		goto bad;
+
+	if ((ret = __os_malloc(dbenv, (zf->hdr.nchunks + 1) *
+	    sizeof(u_int64_t), &zf->off)) != 0)
+		goto err;
+	if ((ret = __os_read(dbenv, fhp, zf->off, (zf->hdr.nchunks + 1) *
+	    sizeof(u_int64_t), &nr)) != 0)
+		goto err;
+	if (nr != (zf->hdr.nchunks + 1) * sizeof(u_int64_t))
+		goto bad;
+	for (i = 0; i < zf->hdr.nchunks; i++)
+		if (zf->off[i + 1] < zf->off[i])
+			goto bad;
+	if ((ret = __os_malloc(dbenv, zf->hdr.chunk, &zf->buf)) != 0)
+		goto err;
+
+	fhp->zfp = zf;
+	F_SET(fhp, DB_FH_ZFILE);
+	*fhpp = fhp;
+	return (0);
+
+bad:	__db_err(dbenv, "%s: not a valid compressed file", name);
+	ret = EINVAL;
+err:	__os_zfree(dbenv, zf);
+	(void)__os_closehandle(dbenv, fhp);
+	return (ret);
+}
+
+/*
+ * __os_zread --
+ *	Read from the current offset of a compressed file.
+ *
+ * PUBLIC: int __os_zread __P((DB_ENV *, DB_FH *, void *, size_t, size_t *));
+ */
+int
+__os_zread(dbenv, fhp, addr, len, nrp)
+	DB_ENV *dbenv;
+	DB_FH *fhp;
+	void *addr;
+	size_t len;
+	size_t *nrp;
+{
+	struct __os_zfile *zf;
+	u_int32_t i, o;
+	size_t n, cp;
+	int ret;
+
+	zf = fhp->zfp;
+	for (n = 0; n < len && zf->pos < zf->hdr.size; n += cp) {
+		i = (u_int32_t)(zf->pos / zf->hdr.chunk);
+		if ((ret = __os_zload(dbenv, fhp, i)) != 0)
+			return (ret);
+		o = (u_int32_t)(zf->pos - (u_int64_t)i * zf->hdr.chunk);
+		cp = __os_zchunklen(zf, i) - o;
+		if (cp > len - n)
+			cp = len - n;
+		memcpy((u_int8_t *)addr + n, zf->buf + o, cp);
+		zf->pos += cp;
+	}
+	*nrp = n;
+	return (0);
+}
+
+/*
+ * __os_zseek --
+ *	Move the offset of a compressed file.
+ *
+ * PUBLIC: int __os_zseek __P((DB_FH *, off_t, int));
+ */
+int
+__os_zseek(fhp, offset, whence)
+	DB_FH *fhp;
+	off_t offset;
+	int whence;
+{
+	struct __os_zfile *zf;
+	off_t base;
+
+	zf = fhp->zfp;
+	switch (whence) {
+	case SEEK_CUR:
+		base = (off_t)zf->pos;
+		break;
+	case SEEK_END:
+		base = (off_t)zf->hdr.size;
+		break;
+	default:
+		base = 0;
+		break;
+	}
+	if (base + offset < 0)
+		return (EINVAL);
+	zf->pos = (u_int64_t)(base + offset);
+	return (0);
+}
+
+/*
+ * __os_zsize --
+ *	Return the uncompressed size of a compressed file.
+ *
+ * PUBLIC: u_int64_t __os_zsize __P((DB_FH *));
+ */
+u_int64_t
+__os_zsize(fhp)
+	DB_FH *fhp;
+{
+	return (fhp->zfp->hdr.size);
+}
+
+/*
+ * __os_zclose --
+ *	Release the state of a compressed file handle.
+ *
+ * PUBLIC: void __os_zclose __P((DB_ENV *, DB_FH *));
+ */
+void
+__os_zclose(dbenv, fhp)
+	DB_ENV *dbenv;
+	DB_FH *fhp;
+{
+	__os_zfree(dbenv, fhp->zfp);
+	fhp->zfp = NULL;
+	F_CLR(fhp, DB_FH_ZFILE);
+}
+
+static int
+__os_zwrite(dbenv, fhp, buf, len)
+	DB_ENV *dbenv;
+	DB_FH *fhp;
+	void *buf;
+	size_t len;
+{
+	size_t nw;
+	int ret;
+
+	if ((ret = __os_write(dbenv, fhp, buf, len, &nw)) != 0)
+		return (ret);
+	return (nw == len ? 0 : EIO);
+}
+
+/*
+ * __os_zcompress --
+ *	Write a chunk-compressed copy of a file, with the same mtime.
+ *
+ * PUBLIC: int __os_zcompress __P((DB_ENV *,
+ * PUBLIC:     const char *, const char *, u_int32_t, int));
+ */
+int
+__os_zcompress(dbenv, from, to, chunk, mode)
+	DB_ENV *dbenv;
+	const char *from, *to;
+	u_int32_t chunk;
+	int mode;
+{
+	ZF_HDR hdr;
+	DB_FH *in, *out;
+	struct stat sb;
+	struct timespec times[2];
+	u_int64_t *off;
+	u_int8_t *raw, *z;
+	u_int32_t i;
+	size_t nr;
+	int zlen, zmax, ret;
+
+	in = out = NULL;
+	off = NULL;
+	raw = z = NULL;
+	zmax = LZ4_compressBound((int)chunk);
+
+	if ((ret = __os_open(dbenv, from, DB_OSO_RDONLY | DB_OSO_SEQ,
+	    0, &in)) != 0)
+		return (ret);
+	if (fstat(in->fd, &sb) != 0) {
+		ret = __os_get_errno();
+		goto err;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = ZF_MAGIC;
+	hdr.version = ZF_VERSION;
+	hdr.chunk = chunk;
+	hdr.size = (u_int64_t)sb.st_size;
+	hdr.nchunks = (u_int32_t)((hdr.size + chunk - 1) / chunk);
+
+	if ((ret = __os_calloc(dbenv,
+	    hdr.nchunks + 1, sizeof(u_int64_t), &off)) != 0 ||
+	    (ret = __os_malloc(dbenv, chunk, &raw)) != 0 ||
+	    (ret = __os_malloc(dbenv, (size_t)zmax, &z)) != 0)
+		goto err;
+
+	if ((ret = __os_open(dbenv, to, DB_OSO_CREATE | DB_OSO_TRUNC,
+	    mode, &out)) != 0)
+		goto err;
+	/* header and a placeholder index, filled in at the end */
+	if ((ret = __os_zwrite(dbenv, out, &hdr, sizeof(hdr))) != 0 ||
+	    (ret = __os_zwrite(dbenv, out, off,
+	    (hdr.nchunks + 1) * sizeof(u_int64_t))) != 0)
+		goto err;
+
+	off[0] = sizeof(hdr) + (hdr.nchunks + 1) * sizeof(u_int64_t);
+	for (i = 0; i < hdr.nchunks; i++) {
+		size_t want = (size_t)(hdr.size - (u_int64_t)i * chunk);
+		if (want > chunk)
+			want = chunk;
+		if ((ret = __os_read(dbenv, in, raw, want, &nr)) != 0)
+			goto err;
+		if (nr != want) {
+			__db_err(dbenv, "%s: changed while compressing", from);
+			ret = EIO;
+			goto err;
+		}
+		zlen = LZ4_compress_default((const char *)raw, (char *)z,
+		    (int)want, zmax);
+		if (zlen > 0 && (size_t)zlen < want)
+			ret = __os_zwrite(dbenv, out, z, (size_t)zlen);
+		else {
+			zlen = (int)want;
+			ret = __os_zwrite(dbenv, out, raw, want);
+		}
+		if (ret != 0)
+			goto err;
+		off[i + 1] = off[i] + (u_int64_t)zlen;
+	}
+
+	if ((ret = __os_seek(dbenv, out, 0, 0, sizeof(hdr), 0,
+	    DB_OS_SEEK_SET)) != 0 ||
+	    (ret = __os_zwrite(dbenv, out, off,
+	    (hdr.nchunks + 1) * sizeof(u_int64_t))) != 0 ||
+	    (ret = __os_fsync(dbenv, out)) != 0)
+		goto err;
+
+	/* age based log retention looks at the mtime */
+	times[0] = sb.st_atim;
+	times[1] = sb.st_mtim;
+	(void)futimens(out->fd, times);
+
+err:	if (out != NULL)
+		(void)__os_closehandle(dbenv, out);
+	if (ret != 0)
+		(void)__os_unlink(dbenv, to);
+	if (in != NULL)
+		(void)__os_closehandle(dbenv, in);
+	if (off != NULL)
+		__os_free(dbenv, off);
+	if (raw != NULL)
+		__os_free(dbenv, raw);
+	if (z != NULL)
+		__os_free(dbenv, z);
+	return (ret);
+}
+
+/*
+ * __os_zexpand --
+ *	Write the original contents of a chunk-compressed file.
+ *
+ * PUBLIC: int __os_zexpand __P((DB_ENV *, const char *, const char *, int));
+ */
+int
+__os_zexpand(dbenv, from, to, mode)
+	DB_ENV *dbenv;
+	const char *from, *to;
+	int mode;
+{
+	DB_FH *in, *out;
+	u_int8_t *buf;
+	size_t nr;
+	int ret;
+
+	out = NULL;
+	buf = NULL;
+	if ((ret = __os_zopen(dbenv, from, &in)) != 0)
+		return (ret);
+	if ((ret = __os_malloc(dbenv, in->zfp->hdr.chunk, &buf)) != 0 ||
+	    (ret = __os_open(dbenv, to, DB_OSO_CREATE | DB_OSO_TRUNC,
+	    mode, &out)) != 0)
+		goto err;
+	for (;;) {
+		if ((ret = __os_read(dbenv,
+		    in, buf, in->zfp->hdr.chunk, &nr)) != 0)
+			goto err;
+		if (nr == 0)
+			break;
+		if ((ret = __os_zwrite(dbenv, out, buf, nr)) != 0)
+			goto err;
+	}
+	ret = __os_fsync(dbenv, out);
+
+err:	if (out != NULL)
+		(void)__os_closehandle(dbenv, out);
+	if (ret != 0 && out != NULL)
+		(void)__os_unlink(dbenv, to);
+	(void)__os_closehandle(dbenv, in);
+	if (buf != NULL)
+		__os_free(dbenv, buf);
+	return (ret);
+}
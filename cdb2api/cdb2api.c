@@ -184,6 +184,7 @@ static int iam_identity = 0;
 
 pthread_mutex_t cdb2_sockpool_mutex = PTHREAD_MUTEX_INITIALIZER;
 #define MAX_SOCKPOOL_FDS 8
+#define MAX_PREPARED 64 /* Statements prepared per connection */
 
 #include <netdb.h>
 
@@ -1021,6 +1022,14 @@ struct cdb2_hndl {
     char *query_hint;
     char *hint;
     int use_hint;
+    int use_prepared;
+    int n_prepared;
+    struct {
+        char *sql;
+        int id;
+    } prepared[MAX_PREPARED]; /* statements prepared on hndl->sb */
+    int stmt_id;   /* send this stmt_id instead of the sql */
+    int prepare;   /* ask the server to prepare the sql */
     int flags;
     char errstr[1024];
     cnonce_t cnonce;
@@ -1038,6 +1047,10 @@ struct cdb2_hndl {
     cdb2_query_list *query_list;
     int snapshot_file;
     int snapshot_offset;
+    int commit_file; /* lsn of the last write committed on this handle */
+    int commit_offset;
+    int read_file; /* queries run where this lsn has been applied */
+    int read_offset;
     int query_no;
     int retry_all;
     int num_set_commands;
@@ -2169,6 +2182,33 @@ typedef enum {
     NEWSQL_STATE_LOCALCACHE
 } newsql_state;
 
+/* Statement ids are bound to the connection; forget them when it changes. */
+static void clear_prepared(cdb2_hndl_tp *hndl)
+{
+    while (hndl->n_prepared > 0) {
+        hndl->n_prepared--;
+        free(hndl->prepared[hndl->n_prepared].sql);
+    }
+}
+
+static int find_prepared(cdb2_hndl_tp *hndl, const char *sql)
+{
+    for (int i = 0; i < hndl->n_prepared; i++) {
+        if (strcmp(hndl->prepared[i].sql, sql) == 0)
+            return hndl->prepared[i].id;
+    }
+    return 0;
+}
+
+static void add_prepared(cdb2_hndl_tp *hndl, const char *sql, int id)
+{
+    if (hndl->n_prepared == MAX_PREPARED || find_prepared(hndl, sql))
+        return;
+    hndl->prepared[hndl->n_prepared].sql = strdup(sql);
+    hndl->prepared[hndl->n_prepared].id = id;
+    hndl->n_prepared++;
+}
+
 static int send_reset(SBUF2 *sb)
 {
     int rc = 0;
@@ -2407,6 +2447,7 @@ static int newsql_connect_via_fd(cdb2_hndl_tp *hndl)
 
     hndl->sb = sb;
     hndl->num_set_commands_sent = 0;
+    clear_prepared(hndl);
     hndl->sent_client_info = 0;
     hndl->connected_host = 0;
     hndl->hosts_connected[hndl->connected_host] = 1;
@@ -2467,6 +2508,7 @@ static int newsql_connect(cdb2_hndl_tp *hndl, int node_indx)
             goto after_callback;
         }
         if (send_reset(sb) == 0) {
+            debugprint("reusing sockpool fd %d\n", fd);
             break;      // connection is ready
         }
         sbuf2close(sb); // retry newsql connect;
@@ -2512,6 +2554,7 @@ static int newsql_connect(cdb2_hndl_tp *hndl, int node_indx)
 
     hndl->sb = sb;
     hndl->num_set_commands_sent = 0;
+    clear_prepared(hndl);
     hndl->sent_client_info = 0;
     hndl->connected_host = node_indx;
     hndl->hosts_connected[hndl->connected_host] = 1;
@@ -2647,6 +2690,15 @@ void cdb2_use_hint(cdb2_hndl_tp *hndl)
     }
 }
 
+void cdb2_use_prepared(cdb2_hndl_tp *hndl)
+{
+    hndl->use_prepared = 1;
+    if (log_calls) {
+        fprintf(stderr, "%p> cdb2_use_prepared(%p)\n", (void *)pthread_self(),
+                hndl);
+    }
+}
+
 /* try to connect to range from low (inclusive) to high (exclusive) starting with begin */
 static inline int cdb2_try_connect_range(cdb2_hndl_tp *hndl, int begin, int low, int high)
 {
@@ -3166,6 +3218,7 @@ static int cdb2_send_query(cdb2_hndl_tp *hndl, cdb2_hndl_tp *event_hndl,
     CDB2QUERY query = CDB2__QUERY__INIT;
     CDB2SQLQUERY sqlquery = CDB2__SQLQUERY__INIT;
     CDB2SQLQUERY__Snapshotinfo snapshotinfo;
+    CDB2SQLQUERY__Snapshotinfo read_lsn;
 
     // This should be sent once right after we connect, not with every query
     CDB2SQLQUERY__Cinfo cinfo = CDB2__SQLQUERY__CINFO__INIT;
@@ -3186,6 +3239,15 @@ static int cdb2_send_query(cdb2_hndl_tp *hndl, cdb2_hndl_tp *event_hndl,
 
     sqlquery.dbname = (char *)dbname;
     sqlquery.sql_query = (char *)cdb2_skipws(sql);
+    if (hndl && hndl->stmt_id) {
+        sqlquery.sql_query = "";
+        sqlquery.has_stmt_id = 1;
+        sqlquery.stmt_id = hndl->stmt_id;
+        debugprint("sending stmt_id %d\n", hndl->stmt_id);
+    } else if (hndl && hndl->prepare) {
+        sqlquery.has_prepare = 1;
+        sqlquery.prepare = 1;
+    }
 #if _LINUX_SOURCE
     sqlquery.little_endian = 1;
 #else
@@ -3244,6 +3306,13 @@ static int cdb2_send_query(cdb2_hndl_tp *hndl, cdb2_hndl_tp *event_hndl,
             sqlquery.retry = hndl->is_retry;
         }
 
+        if (hndl->read_file) {
+            cdb2__sqlquery__snapshotinfo__init(&read_lsn);
+            read_lsn.file = hndl->read_file;
+            read_lsn.offset = hndl->read_offset;
+            sqlquery.read_lsn = &read_lsn;
+        }
+
         if ( !(hndl->flags & CDB2_READ_INTRANS_RESULTS) && is_begin) {
             features[n_features++] = CDB2_CLIENT_FEATURES__SKIP_INTRANS_RESULTS;
         }
@@ -3507,6 +3576,14 @@ retry_next_record:
         hndl->snapshot_offset = hndl->lastresponse->snapshot_info->offset;
     }
 
+    if (hndl->lastresponse->commit_lsn &&
+        hndl->lastresponse->commit_lsn->file) {
+        hndl->commit_file = hndl->lastresponse->commit_lsn->file;
+        hndl->commit_offset = hndl->lastresponse->commit_lsn->offset;
+        if (hndl->flags & CDB2_READ_YOUR_WRITES)
+            cdb2_set_read_lsn(hndl, hndl->commit_file, hndl->commit_offset);
+    }
+
     if (hndl->lastresponse->response_type == RESPONSE_TYPE__COLUMN_VALUES ||
         hndl->lastresponse->response_type == RESPONSE_TYPE__SQL_ROW) {
         // "Good" rcodes are not retryable
@@ -3780,6 +3857,7 @@ int cdb2_close(cdb2_hndl_tp *hndl)
     free(hndl->query_hint);
     free(hndl->hint);
     free(hndl->sql);
+    clear_prepared(hndl);
 
     cdb2_clearbindings(hndl);
     cdb2_free_context_msgs(hndl);
@@ -4490,6 +4568,7 @@ static void attach_to_handle(cdb2_hndl_tp *child, cdb2_hndl_tp *parent)
 
     child->debug_trace = parent->debug_trace;
     child->use_hint = parent->use_hint;
+    child->use_prepared = parent->use_prepared;
 
     free_events(child);
     child->events = parent->events;
@@ -4688,6 +4767,14 @@ retry_queries:
     hndl->ntypes = ntypes;
     hndl->types = types;
 
+    hndl->stmt_id = hndl->prepare = 0;
+    if (hndl->use_prepared && !hndl->in_trans && !is_begin && !using_hint) {
+        /* Prepared statements only outside transactions: queries in a
+           transaction may be replayed on another connection. */
+        if ((hndl->stmt_id = find_prepared(hndl, sql)) == 0)
+            hndl->prepare = (hndl->n_prepared < MAX_PREPARED);
+    }
+
     if (!hndl->in_trans || is_begin) {
         hndl->query_no = 0;
         rc = cdb2_send_query(
@@ -4972,6 +5059,20 @@ read_record:
 
     debugprint("Received message %d\n", hndl->firstresponse->response_type);
 
+    if (hndl->stmt_id) {
+        if (hndl->firstresponse->error_code == CDB2__ERROR_CODE__NOSTATEMENT) {
+            /* server lost our statements; send the text */
+            clear_prepared(hndl);
+            hndl->retry_all = 1;
+            debugprint("goto retry_queries on unknown stmt_id %d\n",
+                       hndl->stmt_id);
+            goto retry_queries;
+        }
+    } else if (hndl->prepare && hndl->firstresponse->has_stmt_id) {
+        debugprint("prepared as stmt_id %d\n", hndl->firstresponse->stmt_id);
+        add_prepared(hndl, sql, hndl->firstresponse->stmt_id);
+    }
+
     if (using_hint) {
         if (hndl->firstresponse->error_code ==
                 CDB2__ERROR_CODE__PREPARE_ERROR_OLD ||
@@ -5301,6 +5402,34 @@ int cdb2_snapshot_file(cdb2_hndl_tp *hndl, int *snapshot_file,
     return 0;
 }
 
+int cdb2_commit_lsn(cdb2_hndl_tp *hndl, int *file, int *offset)
+{
+    if (hndl == NULL || hndl->commit_file == 0) {
+        (*file) = -1;
+        (*offset) = -1;
+        return -1;
+    }
+
+    (*file) = hndl->commit_file;
+    (*offset) = hndl->commit_offset;
+    return 0;
+}
+
+/* Later queries wait for the serving node to apply file:offset.  Only moves
+   forward; 0:0 clears it. */
+void cdb2_set_read_lsn(cdb2_hndl_tp *hndl, int file, int offset)
+{
+    if (hndl == NULL)
+        return;
+    if (file == 0 && offset == 0) {
+        hndl->read_file = hndl->read_offset = 0;
+    } else if (file > hndl->read_file ||
+               (file == hndl->read_file && offset > hndl->read_offset)) {
+        hndl->read_file = file;
+        hndl->read_offset = offset;
+    }
+}
+
 void cdb2_getinfo(cdb2_hndl_tp *hndl, int *intrans, int *hasql)
 {
     (*intrans) = hndl->in_trans;
@@ -39,6 +39,7 @@ enum cdb2_hndl_alloc_flags {
     CDB2_TYPE_IS_FD = 256,
     CDB2_REQUIRE_FASTSQL = 512,
     CDB2_MASTER = 1024,
+    CDB2_READ_YOUR_WRITES = 2048,
 };
 
 enum cdb2_request_type {
@@ -232,6 +233,8 @@ void cdb2_set_debug_trace(cdb2_hndl_tp *hndl);
 void cdb2_dump_ports(cdb2_hndl_tp *hndl, FILE *out);
 void cdb2_cluster_info(cdb2_hndl_tp *hndl, char **cluster, int *ports, int max, int *count);
 int cdb2_snapshot_file(cdb2_hndl_tp *hndl, int *file, int *offset);
+int cdb2_commit_lsn(cdb2_hndl_tp *hndl, int *file, int *offset);
+void cdb2_set_read_lsn(cdb2_hndl_tp *hndl, int file, int offset);
 void cdb2_getinfo(cdb2_hndl_tp *hndl, int *intrans, int *hasql);
 void cdb2_set_max_retries(int max_retries);
 void cdb2_set_min_retries(int min_retries);
@@ -239,6 +242,7 @@ void cdb2_hndl_set_max_retries(cdb2_hndl_tp *hndl, int max_retries);
 void cdb2_hndl_set_min_retries(cdb2_hndl_tp *hndl, int min_retries);
 
 void cdb2_use_hint(cdb2_hndl_tp *hndl);
+void cdb2_use_prepared(cdb2_hndl_tp *hndl);
 
 int cdb2_bind_param(cdb2_hndl_tp *hndl, const char *name, int type,
                     const void *varaddr, int length);
@@ -5574,7 +5574,8 @@ static void goodbye()
    TOOL(cdb2_printlog)  \
    TOOL(cdb2_stat)      \
    TOOL(cdb2_verify)    \
-   TOOL(cdb2_pgdump)
+   TOOL(cdb2_pgdump)    \
+   TOOL(cdb2_bench)
 
 #undef TOOL
 #define TOOL(x) int tool_ ##x ##_main(int argc, char *argv[]);
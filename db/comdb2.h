@@ -471,6 +471,13 @@ enum RECORD_WRITE_TYPES {
     RECORD_WRITE_MAX = 3
 };
 
+/* Per table query latency, see latency_histograms */
+enum TABLE_LATENCY_OPS {
+    TABLE_LATENCY_READ = 0,  /* queries that only read the table */
+    TABLE_LATENCY_WRITE = 1, /* queries that wrote the table */
+    TABLE_LATENCY_MAX = 2
+};
+
 enum RECOVER_DEADLOCK_FLAGS {
     RECOVER_DEADLOCK_PTRACE = 0x00000001,
     RECOVER_DEADLOCK_FORCE_FAIL = 0x00000002,
@@ -662,6 +669,7 @@ typedef struct dbtable {
     int64_t aa_needs_analyze_time; // time when analyze is needed for table in request mode, otherwise 0
     int64_t read_count; // counter for reads to this table
     int64_t index_used_count;   // counter for number of times a table index was used
+    struct latency_hist *latency[TABLE_LATENCY_MAX]; // query times, by operation
 
     /* Foreign key constraints */
     constraint_t *constraints;
@@ -789,6 +797,12 @@ typedef struct dbtable {
 
     /* name of the timepartition, if this is a shard */
     const char *timepartition_name;
+
+    /* min/max summary of a frozen shard, see views_summary.c */
+    int summary_state;
+    char *summary_col;
+    char *summary_min;
+    char *summary_max;
 } dbtable;
 
 struct dbview {
@@ -1466,6 +1480,7 @@ struct ireq {
     unsigned vfy_genid_track : 1;
     unsigned vfy_idx_track : 1;
     unsigned have_blkseq : 1;
+    unsigned summary_dropped : 1; /* dropped a shard summary */
 
     unsigned sc_locked : 1;
     unsigned sc_should_abort : 1;
@@ -2355,6 +2370,10 @@ int ix_find_auxdb_by_key_tran(int auxdb, struct ireq *iq, void *key, int keylen,
                               int index, void *fndkey, int *fndrrn,
                               unsigned long long *genid, void *fnddta,
                               int *fndlen, int maxlen, void *trans);
+int ix_find_absent_by_key_tran(struct ireq *iq, void *key, int keylen,
+                               int index, void *fndkey, int *fndrrn,
+                               unsigned long long *genid, void *fnddta,
+                               int *fndlen, int maxlen, void *trans);
 
 /* This is pretty much a straight through wrapper for the bdb range delete. */
 typedef int (*comdb2_formkey_callback_t)(void *, size_t, void *, size_t, int,
@@ -3682,6 +3701,11 @@ void plugin_post_dbenv_hook(struct dbenv *dbenv);
 extern int64_t gbl_temptable_created;
 extern int64_t gbl_temptable_create_reqs;
 extern int64_t gbl_temptable_spills;
+extern int64_t gbl_lua_sp_pool_hits;
+extern int64_t gbl_lua_sp_pool_misses;
+extern int64_t gbl_lua_sp_bytecode_hits;
+extern int64_t gbl_lua_sp_bytecode_misses;
+extern int64_t gbl_lua_sp_setup_us_saved;
 
 extern int gbl_disable_tpsc_tblvers;
 
@@ -715,7 +715,8 @@ int verify_del_constraints(struct ireq *iq, void *trans, int *errout)
         }
         iq->usedb = get_dbtable_by_name(bct->tablename);
         if (iq->usedb) {
-            rc = ix_find_by_key_tran(iq, skey, bct->sixlen, bct->sixnum, key, &rrn, &genid, NULL, NULL, 0, trans);
+            rc = ix_find_absent_by_key_tran(iq, skey, bct->sixlen, bct->sixnum, key, &rrn, &genid, NULL, NULL, 0,
+                                            trans);
         } else {
             rc = ERR_NO_SUCH_TABLE;
         }
@@ -27,6 +27,7 @@
 #include "util.h"
 #include "tohex.h"
 #include "string_ref.h"
+#include "latency_hist.h"
 #include <ctrace.h>
 
 extern int gbl_old_column_names;
@@ -41,6 +42,7 @@ extern hash_t *gbl_sample_queries_hash;
 extern int gbl_verbose_normalized_queries;
 int gbl_fingerprint_max_queries = 1000;
 int gbl_warn_on_equiv_type_mismatch;
+int gbl_latency_histograms = 1;
 
 static int free_fingerprint(void *obj, void *arg)
 {
@@ -48,6 +50,7 @@ static int free_fingerprint(void *obj, void *arg)
     int *plans_count = (int *)arg;
     if (t != NULL) {
         free(t->zNormSql);
+        latency_hist_free(t->latency);
         if (t->query_plan_hash) {
             *plans_count += free_query_plan_hash(t->query_plan_hash);
         }
@@ -95,6 +98,21 @@ void calc_fingerprint(const char *zNormSql, size_t *pnNormSql,
     MD5Final(fingerprint, &ctx);
 }
 
+/* Average cost of past executions of a fingerprint, -1 if never seen. */
+int64_t fingerprint_avg_cost(const unsigned char fingerprint[FINGERPRINTSZ])
+{
+    int64_t cost = -1;
+    Pthread_mutex_lock(&gbl_fingerprint_hash_mu);
+    if (gbl_fingerprint_hash) {
+        struct fingerprint_track *t =
+            hash_find(gbl_fingerprint_hash, fingerprint);
+        if (t && t->count > 0)
+            cost = t->cost / t->count;
+    }
+    Pthread_mutex_unlock(&gbl_fingerprint_hash_mu);
+    return cost;
+}
+
 static int have_type_overrides(struct sqlclntstate *clnt) {
     return clnt->plugin.override_count(clnt) > 0;
 }
@@ -338,6 +356,15 @@ void add_fingerprint(struct sqlclntstate *clnt, sqlite3_stmt *stmt, struct strin
         assert( strncmp(t->zNormSql,zNormSql,t->nNormSql)==0 );
     }
 
+    if (gbl_latency_histograms) {
+        if (t->latency == NULL)
+            t->latency = latency_hist_new();
+        /* the request logger has microseconds, stored procedures only
+         * account milliseconds */
+        if (t->latency)
+            latency_hist_add(t->latency, (logger && !is_lua) ? reqlog_current_us(logger) : time * 1000);
+    }
+
     if (clnt->adjusted_column_names && t->alert_once_truncated_col) {
         t->alert_once_truncated_col = 0;
         char fp[FINGERPRINTSZ * 2 + 1]; /* 16 ==> 33 */
@@ -70,6 +70,14 @@ struct comdb2_metrics_store {
     int64_t checkpoint_count;
     int64_t rcache_hits;
     int64_t rcache_misses;
+    int64_t ahi_hits;
+    int64_t ahi_invalidations;
+    int64_t keypfx_hits;
+    int64_t keypfx_narrowed;
+    int64_t sql_array_insert_loops;
+    int64_t osql_insert_batches;
+    int64_t sql_arena_resets;
+    int64_t sql_arena_busy_resets;
     int64_t last_election_ms;
     int64_t total_election_ms;
     int64_t election_count;
@@ -89,6 +97,11 @@ struct comdb2_metrics_store {
     int64_t temptable_created;
     int64_t temptable_create_reqs;
     int64_t temptable_spills;
+    int64_t lua_sp_pool_hits;
+    int64_t lua_sp_pool_misses;
+    int64_t lua_sp_bytecode_hits;
+    int64_t lua_sp_bytecode_misses;
+    int64_t lua_sp_setup_us_saved;
     int64_t net_drops;
     int64_t net_queue_size;
     int64_t rep_deadlocks;
@@ -220,6 +233,22 @@ comdb2_metric gbl_metrics[] = {
      &stats.rcache_hits},
     {"rcache_misses", "Count of root-page cache misses", STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE,
      &stats.rcache_misses},
+    {"ahi_hits", "Count of point lookups sent straight to the leaf by the adaptive hash index", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.ahi_hits},
+    {"ahi_invalidations", "Count of adaptive hash index entries found out of date", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.ahi_invalidations},
+    {"keypfx_hits", "Count of internal page searches that used cached key prefixes", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.keypfx_hits},
+    {"keypfx_narrowed", "Count of internal page searches that cached key prefixes narrowed to fewer entries",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.keypfx_narrowed},
+    {"sql_array_insert_loops", "Count of array inserts run as a single statement execution", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.sql_array_insert_loops},
+    {"osql_insert_batches", "Count of OSQL_INSERT messages sent with packed rows", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.osql_insert_batches},
+    {"sql_arena_resets", "Count of statement arena resets", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.sql_arena_resets},
+    {"sql_arena_busy_resets", "Count of statement arena resets that held chunks back for live blocks",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.sql_arena_busy_resets},
     {"last_election_ms", "Time taken to resolve last election", STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST,
      &stats.last_election_ms, NULL},
     {"total_election_ms", "Total time taken to resolve elections", STATISTIC_INTEGER,
@@ -258,6 +287,16 @@ comdb2_metric gbl_metrics[] = {
      STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.temptable_create_reqs, NULL},
     {"temptable_spills", "Number of temporary tables that had to be spilled to disk-backed tables", STATISTIC_INTEGER,
      STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.temptable_spills, NULL},
+    {"lua_sp_pool_hits", "Number of stored procedure runs that reused a pooled Lua VM", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.lua_sp_pool_hits, NULL},
+    {"lua_sp_pool_misses", "Number of Lua VMs created for stored procedures", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.lua_sp_pool_misses, NULL},
+    {"lua_sp_bytecode_hits", "Number of stored procedure loads served from compiled bytecode", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.lua_sp_bytecode_hits, NULL},
+    {"lua_sp_bytecode_misses", "Number of stored procedure loads compiled from source", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.lua_sp_bytecode_misses, NULL},
+    {"lua_sp_setup_us_saved", "Estimated microseconds of Lua VM setup and compilation saved by reuse",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.lua_sp_setup_us_saved, NULL},
     {"net_drops", "Number of packets that didn't fit on network queue and were dropped", STATISTIC_INTEGER,
      STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.net_drops, NULL},
     {"net_queue_size", "Size of largest outgoing net queue", STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST,
@@ -651,6 +690,14 @@ int refresh_metrics(void)
     stats.checkpoint_count = gbl_checkpoint_count;
     stats.rcache_hits = rcache_hits;
     stats.rcache_misses = rcache_miss;
+    stats.ahi_hits = bt_ahi_hits;
+    stats.ahi_invalidations = bt_ahi_invalid;
+    stats.keypfx_hits = bt_keypfx_hits;
+    stats.keypfx_narrowed = bt_keypfx_narrowed;
+    stats.sql_array_insert_loops = gbl_sql_array_insert_loops;
+    stats.osql_insert_batches = gbl_osql_insert_batches;
+    stats.sql_arena_resets = gbl_sql_arena_resets;
+    stats.sql_arena_busy_resets = gbl_sql_arena_busy_resets;
     stats.last_election_ms = gbl_last_election_time_ms;
     stats.total_election_ms = gbl_total_election_time_ms;
     stats.election_count = gbl_election_count;
@@ -669,6 +716,11 @@ int refresh_metrics(void)
     stats.temptable_created = gbl_temptable_created;
     stats.temptable_create_reqs = gbl_temptable_create_reqs;
     stats.temptable_spills = gbl_temptable_spills;
+    stats.lua_sp_pool_hits = gbl_lua_sp_pool_hits;
+    stats.lua_sp_pool_misses = gbl_lua_sp_pool_misses;
+    stats.lua_sp_bytecode_hits = gbl_lua_sp_bytecode_hits;
+    stats.lua_sp_bytecode_misses = gbl_lua_sp_bytecode_misses;
+    stats.lua_sp_setup_us_saved = gbl_lua_sp_setup_us_saved;
 
     struct net_stats net_stats;
     rc = net_get_stats(thedb->handle_sibling, &net_stats);
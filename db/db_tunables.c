@@ -34,6 +34,7 @@
 #include "sc_rename_table.h"
 #include <disttxn.h>
 #include "views.h"
+#include "comdb2_ruleset.h"
 
 /* Maximum allowable size of the value of tunable. */
 #define MAX_TUNABLE_VALUE_SIZE 512
@@ -106,6 +107,20 @@ extern int gbl_fdb_push_redirect_foreign;
 extern int gbl_fdb_push_remote;
 extern int gbl_fdb_push_remote_write;
 extern int gbl_fdb_remsql_cdb2api;
+extern int gbl_fdb_rowcache_size_kb;
+extern int gbl_fdb_rowcache_max_entry_kb;
+extern int gbl_fdb_rowcache_ttl_ms;
+extern int gbl_sql_arena_kb;
+extern int gbl_sql_arena_chunk_kb;
+extern int gbl_sql_sched;
+extern int gbl_sql_sched_long_cost;
+extern int gbl_sql_sched_long_maxthds;
+extern int gbl_newsql_max_prepared;
+extern int gbl_sql_array_insert;
+extern int gbl_osql_insert_batch;
+extern int gbl_read_lsn_wait_ms;
+extern int gbl_sql_sched_long_weight;
+extern int gbl_sql_sched_short_weight;
 extern int gbl_goslow;
 extern int gbl_heartbeat_send;
 extern int gbl_keycompr;
@@ -119,6 +134,8 @@ extern int gbl_debug_stat4dump_loop;
 extern int gbl_master_swing_osql_verbose;
 extern int gbl_master_swing_sock_restart_sleep;
 extern int gbl_max_lua_instructions;
+extern int gbl_lua_sp_pool_size;
+extern int gbl_lua_sp_bytecode_cache_size;
 extern int gbl_max_sqlcache;
 extern int __gbl_max_mpalloc_sleeptime;
 extern int gbl_mem_nice;
@@ -317,6 +334,7 @@ extern int gbl_max_trigger_threads;
 extern int gbl_alternate_normalize;
 extern int gbl_sc_logbytes_per_second;
 extern int gbl_fingerprint_max_queries;
+extern int gbl_latency_histograms;
 extern int gbl_query_plan_max_plans;
 extern double gbl_query_plan_percentage;
 extern int gbl_ufid_log;
@@ -344,6 +362,7 @@ extern char *gbl_crypto;
 extern char *gbl_spfile_name;
 extern char *gbl_user_vers_spfile_name;
 extern char *gbl_timepart_file_name;
+extern char *gbl_timepart_summary_column;
 extern char *gbl_test_log_file;
 extern pthread_mutex_t gbl_test_log_file_mtx;
 extern char *gbl_machine_class;
@@ -443,6 +462,9 @@ extern int gbl_instrument_consumer_lock;
 extern int gbl_reject_mixed_ddl_dml;
 extern int gbl_debug_create_master_entry;
 extern int eventlog_nkeep;
+extern int gbl_eventlog_binary;
+extern int gbl_eventlog_ring_kb;
+extern int eventlog_set_binary(int);
 extern int gbl_debug_systable_locks;
 extern int gbl_assert_systable_locks;
 extern int gbl_track_curtran_gettran_locks;
@@ -554,6 +576,7 @@ int gbl_new_leader_duration = 3;
 extern int gbl_transaction_grace_period;
 extern int gbl_partition_sc_reorder;
 extern int gbl_dohsql_joins;
+extern int gbl_dohsql_stripe_scan;
 extern int gbl_altersc_latency;
 extern int gbl_altersc_delay_usec;
 extern int gbl_altersc_latency_thr;
@@ -791,6 +814,11 @@ static int genid_seed_update(void *context, void *value)
     return 0;
 }
 
+static int eventlog_binary_update(void *context, void *value)
+{
+    return eventlog_set_binary(*(int *)value);
+}
+
 /*
   Enable client side retrys for n seconds. Keep blkseq's around
   for 2 * this time.
@@ -1209,6 +1237,27 @@ static int page_order_table_scan_update(void *context, void *value)
     return 0;
 }
 
+static int sql_sched_update(void *context, void *value)
+{
+    gbl_sql_sched = (*(int *)value) ? 1 : 0;
+    if (gbl_sql_sched && !comdb2_ruleset_fingerprints_allowed())
+        logmsg(LOGMSG_WARN, "sql_sched: strict_double_quotes is off, so queued "
+                            "queries are not fingerprinted: they are grouped "
+                            "by ruleset rule only and all scheduled as short\n");
+    return 0;
+}
+
+extern void fdb_rowcache_flush(void);
+
+static int fdb_rowcache_size_kb_update(void *context, void *value)
+{
+    gbl_fdb_rowcache_size_kb = *(int *)value;
+    /* disabling the cache gives back its memory, statistics included */
+    if (gbl_fdb_rowcache_size_kb <= 0)
+        fdb_rowcache_flush();
+    return 0;
+}
+
 static int max_password_cache_size_update(void *context, void *value)
 {
     int val = *(int *)value;
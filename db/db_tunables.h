@@ -808,6 +808,12 @@ REGISTER_TUNABLE("max_query_fingerprints",
                  "hash (Default: 1000)",
                  TUNABLE_INTEGER, &gbl_fingerprint_max_queries, 0, NULL,
                  NULL, NULL, NULL);
+REGISTER_TUNABLE("latency_histograms",
+                 "Keep latency histograms per query fingerprint and per table, "
+                 "see comdb2_fingerprint_latency and comdb2_table_latency "
+                 "(Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_latency_histograms, 0, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("memnice", NULL, TUNABLE_INTEGER, &gbl_mem_nice,
                  READONLY | NOARG, NULL, NULL, memnice_update, NULL);
 REGISTER_TUNABLE("mempget_timeout", NULL, TUNABLE_INTEGER,
@@ -1115,6 +1121,12 @@ REGISTER_TUNABLE("version_spfile", NULL, TUNABLE_STRING, &gbl_user_vers_spfile_n
 REGISTER_TUNABLE("timepartitions", NULL, TUNABLE_STRING,
                  &gbl_timepart_file_name, READONLY, NULL, NULL, file_update,
                  NULL);
+REGISTER_TUNABLE("timepart_summary_column",
+                 "Keep min/max of this column for time partition shards that "
+                 "no longer take inserts, and skip shards that cannot match a "
+                 "comparison on it (Default: none)",
+                 TUNABLE_STRING, &gbl_timepart_summary_column, READONLY, NULL,
+                 NULL, NULL, NULL);
 REGISTER_TUNABLE("sqlflush", "Force flushing the current record "
                              "stream to client every specified "
                              "number of records. (Default: 0)",
@@ -2095,6 +2107,19 @@ REGISTER_TUNABLE("longreq_log_freq_sec",
 REGISTER_TUNABLE("eventlog_nkeep", "Keep this many eventlog files (Default: 2)",
                  TUNABLE_INTEGER, &eventlog_nkeep, 0, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("eventlog_binary",
+                 "Write the event log as compact binary records, queued per "
+                 "thread and written out by a background thread "
+                 "(Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_eventlog_binary, 0, NULL, NULL,
+                 eventlog_binary_update, NULL);
+
+REGISTER_TUNABLE("eventlog_ring_kb",
+                 "Size of each thread's binary event log ring; events that "
+                 "don't fit are dropped (Default: 256)",
+                 TUNABLE_INTEGER, &gbl_eventlog_ring_kb, 0, NULL, NULL, NULL,
+                 NULL);
+
 REGISTER_TUNABLE("waitalive_iterations",
                  "Wait this many iterations for a "
                  "socket to be usable.  (Default: 3)",
@@ -2189,6 +2214,19 @@ REGISTER_TUNABLE("debug_queuedb",
                  TUNABLE_BOOLEAN, &gbl_debug_queuedb, EXPERIMENTAL, NULL, NULL,
                  NULL, NULL);
 
+REGISTER_TUNABLE("lua_sp_pool_size",
+                 "Number of Lua VMs of closed connections kept for reuse by "
+                 "the next connection running the same stored procedure as "
+                 "the same user; 0 disables the pool.  (Default: 32)",
+                 TUNABLE_INTEGER, &gbl_lua_sp_pool_size, 0, NULL, NULL, NULL,
+                 NULL);
+
+REGISTER_TUNABLE("lua_sp_bytecode_cache_size",
+                 "Number of compiled stored procedure sources to keep; 0 "
+                 "compiles the source on every execution.  (Default: 256)",
+                 TUNABLE_INTEGER, &gbl_lua_sp_bytecode_cache_size, 0, NULL,
+                 NULL, NULL, NULL);
+
 REGISTER_TUNABLE("lua_prepare_retries",
                  "Maximum number of times to retry SQL query preparation "
                  "when faced with 'database schema has changed' errors in "
@@ -2412,6 +2450,16 @@ REGISTER_TUNABLE("fdb_io_error_retries_phase_2_poll",
 REGISTER_TUNABLE("fdb_remsql_cdb2api",
                  "Switch the standalone remote sql queries to cdb2api",
                  TUNABLE_BOOLEAN, &gbl_fdb_remsql_cdb2api, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_rowcache_size_kb",
+                 "Size in KB of the cache of remote cursor result sets shared across sql threads; 0 disables. "
+                 "(Default: 0)",
+                 TUNABLE_INTEGER, &gbl_fdb_rowcache_size_kb, 0, NULL, NULL, fdb_rowcache_size_kb_update, NULL);
+REGISTER_TUNABLE("fdb_rowcache_max_entry_kb",
+                 "Result sets larger than this are not added to the remote row cache.  (Default: 256)",
+                 TUNABLE_INTEGER, &gbl_fdb_rowcache_max_entry_kb, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_rowcache_ttl_ms",
+                 "Milliseconds a cached remote result set is served before it is refetched.  (Default: 10000)",
+                 TUNABLE_INTEGER, &gbl_fdb_rowcache_ttl_ms, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("unexpected_last_type_warn",
                  "print a line of trace if the last response server sent before sockpool reset isn't LAST_ROW",
                  TUNABLE_INTEGER, &gbl_unexpected_last_type_warn, EXPERIMENTAL | INTERNAL, NULL, NULL, NULL, NULL);
@@ -2453,6 +2501,10 @@ REGISTER_TUNABLE("partition_sc_reorder", "If the schema change is serialized for
 
 REGISTER_TUNABLE("dohsql_joins", "Enable to support joins in parallel sql execution (default: on)", TUNABLE_BOOLEAN,
                  &gbl_dohsql_joins, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("dohsql_stripe_scan",
+                 "Run single table scans in parallel, one sql engine per range of data stripes; "
+                 "COUNT/SUM/MIN/MAX are combined by the coordinator (default: off)",
+                 TUNABLE_BOOLEAN, &gbl_dohsql_stripe_scan, 0, NULL, NULL, NULL, NULL);
 
 REGISTER_TUNABLE("altersc_latency", "Enable tracking master queue latency and delay alter schema changes if too high",
                  TUNABLE_BOOLEAN, &gbl_altersc_latency, 0, NULL, NULL, NULL, NULL);
@@ -2482,5 +2534,49 @@ REGISTER_TUNABLE("sc_status_max_rows", "Max number of rows returned in comdb2_sc
                  TUNABLE_INTEGER, &gbl_sc_status_max_rows, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("rep_process_pstack_time", "pstack the server if rep_process runs longer than time specified in secs (Default: 30s)",
                  TUNABLE_INTEGER, &gbl_rep_process_pstack_time, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_arena_kb",
+                 "Size in KB of the per-thread arena that sql statements allocate their "
+                 "short-lived buffers from; 0 disables.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_sql_arena_kb, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_arena_chunk_kb",
+                 "Size in KB of the chunks the sql statement arena grows by.  (Default: 64)",
+                 TUNABLE_INTEGER, &gbl_sql_arena_chunk_kb, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_sched",
+                 "Serve queued SQL in weighted fair order of ruleset rule and "
+                 "fingerprint, charging each query its average past cost.  (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_sql_sched, 0, NULL, NULL, sql_sched_update, NULL);
+REGISTER_TUNABLE("sql_sched_long_cost",
+                 "Fingerprints averaging at least this cost are scheduled as long "
+                 "queries; 0 puts everything in the short class.  (Default: 100000)",
+                 TUNABLE_INTEGER, &gbl_sql_sched_long_cost, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_sched_long_maxthds",
+                 "Maximum long queries running at once in a pool; 0 means no limit.  "
+                 "(Default: 0)",
+                 TUNABLE_INTEGER, &gbl_sql_sched_long_maxthds, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_sched_long_weight",
+                 "Scheduling weight of long queries.  (Default: 1)",
+                 TUNABLE_INTEGER, &gbl_sql_sched_long_weight, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_sched_short_weight",
+                 "Scheduling weight of short queries.  (Default: 4)",
+                 TUNABLE_INTEGER, &gbl_sql_sched_short_weight, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("newsql_max_prepared",
+                 "Maximum statements a client connection may prepare for execution by "
+                 "statement id; 0 disables prepared statements.  (Default: 128)",
+                 TUNABLE_INTEGER, &gbl_newsql_max_prepared, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_array_insert",
+                 "Run an INSERT whose parameters are bound to arrays once per "
+                 "array element, in a single transaction.  (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_sql_array_insert, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("osql_insert_batch",
+                 "Pack the rows of an array insert into OSQL_INSERT messages "
+                 "of up to this many bytes; every node must understand packed "
+                 "inserts before this is set.  0 sends one message per row.  "
+                 "(Default: 0)",
+                 TUNABLE_INTEGER, &gbl_osql_insert_batch, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("read_lsn_wait_ms",
+                 "Longest a query carrying a read lsn waits for this node to "
+                 "apply it before the client is told to change nodes.  "
+                 "(Default: 1000)",
+                 TUNABLE_INTEGER, &gbl_read_lsn_wait_ms, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("sql_recover_time", "Number of msec before checking if SQL has waiters. 0 will disable. (Default: 10ms)", TUNABLE_INTEGER, &gbl_sql_recover_time, 0, NULL, NULL, NULL, NULL);
 #endif /* _DB_TUNABLES_H */
@@ -25,6 +25,7 @@
 int gbl_dohast_disable = 0;
 int gbl_dohast_verbose = 0;
 int gbl_dohsql_joins = 1;
+int gbl_dohsql_stripe_scan = 0;
 
 static void node_free(dohsql_node_t **pnode, sqlite3 *db);
 static void _save_params(Parse *pParse, dohsql_node_t *node);
@@ -548,6 +549,12 @@ static void node_free(dohsql_node_t **pnode, sqlite3 *db)
         free((*pnode)->params);
     }
 
+    /* per stripe nodes are not allocated with their parent */
+    if (node->nodes && node->nodes != (dohsql_node_t **)(node + 1))
+        free(node->nodes);
+    free(node->stripe_tbl);
+    free(node->aggs);
+
     /* current node */
     if ((*pnode)->sql) {
         sqlite3_free((*pnode)->sql);
@@ -693,6 +700,138 @@ static int skip_tables(Select *p)
     return 0;
 }
 
+static void _drop_stripes(dohsql_node_t *node, sqlite3 *db)
+{
+    int i;
+
+    for (i = 0; i < node->nnodes; i++)
+        node_free(&node->nodes[i], db);
+    free(node->nodes);
+    node->nodes = NULL;
+    node->nnodes = 0;
+    free(node->stripe_tbl);
+    node->stripe_tbl = NULL;
+    free(node->aggs);
+    node->aggs = NULL;
+}
+
+/* partial aggregate the coordinator can fold, 0 if none */
+static int _stripe_agg(Expr *pExpr)
+{
+    const char *name;
+
+    if (pExpr->op != TK_AGG_FUNCTION ||
+        ExprHasProperty(pExpr, EP_Distinct | EP_WinFunc))
+        return 0;
+
+    name = pExpr->u.zToken;
+    if (!strcasecmp(name, "count"))
+        return DOHSQL_AGG_COUNT;
+    if (!strcasecmp(name, "sum"))
+        return DOHSQL_AGG_SUM;
+    if (!strcasecmp(name, "min"))
+        return DOHSQL_AGG_MIN;
+    if (!strcasecmp(name, "max"))
+        return DOHSQL_AGG_MAX;
+    return 0;
+}
+
+/**
+ * Split a single table select in one select per range of data stripes;
+ * the sql is the same, each engine restricts its data cursor to its range.
+ * Whether the table is actually scanned is only known once the plan is
+ * done, see _is_stripe_scan()
+ *
+ */
+static void gen_stripes(Vdbe *v, Select *p, dohsql_node_t *node)
+{
+    struct dbtable *db;
+    int *aggs = NULL;
+    int nthds, i;
+
+    if (p->pSrc->nSrc != 1 || !p->pSrc->a[0].pTab ||
+        p->pSrc->a[0].pTab->iDb != 0 || p->pLimit ||
+        p->pOrderBy || (p->selFlags & SF_Distinct))
+        return;
+
+    db = get_dbtable_by_name(p->pSrc->a[0].pTab->zName);
+    if (!db || !db->dtastripe)
+        return;
+
+    nthds = gbl_dtastripe;
+    if (gbl_dohsql_max_threads && nthds > gbl_dohsql_max_threads)
+        nthds = gbl_dohsql_max_threads;
+    if (nthds < 2)
+        return;
+
+    if (p->selFlags & SF_Aggregate) {
+        aggs = calloc(p->pEList->nExpr, sizeof(int));
+        if (!aggs)
+            return;
+        for (i = 0; i < p->pEList->nExpr; i++) {
+            aggs[i] = _stripe_agg(p->pEList->a[i].pExpr);
+            if (!aggs[i]) {
+                free(aggs);
+                return;
+            }
+        }
+    }
+
+    node->nodes = calloc(nthds, sizeof(dohsql_node_t *));
+    if (!node->nodes) {
+        free(aggs);
+        return;
+    }
+    for (node->nnodes = 0; node->nnodes < nthds; node->nnodes++) {
+        node->nodes[node->nnodes] = gen_oneselect(v, p, NULL, NULL, NULL, 0);
+        if (!node->nodes[node->nnodes])
+            break;
+    }
+    node->stripe_tbl = strdup(db->tablename);
+    node->aggs = aggs;
+    if (node->nnodes < nthds || !node->stripe_tbl)
+        _drop_stripes(node, v->db);
+}
+
+/**
+ * The split is correct only if the table is read by walking its data
+ * btree; index lookups, rowid seeks and btree counts are not restricted to
+ * a stripe
+ *
+ */
+static int _is_stripe_scan(Vdbe *v)
+{
+    int i, csr = -1, scan = 0;
+
+    for (i = 0; i < v->nOp; i++) {
+        VdbeOp *pOp = &v->aOp[i];
+        switch (pOp->opcode) {
+        case OP_OpenRead:
+            if (csr != -1 || pOp->p4type == P4_KEYINFO)
+                return 0;
+            csr = pOp->p1;
+            break;
+        case OP_ReopenIdx:
+        case OP_OpenWrite:
+        case OP_OpenDup:
+        case OP_SeekRowid:
+        case OP_NotExists:
+        case OP_SeekGE:
+        case OP_SeekGT:
+        case OP_SeekLE:
+        case OP_SeekLT:
+        case OP_Count:
+            return 0;
+        case OP_Rewind:
+            if (pOp->p1 == csr)
+                scan = 1;
+            break;
+        }
+    }
+
+    return scan;
+}
+
 static dohsql_node_t *gen_select(Vdbe *v, Select *p)
 {
     Select *crt;
@@ -793,8 +932,12 @@ int ast_push(ast_t *ast, enum ast_type op, Vdbe *v, void *obj)
         Select *p = (Select *)obj;
 
         if ((p->selFlags & SF_ASTIncluded) == 0) {
+            dohsql_node_t *node = gen_select(v, p);
+            if (node && node->type == AST_TYPE_SELECT && !node->remotedb &&
+                gbl_dohsql_stripe_scan)
+                gen_stripes(v, p, node);
             ast->stack[ast->nused].op = op;
-            ast->stack[ast->nused].obj = gen_select(v, p);
+            ast->stack[ast->nused].obj = node;
             ast->nused++;
         } else {
             ignore = 1;
@@ -905,12 +1048,28 @@ int comdb2_check_parallel(Parse *pParse)
 
     node = (dohsql_node_t *)ast->stack[0].obj;
 
+    if (node->stripe_tbl && !_is_stripe_scan(pParse->pVdbe))
+        _drop_stripes(node, pParse->db);
+
     if (pParse->explain) {
         if (pParse->explain == 3)
             explain_distribution(node);
         return 0;
     }
 
+    if (node->type == AST_TYPE_SELECT && node->stripe_tbl) {
+        _save_params(pParse, node);
+
+        if (gbl_dohast_verbose)
+            logmsg(LOGMSG_USER, "%p Parallel scan of %s, %d threads \"%s\"\n",
+                   (void *)pthread_self(), node->stripe_tbl, node->nnodes,
+                   node->sql);
+
+        if (dohsql_distribute(node))
+            return 0;
+        return 1;
+    }
+
     if (node->type == AST_TYPE_SELECT) {
         if (gbl_dohast_verbose)
             logmsg(LOGMSG_USER, "%p Single query \"%s\"\n", (void *)pthread_self(), node->sql);
@@ -72,6 +72,9 @@ struct dohsql_connector {
     long long queue_size;   /* size of queue in bytes */
     int nparams;            /* parameters for the child */
     struct param_data *params;
+    const char *stripe_tbl; /* scan only stripes [stripe_lo, stripe_hi) of */
+    int stripe_lo;          /* this table, if set */
+    int stripe_hi;
     dohsql_connector_stats_t stats;
 };
 typedef struct dohsql_connector dohsql_connector_t;
@@ -123,6 +126,12 @@ struct dohsql {
     int order_size;
     int *order_dir;
     int nparams;
+    /* per stripe scan support */
+    char *stripe_tbl;
+    int *aggs;           /* how to fold partial aggregates, if any */
+    Mem *agg;            /* folded row */
+    int agg_done;        /* folded row was returned */
+    const char *agg_err; /* folding failed, e.g. the sum overflowed */
     /* stats */
     dohsql_req_stats_t stats;
 };
@@ -461,6 +470,8 @@ static int dohsql_dist_column_count(struct sqlclntstate *clnt, sqlite3_stmt *_)
                                          sqlite3_stmt *stmt, int iCol)         \
     {                                                                          \
         dohsql_t *conns = clnt->conns;                                         \
+        if (conns->agg_done)                                                   \
+            return sqlite3_value_##type(&conns->agg[iCol]);                    \
         if (conns->row_src == 0)                                               \
             return sqlite3_column_##type(stmt, iCol);                          \
         if (!conns->row->unpacked) {                                           \
@@ -483,6 +494,8 @@ static const intv_t *dohsql_dist_column_interval(struct sqlclntstate *clnt,
                                                  int type)
 {
     dohsql_t *conns = clnt->conns;
+    if (conns->agg_done)
+        return sqlite3_value_interval(&conns->agg[iCol], type);
     if (conns->row_src == 0)
         return sqlite3_column_interval(stmt, iCol, type);
 
@@ -870,6 +883,97 @@ got_row:
     return SQLITE_ROW;
 }
 
+static int _is_decimal(const Mem *m)
+{
+    return (m->flags & MEM_Interval) && m->du.tv.type == INTV_DECIMAL_TYPE;
+}
+
+/* the partial sums are added the way sumStep() would have added the rows,
+ * had a single engine seen all of them; returns the error the query fails
+ * with, or NULL */
+static const char *_agg_step(Mem *acc, int agg, Mem *val)
+{
+    Mem res;
+    i64 sum;
+
+    if (val->flags & MEM_Null)
+        return NULL;
+
+    if (acc->flags & MEM_Null) {
+        sqlite3VdbeMemCopy(acc, val);
+        return NULL;
+    }
+
+    switch (agg) {
+    case DOHSQL_AGG_COUNT:
+    case DOHSQL_AGG_SUM:
+        if ((acc->flags & MEM_Int) && (val->flags & MEM_Int)) {
+            if (__builtin_add_overflow(acc->u.i, val->u.i, &sum))
+                return "integer overflow";
+            sqlite3VdbeMemSetInt64(acc, sum);
+        } else if ((_is_decimal(acc) && !(val->flags & MEM_Real)) ||
+                   (_is_decimal(val) && !(acc->flags & MEM_Real))) {
+            if (_is_decimal(acc)
+                    ? sqliteVdbeMemDecimalBasicArithmetics(acc, val, OP_Add,
+                                                           &res, 0)
+                    : sqliteVdbeMemDecimalBasicArithmetics(val, acc, OP_Add,
+                                                           &res, 0))
+                return "decimal overflow";
+            sqlite3VdbeMemCopy(acc, &res);
+        } else if ((acc->flags & MEM_Interval) &&
+                   (val->flags & MEM_Interval) &&
+                   (acc->du.tv.type == INTV_YM_TYPE) ==
+                       (val->du.tv.type == INTV_YM_TYPE)) {
+            if (sqlite3VdbeMemIntervalAndInterval(acc, val, OP_Add, &res))
+                return "interval overflow";
+            sqlite3VdbeMemCopy(acc, &res);
+        } else {
+            sqlite3VdbeMemSetDouble(acc, sqlite3VdbeRealValue(acc) +
+                                             sqlite3VdbeRealValue(val));
+        }
+        break;
+    case DOHSQL_AGG_MIN:
+        if (sqlite3MemCompare(val, acc, NULL) < 0)
+            sqlite3VdbeMemCopy(acc, val);
+        break;
+    case DOHSQL_AGG_MAX:
+        if (sqlite3MemCompare(val, acc, NULL) > 0)
+            sqlite3VdbeMemCopy(acc, val);
+        break;
+    }
+    return NULL;
+}
+
+/**
+ * every engine scanned its own stripes and returned one row of partial
+ * aggregates; fold them into the one row the client asked for
+ *
+ */
+static int dohsql_dist_next_row_combined(struct sqlclntstate *clnt,
+                                         sqlite3_stmt *stmt)
+{
+    dohsql_t *conns = clnt->conns;
+    int i, rc;
+
+    if (conns->agg_done)
+        return SQLITE_DONE;
+
+    while ((rc = dohsql_dist_next_row(clnt, stmt)) == SQLITE_ROW) {
+        /* keep draining the shards after a failure, they have to finish */
+        for (i = 0; i < conns->ncols && !conns->agg_err; i++)
+            conns->agg_err = _agg_step(&conns->agg[i], conns->aggs[i],
+                                       dohsql_dist_column_value(clnt, stmt, i));
+    }
+    if (rc != SQLITE_DONE)
+        return rc;
+
+    conns->agg_done = 1;
+    /* reported by dohsql_error() */
+    if (conns->agg_err)
+        return SQLITE_EARLYSTOP_DOHSQL;
+    return SQLITE_ROW;
+}
+
 static int dohsql_write_response(struct sqlclntstate *c, int t, void *a, int i)
 {
     if (gbl_plugin_api_debug)
@@ -1088,8 +1192,12 @@ static void _master_clnt_set(struct sqlclntstate *clnt)
     clnt->adapter_backup = clnt->adapter;
 
     clnt->plugin.column_count = dohsql_dist_column_count;
-    clnt->plugin.next_row = (clnt->conns->order) ? dohsql_dist_next_row_ordered
-                                                 : dohsql_dist_next_row;
+    if (clnt->conns->aggs)
+        clnt->plugin.next_row = dohsql_dist_next_row_combined;
+    else
+        clnt->plugin.next_row = (clnt->conns->order)
+                                    ? dohsql_dist_next_row_ordered
+                                    : dohsql_dist_next_row;
     clnt->plugin.column_type = dohsql_dist_column_type;
     clnt->plugin.column_int64 = dohsql_dist_column_int64;
     clnt->plugin.column_double = dohsql_dist_column_double;
@@ -1200,6 +1308,24 @@ int dohsql_distribute(dohsql_node_t *node)
         }
         flags = THDPOOL_FORCE_DISPATCH;
     }
+    if (node->stripe_tbl) {
+        /* take over the split; node is gone once the prepare is done */
+        conns->stripe_tbl = node->stripe_tbl;
+        node->stripe_tbl = NULL;
+        if (node->aggs) {
+            conns->agg = calloc(conns->ncols, sizeof(Mem));
+            if (!conns->agg) {
+                free(conns->stripe_tbl);
+                free(conns);
+                _rem_parallel_load();
+                return SHARD_ERR_MALLOC;
+            }
+            for (i = 0; i < conns->ncols; i++)
+                conns->agg[i].flags = MEM_Null;
+            conns->aggs = node->aggs;
+            node->aggs = NULL;
+        }
+    }
     /* there is a slack to allow non-coordinator tasks to drain;
      * it is still possible to fill the sql queue; force the 
      * worker shards on the queue in any case
@@ -1223,6 +1349,11 @@ int dohsql_distribute(dohsql_node_t *node)
         if ((rc = _shard_connect(clnt, &conns->conns[i], node->nodes[i]->sql,
                                  nparams, params)) != 0)
             return rc;
+        if (conns->stripe_tbl) {
+            conns->conns[i].stripe_tbl = conns->stripe_tbl;
+            conns->conns[i].stripe_lo = i * gbl_dtastripe / conns->nconns;
+            conns->conns[i].stripe_hi = (i + 1) * gbl_dtastripe / conns->nconns;
+        }
 
         if (i > 0) {
             struct string_ref *sr = create_string_ref(node->nodes[i]->sql);
@@ -1343,6 +1474,13 @@ int dohsql_end_distribute(struct sqlclntstate *clnt, struct reqlogger *logger)
         free(conns->order);
         free(conns->order_dir);
     }
+    if (conns->agg) {
+        for (i = 0; i < conns->ncols; i++)
+            sqlite3VdbeMemRelease(&conns->agg[i]);
+        free(conns->agg);
+        free(conns->aggs);
+    }
+    free(conns->stripe_tbl);
     clnt_plugin_reset(clnt);
     clnt->conns = NULL;
     free(conns);
@@ -1412,6 +1550,26 @@ void dohsql_wait_for_master(sqlite3_stmt *stmt, struct sqlclntstate *clnt)
     Pthread_mutex_unlock(&conn->mtx);
 }
 
+int dohsql_scan_stripes(struct sqlclntstate *clnt, const char *tbl, int *lo,
+                        int *hi)
+{
+    dohsql_connector_t *conn;
+
+    if (clnt->conns)
+        conn = &clnt->conns->conns[0]; /* coordinator runs the first range */
+    else if (DOHSQL_CLIENT)
+        conn = clnt->plugin.state;
+    else
+        return 0;
+
+    if (!conn->stripe_tbl || strcasecmp(conn->stripe_tbl, tbl))
+        return 0;
+
+    *lo = conn->stripe_lo;
+    *hi = conn->stripe_hi;
+    return 1;
+}
+
 const char *dohsql_get_sql(struct sqlclntstate *clnt, int index)
 {
     return clnt->conns->conns[index].clnt->sql;
@@ -1889,6 +2047,11 @@ int dohsql_error(struct sqlclntstate *clnt, const char **errstr)
 {
     struct sqlclntstate *child_clnt;
 
+    if (clnt && clnt->conns && clnt->conns->agg_err) {
+        *errstr = clnt->conns->agg_err;
+        return SQLITE_ERROR;
+    }
+
     if (clnt && clnt->conns && clnt->conns->child_err) {
         child_clnt = clnt->conns->conns[clnt->conns->child_err].clnt;
         *errstr = child_clnt->saved_errstr;
@@ -1956,7 +2119,7 @@ void explain_distribution(dohsql_node_t *node)
     if (write_response(clnt, RESPONSE_COLUMNS_STR, &cols, 1))
         return;
 
-    if (node->type == AST_TYPE_UNION) {
+    if (node->type == AST_TYPE_UNION || node->stripe_tbl) {
         snprintf(str, sizeof(str), "Threads %d", node->nnodes);
         char *pstr = &str[0];
 
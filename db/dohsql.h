@@ -25,6 +25,14 @@ struct params_info {
     struct param_data *params;
 };
 
+/* how the coordinator folds the per-stripe rows of an aggregate */
+enum dohsql_agg {
+    DOHSQL_AGG_COUNT = 1,
+    DOHSQL_AGG_SUM = 2,
+    DOHSQL_AGG_MIN = 3,
+    DOHSQL_AGG_MAX = 4
+};
+
 struct dohsql_node {
     enum ast_type type;
     char *sql;
@@ -36,6 +44,8 @@ struct dohsql_node {
     int nparams;
     int remotedb;
     struct params_info *params;
+    char *stripe_tbl; /* single select split in one node per stripe range */
+    int *aggs;        /* per column dohsql_agg, if an aggregate was split */
 };
 typedef struct dohsql_node dohsql_node_t;
 
@@ -69,6 +79,14 @@ void dohsql_wait_for_master(sqlite3_stmt *stmt, struct sqlclntstate *clnt);
     struct sql_thread *thd = pthread_getspecific(query_info_key);              \
     struct sqlclntstate *clnt = thd->clnt;
 
+/**
+ * Return 1 if data cursors on table "tbl" opened by this client must walk
+ * only the stripes [*lo, *hi)
+ *
+ */
+int dohsql_scan_stripes(struct sqlclntstate *clnt, const char *tbl, int *lo,
+                        int *hi);
+
 /**
  * Return 1 if this sql thread servers a parallel statement
  *
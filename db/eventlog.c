@@ -24,6 +24,7 @@
 #include <sys/time.h>
 #include <inttypes.h>
 #include <dirent.h>
+#include <sys/stat.h>
 #include <bb_oscompat.h>
 
 #include <comdb2.h>
@@ -43,6 +44,8 @@
 #include "cson.h"
 #include "comdb2_atomic.h"
 #include "string_ref.h"
+#include "eventlog_bin.h"
+#include "thread_util.h"
 
 #include <carray.h>
 
@@ -64,7 +67,14 @@ static int eventlog_every_n = 1;
 static int64_t eventlog_count = 0;
 static int eventlog_debug_events = 0;
 
+int gbl_eventlog_binary = 0;
+int gbl_eventlog_ring_kb = 256;
+static int eventlog_is_binary = 0; /* format of the open file */
+static int eventlog_gen = 1;       /* bumped whenever seen_sql is reset */
+
 static void eventlog_roll(void);
+static void eventlog_drain_locked(void);
+static void eventlog_start_drain(void);
 
 struct sqltrack {
     char fingerprint[FINGERPRINTSZ];
@@ -75,6 +85,46 @@ LISTC_T(struct sqltrack) sql_statements;
 
 static hash_t *seen_sql;
 
+/* Binary event log: request threads encode events into their own ring and
+ * the drain thread writes them out, so logging costs the request neither
+ * eventlog_lk nor compression. */
+struct evbuf {
+    uint8_t *buf;
+    size_t len;
+    size_t cap;
+};
+
+#define EVRING_NSEEN 128
+
+/* ring record header flags */
+#define EVR_NEWSQL 0x01  /* fingerprint may not have been logged yet */
+#define EVR_HAS_SQL 0x02 /* ... and its sql text follows */
+
+/* Single producer (the owning thread), single consumer (the drain thread) */
+struct evring {
+    uint8_t *data;
+    uint64_t size; /* power of 2 */
+    uint64_t head; /* advanced by the owner */
+    uint64_t tail; /* advanced by the drain thread */
+    int orphaned;  /* owner exited; free once drained */
+    int64_t ndropped;
+    struct evbuf scratch;
+    /* fingerprints this thread already sent sql text for */
+    int seen_gen[EVRING_NSEEN];
+    char seen[EVRING_NSEEN][FINGERPRINTSZ];
+    LINKC_T(struct evring) lnk;
+};
+
+static LISTC_T(struct evring) evrings;
+static pthread_mutex_t evring_lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t evring_key;
+static __thread struct evring *my_evring;
+static int64_t evring_dropped; /* by rings already freed */
+
+static pthread_mutex_t evdrain_lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t evdrain_cond = PTHREAD_COND_INITIALIZER;
+static int evdrain_started = 0;
+
 static inline void free_gbl_eventlog_fname()
 {
     if (gbl_eventlog_fname == NULL)
@@ -152,6 +202,8 @@ static gzFile eventlog_open(char *fname, int append)
 {
     gbl_eventlog_fname = fname;
     const char *mode = append ? "2a" : "2w";
+    struct stat st;
+    int empty = !append || stat(fname, &st) != 0 || st.st_size == 0;
     gzFile f = gzopen(fname, mode);
     if (f == NULL) {
         logmsg(LOGMSG_ERROR, "Failed to open log file = %s\n", fname);
@@ -160,12 +212,20 @@ static gzFile eventlog_open(char *fname, int append)
         return NULL;
     }
     gbl_eventlog_fname = fname;
+    eventlog_is_binary = gbl_eventlog_binary;
+    if (eventlog_is_binary) {
+        if (empty)
+            gzwrite(f, EVB_MAGIC, EVB_MAGIC_LEN);
+        eventlog_start_drain();
+    }
     return f;
 }
 
 static void eventlog_close(void)
 {
     if (eventlog == NULL) return;
+    if (eventlog_is_binary)
+        eventlog_drain_locked();
     gzclose(eventlog);
     eventlog = NULL;
     bytes_written = 0;
@@ -175,13 +235,18 @@ static void eventlog_close(void)
         free(t);
         t = listc_rtl(&sql_statements);
     }
+    ATOMIC_ADD32(eventlog_gen, 1);
     free_gbl_eventlog_fname();
 }
 
+static void evring_thread_done(void *p);
+
 void eventlog_init()
 {
     seen_sql = hash_init_o(offsetof(struct sqltrack, fingerprint), FINGERPRINTSZ);
     listc_init(&sql_statements, offsetof(struct sqltrack, lnk));
+    listc_init(&evrings, offsetof(struct evring, lnk));
+    Pthread_key_create(&evring_key, evring_thread_done);
     char *fname = eventlog_fname(thedb->envname);
     if (eventlog_enabled) eventlog = eventlog_open(fname, 0);
 }
@@ -466,14 +531,19 @@ static void eventlog_path(cson_object *obj, const struct reqlogger *logger)
     cson_object_set(obj, "path", components);
 }
 
-/* add never seen before "newsql" query, also print it to log */
-static void eventlog_add_newsql(const struct reqlogger *logger)
+static void eventlog_track_sql(const char *fingerprint)
 {
     struct sqltrack *st;
     st = malloc(sizeof(struct sqltrack));
-    memcpy(st->fingerprint, logger->fingerprint, sizeof(logger->fingerprint));
+    memcpy(st->fingerprint, fingerprint, FINGERPRINTSZ);
     hash_add(seen_sql, st);
     listc_abl(&sql_statements, st);
+}
+
+/* add never seen before "newsql" query, also print it to log */
+static void eventlog_add_newsql(const struct reqlogger *logger)
+{
+    eventlog_track_sql(logger->fingerprint);
 
     cson_value *newval;
     cson_object *newobj;
@@ -606,6 +676,491 @@ static inline void add_to_fingerprints(const struct reqlogger *logger)
     }
 }
 
+static uint8_t *evb_reserve(struct evbuf *b, size_t n)
+{
+    if (b->len + n > b->cap) {
+        size_t cap = b->cap ? b->cap : 1024;
+        while (cap < b->len + n)
+            cap *= 2;
+        b->buf = realloc(b->buf, cap);
+        b->cap = cap;
+    }
+    return b->buf + b->len;
+}
+
+static void evb_byte(struct evbuf *b, uint8_t c)
+{
+    *evb_reserve(b, 1) = c;
+    b->len++;
+}
+
+static void evb_raw(struct evbuf *b, const void *p, size_t n)
+{
+    memcpy(evb_reserve(b, n), p, n);
+    b->len += n;
+}
+
+static void evb_varint(struct evbuf *b, uint64_t v)
+{
+    b->len += evb_put_varint(evb_reserve(b, 10), v);
+}
+
+static void evb_item(struct evbuf *b, int type, int key)
+{
+    evb_byte(b, type);
+    if (key != EVB_KEY_NONE)
+        evb_byte(b, key);
+}
+
+static void evb_int(struct evbuf *b, int key, int64_t v)
+{
+    evb_item(b, EVB_INT, key);
+    evb_varint(b, evb_zigzag(v));
+}
+
+static void evb_double(struct evbuf *b, int key, double v)
+{
+    uint64_t u;
+    memcpy(&u, &v, sizeof(u));
+    evb_item(b, EVB_DBL, key);
+    uint8_t *p = evb_reserve(b, 8);
+    for (int i = 0; i < 8; i++)
+        p[i] = u >> (56 - 8 * i);
+    b->len += 8;
+}
+
+static void evb_strn(struct evbuf *b, int key, const char *str, size_t n)
+{
+    evb_item(b, EVB_STR, key);
+    evb_varint(b, n);
+    evb_raw(b, str, n);
+}
+
+static void evb_str(struct evbuf *b, int key, const char *str)
+{
+    evb_strn(b, key, str, strlen(str));
+}
+
+static void evb_json(struct evbuf *b, int key, cson_value *val)
+{
+    cson_buffer out;
+    if (cson_output_buffer(val, &out) != 0)
+        return;
+    evb_item(b, EVB_JSON, key);
+    evb_varint(b, out.used);
+    evb_raw(b, out.mem, out.used);
+}
+
+static void evb_end(struct evbuf *b)
+{
+    evb_byte(b, EVB_END);
+}
+
+static void evb_snap_info_key(struct evbuf *b, snap_uid_t *snap_info)
+{
+    if (!snap_info)
+        return;
+
+    if (gbl_print_cnonce_as_hex) {
+        char cnonce[2 * snap_info->keylen + 1];
+        util_tohex(cnonce, snap_info->key, snap_info->keylen);
+        evb_strn(b, EVB_KEY_CNONCE, cnonce, snap_info->keylen * 2);
+    } else {
+        evb_strn(b, EVB_KEY_CNONCE, snap_info->key, snap_info->keylen);
+    }
+}
+
+static void evb_perfdata(struct evbuf *b, const struct reqlogger *logger)
+{
+    const struct berkdb_thread_stats *thread_stats = bdb_get_thread_stats();
+
+    evb_item(b, EVB_OBJ, EVB_KEY_PERF);
+    evb_int(b, EVB_KEY_TOTTIME, logger->durationus);
+    evb_int(b, EVB_KEY_PROCESSINGTIME,
+            logger->durationus - logger->queuetimeus);
+    if (logger->netwaitus)
+        evb_int(b, EVB_KEY_NETWAITUS, logger->netwaitus);
+    if (logger->queuetimeus)
+        evb_int(b, EVB_KEY_QTIME, logger->queuetimeus);
+    if (thread_stats->n_lock_waits) {
+        evb_int(b, EVB_KEY_LOCKWAITS, thread_stats->n_lock_waits);
+        evb_int(b, EVB_KEY_LOCKWAITTIME, thread_stats->lock_wait_time_us);
+    }
+    if (thread_stats->n_preads) {
+        evb_int(b, EVB_KEY_READS, thread_stats->n_preads);
+        evb_int(b, EVB_KEY_READTIME, thread_stats->pread_time_us);
+    }
+    if (thread_stats->n_pwrites) {
+        evb_int(b, EVB_KEY_WRITES, thread_stats->n_pwrites);
+        evb_int(b, EVB_KEY_WRITETIME, thread_stats->pwrite_time_us);
+    }
+    evb_end(b);
+}
+
+/* binary twin of populate_obj(): same fields, same conditions */
+static void populate_bin(struct evbuf *b, const struct reqlogger *logger)
+{
+    evb_int(b, EVB_KEY_TIME, logger->startus);
+    if (logger->event_type != EV_UNSET)
+        evb_str(b, EVB_KEY_TYPE, ev_str[logger->event_type]);
+
+    if (logger->sql_ref && eventlog_detailed) {
+        evb_strn(b, EVB_KEY_SQL, string_ref_cstr(logger->sql_ref),
+                 string_ref_len(logger->sql_ref));
+        if (logger->bound_param_cson) {
+            /* the json object would have owned it */
+            evb_json(b, EVB_KEY_BOUND_PARAMETERS, logger->bound_param_cson);
+            cson_value_free(logger->bound_param_cson);
+        }
+    }
+
+    snap_uid_t snap, *p = NULL;
+    if (logger->iq && IQ_HAS_SNAPINFO(logger->iq)) /* for txn type */
+        p = IQ_SNAPINFO(logger->iq);
+    else if (logger->clnt && get_cnonce(logger->clnt, &snap) == 0)
+        p = &snap;
+    evb_snap_info_key(b, p);
+
+    if (logger->have_id)
+        evb_str(b, EVB_KEY_ID, logger->id);
+    if (logger->sqlcost)
+        evb_double(b, EVB_KEY_COST, logger->sqlcost);
+    if (logger->sqlrows)
+        evb_int(b, EVB_KEY_ROWS, logger->sqlrows);
+    if (logger->vreplays)
+        evb_int(b, EVB_KEY_REPLAYS, logger->vreplays);
+
+    if (logger->error) {
+        evb_int(b, EVB_KEY_RC, logger->rc);
+        evb_int(b, EVB_KEY_ERROR_CODE, logger->error_code);
+        evb_str(b, EVB_KEY_ERROR, logger->error);
+        if (logger->iq && logger->iq->retries > 0)
+            evb_int(b, EVB_KEY_DEADLOCKRETRIES, logger->iq->retries);
+    }
+
+    evb_str(b, EVB_KEY_HOST, logger->origin);
+
+    if (logger->have_fingerprint) {
+        char expanded_fp[2 * FINGERPRINTSZ + 1];
+        util_tohex(expanded_fp, logger->fingerprint, FINGERPRINTSZ);
+        evb_strn(b, EVB_KEY_FINGERPRINT, expanded_fp, FINGERPRINTSZ * 2);
+    }
+
+    if (logger->clnt) {
+        uint64_t clientstarttime = get_client_starttime(logger->clnt);
+        if (clientstarttime && logger->startus > clientstarttime)
+            evb_int(b, EVB_KEY_STARTLAG, logger->startus - clientstarttime);
+        int clientretries = get_client_retries(logger->clnt);
+        if (clientretries > 0)
+            evb_int(b, EVB_KEY_CLIENTRETRIES, clientretries);
+        evb_int(b, EVB_KEY_CONNID, logger->clnt->connid);
+        evb_int(b, EVB_KEY_PID, logger->clnt->last_pid);
+        if (logger->clnt->argv0)
+            evb_str(b, EVB_KEY_CLIENT, logger->clnt->argv0);
+    }
+
+    if (logger->nwrites > 0)
+        evb_int(b, EVB_KEY_NWRITES, logger->nwrites);
+    if (logger->cascaded_nwrites > 0)
+        evb_int(b, EVB_KEY_CASC_NWRITES, logger->cascaded_nwrites);
+
+    if (logger->ncontext > 0) {
+        evb_item(b, EVB_ARR, EVB_KEY_CONTEXT);
+        for (int i = 0; i < logger->ncontext; i++)
+            evb_str(b, EVB_KEY_NONE, logger->context[i]);
+        evb_end(b);
+    }
+
+    evb_perfdata(b, logger);
+
+    if (logger->ntables > 0) {
+        evb_item(b, EVB_ARR, EVB_KEY_TABLES);
+        for (int i = 0; i < logger->ntables; i++)
+            evb_str(b, EVB_KEY_NONE, logger->sqltables[i]);
+        evb_end(b);
+    }
+
+    if (logger->path && logger->path->n_components > 0) {
+        evb_item(b, EVB_ARR, EVB_KEY_PATH);
+        for (int i = 0; i < logger->path->n_components; i++) {
+            struct client_query_path_component *c;
+            c = &logger->path->path_stats[i];
+            evb_item(b, EVB_OBJ, EVB_KEY_NONE);
+            if (c->table[0])
+                evb_str(b, EVB_KEY_TABLE, c->table);
+            if (c->ix != -1)
+                evb_int(b, EVB_KEY_INDEX, c->ix);
+            if (c->nfind)
+                evb_int(b, EVB_KEY_FIND, c->nfind);
+            if (c->nnext)
+                evb_int(b, EVB_KEY_NEXT, c->nnext);
+            if (c->nwrite)
+                evb_int(b, EVB_KEY_WRITE, c->nwrite);
+            evb_end(b);
+        }
+        evb_end(b);
+    }
+}
+
+static void evring_thread_done(void *p)
+{
+    struct evring *r = p;
+    XCHANGE32(r->orphaned, 1);
+}
+
+static struct evring *evring_get(void)
+{
+    struct evring *r = my_evring;
+    if (r)
+        return r;
+
+    uint64_t size = 4096;
+    while (size < gbl_eventlog_ring_kb * 1024ULL)
+        size <<= 1;
+    r = calloc(1, sizeof(struct evring));
+    if (r == NULL)
+        return NULL;
+    r->data = malloc(size);
+    if (r->data == NULL) {
+        free(r);
+        return NULL;
+    }
+    r->size = size;
+
+    Pthread_mutex_lock(&evring_lk);
+    listc_abl(&evrings, r);
+    Pthread_mutex_unlock(&evring_lk);
+    Pthread_setspecific(evring_key, r);
+    my_evring = r;
+    return r;
+}
+
+/* start a ring record in the thread's scratch buffer */
+static struct evbuf *evring_begin(struct evring *r, uint8_t flags)
+{
+    r->scratch.len = 0;
+    evb_byte(&r->scratch, flags);
+    return &r->scratch;
+}
+
+/* has this thread not sent the sql for this fingerprint to the current
+ * file yet?  Hashing into a small table keeps this lock free; a collision
+ * only costs sending the sql text again. */
+static int evring_first_sight(struct evring *r, const char *fingerprint)
+{
+    int gen = ATOMIC_LOAD32(eventlog_gen);
+    int i = (uint8_t)fingerprint[0] % EVRING_NSEEN;
+    if (r->seen_gen[i] == gen &&
+        memcmp(r->seen[i], fingerprint, FINGERPRINTSZ) == 0)
+        return 0;
+    r->seen_gen[i] = gen;
+    memcpy(r->seen[i], fingerprint, FINGERPRINTSZ);
+    return 1;
+}
+
+static void evring_copy_in(struct evring *r, uint64_t pos, const void *src,
+                           size_t n)
+{
+    size_t off = pos & (r->size - 1);
+    size_t first = min(n, r->size - off);
+    memcpy(r->data + off, src, first);
+    memcpy(r->data, (const uint8_t *)src + first, n - first);
+}
+
+static void evring_copy_out(struct evring *r, uint64_t pos, void *dst,
+                            size_t n)
+{
+    size_t off = pos & (r->size - 1);
+    size_t first = min(n, r->size - off);
+    memcpy(dst, r->data + off, first);
+    memcpy((uint8_t *)dst + first, r->data, n - first);
+}
+
+/* append the scratch record; drop it if the ring is full */
+static void evring_push(struct evring *r)
+{
+    uint32_t len = r->scratch.len;
+    uint64_t need = sizeof(len) + len;
+    uint64_t head = r->head;
+    uint64_t used = head - ATOMIC_LOAD64(r->tail);
+
+    if (need > r->size - used) {
+        ATOMIC_ADD64(r->ndropped, 1);
+        return;
+    }
+    evring_copy_in(r, head, &len, sizeof(len));
+    evring_copy_in(r, head + sizeof(len), r->scratch.buf, len);
+    XCHANGE64(r->head, head + need);
+
+    /* don't wait for the next tick once we're half full */
+    if (used < r->size / 2 && used + need >= r->size / 2)
+        Pthread_cond_signal(&evdrain_cond);
+}
+
+static int write_bin(const void *src, size_t n)
+{
+    uint8_t hdr[10];
+    int nhdr = evb_put_varint(hdr, n);
+    int rc = gzwrite(eventlog, hdr, nhdr);
+    bytes_written += rc;
+    if (rc != nhdr)
+        return 1;
+    rc = gzwrite(eventlog, src, n);
+    bytes_written += rc;
+    return rc != n;
+}
+
+/* write one ring record to the log, preceded by a "newsql" event if this
+ * file hasn't seen its fingerprint yet */
+static void eventlog_write_record(const uint8_t *p, size_t len)
+{
+    static struct evbuf newsql; /* under eventlog_lk */
+    const uint8_t *end = p + len;
+    uint8_t flags = *p++;
+
+    if (flags & EVR_NEWSQL) {
+        char fingerprint[FINGERPRINTSZ];
+        int64_t time;
+        uint32_t sqllen = 0;
+        const char *sql;
+
+        memcpy(&time, p, sizeof(time));
+        p += sizeof(time);
+        memcpy(fingerprint, p, FINGERPRINTSZ);
+        p += FINGERPRINTSZ;
+        if (flags & EVR_HAS_SQL) {
+            memcpy(&sqllen, p, sizeof(sqllen));
+            p += sizeof(sqllen);
+        }
+        sql = (const char *)p;
+        p += sqllen;
+
+        if (!hash_find(seen_sql, fingerprint)) {
+            char expanded_fp[2 * FINGERPRINTSZ + 1];
+
+            eventlog_track_sql(fingerprint);
+            newsql.len = 0;
+            evb_int(&newsql, EVB_KEY_TIME, time);
+            evb_str(&newsql, EVB_KEY_TYPE, "newsql");
+            if (flags & EVR_HAS_SQL)
+                evb_strn(&newsql, EVB_KEY_SQL, sql, sqllen);
+            util_tohex(expanded_fp, fingerprint, FINGERPRINTSZ);
+            evb_strn(&newsql, EVB_KEY_FINGERPRINT, expanded_fp,
+                     FINGERPRINTSZ * 2);
+            evb_end(&newsql);
+            write_bin(newsql.buf, newsql.len);
+        }
+    }
+    write_bin(p, end - p);
+}
+
+/* move everything queued in the rings to the log (or drop it if the log
+ * is no longer binary), freeing rings of threads that have exited.
+ * This function must be called while holding eventlog_lk */
+static void eventlog_drain_locked(void)
+{
+    static struct evbuf rec; /* under eventlog_lk */
+    int writing = eventlog != NULL && eventlog_is_binary;
+    struct evring *r, *tmp;
+
+    Pthread_mutex_lock(&evring_lk);
+    LISTC_FOR_EACH_SAFE(&evrings, r, tmp, lnk)
+    {
+        uint64_t head = ATOMIC_LOAD64(r->head);
+        uint64_t tail = r->tail;
+        while (tail != head) {
+            uint32_t len;
+            evring_copy_out(r, tail, &len, sizeof(len));
+            if (writing) {
+                evring_copy_out(r, tail + sizeof(len), evb_reserve(&rec, len),
+                                len);
+                eventlog_write_record(rec.buf, len);
+            }
+            tail += sizeof(len) + len;
+        }
+        XCHANGE64(r->tail, tail);
+
+        if (ATOMIC_LOAD32(r->orphaned) && ATOMIC_LOAD64(r->head) == tail) {
+            listc_rfl(&evrings, r);
+            evring_dropped += r->ndropped;
+            free(r->scratch.buf);
+            free(r->data);
+            free(r);
+        }
+    }
+    Pthread_mutex_unlock(&evring_lk);
+}
+
+static void *eventlog_drain_thd(void *unused)
+{
+    thread_started("eventlog drain");
+
+    while (!db_is_exiting()) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 10 * 1000000;
+        if (ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        Pthread_mutex_lock(&evdrain_lk);
+        pthread_cond_timedwait(&evdrain_cond, &evdrain_lk, &ts);
+        Pthread_mutex_unlock(&evdrain_lk);
+
+        int call_roll_cleanup = 0;
+        Pthread_mutex_lock(&eventlog_lk);
+        eventlog_drain_locked();
+        if (eventlog != NULL && eventlog_is_binary && eventlog_rollat > 0 &&
+            bytes_written > eventlog_rollat) {
+            eventlog_roll();
+            call_roll_cleanup = 1;
+        }
+        Pthread_mutex_unlock(&eventlog_lk);
+
+        if (call_roll_cleanup)
+            eventlog_roll_cleanup();
+    }
+    return NULL;
+}
+
+// this function must be called while holding eventlog_lk
+static void eventlog_start_drain(void)
+{
+    pthread_t tid;
+    if (evdrain_started)
+        return;
+    Pthread_create(&tid, &gbl_pthread_attr_detached, eventlog_drain_thd, NULL);
+    evdrain_started = 1;
+}
+
+static void eventlog_add_bin(const struct reqlogger *logger)
+{
+    struct evring *r = evring_get();
+    struct evbuf *b;
+    int isSqlErr = logger->error && logger->sql_ref;
+
+    if (r == NULL)
+        return;
+
+    if ((EV_SQL == logger->event_type || isSqlErr) &&
+        evring_first_sight(r, logger->fingerprint)) {
+        int64_t time = logger->startus;
+        b = evring_begin(r, EVR_NEWSQL | (logger->sql_ref ? EVR_HAS_SQL : 0));
+        evb_raw(b, &time, sizeof(time));
+        evb_raw(b, logger->fingerprint, FINGERPRINTSZ);
+        if (logger->sql_ref) {
+            uint32_t sqllen = string_ref_len(logger->sql_ref);
+            evb_raw(b, &sqllen, sizeof(sqllen));
+            evb_raw(b, string_ref_cstr(logger->sql_ref), sqllen);
+        }
+    } else {
+        b = evring_begin(r, 0);
+    }
+    populate_bin(b, logger);
+    evb_end(b);
+    evring_push(r);
+}
+
 void eventlog_add(const struct reqlogger *logger)
 {
     if (eventlog == NULL || !eventlog_enabled ||
@@ -618,6 +1173,11 @@ void eventlog_add(const struct reqlogger *logger)
         return;
     }
 
+    if (eventlog_is_binary) {
+        eventlog_add_bin(logger);
+        return;
+    }
+
     cson_value *val = cson_value_new_object();
     cson_object *obj = cson_value_get_object(val);
     populate_obj(obj, logger);
@@ -651,6 +1211,23 @@ void eventlog_status(void)
         logmsg(LOGMSG_USER, "Eventlog enabled, file:%s\n", gbl_eventlog_fname);
     else
         logmsg(LOGMSG_USER, "Eventlog disabled\n");
+
+    if (eventlog_is_binary) {
+        struct evring *r;
+        int nrings = 0;
+        int64_t ndropped = evring_dropped;
+        Pthread_mutex_lock(&evring_lk);
+        LISTC_FOR_EACH(&evrings, r, lnk)
+        {
+            nrings++;
+            ndropped += ATOMIC_LOAD64(r->ndropped);
+        }
+        Pthread_mutex_unlock(&evring_lk);
+        logmsg(LOGMSG_USER,
+               "Eventlog format binary, %d thread rings of %d KB, %" PRId64
+               " events dropped\n",
+               nrings, gbl_eventlog_ring_kb, ndropped);
+    }
 }
 
 // roll the log: close existing file open a new one
@@ -686,6 +1263,30 @@ static void eventlog_disable(void)
     eventlog_enabled = 0;
 }
 
+// this function must be called while holding eventlog_lk
+static void eventlog_set_binary_locked(int on, int *call_roll_cleanup)
+{
+    gbl_eventlog_binary = on;
+    if (eventlog != NULL && eventlog_is_binary != on) {
+        /* the format is per file */
+        eventlog_roll();
+        *call_roll_cleanup = 1;
+    }
+}
+
+int eventlog_set_binary(int on)
+{
+    int call_roll_cleanup = 0;
+    Pthread_mutex_lock(&eventlog_lk);
+    eventlog_set_binary_locked(on, &call_roll_cleanup);
+    Pthread_mutex_unlock(&eventlog_lk);
+
+    if (call_roll_cleanup) {
+        eventlog_roll_cleanup();
+    }
+    return 0;
+}
+
 void eventlog_stop(void)
 {
     Pthread_mutex_lock(&eventlog_lk);
@@ -709,6 +1310,8 @@ static void eventlog_help(void)
                         "events rollat N          - roll when log file size larger than N MB\n"
                         "events every N           - log only every Nth event, 0 logs all\n"
                         "events verbose on/off    - turn on/off verbose mode\n"
+                        "events binary <on|off>   - write compact binary events from a\n"
+                        "                           background thread (see cdb2_sqlreplay --tojson)\n"
                         "events dir <dir>         - set custom directory for event log files\n"
                         "events file <file>       - set log file to custom location\n"
                         "events flush             - flush log\n"
@@ -822,7 +1425,18 @@ static void eventlog_process_message_locked(char *line, int lline, int *toff, in
         } else {
             logmsg(LOGMSG_ERROR, "Expected on/off for 'verbose'\n");
         }
+    } else if (tokcmp(tok, ltok, "binary") == 0) {
+        tok = segtok(line, lline, toff, &ltok);
+        if (tokcmp(tok, ltok, "on") == 0) {
+            eventlog_set_binary_locked(1, call_roll_cleanup);
+        } else if (tokcmp(tok, ltok, "off") == 0) {
+            eventlog_set_binary_locked(0, call_roll_cleanup);
+        } else {
+            logmsg(LOGMSG_ERROR, "Expected on/off for 'binary'\n");
+        }
     } else if (tokcmp(tok, ltok, "flush") == 0) {
+        if (eventlog && eventlog_is_binary)
+            eventlog_drain_locked();
         if (eventlog)
             gzflush(eventlog, 1);
     } else if (tokcmp(tok, ltok, "file") == 0) {
@@ -875,6 +1489,25 @@ void eventlog_debug(char *fmt, ...) {
     if (!(eventlog_enabled && eventlog != NULL && eventlog_debug_events))
         return;
 
+    if (eventlog_is_binary) {
+        struct evring *r = evring_get();
+        if (r == NULL)
+            return;
+        va_start(args, fmt);
+        int rc = vasprintf(&s, fmt, args);
+        va_end(args);
+        if (rc < 0 || s == NULL)
+            return;
+        struct evbuf *b = evring_begin(r, 0);
+        evb_str(b, EVB_KEY_TYPE, "debug");
+        evb_int(b, EVB_KEY_TIME, comdb2_time_epochus());
+        evb_str(b, EVB_KEY_DEBUG, s);
+        evb_end(b);
+        os_free(s);
+        evring_push(r);
+        return;
+    }
+
     cson_value *vobj = cson_value_new_object();
     cson_object *obj = cson_value_get_object(vobj);
 
@@ -899,12 +1532,48 @@ int eventlog_debug_enabled(void) {
     return eventlog_debug_events;
 }
 
+static void eventlog_deadlock_cycle_bin(locker_info *idmap, u_int32_t *deadmap,
+                                        u_int32_t nlockers, u_int32_t victim)
+{
+    extern char *gbl_myhostname;
+    struct evring *r = evring_get();
+    if (r == NULL)
+        return;
+
+    struct evbuf *b = evring_begin(r, 0);
+    evb_int(b, EVB_KEY_TIME, comdb2_time_epochus());
+    evb_str(b, EVB_KEY_HOST, gbl_myhostname);
+    evb_item(b, EVB_ARR, EVB_KEY_DEADLOCK_CYCLE);
+    for (int j = 0; j < nlockers; j++) {
+        if (!ISSET_MAP(deadmap, j))
+            continue;
+        char hex[11];
+        evb_item(b, EVB_OBJ, EVB_KEY_NONE);
+        evb_snap_info_key(b, idmap[j].snap_info);
+        sprintf(hex, "0x%x", idmap[j].id);
+        evb_str(b, EVB_KEY_LID, hex);
+        evb_int(b, EVB_KEY_LCOUNT, idmap[j].lcount);
+        if (j == victim) {
+            evb_item(b, EVB_BOOL, EVB_KEY_VICTIM);
+            evb_byte(b, 1);
+        }
+        evb_end(b);
+    }
+    evb_end(b);
+    evb_end(b);
+    evring_push(r);
+}
+
 void eventlog_deadlock_cycle(locker_info *idmap, u_int32_t *deadmap,
                              u_int32_t nlockers, u_int32_t victim)
 {
     if (!eventlog_enabled || eventlog == NULL) {
         return;
     }
+    if (eventlog_is_binary) {
+        eventlog_deadlock_cycle_bin(idmap, deadmap, nlockers, victim);
+        return;
+    }
     cson_value *dd_list = cson_value_new_array();
     cson_array *arr = cson_value_get_array(dd_list);
     for (int j = 0; j < nlockers; j++) {
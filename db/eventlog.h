@@ -20,6 +20,7 @@ void eventlog_init();
 void eventlog_status(void);
 void eventlog_add(const struct reqlogger *logger);
 void eventlog_stop(void);
+int eventlog_set_binary(int on);
 void eventlog_process_message(char *line, int llen, int *toff);
 void eventlog_debug(char *fmt, ...);
 
@@ -223,6 +223,10 @@ struct fdb_cursor {
     uuid_t tiduuid; /* UUID/fastseed storage for transaction, if any, or 0 */
     char *node;     /* connected to where? */
     int need_ssl;   /* uses ssl */
+
+    fdb_rowcache_ent_t *rc_ent;  /* cached result set served, if any */
+    int rc_pos;                  /* current row in rc_ent */
+    fdb_rowcache_ent_t *rc_fill; /* result set captured while streaming */
 };
 
 typedef struct fdb_systable_info {
@@ -278,6 +282,7 @@ static void fdb_cursor_get_found_data_cdb2api(BtCursor *pCur,
                                               unsigned long long *genid,
                                               int *datalen, char **data);
 static int fdb_cursor_move_sql_cdb2api(BtCursor *pCur, int how);
+static void _fdb_cursor_rowcache_reset(fdb_cursor_t *fdbc);
 static int fdb_cursor_find_sql_cdb2api(BtCursor *pCur, Mem *key, int nfields,
                                        int bias);
 
@@ -1125,6 +1130,10 @@ run:
         (rc == IX_EMPTY /* && *found_ent -- capture also missing table */))
         rc = FDB_NOERR;
 
+    /* drop cached rows of older versions of this table */
+    if (rc == FDB_NOERR && versioned && !is_sqlite_master)
+        fdb_rowcache_invalidate(fdb->dbname, tbl->name, tbl->version);
+
 close:
     irc = fdb_cursor_close(cur);
     if (irc) {
@@ -2789,6 +2798,8 @@ static void fdb_cursor_close_on_open(BtCursor *pCur, int cache)
     if (pCur->fdbc) {
         fdb_cursor_t *fdbc = pCur->fdbc->impl;
 
+        _fdb_cursor_rowcache_reset(fdbc);
+
         Pthread_rwlock_wrlock(&fdbs.h_curs_lock);
         hash_del(fdbs.h_curs, fdbc);
         Pthread_rwlock_unlock(&fdbs.h_curs_lock);
@@ -3259,6 +3270,9 @@ static void _fdb_handle_sqlite_schema_err(fdb_cursor_t *fdbc, char *errstr)
        values if the remote table is schema changed repeatedly
        */
     fdbc->ent->tbl->need_version = remote_version + 1;
+
+    fdb_rowcache_invalidate(fdbc->ent->tbl->fdb->dbname, fdbc->ent->tbl->name,
+                            0);
 }
 
 static int _fdb_handle_io_read_error(BtCursor *pCur, int *retry, int *pollms,
@@ -4578,6 +4592,9 @@ static int __free_fdb_tbl(void *obj, void *arg)
         fdb_sqlstat_cache_destroy(&fdb->sqlstats);
     }
 
+    /* cached rows for this table are stale too */
+    fdb_rowcache_invalidate(fdb->dbname, tbl->name, 0);
+
     /* free each entry for table */
     LISTC_FOR_EACH_SAFE(&tbl->ents, ent, tmp, lnk)
     {
@@ -5491,10 +5508,25 @@ void fdb_systable_info_free(void *data, int npoints)
     free(ient);
 }
 
+/* current row, either from the cdb2api handle or from the row cache */
+static void _fdb_cursor_row_cdb2api(BtCursor *pCur, char **value, int *len)
+{
+    fdb_cursor_t *fdbc = pCur->fdbc->impl;
+
+    if (fdbc->rc_ent) {
+        fdb_rowcache_row(fdbc->rc_ent, fdbc->rc_pos, value, len);
+        return;
+    }
+    if (value)
+        *value = cdb2_column_value(fdbc->fcon.api.hndl, 0);
+    if (len)
+        *len = cdb2_column_size(fdbc->fcon.api.hndl, 0);
+}
+
 #define CHECK_ROW_LEN(ret) \
     do { \
-    cdb2_hndl_tp *hndl = pCur->fdbc->impl->fcon.api.hndl; \
-    int len = cdb2_column_size(hndl, 0); \
+    int len; \
+    _fdb_cursor_row_cdb2api(pCur, NULL, &len); \
     if (len <= sizeof(unsigned long long)) { \
         logmsg(LOGMSG_ERROR, "%s: BUG, row length is too small %d\n", \
                __func__, len); \
@@ -5538,9 +5570,10 @@ static void fdb_cursor_get_found_data_cdb2api(BtCursor *pCur,
                                               unsigned long long *genid,
                                               int *datalen, char **data)
 {
-    cdb2_hndl_tp *hndl = pCur->fdbc->impl->fcon.api.hndl;
-    char *value = cdb2_column_value(hndl, 0);
-    int len = cdb2_column_size(hndl, 0);
+    char *value;
+    int len;
+
+    _fdb_cursor_row_cdb2api(pCur, &value, &len);
     if (len <= sizeof(unsigned long long)) {
         logmsg(LOGMSG_ERROR, "%s: BUG, row length is too small %d\n",
                __func__, len);
@@ -5777,6 +5810,116 @@ done:
     return rc;
 }
 
+/* release any row cache state of a cursor */
+static void _fdb_cursor_rowcache_reset(fdb_cursor_t *fdbc)
+{
+    if (fdbc->rc_ent) {
+        fdb_rowcache_put(fdbc->rc_ent);
+        fdbc->rc_ent = NULL;
+    }
+    if (fdbc->rc_fill) {
+        fdb_rowcache_fill_abort(fdbc->rc_fill);
+        fdbc->rc_fill = NULL;
+    }
+}
+
+/* can the result sets of this cursor be shared with other sql threads */
+static int _fdb_cursor_rowcache_allowed(BtCursor *pCur)
+{
+    fdb_cursor_t *fdbc = pCur->fdbc->impl;
+    extern void *(*externalComdb2getAuthIdBlob)(void *ID);
+
+    if (!fdb_rowcache_enabled())
+        return 0;
+
+    /* skip schema and stats reads, and cursors part of a remote transaction,
+       which might see their own uncommitted writes */
+    if (!fdbc->ent || fdbc->is_schema || fdbc->trans || !pCur->clnt ||
+        is_sqlite_stat(fdbc->ent->tbl->name))
+        return 0;
+
+    /* remote checks access for each identity */
+    if (gbl_fdb_auth_enabled && externalComdb2getAuthIdBlob &&
+        get_authdata(pCur->clnt))
+        return 0;
+
+    return 1;
+}
+
+/**
+ * Check the row cache for the result set of "sql"; on a hit, the cursor
+ * serves rows from the cache and "sql" is consumed.  On a miss, the cursor
+ * starts capturing the result set as it is streamed from remote.
+ * Returns 1 on a hit
+ *
+ */
+static int _fdb_cursor_rowcache_lookup(BtCursor *pCur, char *sql)
+{
+    fdb_cursor_t *fdbc = pCur->fdbc->impl;
+    sqlclntstate *clnt = pCur->clnt;
+    fdb_tbl_t *tbl;
+    char *key;
+
+    _fdb_cursor_rowcache_reset(fdbc);
+
+    if (!_fdb_cursor_rowcache_allowed(pCur))
+        return 0;
+
+    /* session settings that change the returned rows are part of the key */
+    key = sqlite3_mprintf("%s.%d.%s", clnt->tzname, clnt->dtprec, sql);
+    if (!key)
+        return 0;
+
+    tbl = fdbc->ent->tbl;
+    fdbc->rc_ent =
+        fdb_rowcache_get(tbl->fdb->dbname, tbl->name, tbl->version, key);
+    if (fdbc->rc_ent) {
+        fdbc->rc_pos = 0;
+        if (fdbc->sql_hint != sql)
+            sqlite3_free(sql);
+    } else {
+        fdbc->rc_fill = fdb_rowcache_fill_start(tbl->fdb->dbname, tbl->name,
+                                                tbl->version, key);
+    }
+    sqlite3_free(key);
+
+    return fdbc->rc_ent != NULL;
+}
+
+/* position a cursor served from the row cache */
+static int _fdb_cursor_rowcache_move(fdb_cursor_t *fdbc, int next)
+{
+    if (next)
+        fdbc->rc_pos++;
+    return (fdbc->rc_pos < fdb_rowcache_nrows(fdbc->rc_ent)) ? IX_FNDMORE
+                                                              : IX_EMPTY;
+}
+
+/* capture the row just read from remote, and publish at end of stream */
+static void _fdb_cursor_rowcache_capture(BtCursor *pCur, int rc)
+{
+    fdb_cursor_t *fdbc = pCur->fdbc->impl;
+    cdb2_hndl_tp *hndl = fdbc->fcon.api.hndl;
+
+    if (!fdbc->rc_fill)
+        return;
+
+    if (rc == IX_FNDMORE) {
+        if (fdb_rowcache_fill_add(fdbc->rc_fill, cdb2_column_value(hndl, 0),
+                                  cdb2_column_size(hndl, 0))) {
+            /* result set too large to cache */
+            fdb_rowcache_fill_abort(fdbc->rc_fill);
+            fdbc->rc_fill = NULL;
+        }
+    } else if (rc == IX_EMPTY) {
+        fdb_rowcache_fill_done(fdbc->rc_fill);
+        fdbc->rc_fill = NULL;
+    } else {
+        fdb_rowcache_fill_abort(fdbc->rc_fill);
+        fdbc->rc_fill = NULL;
+    }
+}
+
 static int fdb_cursor_move_sql_cdb2api(BtCursor *pCur, int how)
 {
     fdb_cursor_t *fdbc = pCur->fdbc->impl;
@@ -5798,6 +5941,9 @@ version_retry:
         if (rc)
             return rc;
 
+        if (_fdb_cursor_rowcache_lookup(pCur, sql))
+            return _fdb_cursor_rowcache_move(fdbc, 0);
+
         rc = _fdb_run_sql(pCur, sql);
         if (rc  == FDB_ERR_FDB_VERSION) {
             /* might move cursor to different backend */
@@ -5810,8 +5956,12 @@ version_retry:
                 return fdb_cursor_move_sql(pCur, how);
             }
             /* just an older cdb2api version, gonna run same backend */
+            fdbc = pCur->fdbc->impl;
+            hndl = fdbc->fcon.api.hndl;
             goto version_retry;
         }
+    } else if (fdbc->rc_ent) {
+        return _fdb_cursor_rowcache_move(fdbc, 1);
     }
 
     if (!rc) {
@@ -5823,6 +5973,7 @@ version_retry:
             rc = IX_EMPTY;
         }
     }
+    _fdb_cursor_rowcache_capture(pCur, rc);
 
     return rc;
 }
@@ -5851,6 +6002,9 @@ version_retry:
     if (rc)
         return rc;
 
+    if (_fdb_cursor_rowcache_lookup(pCur, sql))
+        return _fdb_cursor_rowcache_move(fdbc, 0);
+
     rc = _fdb_run_sql(pCur, sql);
     if (rc == FDB_ERR_FDB_VERSION) {
         /* might move cursor to different backend */
@@ -5864,6 +6018,8 @@ version_retry:
         }
 
         /* just an older cdb2api version, gonna run same backend */
+        fdbc = pCur->fdbc->impl;
+        hndl = fdbc->fcon.api.hndl;
         goto version_retry;
     }
 
@@ -5876,6 +6032,7 @@ version_retry:
             rc = IX_EMPTY;
         }
     }
+    _fdb_cursor_rowcache_capture(pCur, rc);
 
     return rc;
 }
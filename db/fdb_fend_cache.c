@@ -15,15 +15,24 @@
  */
 
 #include <stdio.h>
+#include <alloca.h>
 #include <pthread.h>
 
 #include <comdb2.h>
 #include <sql.h>
 #include <bdb_api.h>
 #include <util.h>
+#include <list.h>
+#include <plhash_glue.h>
+#include <epochlib.h>
 
 #include "fdb_fend.h"
 #include "fdb_fend_cache.h"
+#include "fdb_systable.h"
+
+int gbl_fdb_rowcache_size_kb = 0;
+int gbl_fdb_rowcache_max_entry_kb = 256;
+int gbl_fdb_rowcache_ttl_ms = 10000;
 
 /**
  * Cache implemented as a decorator pattern
@@ -676,3 +685,446 @@ static int fdb_sqlstat_cursor_update(BtCursor *pCur, struct sqlclntstate *clnt,
 {
     abort();
 }
+
+/**
+ * Shared remote row cache
+ *
+ */
+
+struct fdb_rowcache_row {
+    int len;
+    char *data;
+};
+
+/* per remote table statistics; created on first access, freed when the
+   cache is flushed */
+struct fdb_rowcache_tbl {
+    char *key; /* "dbname.tblname" */
+    char *dbname;
+    char *tblname;
+    unsigned long long version; /* version of the last cached result set */
+
+    int nents;
+    int64_t nrows;
+    int64_t bytes;
+    int64_t hits;
+    int64_t misses;
+    int64_t evictions;
+    int64_t invalidations;
+
+    LISTC_T(struct fdb_rowcache_ent) ents;
+};
+
+struct fdb_rowcache_ent {
+    char *key; /* "dbname.tblname.version.sql" */
+    char *dbname;
+    char *tblname;
+    struct fdb_rowcache_tbl *tbl;
+    unsigned long long version;
+
+    int nrows;
+    int nalloc;
+    struct fdb_rowcache_row *rows;
+    int64_t bytes;
+
+    int created_ms;
+    int users;  /* references; the cache holds one while the entry is linked */
+    int linked; /* entry is in the hash and lru */
+
+    LINKC_T(struct fdb_rowcache_ent) lru_lnk;
+    LINKC_T(struct fdb_rowcache_ent) tbl_lnk;
+};
+
+static struct {
+    pthread_mutex_t mtx;
+    hash_t *h_ents;
+    hash_t *h_tbls;
+    LISTC_T(struct fdb_rowcache_ent) lru; /* top is most recently used */
+    int64_t bytes;
+} rowcache = {.mtx = PTHREAD_MUTEX_INITIALIZER};
+
+/* call under rowcache.mtx */
+static void _rowcache_init(void)
+{
+    if (rowcache.h_ents)
+        return;
+
+    rowcache.h_ents = hash_init_strptr(offsetof(struct fdb_rowcache_ent, key));
+    rowcache.h_tbls = hash_init_strptr(offsetof(struct fdb_rowcache_tbl, key));
+    listc_init(&rowcache.lru, offsetof(struct fdb_rowcache_ent, lru_lnk));
+}
+
+static char *_rowcache_key(const char *dbname, const char *tblname,
+                           unsigned long long version, const char *sql)
+{
+    int len = strlen(dbname) + strlen(tblname) + strlen(sql) + 32;
+    char *key = malloc(len);
+    if (key)
+        snprintf(key, len, "%s.%s.%llu.%s", dbname, tblname, version, sql);
+    return key;
+}
+
+/* call under rowcache.mtx */
+static struct fdb_rowcache_tbl *_rowcache_tbl(const char *dbname,
+                                              const char *tblname, int create)
+{
+    struct fdb_rowcache_tbl *tbl;
+    int len = strlen(dbname) + strlen(tblname) + 2;
+    char *key = alloca(len);
+
+    /* key on the full name, so that no two tables can share an entry */
+    snprintf(key, len, "%s.%s", dbname, tblname);
+    char *pkey = key;
+    tbl = hash_find_readonly(rowcache.h_tbls, &pkey);
+    if (tbl || !create)
+        return tbl;
+
+    tbl = calloc(1, sizeof(*tbl));
+    if (!tbl)
+        return NULL;
+    tbl->key = strdup(key);
+    tbl->dbname = strdup(dbname);
+    tbl->tblname = strdup(tblname);
+    listc_init(&tbl->ents, offsetof(struct fdb_rowcache_ent, tbl_lnk));
+    hash_add(rowcache.h_tbls, tbl);
+
+    return tbl;
+}
+
+static void _rowcache_ent_free(struct fdb_rowcache_ent *ent)
+{
+    int i;
+
+    for (i = 0; i < ent->nrows; i++)
+        free(ent->rows[i].data);
+    free(ent->rows);
+    free(ent->key);
+    free(ent->dbname);
+    free(ent->tblname);
+    free(ent);
+}
+
+/* call under rowcache.mtx */
+static void _rowcache_ent_unref(struct fdb_rowcache_ent *ent)
+{
+    assert(ent->users > 0);
+    if (--ent->users == 0)
+        _rowcache_ent_free(ent);
+}
+
+/* call under rowcache.mtx */
+static void _rowcache_ent_unlink(struct fdb_rowcache_ent *ent, int invalidate)
+{
+    struct fdb_rowcache_tbl *tbl = ent->tbl;
+
+    assert(ent->linked);
+
+    hash_del(rowcache.h_ents, ent);
+    listc_rfl(&rowcache.lru, ent);
+    listc_rfl(&tbl->ents, ent);
+    ent->linked = 0;
+
+    rowcache.bytes -= ent->bytes;
+    tbl->nents--;
+    tbl->nrows -= ent->nrows;
+    tbl->bytes -= ent->bytes;
+    if (invalidate)
+        tbl->invalidations++;
+    else
+        tbl->evictions++;
+
+    _rowcache_ent_unref(ent);
+}
+
+int fdb_rowcache_enabled(void)
+{
+    return gbl_fdb_rowcache_size_kb > 0;
+}
+
+fdb_rowcache_ent_t *fdb_rowcache_get(const char *dbname, const char *tblname,
+                                     unsigned long long version,
+                                     const char *sql)
+{
+    struct fdb_rowcache_ent *ent;
+    struct fdb_rowcache_tbl *tbl;
+    char *key;
+
+    key = _rowcache_key(dbname, tblname, version, sql);
+    if (!key)
+        return NULL;
+
+    Pthread_mutex_lock(&rowcache.mtx);
+    _rowcache_init();
+
+    ent = hash_find_readonly(rowcache.h_ents, &key);
+    if (ent && (comdb2_time_epochms() - ent->created_ms) >
+                   gbl_fdb_rowcache_ttl_ms) {
+        /* remote data might have changed since; refetch */
+        _rowcache_ent_unlink(ent, 0);
+        ent = NULL;
+    }
+
+    if (ent) {
+        ent->users++;
+        listc_rfl(&rowcache.lru, ent);
+        listc_atl(&rowcache.lru, ent);
+        ent->tbl->hits++;
+    } else {
+        tbl = _rowcache_tbl(dbname, tblname, 1);
+        if (tbl)
+            tbl->misses++;
+    }
+
+    Pthread_mutex_unlock(&rowcache.mtx);
+
+    free(key);
+    return ent;
+}
+
+void fdb_rowcache_put(fdb_rowcache_ent_t *ent)
+{
+    Pthread_mutex_lock(&rowcache.mtx);
+    _rowcache_ent_unref(ent);
+    Pthread_mutex_unlock(&rowcache.mtx);
+}
+
+int fdb_rowcache_nrows(fdb_rowcache_ent_t *ent)
+{
+    return ent->nrows;
+}
+
+void fdb_rowcache_row(fdb_rowcache_ent_t *ent, int idx, char **data,
+                      int *datalen)
+{
+    assert(idx >= 0 && idx < ent->nrows);
+    if (data)
+        *data = ent->rows[idx].data;
+    if (datalen)
+        *datalen = ent->rows[idx].len;
+}
+
+fdb_rowcache_ent_t *fdb_rowcache_fill_start(const char *dbname,
+                                            const char *tblname,
+                                            unsigned long long version,
+                                            const char *sql)
+{
+    struct fdb_rowcache_ent *ent;
+
+    ent = calloc(1, sizeof(*ent));
+    if (!ent)
+        return NULL;
+
+    ent->key = _rowcache_key(dbname, tblname, version, sql);
+    ent->dbname = strdup(dbname);
+    ent->tblname = strdup(tblname);
+    if (!ent->key || !ent->dbname || !ent->tblname) {
+        _rowcache_ent_free(ent);
+        return NULL;
+    }
+    ent->version = version;
+    ent->users = 1;
+
+    return ent;
+}
+
+int fdb_rowcache_fill_add(fdb_rowcache_ent_t *ent, const char *data,
+                          int datalen)
+{
+    struct fdb_rowcache_row *row;
+
+    if (ent->bytes + datalen > (int64_t)gbl_fdb_rowcache_max_entry_kb * 1024)
+        return -1;
+
+    if (ent->nrows == ent->nalloc) {
+        int nalloc = ent->nalloc ? ent->nalloc * 2 : 16;
+        row = realloc(ent->rows, nalloc * sizeof(*row));
+        if (!row)
+            return -1;
+        ent->rows = row;
+        ent->nalloc = nalloc;
+    }
+
+    row = &ent->rows[ent->nrows];
+    row->data = malloc(datalen);
+    if (!row->data)
+        return -1;
+    memcpy(row->data, data, datalen);
+    row->len = datalen;
+
+    ent->nrows++;
+    ent->bytes += datalen + sizeof(*row);
+
+    return 0;
+}
+
+void fdb_rowcache_fill_done(fdb_rowcache_ent_t *ent)
+{
+    struct fdb_rowcache_ent *old;
+    struct fdb_rowcache_tbl *tbl;
+    int64_t limit = (int64_t)gbl_fdb_rowcache_size_kb * 1024;
+
+    if (ent->bytes > limit) {
+        /* cache was disabled or shrunk while we were streaming */
+        fdb_rowcache_fill_abort(ent);
+        return;
+    }
+
+    Pthread_mutex_lock(&rowcache.mtx);
+    _rowcache_init();
+
+    tbl = _rowcache_tbl(ent->dbname, ent->tblname, 1);
+    if (!tbl) {
+        _rowcache_ent_unref(ent);
+        goto done;
+    }
+
+    /* a concurrent reader might have cached the same result set */
+    old = hash_find_readonly(rowcache.h_ents, &ent->key);
+    if (old)
+        _rowcache_ent_unlink(old, 0);
+
+    ent->tbl = tbl;
+    ent->created_ms = comdb2_time_epochms();
+    ent->linked = 1;
+    ent->users++;
+    hash_add(rowcache.h_ents, ent);
+    listc_atl(&rowcache.lru, ent);
+    listc_abl(&tbl->ents, ent);
+    rowcache.bytes += ent->bytes;
+    tbl->version = ent->version;
+    tbl->nents++;
+    tbl->nrows += ent->nrows;
+    tbl->bytes += ent->bytes;
+
+    /* make room, least recently used first */
+    while (rowcache.bytes > limit && rowcache.lru.bot != ent)
+        _rowcache_ent_unlink(rowcache.lru.bot, 0);
+
+    /* drop the filler reference */
+    _rowcache_ent_unref(ent);
+
+done:
+    Pthread_mutex_unlock(&rowcache.mtx);
+}
+
+void fdb_rowcache_fill_abort(fdb_rowcache_ent_t *ent)
+{
+    assert(!ent->linked && ent->users == 1);
+    _rowcache_ent_free(ent);
+}
+
+void fdb_rowcache_invalidate(const char *dbname, const char *tblname,
+                             unsigned long long version)
+{
+    struct fdb_rowcache_tbl *tbl;
+    struct fdb_rowcache_ent *ent, *tmp;
+
+    Pthread_mutex_lock(&rowcache.mtx);
+    if (!rowcache.h_tbls)
+        goto done;
+
+    tbl = _rowcache_tbl(dbname, tblname, 0);
+    if (!tbl)
+        goto done;
+
+    LISTC_FOR_EACH_SAFE(&tbl->ents, ent, tmp, tbl_lnk)
+    {
+        if (version == 0 || ent->version != version)
+            _rowcache_ent_unlink(ent, 1);
+    }
+
+done:
+    Pthread_mutex_unlock(&rowcache.mtx);
+}
+
+static int _rowcache_tbl_free(void *obj, void *arg)
+{
+    struct fdb_rowcache_tbl *tbl = obj;
+
+    assert(listc_size(&tbl->ents) == 0);
+    free(tbl->key);
+    free(tbl->dbname);
+    free(tbl->tblname);
+    free(tbl);
+    return 0;
+}
+
+void fdb_rowcache_flush(void)
+{
+    Pthread_mutex_lock(&rowcache.mtx);
+    if (!rowcache.h_tbls)
+        goto done;
+
+    /* entries in use by cursors are freed by their last fdb_rowcache_put */
+    while (rowcache.lru.bot)
+        _rowcache_ent_unlink(rowcache.lru.bot, 0);
+
+    hash_for(rowcache.h_tbls, _rowcache_tbl_free, NULL);
+    hash_clear(rowcache.h_tbls);
+
+done:
+    Pthread_mutex_unlock(&rowcache.mtx);
+}
+
+typedef struct fdb_rowcache_systable_info {
+    fdb_rowcache_systable_ent_t *arr;
+    int narr;
+    int nalloc;
+} fdb_rowcache_systable_info_t;
+
+static int _rowcache_systable_ent(void *obj, void *arg)
+{
+    struct fdb_rowcache_tbl *tbl = obj;
+    fdb_rowcache_systable_info_t *info = arg;
+    fdb_rowcache_systable_ent_t *ient;
+
+    if (info->narr == info->nalloc) {
+        int nalloc = info->nalloc ? info->nalloc * 2 : 16;
+        ient = realloc(info->arr, nalloc * sizeof(*ient));
+        if (!ient)
+            return -1;
+        info->arr = ient;
+        info->nalloc = nalloc;
+    }
+
+    ient = &info->arr[info->narr++];
+    ient->dbname = strdup(tbl->dbname);
+    ient->tablename = strdup(tbl->tblname);
+    ient->version = tbl->version;
+    ient->entries = tbl->nents;
+    ient->rows = tbl->nrows;
+    ient->bytes = tbl->bytes;
+    ient->hits = tbl->hits;
+    ient->misses = tbl->misses;
+    ient->evictions = tbl->evictions;
+    ient->invalidations = tbl->invalidations;
+
+    return 0;
+}
+
+int fdb_rowcache_systable_collect(void **data, int *npoints)
+{
+    fdb_rowcache_systable_info_t info = {0};
+
+    Pthread_mutex_lock(&rowcache.mtx);
+    if (rowcache.h_tbls)
+        hash_for(rowcache.h_tbls, _rowcache_systable_ent, &info);
+    Pthread_mutex_unlock(&rowcache.mtx);
+
+    *data = info.arr;
+    *npoints = info.narr;
+
+    return 0;
+}
+
+void fdb_rowcache_systable_free(void *data, int npoints)
+{
+    fdb_rowcache_systable_ent_t *ient = data;
+    int i;
+
+    for (i = 0; i < npoints; i++) {
+        free(ient[i].dbname);
+        free(ient[i].tablename);
+    }
+    free(ient);
+}
@@ -42,4 +42,57 @@ int fdb_sqlstat_cache_create(struct sqlclntstate *clnt, fdb_t *fdb,
  */
 void fdb_sqlstat_cache_destroy(fdb_sqlstat_cache_t **pcache);
 
+/**
+ * Shared remote row cache
+ *
+ * Result sets of remote reads are cached across sql threads, keyed by
+ * remote db, table, table version and the generated remote sql.
+ * Entries are reference counted; a cursor that serves rows from an entry
+ * keeps it alive even if the entry is evicted or invalidated meanwhile.
+ *
+ */
+typedef struct fdb_rowcache_ent fdb_rowcache_ent_t;
+
+/* is the cache enabled? */
+int fdb_rowcache_enabled(void);
+
+/* lookup a result set; returns a referenced entry, or NULL if not cached */
+fdb_rowcache_ent_t *fdb_rowcache_get(const char *dbname, const char *tblname,
+                                     unsigned long long version,
+                                     const char *sql);
+
+/* release a reference returned by get/fill_start */
+void fdb_rowcache_put(fdb_rowcache_ent_t *ent);
+
+/* number of rows and row access for a cached result set */
+int fdb_rowcache_nrows(fdb_rowcache_ent_t *ent);
+void fdb_rowcache_row(fdb_rowcache_ent_t *ent, int idx, char **data,
+                      int *datalen);
+
+/**
+ * Capture a result set while it is streamed from remote
+ * fill_add returns non-zero if the result set grows beyond the per entry
+ * limit, in which case the caller should abort the fill
+ *
+ */
+fdb_rowcache_ent_t *fdb_rowcache_fill_start(const char *dbname,
+                                            const char *tblname,
+                                            unsigned long long version,
+                                            const char *sql);
+int fdb_rowcache_fill_add(fdb_rowcache_ent_t *ent, const char *data,
+                          int datalen);
+void fdb_rowcache_fill_done(fdb_rowcache_ent_t *ent);
+void fdb_rowcache_fill_abort(fdb_rowcache_ent_t *ent);
+
+/**
+ * Drop cached result sets for a remote table, except the ones matching
+ * "version"; version 0 drops everything for the table
+ *
+ */
+void fdb_rowcache_invalidate(const char *dbname, const char *tblname,
+                             unsigned long long version);
+
+/* Drop every cached result set and the per table statistics */
+void fdb_rowcache_flush(void);
+
 #endif
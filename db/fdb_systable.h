@@ -31,4 +31,21 @@ typedef struct fdb_systable_ent {
 int fdb_systable_info_collect(void **data, int *npoints);
 void fdb_systable_info_free(void *data, int npoints);
 
+typedef struct fdb_rowcache_systable_ent {
+    char *dbname;
+    char *tablename;
+    int64_t version;
+    int64_t entries;
+    int64_t rows;
+    int64_t bytes;
+    int64_t hits;
+    int64_t misses;
+    int64_t evictions;
+    int64_t invalidations;
+} fdb_rowcache_systable_ent_t;
+
+/* Collect/Free row cache information */
+int fdb_rowcache_systable_collect(void **data, int *npoints);
+void fdb_rowcache_systable_free(void *data, int npoints);
+
 #endif
@@ -2368,6 +2368,31 @@ int ix_find_by_key_tran(struct ireq *iq, void *key, int keylen, int index,
                                      trans);
 }
 
+/* Like ix_find_by_key_tran, for lookups that usually miss (unique checks of
+ * new keys, no-references constraint checks): consults the index Bloom
+ * filter first and skips the btree search on a definite miss. */
+int ix_find_absent_by_key_tran(struct ireq *iq, void *key, int keylen,
+                               int index, void *fndkey, int *fndrrn,
+                               unsigned long long *genid, void *fnddta,
+                               int *fndlen, int maxlen, void *trans)
+{
+    int rc, maybe, bdberr;
+    bdb_state_type *bdb_handle = iq->usedb->handle;
+
+    maybe = bdb_ix_bloom_check(bdb_handle, trans, index, key, keylen, &bdberr);
+    if (maybe == 0)
+        return IX_NOTFND;
+    if (maybe == -1 && bdberr == BDBERR_DEADLOCK)
+        return trans ? RC_INTERNAL_RETRY : ERR_INTERNAL;
+
+    rc = ix_find_by_key_tran(iq, key, keylen, index, fndkey, fndrrn, genid,
+                             fnddta, fndlen, maxlen, trans);
+    if (maybe == 1 &&
+        (rc == IX_NOTFND || rc == IX_PASTEOF || rc == IX_EMPTY))
+        bdb_ix_bloom_false_positive(bdb_handle, index);
+    return rc;
+}
+
 int ix_find_auxdb_by_key_tran(int auxdb, struct ireq *iq, void *key, int keylen,
                               int index, void *fndkey, int *fndrrn,
                               unsigned long long *genid, void *fnddta,
@@ -3983,6 +4008,7 @@ void get_disable_skipscan_all()
     for (int ii = 0; ii < thedb->num_dbs; ii++) {
         struct dbtable *d = thedb->dbs[ii];
         get_disable_skipscan(d, tran);
+        views_summary_load(d, tran);
     }
     curtran_puttran(tran);
 }
@@ -4156,6 +4182,7 @@ int backend_open_tran(struct dbenv *dbenv, tran_type *tran, uint32_t flags)
             }
 
             get_disable_skipscan(tbl, tran);
+            views_summary_load(tbl, tran);
         }
 
         if (bthashsz) {
@@ -216,8 +216,8 @@ int check_index(struct ireq *iq, void *trans, int ixnum, blob_buffer_t *blobs, s
         return 0;
     }
 
-    rc = ix_find_by_key_tran(iq, key, ixkeylen, ixnum, NULL, &fndrrn, &fndgenid,
-                             NULL, NULL, 0, trans);
+    rc = ix_find_absent_by_key_tran(iq, key, ixkeylen, ixnum, NULL, &fndrrn,
+                                    &fndgenid, NULL, NULL, 0, trans);
     if (rc == IX_FND) {
         *ixfailnum = ixnum;
         /* If following changes, update OSQL_INSREC in osqlcomm.c */
@@ -467,9 +467,9 @@ int add_record_indices(struct ireq *iq, void *trans, blob_buffer_t *blobs,
             if (vgenid && iq->usedb->ix_dupes[ixnum] == 0 && !isnullk) {
                 int fndrrn = 0;
                 unsigned long long fndgenid = 0ULL;
-                rc =
-                    ix_find_by_key_tran(iq, key, ixkeylen, ixnum, NULL, &fndrrn,
-                                        &fndgenid, NULL, NULL, 0, trans);
+                rc = ix_find_absent_by_key_tran(iq, key, ixkeylen, ixnum, NULL,
+                                                &fndrrn, &fndgenid, NULL, NULL,
+                                                0, trans);
                 if (rc == IX_FND && fndgenid == vgenid) {
                     rc = ERR_VERIFY;
                     ERR(rc, "verify error", 0);
@@ -1079,9 +1079,10 @@ int upd_new_record_add2indices(struct ireq *iq, void *trans,
         if (vgenid && iq->usedb->ix_dupes[ixnum] == 0 && !isnullk) {
             int fndrrn = 0;
             unsigned long long fndgenid = 0ULL;
-            rc = ix_find_by_key_tran(iq, key, getkeysize(iq->usedb, ixnum),
-                                     ixnum, NULL, &fndrrn, &fndgenid, NULL,
-                                     NULL, 0, trans);
+            rc = ix_find_absent_by_key_tran(iq, key,
+                                            getkeysize(iq->usedb, ixnum), ixnum,
+                                            NULL, &fndrrn, &fndgenid, NULL,
+                                            NULL, 0, trans);
             if (rc == IX_FND && fndgenid == vgenid) {
                 return ERR_VERIFY;
             } else if (rc == IX_FND) {
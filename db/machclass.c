@@ -18,6 +18,7 @@
 #include <stdlib.h>
 #include <pthread.h>
 #include <plhash_glue.h>
+#include <rcu_hash.h>
 #include "machclass.h"
 #include "lockmacros.h"
 
@@ -28,9 +29,11 @@ typedef struct machine_class {
     int value;
 } machine_class_t;
 
+/* Classes are looked up without locks; mach_mtx serializes changes to
+ * them and protects fdb_tiers. */
 static pthread_mutex_t mach_mtx = PTHREAD_MUTEX_INITIALIZER;
-static hash_t *classes = NULL;
-static hash_t *class_names = NULL;
+static rcu_hash_t *classes = NULL;
+static rcu_hash_t *class_names = NULL;
 
 typedef struct machine_cluster {
     char *name;
@@ -72,8 +75,8 @@ int mach_class_cluster_init(void)
     int rc = 0;
 
     Pthread_mutex_lock(&mach_mtx);
-    classes = hash_init_strcaseptr(offsetof(struct machine_class, name));
-    class_names = hash_init_i4(offsetof(struct machine_class, value));
+    classes = rcu_hash_init_strcaseptr(offsetof(struct machine_class, name));
+    class_names = rcu_hash_init_i4(offsetof(struct machine_class, value));
     if (!classes || !class_names) {
         Pthread_mutex_unlock(&mach_mtx);
         return -1;
@@ -100,11 +103,15 @@ int mach_class_cluster_init(void)
 
 static int _mach_class_add(machine_class_t *class, int *added)
 {
-    if (!hash_find(classes, &class->name)) {
+    if (!rcu_hash_find(classes, &class->name)) {
         logmsg(LOGMSG_DEBUG, "Adding class %s value %d\n", class->name,
                class->value);
-        hash_add(classes, class);
-        hash_add(class_names, class);
+        if (rcu_hash_add(classes, class) != 0)
+            return -1;
+        if (rcu_hash_add(class_names, class) != 0) {
+            rcu_hash_del(classes, class);
+            return -1;
+        }
         if (added)
             *added = 1;
     }
@@ -186,7 +193,8 @@ int mach_class_addclass(const char *name, int value)
     Pthread_mutex_lock(&mach_mtx);
     if (is_default) {
         /* override the default with client classes */
-        hash_clear(classes);
+        for (int i = 0; i < sizeof(default_classes) / sizeof(default_classes[0]); i++)
+            rcu_hash_del(classes, &default_classes[i]);
         is_default = 0;
     }
     rc = _mach_class_add(class, &added);
@@ -205,14 +213,10 @@ int mach_class_name2class(const char *name)
     machine_class_t *class;
     int value = CLASS_UNKNOWN;
 
-    Pthread_mutex_lock(&mach_mtx);
-
-    class = hash_find(classes, &name);
+    class = rcu_hash_find(classes, &name);
     if (class)
         value = class->value;
 
-    Pthread_mutex_unlock(&mach_mtx);
-
     return value;
 }
 
@@ -221,14 +225,10 @@ const char *mach_class_class2name(int value)
     machine_class_t *class;
     const char *name = NULL;
 
-    Pthread_mutex_lock(&mach_mtx);
-
-    class = hash_find(class_names, &value);
+    class = rcu_hash_find(class_names, &value);
     if (class)
         name = class->name;
 
-    Pthread_mutex_unlock(&mach_mtx);
-
     return name;
 }
 
@@ -239,7 +239,7 @@ int mach_class_remap_fdb_tier(const char *name, const char *tier)
 
     Pthread_mutex_lock(&mach_mtx);
 
-    class = hash_find(classes, &name);
+    class = rcu_hash_find(classes, &name);
     if (class == NULL) {
         logmsg(LOGMSG_ERROR, "machine class '%s' does not exist", name);
         rc = -1;
@@ -266,7 +266,7 @@ const char *mach_class_class2tier(int value)
     if (fdb_tiers[value] != NULL)
         ret = fdb_tiers[value];
     else {
-        class = hash_find(class_names, &value);
+        class = rcu_hash_find(class_names, &value);
         if (class)
             ret = class->name;
     }
@@ -278,8 +278,6 @@ const char *mach_class_class2tier(int value)
 
 int is_valid_mach_class(const char *name)
 {
-    Pthread_mutex_lock(&mach_mtx);
-    machine_class_t *class = hash_find(classes, &name);
-    Pthread_mutex_unlock(&mach_mtx);
+    machine_class_t *class = rcu_hash_find(classes, &name);
     return (class == NULL) ? 0 : 1;
 }
@@ -77,6 +77,17 @@ extern int gbl_checkpoint_count;
 extern uint32_t rcache_hits;
 extern uint32_t rcache_miss;
 
+extern uint64_t bt_ahi_hits;
+extern uint64_t bt_ahi_invalid;
+
+extern uint64_t bt_keypfx_hits;
+extern uint64_t bt_keypfx_narrowed;
+
+extern uint64_t gbl_sql_array_insert_loops;
+extern uint64_t gbl_osql_insert_batches;
+extern uint64_t gbl_sql_arena_resets;
+extern uint64_t gbl_sql_arena_busy_resets;
+
 extern time_t gbl_election_time_completed;
 extern uint64_t gbl_last_election_time_ms;
 extern uint64_t gbl_total_election_time_ms;
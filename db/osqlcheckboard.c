@@ -291,7 +291,7 @@ int osql_chkboard_sqlsession_exists(unsigned long long rqid, uuid_t uuid)
 }
 
 int osql_chkboard_sqlsession_rc(unsigned long long rqid, uuid_t uuid, int nops, void *data, struct errstat *errstat,
-                                struct query_effects *effects, const char *from)
+                                struct query_effects *effects, int commit_file, int commit_offset, const char *from)
 {
     if (!checkboard)
         return 0;
@@ -350,6 +350,11 @@ int osql_chkboard_sqlsession_rc(unsigned long long rqid, uuid_t uuid, int nops,
         }
     }
 
+    if (!errstat && commit_file > 0) {
+        entry->clnt->commit_lsn_file = commit_file;
+        entry->clnt->commit_lsn_offset = commit_offset;
+    }
+
     Pthread_cond_signal(&entry->cond);
     Pthread_mutex_unlock(&entry->mtx);
     return 0;
@@ -106,7 +106,7 @@ int osql_unregister_sqlthr(struct sqlclntstate *clnt);
  *
  */
 int osql_chkboard_sqlsession_rc(unsigned long long rqid, uuid_t uuid, int nops, void *data, struct errstat *errstat,
-                                struct query_effects *effects, const char *from);
+                                struct query_effects *effects, int commit_file, int commit_offset, const char *from);
 
 /**
  * Wait the default time for the session to complete
@@ -1220,13 +1220,18 @@ typedef struct osql_done_uuid_rpl {
     osql_done_t dt;
     struct query_effects effects;
     struct query_effects fk_effects;
+    int commit_file;
+    int commit_offset;
 } osql_done_uuid_rpl_t;
 
+/* v3 appends the commit lsn; older replicants ignore the trailing bytes */
 enum {
     OSQLCOMM_DONE_UUID_RPL_v1_LEN =
         OSQLCOMM_UUID_RPL_TYPE_LEN + OSQLCOMM_DONE_TYPE_LEN,
     OSQLCOMM_DONE_UUID_RPL_v2_LEN =
         OSQLCOMM_DONE_UUID_RPL_v1_LEN + (2 * sizeof(struct query_effects)),
+    OSQLCOMM_DONE_UUID_RPL_v3_LEN =
+        OSQLCOMM_DONE_UUID_RPL_v2_LEN + (2 * sizeof(int)),
 };
 
 #if 0
@@ -1864,6 +1869,7 @@ BB_COMPILE_TIME_ASSERT(osqlcomm_ins_type_len,
 enum osql_insert_flags {
     OSQL_INSERT_UPSERT = 1 << 0,
     OSQL_INSERT_SEND_DK = 1 << 1,
+    OSQL_INSERT_BATCH = 1 << 2, /* pData holds packed rows */
 };
 
 static uint8_t *osqlcomm_ins_type_put(const osql_ins_t *p_osql_ins,
@@ -1941,6 +1947,47 @@ static const uint8_t *osqlcomm_ins_type_get(osql_ins_t *p_osql_ins,
     return p_buf;
 }
 
+/* One row of an OSQL_INSERT_BATCH payload, which is a row count followed by
+ * the rows. */
+typedef struct osql_insbatch_row {
+    unsigned long long dk;
+    int nData;
+    const uint8_t *pData;
+} osql_insbatch_row_t;
+
+enum { OSQLCOMM_INSBATCH_ROW_LEN = 8 + 4 }; /* dk + nData, then the record */
+
+static uint8_t *osqlcomm_insbatch_row_put(const osql_insbatch_row_t *p_row,
+                                          uint8_t *p_buf,
+                                          const uint8_t *p_buf_end)
+{
+    if (p_buf_end < p_buf ||
+        OSQLCOMM_INSBATCH_ROW_LEN + p_row->nData > (p_buf_end - p_buf))
+        return NULL;
+
+    p_buf = buf_no_net_put(&(p_row->dk), sizeof(p_row->dk), p_buf, p_buf_end);
+    p_buf = buf_put(&(p_row->nData), sizeof(p_row->nData), p_buf, p_buf_end);
+    p_buf = buf_no_net_put(p_row->pData, p_row->nData, p_buf, p_buf_end);
+
+    return p_buf;
+}
+
+static const uint8_t *osqlcomm_insbatch_row_get(osql_insbatch_row_t *p_row,
+                                                const uint8_t *p_buf,
+                                                const uint8_t *p_buf_end)
+{
+    if (p_buf_end < p_buf || OSQLCOMM_INSBATCH_ROW_LEN > (p_buf_end - p_buf))
+        return NULL;
+
+    p_buf = buf_no_net_get(&(p_row->dk), sizeof(p_row->dk), p_buf, p_buf_end);
+    p_buf = buf_get(&(p_row->nData), sizeof(p_row->nData), p_buf, p_buf_end);
+    if (p_row->nData < 0 || p_row->nData > (p_buf_end - p_buf))
+        return NULL;
+    p_row->pData = p_buf;
+
+    return p_buf + p_row->nData;
+}
+
 typedef struct osql_ins_rpl {
     osql_rpl_t hd;
     osql_ins_t dt;
@@ -3676,7 +3723,8 @@ static void net_snap_uid_rpl(void *hndl, void *uptr, char *fromhost,
 {
     snap_uid_t snap_info;
     snap_uid_get(&snap_info, dtap, (uint8_t *)dtap + dtalen);
-    osql_chkboard_sqlsession_rc(OSQL_RQID_USE_UUID, snap_info.uuid, 0, &snap_info, NULL, &snap_info.effects, fromhost);
+    osql_chkboard_sqlsession_rc(OSQL_RQID_USE_UUID, snap_info.uuid, 0, &snap_info, NULL, &snap_info.effects, 0, 0,
+                                fromhost);
 }
 
 int gbl_disable_cnonce_blkseq;
@@ -4729,6 +4777,84 @@ int osql_send_insrec(osql_target_t *target, unsigned long long rqid,
                         (nData > sent) ? nData - sent : 0);
 }
 
+uint64_t gbl_osql_insert_batches = 0; /* packed OSQL_INSERTs sent */
+
+int osql_insbatch_add(struct osql_insbatch *batch, unsigned long long dirty_keys,
+                      char *pData, int nData)
+{
+    osql_insbatch_row_t row = {.dk = dirty_keys, .nData = nData, .pData = (uint8_t *)pData};
+    int len = batch->nrows ? batch->len : sizeof(batch->nrows);
+    int need = len + OSQLCOMM_INSBATCH_ROW_LEN + nData;
+
+    if (need > batch->alloc) {
+        int alloc = batch->alloc * 2 > need ? batch->alloc * 2 : need;
+        uint8_t *buf = realloc(batch->buf, alloc);
+        if (!buf)
+            return -1;
+        batch->buf = buf;
+        batch->alloc = alloc;
+    }
+    if (!osqlcomm_insbatch_row_put(&row, batch->buf + len, batch->buf + need))
+        return -1;
+    batch->len = need;
+    batch->nrows++;
+    return 0;
+}
+
+/* The rows go out as one OSQL_INSERT flagged OSQL_INSERT_BATCH, whose pData is
+ * the row count followed by the rows.  Older masters do not know the flag, so
+ * this is only used when the osql_insert_batch tunable is set. */
+int osql_send_insbatch(osql_target_t *target, uuid_t uuid,
+                       struct osql_insbatch *batch, int type)
+{
+    osql_ins_uuid_rpl_t ins_uuid_rpl = {{0}};
+    uint8_t buf[OSQLCOMM_INS_UUID_RPL_TYPE_LEN];
+    uint8_t *p_buf = buf;
+    uint8_t *p_buf_end;
+    int len = OSQLCOMM_INS_UUID_RPL_TYPE_LEN -
+              sizeof(ins_uuid_rpl.dt.upsert_flags) - sizeof(ins_uuid_rpl.dt.dk);
+    int sent = sizeof(ins_uuid_rpl.dt.pData);
+    int rc;
+
+    if (batch->nrows == 0)
+        return 0;
+    if (check_master(target))
+        return OSQL_SEND_ERROR_WRONGMASTER;
+
+    buf_put(&batch->nrows, sizeof(batch->nrows), batch->buf,
+            batch->buf + sizeof(batch->nrows));
+
+    ins_uuid_rpl.hd.type = OSQL_INSERT;
+    comdb2uuidcpy(ins_uuid_rpl.hd.uuid, uuid);
+    ins_uuid_rpl.dt.flags = OSQL_INSERT_BATCH;
+    ins_uuid_rpl.dt.nData = batch->len;
+
+    p_buf_end = p_buf + len;
+    if (!(p_buf = osqlcomm_ins_uuid_rpl_type_put(&ins_uuid_rpl, p_buf,
+                                                 p_buf_end))) {
+        logmsg(LOGMSG_ERROR, "%s:%s returns NULL\n", __func__,
+               "osqlcomm_ins_uuid_rpl_type_put");
+        return -1;
+    }
+    /* the row count fills the pData slot of the header */
+    p_buf = buf_no_net_put(batch->buf, sent, p_buf, p_buf_end);
+
+    if (gbl_enable_osql_logging) {
+        uuidstr_t us;
+        logmsg(LOGMSG_DEBUG, "[%s] send OSQL_INSERT batch of %d rows\n",
+               comdb2uuidstr(uuid, us), batch->nrows);
+    }
+
+    rc = target->send(target, osql_net_type_to_net_uuid_type(type), buf, len,
+                      0, batch->buf + sent, batch->len - sent);
+    if (rc == 0) {
+        gbl_osql_insert_batches++;
+        batch->nrows = 0;
+        batch->len = 0;
+    }
+    return rc;
+}
+
 int osql_send_dbq_consume(osql_target_t *target, unsigned long long rqid,
                           uuid_t uuid, genid_t genid, int type)
 {
@@ -5462,13 +5588,23 @@ static int signal_spew = 0;
 int osql_comm_signal_sqlthr_rc(osql_target_t *target, unsigned long long rqid,
                                uuid_t uuid, int nops, struct errstat *xerr,
                                snap_uid_t *snap, int rc)
+{
+    return osql_comm_signal_sqlthr_rc_lsn(target, rqid, uuid, nops, xerr, snap,
+                                          rc, 0, 0);
+}
+
+int osql_comm_signal_sqlthr_rc_lsn(osql_target_t *target,
+                                   unsigned long long rqid, uuid_t uuid,
+                                   int nops, struct errstat *xerr,
+                                   snap_uid_t *snap, int rc, int commit_file,
+                                   int commit_offset)
 {
     uuidstr_t us;
     int msglen = 0;
     int type;
     union {
         char a[OSQLCOMM_DONE_XERR_UUID_RPL_LEN];
-        char b[OSQLCOMM_DONE_UUID_RPL_v2_LEN];
+        char b[OSQLCOMM_DONE_UUID_RPL_v3_LEN];
         char c[OSQLCOMM_DONE_XERR_RPL_LEN];
         char d[OSQLCOMM_DONE_RPL_LEN];
     } largest_message;
@@ -5483,7 +5619,8 @@ int osql_comm_signal_sqlthr_rc(osql_target_t *target, unsigned long long rqid,
     /* if error, lets send the error string */
     if (target->host == gbl_myhostname) {
         /* local */
-        return osql_chkboard_sqlsession_rc(rqid, uuid, nops, snap, xerr, (snap) ? &snap->effects : NULL, target->host);
+        return osql_chkboard_sqlsession_rc(rqid, uuid, nops, snap, xerr, (snap) ? &snap->effects : NULL,
+                                           rc ? 0 : commit_file, commit_offset, target->host);
     }
 
     /* remote */
@@ -5500,7 +5637,7 @@ int osql_comm_signal_sqlthr_rc(osql_target_t *target, unsigned long long rqid,
         } else {
             osql_done_uuid_rpl_t rpl_ok = {{0}};
             uint8_t *p_buf = buf;
-            uint8_t *p_buf_end = buf + OSQLCOMM_DONE_UUID_RPL_v2_LEN;
+            uint8_t *p_buf_end = buf + OSQLCOMM_DONE_UUID_RPL_v3_LEN;
             if (likely(gbl_master_sends_query_effects)) {
                 rpl_ok.hd.type = OSQL_DONE_WITH_EFFECTS;
             } else {
@@ -5516,13 +5653,29 @@ int osql_comm_signal_sqlthr_rc(osql_target_t *target, unsigned long long rqid,
 
             msglen = OSQLCOMM_DONE_UUID_RPL_v1_LEN;
 
-            /* Send query effects to the replicant. */
-            if (likely(gbl_master_sends_query_effects)) {
+            /* Send query effects to the replicant.  The commit lsn follows
+             * them even with effects off, so read-your-writes does not
+             * depend on that switch: the effects are zeroed then, and an
+             * OSQL_DONE reader only looks at the length. */
+            if (likely(gbl_master_sends_query_effects) || commit_file > 0) {
+                if (!gbl_master_sends_query_effects)
+                    memset(&rpl_ok.effects, 0, sizeof(rpl_ok.effects));
                 p_buf = osqlcomm_query_effects_put(&(rpl_ok.effects), p_buf,
                                                    p_buf_end);
                 p_buf = osqlcomm_query_effects_put(&(rpl_ok.fk_effects), p_buf,
                                                    p_buf_end);
                 msglen = OSQLCOMM_DONE_UUID_RPL_v2_LEN;
+                if (commit_file > 0) {
+                    rpl_ok.commit_file = commit_file;
+                    rpl_ok.commit_offset = commit_offset;
+                    p_buf = buf_put(&(rpl_ok.commit_file),
+                                    sizeof(rpl_ok.commit_file), p_buf,
+                                    p_buf_end);
+                    p_buf = buf_put(&(rpl_ok.commit_offset),
+                                    sizeof(rpl_ok.commit_offset), p_buf,
+                                    p_buf_end);
+                    msglen = OSQLCOMM_DONE_UUID_RPL_v3_LEN;
+                }
             }
         }
         type = osql_net_type_to_net_uuid_type(NET_OSQL_SIGNAL);
@@ -6977,6 +7130,182 @@ int osql_finalize_scs(struct ireq *iq, tran_type *trans)
 }
 
 
+/**
+ * Add the ondisk record of an OSQL_INSERT, or of one row of a batch
+ *
+ */
+static int osql_process_insert_row(struct ireq *iq, void *trans, uuid_t uuid,
+                                   unsigned char *pData, int nData,
+                                   unsigned long long dk, int flags,
+                                   int upsert_flags,
+                                   blob_buffer_t blobs[MAXBLOBS], int step,
+                                   struct block_err *err, int *receivedrows)
+{
+    const unsigned char tag_name_ondisk[] = ".ONDISK";
+    const size_t tag_name_ondisk_len = 8 /*includes NUL*/;
+    int rrn = 0;
+    unsigned long long newgenid = 0;
+    int rc;
+
+    int addflags = RECFLAGS_DYNSCHEMA_NULLS_ONLY | RECFLAGS_DONT_LOCK_TBL;
+    if (!iq->sorese->is_delayed && iq->usedb->n_constraints == 0 &&
+        gbl_goslow == 0) {
+        addflags |= RECFLAGS_NO_CONSTRAINTS;
+    } else {
+        iq->sorese->is_delayed = 1;
+    }
+
+    rc = add_record(iq, trans, tag_name_ondisk,
+                    tag_name_ondisk + tag_name_ondisk_len, /*tag*/
+                    pData, pData + nData,               /*dta*/
+                    NULL,            /*nulls, no need as no
+                                       ctag2stag is called */
+                    blobs, MAXBLOBS, /*blobs*/
+                    &err->errcode, &err->ixnum, &rrn, &newgenid, /*new id*/
+                    dk, BLOCK2_ADDKL, step, addflags,
+                    upsert_flags); /* do I need this?*/
+
+    EVENTLOG_DEBUG(
+        uuidstr_t ustr;
+        comdb2uuidstr(uuid, ustr);
+        eventlog_debug("%s:%d uuid %s add_record genid %"PRIx64" rc %d errcode %d flags %x upsert_flags %x vfy_idx_track %d dup_key_insert %d upsert_idx %d force_verify %d", __func__, __LINE__, ustr, newgenid, rc,
+                       err->errcode, flags, upsert_flags, iq->vfy_genid_track, iq->dup_key_insert, upsert_flags >> 8, upsert_flags & OSQL_FORCE_VERIFY);
+    );
+
+    free_blob_buffers(blobs, MAXBLOBS);
+    if (iq->idxInsert || iq->idxDelete) {
+        free_cached_idx(iq->idxInsert);
+        free_cached_idx(iq->idxDelete);
+        free(iq->idxInsert);
+        free(iq->idxDelete);
+        iq->idxInsert = iq->idxDelete = NULL;
+    }
+
+    if (gbl_enable_osql_logging) {
+        unsigned long long lclgenid = bdb_genid_to_host_order(newgenid);
+        logmsg(LOGMSG_DEBUG, " %llx (%d:%lld)\n", lclgenid, rrn, lclgenid);
+    }
+
+    if (rc != 0) {
+        if (err->errcode == OP_FAILED_UNIQ) {
+            if (iq->vfy_idx_track == 1 && iq->dup_key_insert == 1) {
+                rc = ERR_UNCOMMITTABLE_TXN;
+                reqerrstr(iq, COMDB2_CSTRT_RC_DUP, "Transaction is uncommittable: "
+                                                   "Duplicate insert on key '%s' "
+                                                   "in table '%s' index %d",
+                      get_keynm_from_db_idx(iq->usedb, err->ixnum),
+                      iq->usedb->tablename, err->ixnum);
+                err->errcode = ERR_UNCOMMITTABLE_TXN;
+                goto done_delete;
+            }
+
+            int upsert_idx = upsert_flags >> 8;
+            if ((upsert_flags & OSQL_FORCE_VERIFY) != 0) {
+                if (upsert_idx == err->ixnum || upsert_idx == MAXINDEX + 1) {
+                    err->errcode = OP_FAILED_VERIFY;
+                    rc = ERR_VERIFY;
+                }
+            }
+
+            if ((upsert_flags & OSQL_IGNORE_FAILURE) != 0) {
+                if (upsert_idx == MAXINDEX + 1) {
+                    /* We're asked to ignore DUPs for all unique indices, no insert took place.*/
+                    err->errcode = 0;
+                    rc = 0;
+                    goto done_delete;
+                } else if ((upsert_flags & OSQL_FORCE_VERIFY) == 1) {
+                    err->errcode = 0;
+                    rc = 0;
+                    goto done_delete;
+                } else if (upsert_idx == err->ixnum) {
+                    /* We're asked to ignore DUPs for this particular * index, no insert took place.*/
+                    err->errcode = 0;
+                    rc = 0;
+                    goto done_delete;
+                }
+            }
+
+            if (rc != ERR_VERIFY) {
+                /* this can happen if we're skipping delayed key adds */
+                reqerrstr(iq, COMDB2_CSTRT_RC_DUP, "add key constraint "
+                                                   "duplicate key '%s' on "
+                                                   "table '%s' index %d",
+                          get_keynm_from_db_idx(iq->usedb, err->ixnum),
+                          iq->usedb->tablename, err->ixnum);
+            }
+        } else if (rc != RC_INTERNAL_RETRY) {
+            errstat_cat_strf(&iq->errstat, " unable to add record rc = %d",
+                             rc);
+        }
+
+        if (gbl_enable_osql_logging)
+            logmsg(LOGMSG_DEBUG,
+                   "Added new record failed, rrn = %d, newgenid=%llx\n",
+                   rrn, bdb_genid_to_host_order(newgenid));
+
+        if (0) {
+done_delete:
+            EVENTLOG_DEBUG(
+                uuidstr_t ustr;
+                comdb2uuidstr(uuid, ustr);
+                eventlog_debug("%s:%d uuid %s add_record genid %"PRIx64" rc adjusted to %d", __func__, __LINE__, ustr, newgenid, rc);
+            );
+            return rc;
+        }
+
+        return rc; /*this is blkproc rc */
+    } else {
+        if (gbl_enable_osql_logging)
+            logmsg(LOGMSG_DEBUG,
+                   "Added new record rrn = %d, newgenid=%llx\n", rrn,
+                   bdb_genid_to_host_order(newgenid));
+    }
+#if DEBUG_REORDER
+    logmsg(LOGMSG_DEBUG,
+           "REORDER: Added new record rrn = %d, newgenid=%llx\n", rrn,
+           bdb_genid_to_host_order(newgenid));
+#endif
+
+    if (likely(gbl_master_sends_query_effects) && IQ_HAS_SNAPINFO(iq)) {
+        IQ_SNAPINFO(iq)->effects.num_inserted++;
+    }
+    (*receivedrows)++;
+    return 0;
+}
+
+/**
+ * Add the rows of an OSQL_INSERT_BATCH payload in order
+ *
+ */
+static int osql_process_insbatch(struct ireq *iq, void *trans, uuid_t uuid,
+                                 const uint8_t *p_buf, int nData,
+                                 blob_buffer_t blobs[MAXBLOBS], int step,
+                                 struct block_err *err, int *receivedrows)
+{
+    const uint8_t *p_buf_end = p_buf + nData;
+    osql_insbatch_row_t row;
+    int nrows = 0;
+    int rc;
+
+    p_buf = buf_get(&nrows, sizeof(nrows), p_buf, p_buf_end);
+    for (int i = 0; p_buf && i < nrows; ++i) {
+        if (!(p_buf = osqlcomm_insbatch_row_get(&row, p_buf, p_buf_end)))
+            break;
+        rc = osql_process_insert_row(iq, trans, uuid, (unsigned char *)row.pData,
+                                     row.nData, row.dk, 0, 0, blobs, step, err,
+                                     receivedrows);
+        if (rc)
+            return rc;
+    }
+    if (!p_buf) {
+        uuidstr_t us;
+        logmsg(LOGMSG_ERROR, "%s %s malformed OSQL_INSERT batch of %d rows\n",
+               __func__, comdb2uuidstr(uuid, us), nrows);
+        return conv_rc_sql2blkop(iq, step, -1, ERR_BADREQ, err, NULL, 0);
+    }
+    return 0;
+}
+
 /**
  * Handles each packet and calls record.c functions
  * to apply to received row updates
@@ -7242,8 +7571,6 @@ int osql_process_packet(struct ireq *iq, uuid_t uuid, void *trans, char **pmsg,
     case OSQL_INSERT: {
         osql_ins_t dt;
         unsigned char *pData = NULL;
-        int rrn = 0;
-        unsigned long long newgenid = 0;
         int is_legacy = (type == OSQL_INSREC);
 
         const uint8_t *p_buf_end;
@@ -7267,129 +7594,13 @@ int osql_process_packet(struct ireq *iq, uuid_t uuid, void *trans, char **pmsg,
             logmsg(LOGMSG_DEBUG, "\n] -> ");
         }
 
-        int addflags = RECFLAGS_DYNSCHEMA_NULLS_ONLY | RECFLAGS_DONT_LOCK_TBL;
-        if (!iq->sorese->is_delayed && iq->usedb->n_constraints == 0 &&
-            gbl_goslow == 0) {
-            addflags |= RECFLAGS_NO_CONSTRAINTS;
-        } else {
-            iq->sorese->is_delayed = 1;
-        }
+        if (!is_legacy && (dt.flags & OSQL_INSERT_BATCH))
+            return osql_process_insbatch(iq, trans, uuid, pData, dt.nData,
+                                         blobs, step, err, receivedrows);
 
-        rc = add_record(iq, trans, tag_name_ondisk,
-                        tag_name_ondisk + tag_name_ondisk_len, /*tag*/
-                        pData, pData + dt.nData,               /*dta*/
-                        NULL,            /*nulls, no need as no
-                                           ctag2stag is called */
-                        blobs, MAXBLOBS, /*blobs*/
-                        &err->errcode, &err->ixnum, &rrn, &newgenid, /*new id*/
-                        dt.dk, BLOCK2_ADDKL, step, addflags,
-                        dt.upsert_flags); /* do I need this?*/
-
-        EVENTLOG_DEBUG(
-            uuidstr_t ustr;
-            comdb2uuidstr(uuid, ustr);
-            eventlog_debug("%s:%d uuid %s add_record genid %"PRIx64" rc %d errcode %d flags %x upsert_flags %x vfy_idx_track %d dup_key_insert %d upsert_idx %d force_verify %d", __func__, __LINE__, ustr, newgenid, rc,
-                           err->errcode, dt.flags, dt.upsert_flags, iq->vfy_genid_track, iq->dup_key_insert, dt.upsert_flags >> 8, dt.upsert_flags & OSQL_FORCE_VERIFY);
-        );
-
-        free_blob_buffers(blobs, MAXBLOBS);
-        if (iq->idxInsert || iq->idxDelete) {
-            free_cached_idx(iq->idxInsert);
-            free_cached_idx(iq->idxDelete);
-            free(iq->idxInsert);
-            free(iq->idxDelete);
-            iq->idxInsert = iq->idxDelete = NULL;
-        }
-
-        if (gbl_enable_osql_logging) {
-            unsigned long long lclgenid = bdb_genid_to_host_order(newgenid);
-            logmsg(LOGMSG_DEBUG, " %llx (%d:%lld)\n", lclgenid, rrn, lclgenid);
-        }
-
-        if (rc != 0) {
-            if (err->errcode == OP_FAILED_UNIQ) {
-                if (iq->vfy_idx_track == 1 && iq->dup_key_insert == 1) {
-                    rc = ERR_UNCOMMITTABLE_TXN;
-                    reqerrstr(iq, COMDB2_CSTRT_RC_DUP, "Transaction is uncommittable: "
-                                                       "Duplicate insert on key '%s' "
-                                                       "in table '%s' index %d",
-                          get_keynm_from_db_idx(iq->usedb, err->ixnum),
-                          iq->usedb->tablename, err->ixnum);
-                    err->errcode = ERR_UNCOMMITTABLE_TXN;
-                    goto done_delete;
-                }
-
-                int upsert_idx = dt.upsert_flags >> 8;
-                if ((dt.upsert_flags & OSQL_FORCE_VERIFY) != 0) {
-                    if (upsert_idx == err->ixnum || upsert_idx == MAXINDEX + 1) {
-                        err->errcode = OP_FAILED_VERIFY;
-                        rc = ERR_VERIFY;
-                    }
-                }
-
-                if ((dt.upsert_flags & OSQL_IGNORE_FAILURE) != 0) {
-                    if (upsert_idx == MAXINDEX + 1) {
-                        /* We're asked to ignore DUPs for all unique indices, no insert took place.*/
-                        err->errcode = 0;
-                        rc = 0;
-                        goto done_delete;
-                    } else if ((dt.upsert_flags & OSQL_FORCE_VERIFY) == 1) {
-                        err->errcode = 0;
-                        rc = 0;
-                        goto done_delete;
-                    } else if (upsert_idx == err->ixnum) {
-                        /* We're asked to ignore DUPs for this particular * index, no insert took place.*/
-                        err->errcode = 0;
-                        rc = 0;
-                        goto done_delete;
-                    }
-                }
-
-                if (rc != ERR_VERIFY) {
-                    /* this can happen if we're skipping delayed key adds */
-                    reqerrstr(iq, COMDB2_CSTRT_RC_DUP, "add key constraint "
-                                                       "duplicate key '%s' on "
-                                                       "table '%s' index %d",
-                              get_keynm_from_db_idx(iq->usedb, err->ixnum),
-                              iq->usedb->tablename, err->ixnum);
-                }
-            } else if (rc != RC_INTERNAL_RETRY) {
-                errstat_cat_strf(&iq->errstat, " unable to add record rc = %d",
-                                 rc);
-            }
-
-            if (gbl_enable_osql_logging)
-                logmsg(LOGMSG_DEBUG,
-                       "Added new record failed, rrn = %d, newgenid=%llx\n",
-                       rrn, bdb_genid_to_host_order(newgenid));
-
-            if (0) {
-done_delete:
-                EVENTLOG_DEBUG(
-                    uuidstr_t ustr;
-                    comdb2uuidstr(uuid, ustr);
-                    eventlog_debug("%s:%d uuid %s add_record genid %"PRIx64" rc adjusted to %d", __func__, __LINE__, ustr, newgenid, rc);
-                );
-                return rc;
-            }
-
-            return rc; /*this is blkproc rc */
-        } else {
-            if (gbl_enable_osql_logging)
-                logmsg(LOGMSG_DEBUG,
-                       "Added new record rrn = %d, newgenid=%llx\n", rrn,
-                       bdb_genid_to_host_order(newgenid));
-        }
-#if DEBUG_REORDER
-        logmsg(LOGMSG_DEBUG,
-               "REORDER: Added new record rrn = %d, newgenid=%llx\n", rrn,
-               bdb_genid_to_host_order(newgenid));
-#endif
-
-        if (likely(gbl_master_sends_query_effects) && IQ_HAS_SNAPINFO(iq)) {
-            IQ_SNAPINFO(iq)->effects.num_inserted++;
-        }
-        (*receivedrows)++;
+        return osql_process_insert_row(iq, trans, uuid, pData, dt.nData, dt.dk,
+                                       dt.flags, dt.upsert_flags, blobs, step,
+                                       err, receivedrows);
     } break;
     case OSQL_STARTGEN: {
         osql_startgen_t dt = {0};
@@ -8046,6 +8257,7 @@ static void net_sorese_signal(void *hndl, void *uptr, char *fromhost,
     struct errstat *xerr;
     struct query_effects effects;
     struct query_effects *p_effects = NULL;
+    int commit_file = 0, commit_offset = 0;
     uint8_t *p_buf = (uint8_t *)dtap;
     uint8_t *p_buf_end = p_buf + dtalen;
     uuid_t uuid;
@@ -8071,8 +8283,16 @@ static void net_sorese_signal(void *hndl, void *uptr, char *fromhost,
 
     /* This also receives the query effects from master. */
     if (osql_comm_is_done(NULL, type, dtap, dtalen, &xerr, &effects) == 1) {
-        if (type == OSQL_DONE_WITH_EFFECTS) {
+        if (type == OSQL_DONE_WITH_EFFECTS)
             p_effects = &effects;
+        /* the commit lsn comes after the effects, with or without them */
+        if ((type == OSQL_DONE_WITH_EFFECTS || type == OSQL_DONE) &&
+            dtalen >= OSQLCOMM_DONE_UUID_RPL_v3_LEN) {
+            const uint8_t *p_lsn =
+                (uint8_t *)dtap + OSQLCOMM_DONE_UUID_RPL_v2_LEN;
+            p_lsn = buf_get(&commit_file, sizeof(commit_file), p_lsn,
+                            p_buf_end);
+            buf_get(&commit_offset, sizeof(commit_offset), p_lsn, p_buf_end);
         }
 
 #if 0
@@ -8084,9 +8304,10 @@ static void net_sorese_signal(void *hndl, void *uptr, char *fromhost,
             uint8_t *p_buf_end = (p_buf + sizeof(struct errstat));
             osqlcomm_errstat_type_get(&errstat, p_buf, p_buf_end);
 
-            osql_chkboard_sqlsession_rc(rqid, uuid, 0, NULL, &errstat, NULL, fromhost);
+            osql_chkboard_sqlsession_rc(rqid, uuid, 0, NULL, &errstat, NULL, 0, 0, fromhost);
         } else {
-            osql_chkboard_sqlsession_rc(rqid, uuid, done.nops, NULL, NULL, p_effects, fromhost);
+            osql_chkboard_sqlsession_rc(rqid, uuid, done.nops, NULL, NULL, p_effects, commit_file, commit_offset,
+                                        fromhost);
         }
 
     } else {
@@ -107,6 +107,22 @@ int osql_send_insrec(osql_target_t *target, unsigned long long rqid,
                      unsigned long long dirty_keys, char *pData, int nData,
                      int type, int upsert_flags);
 
+/**
+ * Append an insert row to a packed batch
+ * Returns 0, or -1 if the batch cannot grow
+ *
+ */
+int osql_insbatch_add(struct osql_insbatch *batch, unsigned long long dirty_keys,
+                      char *pData, int nData);
+
+/**
+ * Send the rows of a packed batch as one OSQL_INSERT, and empty it
+ * It handles remote/local connectivity
+ *
+ */
+int osql_send_insbatch(osql_target_t *target, uuid_t uuid,
+                       struct osql_insbatch *batch, int type);
+
 /**
  * Send DELREC op
  * It handles remote/local connectivity
@@ -225,6 +241,17 @@ int osql_send_updstat(osql_target_t *target, unsigned long long rqid,
 int osql_comm_signal_sqlthr_rc(osql_target_t *target, unsigned long long rqid,
                                uuid_t uuid, int nops, struct errstat *xerr,
                                snap_uid_t *snap, int rc);
+
+/**
+ * Same as osql_comm_signal_sqlthr_rc, also passing the commit lsn of the
+ * transaction so the sql thread can hand it to the client
+ *
+ */
+int osql_comm_signal_sqlthr_rc_lsn(osql_target_t *target,
+                                   unsigned long long rqid, uuid_t uuid,
+                                   int nops, struct errstat *xerr,
+                                   snap_uid_t *snap, int rc, int commit_file,
+                                   int commit_offset);
 /**
  * if anything goes wrong during master bplog processing,
  * let replicant know (wrapper around signal_sqlthr_rc)
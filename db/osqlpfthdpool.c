@@ -621,6 +621,20 @@ int osql_page_prefault(char *rpl, int rplen, struct dbtable **last_db,
         uint8_t *p_buf = (uint8_t *)&((osql_ins_rpl_t *)rpl)->dt;
         pData = (uint8_t *)osqlcomm_ins_type_get(&dt, p_buf, p_buf_end,
                                                  rpl_op.type == OSQL_INSREC);
+        if (rpl_op.type == OSQL_INSERT && (dt.flags & OSQL_INSERT_BATCH)) {
+            const uint8_t *p_row = pData, *p_row_end = pData + dt.nData;
+            osql_insbatch_row_t row;
+            int nrows = 0;
+            p_row = buf_get(&nrows, sizeof(nrows), p_row, p_row_end);
+            for (int i = 0; p_row && i < nrows; ++i) {
+                if (!(p_row = osqlcomm_insbatch_row_get(&row, p_row, p_row_end)))
+                    break;
+                enque_osqlpfault_newdata_newkeys(*last_db, (void *)row.pData,
+                                                 row.nData, last_step_idex,
+                                                 rqid, uuid, seq);
+            }
+            break;
+        }
         enque_osqlpfault_newdata_newkeys(*last_db, pData, dt.nData,
                                          last_step_idex, rqid, uuid, seq);
     } break;
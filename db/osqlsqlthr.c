@@ -61,6 +61,7 @@ extern int gbl_expressions_indexes;
 extern int gbl_reorder_socksql_no_deadlock;
 
 int gbl_allow_bplog_restarts = 600;
+int gbl_osql_insert_batch = 0; /* max bytes of rows packed per OSQL_INSERT */
 int gbl_master_retry_poll_ms = 100;
 int gbl_noleader_retry_duration_ms = 50 * 1000; /* wait up to 50 seconds for a new leader */
 int gbl_noleader_retry_poll_ms = 10;
@@ -531,6 +532,26 @@ inline int osql_updstat(struct BtCursor *pCur, struct sql_thread *thd,
                                    NET_OSQL_SOCK_RPL);
 }
 
+/* Rows of an array insert are packed while the table has no blobs or
+ * indexes on expressions, and the row is not an upsert. */
+static int osql_insbatch_allowed(struct BtCursor *pCur, osqlstate_t *osql,
+                                 int flags)
+{
+    return osql->insbatch_on && !osql->is_reorder_on && flags == 0 &&
+           osql->rqid == OSQL_RQID_USE_UUID && pCur->db->numblobs == 0 &&
+           !(gbl_expressions_indexes && pCur->db->ix_expr);
+}
+
+static int osql_insbatch_send(struct sqlclntstate *clnt)
+{
+    osqlstate_t *osql = &clnt->osql;
+    int rc = osql_send_insbatch(&osql->target, osql->uuid, &osql->insbatch,
+                                NET_OSQL_SOCK_RPL);
+    if (rc == 0)
+        osql->replicant_numops++;
+    return rc;
+}
+
 /**
  * Process the sending part for insrec
  */
@@ -544,6 +565,24 @@ static int osql_send_ins_logic(struct BtCursor *pCur, struct sql_thread *thd,
     if (rc != SQLITE_OK)
         return rc;
 
+    if (osql_insbatch_allowed(pCur, osql, flags)) {
+        /* the batch only holds rows already saved in the shadow tables, so a
+         * restart replays them and starts a new one */
+        if (osql->insbatch.nrows &&
+            osql->insbatch.len + nData > gbl_osql_insert_batch &&
+            (rc = osql_insbatch_send(thd->clnt)) != 0)
+            return rc;
+        if (osql_insbatch_add(&osql->insbatch,
+                              (gbl_partial_indexes && pCur->db->ix_partial)
+                                  ? thd->clnt->ins_keys
+                                  : -1ULL,
+                              pData, nData))
+            return SQLITE_NOMEM;
+        return SQLITE_OK;
+    }
+    if (osql->insbatch.nrows && (rc = osql_insbatch_send(thd->clnt)) != 0)
+        return rc;
+
     if (osql->is_reorder_on) {
         rc = osql_send_insrec(
             &osql->target, osql->rqid, osql->uuid, pCur->genid,
@@ -644,6 +683,42 @@ int osql_insrec(struct BtCursor *pCur, struct sql_thread *thd, char *pData,
     return rc;
 }
 
+/**
+ * Pack the rows of an array insert into batched OSQL_INSERTs until
+ * osql_insbatch_end
+ *
+ */
+void osql_insbatch_begin(struct sqlclntstate *clnt)
+{
+    clnt->osql.insbatch_on = gbl_osql_insert_batch > 0;
+}
+
+/**
+ * Send the rows still packed and stop packing
+ * Returns SQLITE_OK if successful.
+ *
+ */
+int osql_insbatch_end(struct sqlclntstate *clnt)
+{
+    osqlstate_t *osql = &clnt->osql;
+    int restarted;
+    int rc = 0;
+
+    osql->insbatch_on = 0;
+    if (osql->insbatch.nrows == 0)
+        return SQLITE_OK;
+
+    rc = osql_insbatch_send(clnt);
+    RESTART_SOCKSQL;
+    if (restarted) /* the shadow tables replayed the packed rows */
+        return SQLITE_OK;
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s:%d %s - failed to send socksql rows rc=%d\n",
+               __FILE__, __LINE__, __func__, rc);
+    }
+    return rc;
+}
+
 /**
  * process the sending of updrec
  */
@@ -897,6 +972,8 @@ static int osql_sock_restart(struct sqlclntstate *clnt, int maxretries,
         sentops = 0;
 
         osql->replicant_numops = 0;
+        /* the shadow tables replay any packed rows */
+        osql->insbatch.nrows = osql->insbatch.len = 0;
         if (osql->tablename) {
             free(osql->tablename);
             osql->tablename = NULL;
@@ -1042,6 +1119,11 @@ int osql_sock_commit(struct sqlclntstate *clnt, int type, enum trans_clntcomm si
 
     assert(osql->sock_started);
 
+    if ((rc = osql_insbatch_end(clnt)) != 0) {
+        rcout = SQLITE_CLIENT_CHANGENODE;
+        goto err;
+    }
+
     /* send results of sql processing to block master */
     /* if (thd->clnt->query_stats)*/
 
@@ -1293,6 +1375,7 @@ int osql_sock_abort(struct sqlclntstate *clnt, int type)
     clnt->osql.sentops = 0;  /* reset statement size counter*/
     clnt->osql.tran_ops = 0; /* reset transaction size counter*/
     clnt->osql.replicant_numops = 0; /* reset replicant numops counter*/
+    clnt->osql.insbatch.nrows = clnt->osql.insbatch.len = 0;
 
     osql_shadtbl_close(clnt);
 
@@ -1350,6 +1433,10 @@ static int osql_send_usedb_logic_int(char *tablename, struct sqlclntstate *clnt,
         osql->tablenamelen = 0;
     }
 
+    /* packed rows belong to the previous table */
+    if (osql->insbatch.nrows && (rc = osql_insbatch_send(clnt)) != 0)
+        return rc;
+
     do {
         rc = osql_send_usedb(&osql->target, osql->rqid, osql->uuid, tablename,
                              nettype, comdb2_table_version(tablename));
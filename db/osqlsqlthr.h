@@ -147,6 +147,19 @@ int osql_sock_commit(struct sqlclntstate *clnt, int type, enum trans_clntcomm si
  */
 int osql_sock_abort(struct sqlclntstate *clnt, int type);
 
+/**
+ * Pack the rows of an array insert into batched OSQL_INSERTs until
+ * osql_insbatch_end
+ *
+ */
+void osql_insbatch_begin(struct sqlclntstate *clnt);
+
+/**
+ * Send the rows still packed and stop packing
+ *
+ */
+int osql_insbatch_end(struct sqlclntstate *clnt);
+
 /**
  * busy bee,
  * comment me
@@ -1985,6 +1985,19 @@ clipper_usage:
             logmsg(LOGMSG_ERROR, "cache coll: %u\n", rcache_collide);
         }
 #endif
+        else if (tokcmp(tok, ltok, "ahi") == 0) {
+            extern uint64_t bt_ahi_hits, bt_ahi_misses, bt_ahi_saved,
+                bt_ahi_invalid;
+            logmsg(LOGMSG_USER, "ahi hits: %" PRIu64 "\n", bt_ahi_hits);
+            logmsg(LOGMSG_USER, "ahi miss: %" PRIu64 "\n", bt_ahi_misses);
+            logmsg(LOGMSG_USER, "ahi save: %" PRIu64 "\n", bt_ahi_saved);
+            logmsg(LOGMSG_USER, "ahi invd: %" PRIu64 "\n", bt_ahi_invalid);
+        }
+        else if (tokcmp(tok, ltok, "keypfx") == 0) {
+            extern uint64_t bt_keypfx_hits, bt_keypfx_narrowed;
+            logmsg(LOGMSG_USER, "keypfx hits: %" PRIu64 "\n", bt_keypfx_hits);
+            logmsg(LOGMSG_USER, "keypfx narrowed: %" PRIu64 "\n", bt_keypfx_narrowed);
+        }
         else if (tokcmp(tok, ltok, "autoanalyze") == 0) {
             stat_auto_analyze();
         } else if (tokcmp(tok, ltok, "alias") == 0) {
@@ -55,6 +55,7 @@
 #include "gettimeofday_ms.h"
 #include "eventlog.h"
 #include "tohex.h"
+#include "views.h"
 
 extern int gbl_partial_indexes;
 extern int gbl_expressions_indexes;
@@ -660,6 +661,12 @@ int add_record(struct ireq *iq, void *trans, const uint8_t *p_buf_tag_name,
         if (retrc) {
             ERR("live_sc_post rc %d", rc);
         }
+
+        if (iq->usedb->summary_state) {
+            retrc = views_summary_drop(iq, trans, iq->usedb);
+            if (retrc)
+                ERR("views_summary_drop rc %d", retrc);
+        }
     }
 
     dbglog_record_db_write(iq, "insert");
@@ -1633,6 +1640,12 @@ int upd_record(struct ireq *iq, void *trans, void *primkey, int rrn,
         ERR("live_sc_post_update", 0);
     }
 
+    if (iq->usedb->summary_state) {
+        retrc = views_summary_drop(iq, trans, iq->usedb);
+        if (retrc)
+            ERR("views_summary_drop rc %d", retrc);
+    }
+
     ATOMIC_ADD64(iq->usedb->write_count[RECORD_WRITE_UPD], 1);
     if (is_event_from_cascade(flags))
         iq->usedb->casc_write_count++;
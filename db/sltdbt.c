@@ -492,9 +492,10 @@ int handle_ireq(struct ireq *iq)
 
             if (iq->sorese->rqid == 0)
                 abort();
-            osql_comm_signal_sqlthr_rc(
+            osql_comm_signal_sqlthr_rc_lsn(
                 &iq->sorese->target, iq->sorese->rqid, iq->sorese->uuid,
-                iq->sorese->nops, &iq->errstat, IQ_SNAPINFO(iq), sorese_rc);
+                iq->sorese->nops, &iq->errstat, IQ_SNAPINFO(iq), sorese_rc,
+                iq->commit_file, iq->commit_offset);
 
             iq->timings.req_sentrc = osql_log_time();
 
@@ -90,6 +90,7 @@ struct fingerprint_track {
     int alert_once_query_plan; /* Alert only once if there is a better query plan for a query. Init to 1 */
     int alert_once_query_plan_max; /* Alert (once) if hit max number of plans for associated query. Init to 1 */
     int alert_once_truncated_col;  /* Alert once if we truncated some col in the query. Init to 1 */
+    struct latency_hist *latency;  /* Distribution of execution times, if latency_histograms */
 };
 
 struct sql_authorizer_state {
@@ -152,6 +153,14 @@ typedef struct {
 } shadbq_t;
 
 struct srs_tran;
+/* Insert rows packed into one OSQL_INSERT message, see osql_send_insbatch */
+struct osql_insbatch {
+    uint8_t *buf; /* row count, then dirty keys, length and record per row */
+    int len;
+    int alloc;
+    int nrows;
+};
+
 typedef struct osqlstate {
 
     /* == sql_thread == */
@@ -215,6 +224,10 @@ typedef struct osqlstate {
 
     /* set to 1 if we have already called osql_sock_start in socksql mode */
     unsigned sock_started : 1;
+
+    /* set while an array insert packs its rows into insbatch */
+    unsigned insbatch_on : 1;
+    struct osql_insbatch insbatch;
 } osqlstate_t;
 
 enum ctrl_sqleng {
@@ -462,6 +475,7 @@ struct plugin_callbacks {
     get_snapshot_func *get_snapshot; /* newsql_get_snapshot */
     plugin_func *upd_snapshot; /* newsql_update_snapshot */
     plugin_func *clr_snapshot; /* newsql_clear_snapshot */
+    get_snapshot_func *get_read_lsn; /* newsql_get_read_lsn */
 
     plugin_func *has_high_availability; /* newsql_has_high_availability */
     plugin_func *set_high_availability; /* newsql_set_high_availability */
@@ -532,6 +546,7 @@ struct plugin_callbacks {
         make_plugin_callback(clnt, name, get_snapshot);                        \
         make_plugin_callback(clnt, name, upd_snapshot);                        \
         make_plugin_callback(clnt, name, clr_snapshot);                        \
+        make_plugin_callback(clnt, name, get_read_lsn);                        \
         make_plugin_callback(clnt, name, has_high_availability);               \
         make_plugin_callback(clnt, name, set_high_availability);               \
         make_plugin_callback(clnt, name, clr_high_availability);               \
@@ -618,6 +633,8 @@ struct sqlworkstate {
     struct sql_state rec; /* Prepared statement for original SQL query. */
     unsigned char aFingerprint[FINGERPRINTSZ]; /* MD5 of normalized SQL. */
     char zRuleRes[300];   /* Ruleset match result, if any. */
+    uint64_t iSchedFlow;  /* Fair queuing flow: ruleset rule + fingerprint. */
+    int64_t iSchedCost;   /* Average past cost of fingerprint, -1 if none. */
 };
 
 struct sql_hist_cost {
@@ -887,6 +904,7 @@ struct sqlclntstate {
     uint8_t queue_me;
     uint8_t fail_dispatch;
     uint8_t in_sqlite_init; /* clnt is in sqlite init phase when this is set */
+    uint8_t defer_commit;   /* sqlite3BtreeCommit keeps the transaction open */
     uint8_t secure;         /* clnt is forwarded from pmux over the secure port, */
 
     int where_trace_flags;
@@ -990,6 +1008,10 @@ struct sqlclntstate {
     uint32_t last_checkpoint_lsn_file;
     uint32_t last_checkpoint_lsn_offset;
 
+    /* Commit LSN of the last write, returned to the client as a read token */
+    uint32_t commit_lsn_file;
+    uint32_t commit_lsn_offset;
+
     void *modsnap_registration; 
     
     int modsnap_in_progress; 
@@ -1329,6 +1351,8 @@ int sql_mem_init(void *);
 int sql_mem_init_with_save(void *, void **);
 void sql_mem_shutdown(void *);
 void sql_mem_shutdown_and_restore(void *, void **);
+void sql_mem_enable_arena(void);
+void sql_mem_reset_arena(void);
 
 int sqlite3_open_serial(const char *filename, sqlite3 **, struct sqlthdstate *);
 int sqlite3_close_serial(sqlite3 **);
@@ -1515,6 +1539,7 @@ void clnt_query_cost(struct sqlthdstate *thd, double *pCost, int64_t *pPrepMs);
 int clear_fingerprints(int *plans_count);
 void calc_fingerprint(const char *zNormSql, size_t *pnNormSql,
                       unsigned char fingerprint[FINGERPRINTSZ]);
+int64_t fingerprint_avg_cost(const unsigned char fingerprint[FINGERPRINTSZ]);
 void add_fingerprint(struct sqlclntstate *, sqlite3_stmt *, struct string_ref *, const char *, int64_t, int64_t,
                      int64_t, int64_t, struct reqlogger *, unsigned char *, int);
 
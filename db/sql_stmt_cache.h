@@ -83,6 +83,7 @@ struct sql_state {
     void *query_data;               /* data associated with sql */
     stmt_cache_entry_t *stmt_entry; /* fast pointer to hashed record */
     int prepFlags;                  /* flags to get_prepared_stmt_int */
+    int array_rows;                 /* array insert: elements per param */
 };
 
 stmt_cache_t *stmt_cache_new(stmt_cache_t *);
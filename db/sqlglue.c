@@ -90,6 +90,7 @@
 #include <genid.h>
 #include <strbuf.h>
 #include <thread_malloc.h>
+#include "dohsql.h"
 #include "fdb_fend.h"
 #include "fdb_access.h"
 #include "bdb_osqlcur.h"
@@ -5082,6 +5083,12 @@ int sqlite3BtreeCommit(Btree *pBt)
     if (clnt->selectv_arr)
         currangearr_coalesce(clnt->selectv_arr);
 
+    /* array insert with more elements to go, see step_array_insert */
+    if (clnt->defer_commit) {
+        rc = SQLITE_OK;
+        goto done;
+    }
+
     if (!clnt->in_sqlite_init && (clnt->ctrl_sqlengine != SQLENG_INTRANS_STATE) && (clnt->ctrl_sqlengine != SQLENG_STRT_STATE)) {
         clnt->modsnap_in_progress = 0;
         if (clnt->modsnap_registration) {
@@ -8498,6 +8505,16 @@ sqlite3BtreeCursor_cursor(Btree *pBt,      /* The btree */
         return rc;
     }
 
+    /* parallel stripe scan: this engine only reads its own stripes */
+    int stripe_lo, stripe_hi;
+    if (cur->ixnum == -1 &&
+        dohsql_scan_stripes(clnt, cur->db->tablename, &stripe_lo, &stripe_hi) &&
+        cur->bdbcur->setstripes(cur->bdbcur, stripe_lo, stripe_hi)) {
+        logmsg(LOGMSG_ERROR, "%s: failed to restrict %s to stripes %d-%d\n",
+               __func__, cur->db->tablename, stripe_lo, stripe_hi);
+        return SQLITE_INTERNAL;
+    }
+
     if (gbl_expressions_indexes && !clnt->isselect && cur->db->ix_expr) {
         if (!clnt->idxInsert)
             clnt->idxInsert = calloc(MAXINDEX, sizeof(uint8_t *));
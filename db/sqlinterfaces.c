@@ -108,6 +108,7 @@
 #include "dohsql.h"
 #include "comdb2_query_preparer.h"
 #include "string_ref.h"
+#include "latency_hist.h"
 
 #include "osqlsqlsocket.h"
 #include <net_appsock.h>
@@ -150,6 +151,7 @@ extern int gbl_alternate_normalize;
 extern int gbl_typessql;
 extern int gbl_modsnap_asof;
 extern int gbl_use_modsnap_for_snapshot;
+extern int gbl_latency_histograms;
 
 /* Once and for all:
 
@@ -198,9 +200,18 @@ int gbl_dump_history_on_too_many_verify_errors = 0;
 int gbl_thdpool_queue_only = 0;
 int gbl_random_sql_work_delayed = 0;
 int gbl_random_sql_work_rejected = 0;
+int gbl_sql_sched = 0;
+int gbl_sql_sched_long_cost = 100000;
+int gbl_sql_sched_short_weight = 4;
+int gbl_sql_sched_long_weight = 1;
+int gbl_sql_sched_long_maxthds = 0;
+
+/* sql pool scheduling classes */
+enum { SQL_SCHED_SHORT = 0, SQL_SCHED_LONG = 1 };
 
 comdb2_query_preparer_t *query_preparer_plugin;
 int gbl_sql_recover_time = 10;
+int gbl_sql_array_insert = 0;
 int gbl_debug_recover_deadlock_evbuffer = 0;
 
 void rcache_init(size_t, size_t);
@@ -653,6 +664,53 @@ static TAILQ_HEAD(lru_evbuffers, sqlclntstate) lru_evbuffers = TAILQ_HEAD_INITIA
 static TAILQ_HEAD(sql_evbuffers, sqlclntstate) sql_evbuffers = TAILQ_HEAD_INITIALIZER(sql_evbuffers);
 
 static __thread comdb2ma sql_mspace = NULL;
+
+/* Statement arena. Memory that is released by the time a statement is
+   done (registers, unpacked keys) is bumped out of it and given back all
+   at once after each request. Only sql engine threads have one; the
+   threads they spawn (e.g. sorter threads) allocate normally. Btree cursor
+   buffers stay off it, since they are grown and freed with plain
+   realloc() and free(). */
+int gbl_sql_arena_kb = 0;
+int gbl_sql_arena_chunk_kb = 64;
+static __thread int sql_arena_enabled = 0;
+static __thread comdb2arena sql_arena = NULL;
+static __thread comdb2ma sql_arena_mspace = NULL;
+
+static comdb2arena sql_get_arena(void)
+{
+    if (!sql_arena_enabled || gbl_sql_arena_kb <= 0 || sql_mspace == NULL)
+        return NULL;
+    if (unlikely(sql_arena == NULL)) {
+        size_t cap = (size_t)gbl_sql_arena_kb * 1024;
+        size_t chunk = (size_t)gbl_sql_arena_chunk_kb * 1024;
+        if (chunk == 0 || chunk > cap)
+            chunk = cap;
+        sql_arena = comdb2arena_create(sql_mspace, chunk, cap, "SQLITE arena");
+        sql_arena_mspace = sql_mspace;
+    }
+    return sql_arena;
+}
+
+void sql_mem_enable_arena(void)
+{
+    sql_arena_enabled = 1;
+}
+
+uint64_t gbl_sql_arena_resets = 0;
+uint64_t gbl_sql_arena_busy_resets = 0;
+
+/* Called when a request is done. Chunks with something allocated from the
+   arena still around are left out until a later reset. */
+void sql_mem_reset_arena(void)
+{
+    if (sql_arena == NULL)
+        return;
+    if (comdb2arena_reset(sql_arena) != 0)
+        ATOMIC_ADD64(gbl_sql_arena_busy_resets, 1);
+    ATOMIC_ADD64(gbl_sql_arena_resets, 1);
+}
+
 static void sql_mem_create()
 {
     /* We used to start with 1MB - this isn't quite necessary
@@ -686,6 +744,11 @@ int sql_mem_init_with_save(void *arg, void **poldm)
 
 void sql_mem_shutdown(void *arg)
 {
+    if (sql_arena && sql_arena_mspace == sql_mspace) {
+        comdb2arena_destroy(sql_arena);
+        sql_arena = NULL;
+        sql_arena_mspace = NULL;
+    }
     if (sql_mspace) {
         comdb2ma_destroy(sql_mspace);
         sql_mspace = NULL;
@@ -703,6 +766,12 @@ static void *sql_mem_malloc(size_t size)
     if (unlikely(sql_mspace == NULL))
         sql_mem_init(NULL);
 
+    if (sqlite3StmtAllocScope) {
+        comdb2arena ar = sql_get_arena();
+        void *p;
+        if (ar && (p = comdb2arena_malloc(ar, size)) != NULL)
+            return p;
+    }
     return comdb2_malloc(sql_mspace, size);
 }
 
@@ -1219,6 +1288,61 @@ static tsql_meta_command_t is_transaction_meta(struct sqlclntstate *clnt)
     return is_transaction_meta_sql(clnt->sql);
 }
 
+/* Add the statement time to the histograms of the local tables it used,
+   as a write if any of its cursors wrote the table. */
+static void record_table_latency(struct sql_thread *thd, int64_t us)
+{
+    struct {
+        struct dbtable *db;
+        int op;
+    } used[16];
+    int nused = 0;
+    struct query_path_component *c;
+
+    LISTC_FOR_EACH(&thd->query_stats, c, lnk)
+    {
+        if (c->rmt_db[0] || !c->lcl_tbl_name[0])
+            continue;
+        if (c->nfind == 0 && c->nnext == 0 && c->nwrite == 0)
+            continue;
+        struct dbtable *db = get_dbtable_by_name(c->lcl_tbl_name);
+        if (db == NULL)
+            continue;
+        int op = c->nwrite ? TABLE_LATENCY_WRITE : TABLE_LATENCY_READ;
+        int i;
+        for (i = 0; i < nused; i++) {
+            if (used[i].db == db)
+                break;
+        }
+        if (i == nused) {
+            if (nused == sizeof(used) / sizeof(used[0]))
+                continue;
+            used[nused].db = db;
+            used[nused].op = op;
+            nused++;
+        } else if (op == TABLE_LATENCY_WRITE) {
+            used[i].op = op;
+        }
+    }
+
+    for (int i = 0; i < nused; i++) {
+        struct dbtable *db = used[i].db;
+        struct latency_hist *h = ATOMIC_LOAD64(db->latency[used[i].op]);
+        if (h == NULL) {
+            struct latency_hist *newh = latency_hist_new();
+            if (newh == NULL)
+                continue;
+            if (CAS64(db->latency[used[i].op], h, newh)) {
+                h = newh;
+            } else {
+                latency_hist_free(newh);
+                h = ATOMIC_LOAD64(db->latency[used[i].op]);
+            }
+        }
+        latency_hist_add(h, us);
+    }
+}
+
 /* Save copy of sql statement and performance data.  If any other code
    should run after a sql statement is completed it should end up here. */
 static void sql_statement_done(struct sql_thread *thd, struct reqlogger *logger,
@@ -1292,6 +1416,9 @@ static void sql_statement_done(struct sql_thread *thd, struct reqlogger *logger,
         reqlog_set_path(logger, clnt->query_stats);
     }
 
+    if (gbl_latency_histograms)
+        record_table_latency(thd, reqlog_current_us(logger));
+
     if (gbl_fingerprint_queries) {
         if (h->sql_ref) {
             if ((is_lua = is_stored_proc_sql(string_ref_cstr(h->sql_ref)))) {
@@ -2649,9 +2776,9 @@ static int reload_analyze(struct sqlthdstate *thd, struct sqlclntstate *clnt,
     if (analyze_running_flag)
         return 0;
 
-    /* a change in disableskipscan comes on replicant as a sc_analyze scdone log
-     * read here the llmeta entries for that tunable (instead of deep down in
-     * sqlite3AnalysisLoad)
+    /* a change in disableskipscan, or in a time partition shard summary,
+     * comes on replicant as a sc_analyze scdone log; read here the llmeta
+     * entries for those (instead of deep down in sqlite3AnalysisLoad)
      */
     get_disable_skipscan_all();
 
@@ -3433,6 +3560,183 @@ out:if (rc) {
     return rc;
 }
 
+/* An INSERT or REPLACE with parameters bound to arrays of equal length, and
+ * not reading them through carray(), is run once per array element (see
+ * step_array_insert).  Returns the number of elements, or 0 if the statement
+ * does not qualify.
+ */
+static int array_insert_rows(struct sqlclntstate *clnt, sqlite3_stmt *stmt)
+{
+    if (!gbl_sql_array_insert || sqlite3_is_prepare_only(clnt) ||
+        sqlite3_stmt_readonly(stmt) || sqlite3_column_count(stmt) != 0)
+        return 0;
+    if (!stmt_inserts_rows(stmt) || stmt_reads_vtab_module(stmt, "carray"))
+        return 0;
+
+    int rows = 0;
+    int params = param_count(clnt);
+    struct param_data p;
+    for (int i = 0; i < params; ++i) {
+        memset(&p, 0, sizeof(p));
+        if (param_value(clnt, &p, i) != 0)
+            return 0;
+        if (p.null || p.type == COMDB2_NULL_TYPE || p.arraylen == 0)
+            continue;
+        if (rows != 0 && rows != p.arraylen)
+            return 0;
+        rows = p.arraylen;
+    }
+    return rows;
+}
+
+/* The array-bound parameters of an array insert, decoded once for all rows. */
+struct array_insert {
+    struct sqlclntstate *clnt;
+    sqlite3_stmt *stmt;
+    struct param_data *params;
+    int nparams;
+    int row;
+    int rows;
+};
+
+static int array_insert_init(struct array_insert *a, struct sqlclntstate *clnt,
+                             struct sql_state *rec)
+{
+    int params = param_count(clnt);
+    struct param_data p;
+
+    memset(a, 0, sizeof(*a));
+    a->clnt = clnt;
+    a->stmt = rec->stmt;
+    a->rows = rec->array_rows;
+    if ((a->params = calloc(params, sizeof(struct param_data))) == NULL)
+        return SQLITE_NOMEM;
+    for (int i = 0; i < params; ++i) {
+        memset(&p, 0, sizeof(p));
+        if (param_value(clnt, &p, i) != 0)
+            return SQLITE_ERROR;
+        if (p.null || p.type == COMDB2_NULL_TYPE || p.arraylen == 0)
+            continue;
+        if (p.pos == 0)
+            p.pos = sqlite3_bind_parameter_index(a->stmt, p.name);
+        a->params[a->nparams++] = p;
+    }
+    return SQLITE_OK;
+}
+
+/* Replace the array bindings by their element at index row.  While the
+ * statement runs (the array loop), the values are set with stmt_rebind_*().
+ */
+static int bind_array_row(struct array_insert *a, int row, int running)
+{
+    sqlite3_stmt *stmt = a->stmt;
+    int rc = 0;
+    for (int i = 0; i < a->nparams && rc == 0; ++i) {
+        struct param_data *p = &a->params[i];
+        switch (p->type) {
+        case CLIENT_INT: {
+            int64_t v = p->len == sizeof(int32_t) ? ((int32_t *)p->u.p)[row]
+                                                  : ((int64_t *)p->u.p)[row];
+            rc = running ? stmt_rebind_int64(stmt, p->pos, v)
+                         : sqlite3_bind_int64(stmt, p->pos, v);
+            break;
+        }
+        case CLIENT_REAL: {
+            double v = ((double *)p->u.p)[row];
+            rc = running ? stmt_rebind_double(stmt, p->pos, v)
+                         : sqlite3_bind_double(stmt, p->pos, v);
+            break;
+        }
+        case CLIENT_CSTR:
+        case CLIENT_VUTF8: {
+            char *v = ((char **)p->u.p)[row];
+            rc = running ? stmt_rebind_text(stmt, p->pos, v, -1)
+                         : sqlite3_bind_text(stmt, p->pos, v, -1, NULL);
+            break;
+        }
+        case CLIENT_BLOB: {
+            struct cdb2vec *v = (struct cdb2vec *)p->u.p + row;
+            rc = running ? stmt_rebind_blob(stmt, p->pos, v->iov_base, v->iov_len)
+                         : sqlite3_bind_blob(stmt, p->pos, v->iov_base,
+                                             v->iov_len, NULL);
+            break;
+        }
+        default:
+            rc = SQLITE_ERROR;
+            break;
+        }
+    }
+    return rc;
+}
+
+/* Called by OP_Halt after each row of the array loop. */
+static int array_insert_next_row(void *arg)
+{
+    struct array_insert *a = arg;
+    if (++a->row < a->rows)
+        return bind_array_row(a, a->row, 1) == SQLITE_OK ? SQLITE_ROW
+                                                         : SQLITE_ERROR;
+    /* the rows are sent before the statement commits */
+    return osql_insbatch_end(a->clnt) == SQLITE_OK ? SQLITE_DONE : SQLITE_ERROR;
+}
+
+uint64_t gbl_sql_array_insert_loops = 0;
+
+/* Run an array insert.  When the program qualifies (stmt_set_array_loop), it
+ * executes once: OP_Halt rebinds the next element and loops back to the row
+ * segment, and the osql rows are packed into OSQL_INSERT batches when the
+ * osql_insert_batch tunable is set.  Otherwise it is stepped once per
+ * element; outside a client transaction the rows then share one transaction:
+ * sqlite3BtreeCommit leaves it open while clnt->defer_commit is set, which is
+ * cleared before the last element, and an error on an earlier element aborts
+ * it.
+ */
+static int step_array_insert(struct sqlclntstate *clnt, struct sql_state *rec)
+{
+    struct array_insert a;
+    sqlite3_stmt *stmt = rec->stmt;
+    int standalone = clnt->ctrl_sqlengine == SQLENG_NORMAL_PROCESS;
+    int rc;
+
+    if ((rc = array_insert_init(&a, clnt, rec)) != SQLITE_OK)
+        goto out;
+
+    if (stmt_set_array_loop(stmt, array_insert_next_row, &a)) {
+        gbl_sql_array_insert_loops++;
+        osql_insbatch_begin(clnt);
+        if ((rc = bind_array_row(&a, 0, 0)) == SQLITE_OK)
+            rc = next_row(clnt, stmt);
+        stmt_set_array_loop(stmt, NULL, NULL);
+        /* rows packed before an error inside a client transaction */
+        if (osql_insbatch_end(clnt) != SQLITE_OK && rc == SQLITE_DONE)
+            rc = SQLITE_ERROR;
+        goto out;
+    }
+
+    clnt->defer_commit = 1;
+    for (int row = 0; row < a.rows; ++row) {
+        if (row > 0)
+            sqlite3_reset(stmt);
+        if (row == a.rows - 1)
+            clnt->defer_commit = 0;
+        if ((rc = bind_array_row(&a, row, 0)) != 0)
+            break;
+        if ((rc = next_row(clnt, stmt)) != SQLITE_DONE)
+            break;
+    }
+    if (clnt->defer_commit) {
+        clnt->defer_commit = 0;
+        if (standalone && clnt->intrans) {
+            abort_dbtran(clnt);
+            sql_set_sqlengine_state(clnt, __FILE__, __LINE__,
+                                    SQLENG_NORMAL_PROCESS);
+        }
+    }
+out:
+    free(a.params);
+    return rc;
+}
+
 static int bind_params(struct sqlthdstate *thd, struct sqlclntstate *clnt,
                        struct sql_state *rec, struct errstat *err)
 {
@@ -3440,7 +3744,9 @@ static int bind_params(struct sqlthdstate *thd, struct sqlclntstate *clnt,
     int rc = bind_parameters(thd->logger, rec->stmt, clnt, &errstr, 0);
     if (rc) {
         errstat_set_rcstrf(err, ERR_PREPARE, "%s", errstr);
+        return rc;
     }
+    rec->array_rows = array_insert_rows(clnt, rec->stmt);
     return rc;
 }
 
@@ -3830,7 +4136,7 @@ static int run_stmt(struct sqlthdstate *thd, struct sqlclntstate *clnt,
 
     /* Get first row to figure out column structure */
     clnt->last_sent_row_sec = time(NULL);
-    int steprc = next_row(clnt, stmt);
+    int steprc = rec->array_rows > 0 ? step_array_insert(clnt, rec) : next_row(clnt, stmt);
     if (steprc == SQLITE_SCHEMA_REMOTE) {
         /* remote schema changed;
            Only safe to recover here
@@ -4812,6 +5118,23 @@ static int can_execute_sql_query_now(
   return 1;
 }
 
+int gbl_read_lsn_wait_ms = 1000;
+
+/* A client that wrote through another node sends the commit lsn of that write
+   with its reads; wait for this node to apply it so the read sees the write. */
+static int wait_for_read_lsn(struct sqlclntstate *clnt)
+{
+    int file = 0, offset = 0;
+    if (clnt->ctrl_sqlengine != SQLENG_NORMAL_PROCESS && clnt->ctrl_sqlengine != SQLENG_STRT_STATE)
+        return 0; /* waited at the start of the transaction */
+    if (!clnt->plugin.get_read_lsn || clnt->plugin.get_read_lsn(clnt, &file, &offset) != 0 || file <= 0)
+        return 0;
+    if (bdb_wait_for_lsn_applied(thedb->bdb_env, file, offset, gbl_read_lsn_wait_ms) == 0)
+        return 0;
+    logmsg(LOGMSG_DEBUG, "%s: lsn %d:%d not applied after %dms\n", __func__, file, offset, gbl_read_lsn_wait_ms);
+    return -1;
+}
+
 void sqlengine_work_appsock(struct sqlthdstate *thd, struct sqlclntstate *clnt)
 {
     struct sql_thread *sqlthd = thd->sqlthd;
@@ -4842,13 +5165,18 @@ void sqlengine_work_appsock(struct sqlthdstate *thd, struct sqlclntstate *clnt)
         is_legacy_request = 1;
 
     if (!is_legacy_request) {
-        /* everything going in is cursor based */
-        int rc = get_curtran(thedb->bdb_env, clnt);
+        int rc = wait_for_read_lsn(clnt);
         if (rc) {
+            send_run_error(clnt, "Client api should change nodes",
+                    CDB2ERR_CHANGENODE);
+        } else if ((rc = get_curtran(thedb->bdb_env, clnt)) != 0) {
+            /* everything going in is cursor based */
             logmsg(LOGMSG_ERROR, "%s td %p: unable to get a CURSOR transaction, rc=%d!\n", __func__, (void *)pthread_self(),
                     rc);
             send_run_error(clnt, "Client api should change nodes",
                     CDB2ERR_CHANGENODE);
+        }
+        if (rc) {
             clnt->query_rc = -1;
             clnt->osql.timings.query_finished = osql_log_time();
             osql_log_time_done(clnt);
@@ -4925,6 +5253,7 @@ static void sqlengine_work_appsock_pp(struct thdpool *pool, void *work,
             sqlengine_work_lua_thread(thddata, work);
         else
             sqlengine_work_appsock(thddata, work);
+        sql_mem_reset_arena();
         break;
     case THD_FREE:
         /* we just mark the client done here, with error */
@@ -5049,15 +5378,34 @@ static int enqueue_sql_query(struct sqlclntstate *clnt)
         clnt->queue_me = 1;
     }
 
+    /* Short queries keep their place ahead of long scans sharing the pool:
+     * each query is charged its expected cost against its flow, cheaper
+     * for the short class, and long ones may be capped in concurrency. */
+    struct thdpool_sched sched = {0}, *psched = NULL;
+    if (gbl_sql_sched && !clnt->admin) {
+        int64_t cost = clnt->work.iSchedCost;
+        int bLong = gbl_sql_sched_long_cost > 0 &&
+                    cost >= gbl_sql_sched_long_cost;
+        int weight = bLong ? gbl_sql_sched_long_weight
+                           : gbl_sql_sched_short_weight;
+        if (cost < 1)
+            cost = 1;
+        sched.flow = clnt->work.iSchedFlow;
+        sched.cost = (double)cost / (weight > 0 ? weight : 1);
+        sched.cls = bLong ? SQL_SCHED_LONG : SQL_SCHED_SHORT;
+        sched.maxrun = bLong ? gbl_sql_sched_long_maxthds : 0;
+        psched = &sched;
+    }
+
     struct string_ref *sr = get_ref(clnt->sql_ref);
-    if ((rc = thdpool_enqueue(pool, sqlengine_work_appsock_pp,
-                              clnt, clnt->queue_me, sr, flags)) != 0) {
+    if ((rc = thdpool_enqueue_sched(pool, sqlengine_work_appsock_pp, clnt,
+                                    clnt->queue_me, sr, flags, psched)) != 0) {
         if ((in_client_trans(clnt) || clnt->osql.replay == OSQL_RETRY_DO) &&
             gbl_requeue_on_tran_dispatch) {
             /* force this request to queue */
-            rc = thdpool_enqueue(pool,
-                                 sqlengine_work_appsock_pp, clnt, 1, sr,
-                                 flags | THDPOOL_FORCE_QUEUE);
+            rc = thdpool_enqueue_sched(pool, sqlengine_work_appsock_pp, clnt,
+                                       1, sr, flags | THDPOOL_FORCE_QUEUE,
+                                       psched);
         }
 
         if (rc) {
@@ -5157,25 +5505,56 @@ done:
     return clnt->query_rc;
 }
 
+/* Flow and expected cost of a query for the sql pool scheduler.  Queries
+ * are told apart by the ruleset rule they matched and their fingerprint;
+ * the cost is what the fingerprint averaged so far, since nothing has been
+ * prepared yet. */
+static void sched_classify_sql_query(struct sqlclntstate *clnt, int ruleNo,
+                                     int bFingerprint)
+{
+    uint64_t flow = (uint64_t)(ruleNo + 1) * 0x9e3779b97f4a7c15ULL;
+
+    clnt->work.iSchedCost = -1;
+    if (bFingerprint && clnt->work.zOrigNormSql) {
+        uint64_t fp;
+        memcpy(&fp, clnt->work.aFingerprint, sizeof(fp));
+        flow ^= fp;
+        clnt->work.iSchedCost = fingerprint_avg_cost(clnt->work.aFingerprint);
+    }
+    clnt->work.iSchedFlow = flow;
+}
+
 static int verify_dispatch_sql_query(struct sqlclntstate *clnt)
 {
     memset(clnt->work.zRuleRes, 0, sizeof(clnt->work.zRuleRes));
+    clnt->work.iSchedFlow = 0;
+    clnt->work.iSchedCost = -1;
 
-    if (clnt->admin || !gbl_prioritize_queries || !gbl_ruleset) {
+    int bRuleset = gbl_prioritize_queries && gbl_ruleset;
+    if (clnt->admin || (!bRuleset && !gbl_sql_sched)) {
         return 0;
     }
 
+    int bFingerprint = 0;
     if (gbl_fingerprint_queries &&
         comdb2_ruleset_fingerprints_allowed()) {
         /* IGNORED */
         preview_and_calc_fingerprint(clnt);
+        bFingerprint = !is_transaction_meta(clnt);
     }
 
-    int ruleNo = 0;
+    int ruleNo = -1;
     int bRejected = 0;
     int bTryAgain = 0;
 
+    if (!bRuleset) {
+        sched_classify_sql_query(clnt, ruleNo, bFingerprint);
+        return 0;
+    }
+
     int ret = can_execute_sql_query_now(clnt->thd, clnt, &ruleNo, &bRejected, &bTryAgain);
+    if (gbl_sql_sched)
+        sched_classify_sql_query(clnt, ruleNo, bFingerprint);
     if (ret || !bRejected) {
         return 0;
     }
@@ -5549,6 +5928,8 @@ void reset_clnt(struct sqlclntstate *clnt, int initial)
     free(clnt->prev_cost_string);
     clnt->prev_cost_string = NULL;
     clnt->netwaitus = 0;
+    clnt->commit_lsn_file = 0;
+    clnt->commit_lsn_offset = 0;
 
     if (gbl_sockbplog) {
         init_bplog_socket(clnt);
@@ -7007,6 +7388,10 @@ static int internal_clr_snapshot(struct sqlclntstate *a)
 {
     return -1;
 }
+static int internal_get_read_lsn(struct sqlclntstate *a, int *b, int *c)
+{
+    return -1;
+}
 static int internal_has_high_availability(struct sqlclntstate *a)
 {
     return 0;
@@ -7190,6 +7575,37 @@ done:
     return rc;
 }
 
+/* Run sql and return a malloc-ed copy of the first column of the first row,
+ * if that is a string, NULL otherwise */
+char *run_internal_sql_str(const char *sql)
+{
+    struct sqlclntstate clnt = {0};
+    struct schema_mem sm = {0};
+    Mem mout = {0};
+    char *out = NULL;
+    sm.mout = &mout;
+
+    init_internal_sql_clnt(&clnt, &sm);
+    strcpy(clnt.tzname, "UTC");
+
+    char *stmt = strdup(sql);
+    if (run_internal_sql_clnt(&clnt, stmt) == 0 && (mout.flags & MEM_Str) &&
+        mout.z) {
+        out = malloc(mout.n + 1);
+        if (out) {
+            memcpy(out, mout.z, mout.n);
+            out[mout.n] = '\0';
+        }
+    }
+    if (mout.zMalloc)
+        free(mout.zMalloc);
+
+    end_internal_sql_clnt(&clnt);
+    free(stmt);
+
+    return out;
+}
+
 void end_internal_sql_clnt(struct sqlclntstate *clnt)
 {
     cleanup_clnt(clnt);
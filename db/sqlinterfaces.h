@@ -75,6 +75,7 @@ int run_internal_sql_clnt(struct sqlclntstate *clnt, char *sql);
 int run_internal_sql_function(void *outbuf, struct field *dest, const char *sqlfn,
                               struct schema *sc, blob_buffer_t *outblob, const char *tzname,
                               struct convert_failure *fail_reason);
+char *run_internal_sql_str(const char *sql);
 void end_internal_sql_clnt(struct sqlclntstate *clnt);
 void reset_clnt_flags(struct sqlclntstate *);
 void thr_set_user(const char *label, intptr_t id);
@@ -600,6 +600,8 @@ int osql_clean_sqlclntstate(struct sqlclntstate *clnt)
 
     if (osql->tablename)
         free(osql->tablename);
+    free(osql->insbatch.buf);
+    memset(&osql->insbatch, 0, sizeof(osql->insbatch));
     if (!osql_shadtbl_empty(clnt))
         osql_shadtbl_close(clnt);
     if (osql->history)
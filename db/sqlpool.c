@@ -43,6 +43,7 @@ void sqlengine_thd_start(struct thdpool *pool, struct sqlthdstate *thd,
     backend_thread_event(thedb, COMDB2_THR_EVENT_START_RDWR);
 
     sql_mem_init(NULL);
+    sql_mem_enable_arena();
 
     if (!gbl_use_appsock_as_sqlthread)
         thd->thr_self = thrman_register(type);
@@ -69,11 +69,16 @@ int gbl_nid_dbname = NID_commonName;
 double gbl_min_tls_ver = 0;
 /* (test-only) are connections from localhost always allowed? */
 int gbl_ssl_allow_localhost = 0;
+/* hand established sessions to kernel TLS when the kernel supports it */
+int gbl_ssl_ktls = 0;
 
 /* number of full ssl handshakes */
 uint64_t gbl_ssl_num_full_handshakes = 0;
 /* number of partial ssl handshakes (via session resumption) */
 uint64_t gbl_ssl_num_partial_handshakes = 0;
+/* number of sessions whose record encryption was offloaded to the kernel */
+uint64_t gbl_ssl_num_ktls_send = 0;
+uint64_t gbl_ssl_num_ktls_recv = 0;
 
 ssl_mode gbl_client_ssl_mode = SSL_UNKNOWN;
 ssl_mode gbl_rep_ssl_mode = SSL_UNKNOWN;
@@ -237,6 +242,15 @@ int ssl_process_lrl(char *line, size_t len)
         logmsg(LOGMSG_WARN, "POTENTIAL SECURITY ISSUE: "
                "Plaintext remote SQL is permitted. Please make sure that "
                "the databases are in a secure environment.\n");
+    } else if (tokcmp(line, ltok, "ssl_ktls") == 0) {
+        tok = segtok(line, len, &st, &ltok);
+        gbl_ssl_ktls = (ltok <= 0) ? 1 : toknum(tok, ltok);
+#ifndef SSL_OP_ENABLE_KTLS
+        if (gbl_ssl_ktls)
+            logmsg(LOGMSG_WARN, "`ssl_ktls` requires OpenSSL 3.0 or later "
+                                "built with kTLS. Ignored.\n");
+        gbl_ssl_ktls = 0;
+#endif
     } else if (tokcmp(line, ltok, "ssl_cipher_suites") == 0) {
         /* Get cipher suites. */
         tok = segtok(line, len, &st, &ltok);
@@ -389,6 +403,8 @@ void ssl_stats(void)
 
     logmsg(LOGMSG_USER, "  %" PRId64 " full handshakes, %" PRId64 " partial handshakes\n",
            gbl_ssl_num_full_handshakes, gbl_ssl_num_partial_handshakes);
+    logmsg(LOGMSG_USER, "Kernel TLS: %s, %" PRId64 " tx offloaded, %" PRId64 " rx offloaded\n",
+           gbl_ssl_ktls ? "ON" : "OFF", gbl_ssl_num_ktls_send, gbl_ssl_num_ktls_recv);
 
     logmsg(LOGMSG_USER, "Replicant SSL mode: %s\n",
            ssl_mode_to_string(gbl_rep_ssl_mode));
@@ -60,6 +60,7 @@
 #include "schemachange.h" /* sc_errf() */
 #include "dynschematypes.h"
 #include "fdb_fend.h"
+#include "latency_hist.h"
 
 extern struct dbenv *thedb;
 extern pthread_mutex_t csc2_subsystem_mtx;
@@ -6224,10 +6225,24 @@ void freedb_int(dbtable *db, dbtable *replace)
     }
 
     if (replace) {
+        /* keep the latency history across schema changes */
+        struct latency_hist *latency[TABLE_LATENCY_MAX];
+        memcpy(latency, db->latency, sizeof(latency));
         memcpy(db, replace, sizeof(dbtable));
         db->dbs_idx = dbs_idx;
         db->sqlaliasname = sqlaliasname;
         db->timepartition_name = timepartition_name;
+        for (i = 0; i < TABLE_LATENCY_MAX; i++) {
+            if (db->latency[i] == NULL)
+                db->latency[i] = latency[i];
+            else
+                latency_hist_free(latency[i]);
+        }
+    } else {
+        for (i = 0; i < TABLE_LATENCY_MAX; i++) {
+            latency_hist_free(db->latency[i]);
+            db->latency[i] = NULL;
+        }
     }
 }
 
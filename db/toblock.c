@@ -6316,6 +6316,7 @@ static int toblock_main(struct javasp_trans_state *javasp_trans_handle, struct i
     if (rc == 0) {
         osql_postcommit_handle(iq);
         handle_postcommit_bpfunc(iq);
+        views_summary_postcommit(iq);
     } else {
         osql_postabort_handle(iq);
         handle_postabort_bpfunc(iq);
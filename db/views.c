@@ -1165,6 +1165,7 @@ done:
 
         /*  schedule next */
         if (rc == VIEW_NOERR) {
+            views_summary_freeze(name);
             rc = _view_cron_schedule_next_rollout(view, timeCrtRollout,
                                                   timeNextRollout,
                                                   removeShardName, name, err);
@@ -3150,6 +3151,7 @@ void *_view_cron_new_rollout(struct cron_event *event, struct errstat *err)
         bdb_thread_event(thedb->bdb_env, BDBTHR_EVENT_DONE_RDWR);
 
         if (rc == VIEW_NOERR) {
+            views_summary_freeze(name_dup);
             rc = _view_new_rollout_lkless(name_dup, period, rolltime,
                                           &source_id, err);
             if (rc != VIEW_NOERR) {
@@ -3441,3 +3443,5 @@ done:
 
 #include "views_sqlite.c"
 
+#include "views_summary.c"
+
@@ -508,4 +508,49 @@ int logical_partition_next_rollout(const char *name);
  */
 timepart_view_t *timepart_reaquire_view(const char *partname);
 
+enum views_summary_state {
+    SUMMARY_NONE = 0,     /* no summary, every shard query opens the shard */
+    SUMMARY_FREEZING = 1, /* master is computing the summary */
+    SUMMARY_DIRTY = 2,    /* written while freezing, summary is discarded */
+    SUMMARY_FROZEN = 3    /* min/max are valid and used for pruning */
+};
+
+/**
+ * Compute and persist min/max summaries of the summary column for the
+ * shards of partition "name" that no longer receive inserts; master only,
+ * called without any lock after a rollout
+ *
+ */
+void views_summary_freeze(const char *name);
+
+/**
+ * Load the persisted summary of a table, if any, from llmeta
+ *
+ */
+void views_summary_load(struct dbtable *db, tran_type *tran);
+
+/**
+ * A write into a summarized shard drops its summary as part of the
+ * transaction "trans"; sets iq->summary_dropped
+ *
+ */
+int views_summary_drop(struct ireq *iq, void *trans, struct dbtable *db);
+
+/**
+ * After the commit of a transaction that dropped summaries, make all
+ * nodes reload them
+ *
+ */
+void views_summary_postcommit(struct ireq *iq);
+
+struct Parse;
+struct Select;
+
+/**
+ * Restrict the single table select "p" to the shard summary, if the shard
+ * has one; called by sqlite before the WHERE clause is coded
+ *
+ */
+void comdb2_summary_prune(struct Parse *pParse, struct Select *p);
+
 #endif
@@ -0,0 +1,500 @@
+/**
+ * Min/max summaries for time partition shards
+ *
+ * A query against a partition runs every arm of the UNION ALL view, so a
+ * selective predicate on a timestamp still opens and probes every shard.
+ * Once a shard stops receiving inserts, the master records the min and max
+ * of the column named by "timepart_summary_column" as table parameters of
+ * the shard.  When a single table select over a summarized shard compares
+ * that column with a constant, a constant guard evaluating the comparison
+ * against the summary is ANDed to its WHERE clause; sqlite codes constant
+ * terms ahead of the loop, so a shard that cannot match is never opened.
+ *
+ * Any insert or update into a summarized shard drops its summary in the
+ * same transaction.  Summaries travel like disableskipscan: every node
+ * reloads them, and resets its statement caches, when the analyze
+ * generation moves, which the master bumps after freezing or dropping them.
+ * That bump comes after the commit, so the guard is itself guarded by
+ * comdb2_summary_valid(), which checks at run time that the committed
+ * summary is still the one the statement was prepared with.
+ */
+#include "sqlinterfaces.h"
+
+char *gbl_timepart_summary_column = NULL;
+
+static pthread_mutex_t summary_lk = PTHREAD_MUTEX_INITIALIZER;
+
+#define SUMMARY_COLUMN "summary_column"
+#define SUMMARY_MIN "summary_min"
+#define SUMMARY_MAX "summary_max"
+
+/* types whose text form converts back to the same value; a bound is stored
+ * as "<typeof>:<text>" */
+static const char *_summary_cast_type(const char *bound)
+{
+    static const struct {
+        const char *type;
+        const char *cast;
+    } types[] = {{"integer:", "INTEGER"},
+                 {"text:", "TEXT"},
+                 {"datetime:", "DATETIME"},
+                 {"datetimeus:", "DATETIMEUS"}};
+    int i;
+
+    for (i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+        if (strncmp(bound, types[i].type, strlen(types[i].type)) == 0)
+            return types[i].cast;
+    }
+    return NULL;
+}
+
+/* all values of the column are null, or the shard is empty */
+static int _summary_is_null(const char *bound)
+{
+    return strcmp(bound, "null:") == 0;
+}
+
+/* call with summary_lk held; takes ownership of the strings */
+static void _summary_set(struct dbtable *db, int state, char *col, char *min,
+                         char *max)
+{
+    free(db->summary_col);
+    free(db->summary_min);
+    free(db->summary_max);
+    db->summary_state = state;
+    db->summary_col = col;
+    db->summary_min = min;
+    db->summary_max = max;
+}
+
+/* the column goes last on set and first on clear, so a reader that finds
+ * it also finds matching bounds; col == NULL clears */
+static int _summary_persist(void *tran, const char *tbl, const char *col,
+                            const char *min, const char *max)
+{
+    int rc;
+
+    if (col) {
+        rc = bdb_set_table_parameter(tran, tbl, SUMMARY_MIN, min);
+        if (!rc)
+            rc = bdb_set_table_parameter(tran, tbl, SUMMARY_MAX, max);
+        if (!rc)
+            rc = bdb_set_table_parameter(tran, tbl, SUMMARY_COLUMN, col);
+    } else {
+        rc = bdb_set_table_parameter(tran, tbl, SUMMARY_COLUMN, NULL);
+        if (!rc)
+            rc = bdb_set_table_parameter(tran, tbl, SUMMARY_MIN, NULL);
+        if (!rc)
+            rc = bdb_set_table_parameter(tran, tbl, SUMMARY_MAX, NULL);
+    }
+    return rc;
+}
+
+/* returns 0 and the persisted summary of "tbl", 1 if there is none */
+static int _summary_read(const char *tbl, tran_type *tran, char **col,
+                         char **min, char **max)
+{
+    *col = *min = *max = NULL;
+
+    if (bdb_get_table_parameter_tran(tbl, SUMMARY_COLUMN, col, tran))
+        return 1;
+    if (bdb_get_table_parameter_tran(tbl, SUMMARY_MIN, min, tran) ||
+        bdb_get_table_parameter_tran(tbl, SUMMARY_MAX, max, tran)) {
+        free(*col);
+        free(*min);
+        *col = *min = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+void views_summary_load(struct dbtable *db, tran_type *tran)
+{
+    char *col;
+    char *min;
+    char *max;
+
+    if (db->dbtype != DBTYPE_TAGGED_TABLE)
+        return;
+
+    _summary_read(db->tablename, tran, &col, &min, &max);
+
+    Pthread_mutex_lock(&summary_lk);
+    /* a freeze in progress on the master owns the state */
+    if (db->summary_state != SUMMARY_FREEZING &&
+        db->summary_state != SUMMARY_DIRTY) {
+        _summary_set(db, col ? SUMMARY_FROZEN : SUMMARY_NONE, col, min, max);
+        col = min = max = NULL;
+    }
+    Pthread_mutex_unlock(&summary_lk);
+
+    free(col);
+    free(min);
+    free(max);
+}
+
+int comdb2_summary_valid(const char *tbl, const char *col, const char *min,
+                         const char *max)
+{
+    tran_type *tran;
+    char *pcol;
+    char *pmin;
+    char *pmax;
+    int valid = 0;
+
+    /* read with the statement locker: a write that dropped the summary is
+     * either committed, or holds the llmeta page until it is */
+    tran = curtran_gettran();
+    if (!tran)
+        return 0;
+
+    if (_summary_read(tbl, tran, &pcol, &pmin, &pmax) == 0) {
+        valid = strcmp(pcol, col) == 0 && strcmp(pmin, min) == 0 &&
+                strcmp(pmax, max) == 0;
+        free(pcol);
+        free(pmin);
+        free(pmax);
+    }
+    curtran_puttran(tran);
+
+    return valid;
+}
+
+int views_summary_drop(struct ireq *iq, void *trans, struct dbtable *db)
+{
+    int frozen;
+
+    Pthread_mutex_lock(&summary_lk);
+    if (db->summary_state == SUMMARY_FREEZING)
+        db->summary_state = SUMMARY_DIRTY;
+    frozen = (db->summary_state == SUMMARY_FROZEN);
+    Pthread_mutex_unlock(&summary_lk);
+
+    if (!frozen)
+        return 0;
+
+    if (_summary_persist(trans, db->tablename, NULL, NULL, NULL)) {
+        logmsg(LOGMSG_ERROR, "%s: failed to drop summary for %s\n", __func__,
+               db->tablename);
+        return RC_INTERNAL_RETRY;
+    }
+
+    /* stop pruning right away; an abort only leaves the shard unpruned until
+     * the next reload */
+    Pthread_mutex_lock(&summary_lk);
+    if (db->summary_state == SUMMARY_FROZEN)
+        _summary_set(db, SUMMARY_NONE, NULL, NULL, NULL);
+    Pthread_mutex_unlock(&summary_lk);
+
+    iq->summary_dropped = 1;
+    return 0;
+}
+
+void views_summary_postcommit(struct ireq *iq)
+{
+    int bdberr;
+
+    if (!iq->summary_dropped)
+        return;
+    iq->summary_dropped = 0;
+
+    if (bdb_llog_analyze(thedb->bdb_env, 1, &bdberr))
+        logmsg(LOGMSG_ERROR, "%s: bdb_llog_analyze bdberr %d\n", __func__,
+               bdberr);
+}
+
+static char *_summary_bound(const char *tbl, const char *col, const char *fn)
+{
+    char *sql = sqlite3_mprintf(
+        "SELECT typeof(%s(\"%w\")) || ':' || ifnull(CAST(%s(\"%w\") AS TEXT), "
+        "'') FROM \"%w\"",
+        fn, col, fn, col, tbl);
+    char *bound;
+
+    if (!sql)
+        return NULL;
+    bound = run_internal_sql_str(sql);
+    sqlite3_free(sql);
+
+    if (bound && !_summary_cast_type(bound) && !_summary_is_null(bound)) {
+        free(bound);
+        bound = NULL;
+    }
+    return bound;
+}
+
+/* returns 1 if the persisted state of the shard changed */
+static int _summary_freeze_shard(const char *tbl, const char *col)
+{
+    struct dbtable *db;
+    char *min = NULL;
+    char *max = NULL;
+    int dirty = 0;
+    int rc;
+
+    db = get_dbtable_by_name(tbl);
+    if (!db || find_field_idx(db, ".ONDISK", col) < 0)
+        return 0;
+
+    Pthread_mutex_lock(&summary_lk);
+    if (db->summary_state != SUMMARY_NONE) {
+        Pthread_mutex_unlock(&summary_lk);
+        return 0;
+    }
+    db->summary_state = SUMMARY_FREEZING;
+    Pthread_mutex_unlock(&summary_lk);
+
+    /* a write racing with the scans below sees SUMMARY_FREEZING once its
+     * page is written, and marks the summary dirty */
+    rc = -1;
+    if ((min = _summary_bound(tbl, col, "min")) != NULL &&
+        (max = _summary_bound(tbl, col, "max")) != NULL)
+        rc = _summary_persist(NULL, db->tablename, col, min, max);
+
+    Pthread_mutex_lock(&summary_lk);
+    if (rc == 0 && db->summary_state == SUMMARY_FREEZING) {
+        _summary_set(db, SUMMARY_FROZEN, strdup(col), min, max);
+        min = max = NULL;
+    } else {
+        dirty = (rc == 0);
+        db->summary_state = SUMMARY_NONE;
+    }
+    Pthread_mutex_unlock(&summary_lk);
+
+    free(min);
+    free(max);
+
+    if (dirty && _summary_persist(NULL, db->tablename, NULL, NULL, NULL))
+        logmsg(LOGMSG_ERROR, "%s: failed to drop dirty summary for %s\n",
+               __func__, tbl);
+
+    return rc == 0;
+}
+
+/* the current shard and the one it replaced may still see inserts from
+ * transactions that started before the rollout */
+static int _shard_takes_inserts(timepart_view_t *view, int i)
+{
+    int prev;
+
+    if (view->rolltype == TIMEPART_ROLLOUT_TRUNCATE)
+        prev = (view->current_shard + view->nshards - 1) % view->nshards;
+    else
+        prev = view->current_shard + 1;
+
+    return i == view->current_shard || i == prev;
+}
+
+void views_summary_freeze(const char *name)
+{
+    const char *col = gbl_timepart_summary_column;
+    timepart_view_t *view;
+    char **shards = NULL;
+    int nshards = 0;
+    int changed = 0;
+    int bdberr;
+    int i;
+
+    if (!col || !col[0])
+        return;
+
+    Pthread_rwlock_rdlock(&views_lk);
+    view = _get_view(thedb->timepart_views, name);
+    if (view && (shards = calloc(view->nshards, sizeof(char *))) != NULL) {
+        for (i = 0; i < view->nshards; i++) {
+            if (!_shard_takes_inserts(view, i))
+                shards[nshards++] = strdup(view->shards[i].tblname);
+        }
+    }
+    Pthread_rwlock_unlock(&views_lk);
+
+    bdb_thread_event(thedb->bdb_env, BDBTHR_EVENT_START_RDWR);
+    for (i = 0; i < nshards; i++) {
+        if (shards[i])
+            changed |= _summary_freeze_shard(shards[i], col);
+        free(shards[i]);
+    }
+    free(shards);
+
+    if (changed && bdb_llog_analyze(thedb->bdb_env, 0, &bdberr))
+        logmsg(LOGMSG_ERROR, "%s: bdb_llog_analyze bdberr %d\n", __func__,
+               bdberr);
+    bdb_thread_event(thedb->bdb_env, BDBTHR_EVENT_DONE_RDWR);
+}
+
+/* CAST('<text>' AS <type>) for a stored bound, NULL for an all null shard */
+static Expr *_summary_bound_expr(Parse *pParse, const char *bound)
+{
+    sqlite3 *db = pParse->db;
+    const char *cast = _summary_cast_type(bound);
+    Token tok;
+    Expr *pLit;
+    Expr *pCast;
+
+    if (!cast)
+        return sqlite3PExpr(pParse, TK_NULL, 0, 0);
+
+    sqlite3TokenInit(&tok, (char *)strchr(bound, ':') + 1);
+    pLit = sqlite3ExprAlloc(db, TK_STRING, &tok, 0);
+    sqlite3TokenInit(&tok, (char *)cast);
+    pCast = sqlite3ExprAlloc(db, TK_CAST, &tok, 0);
+    sqlite3ExprAttachSubtrees(db, pCast, pLit, 0);
+    return pCast;
+}
+
+static int _summary_is_col(Expr *pExpr, int iCur, int iCol)
+{
+    return pExpr->op == TK_COLUMN && pExpr->iTable == iCur &&
+           pExpr->iColumn == iCol;
+}
+
+/* "<bound> op <pVal>" */
+static Expr *_summary_cmp(Parse *pParse, const char *bound, int op,
+                          Expr *pVal)
+{
+    return sqlite3PExpr(pParse, op, _summary_bound_expr(pParse, bound),
+                        sqlite3ExprDup(pParse->db, pVal, 0));
+}
+
+/* guard for a top level term of the WHERE clause: the terms the shard must
+ * satisfy for any of its rows to pass */
+static Expr *_summary_guard(Parse *pParse, Expr *pTerm, int iCur, int iCol,
+                            const char *min, const char *max)
+{
+    sqlite3 *db = pParse->db;
+    Expr *pVal;
+    int op;
+
+    if (!pTerm)
+        return NULL;
+
+    switch (pTerm->op) {
+    case TK_AND:
+        return sqlite3ExprAnd(
+            db, _summary_guard(pParse, pTerm->pLeft, iCur, iCol, min, max),
+            _summary_guard(pParse, pTerm->pRight, iCur, iCol, min, max));
+    case TK_BETWEEN:
+        if (!_summary_is_col(pTerm->pLeft, iCur, iCol) ||
+            !sqlite3ExprIsConstant(pTerm->x.pList->a[0].pExpr) ||
+            !sqlite3ExprIsConstant(pTerm->x.pList->a[1].pExpr))
+            return NULL;
+        return sqlite3ExprAnd(
+            db, _summary_cmp(pParse, max, TK_GE, pTerm->x.pList->a[0].pExpr),
+            _summary_cmp(pParse, min, TK_LE, pTerm->x.pList->a[1].pExpr));
+    case TK_EQ:
+    case TK_GT:
+    case TK_GE:
+    case TK_LT:
+    case TK_LE:
+        op = pTerm->op;
+        if (_summary_is_col(pTerm->pLeft, iCur, iCol)) {
+            pVal = pTerm->pRight;
+        } else if (_summary_is_col(pTerm->pRight, iCur, iCol)) {
+            pVal = pTerm->pLeft;
+            /* X op col is col op' X */
+            if (op != TK_EQ)
+                op = (op == TK_GT)   ? TK_LT
+                     : (op == TK_GE) ? TK_LE
+                     : (op == TK_LT) ? TK_GT
+                                     : TK_GE;
+        } else {
+            return NULL;
+        }
+        if (!sqlite3ExprIsConstant(pVal))
+            return NULL;
+        if (op == TK_EQ)
+            return sqlite3ExprAnd(db, _summary_cmp(pParse, min, TK_LE, pVal),
+                                  _summary_cmp(pParse, max, TK_GE, pVal));
+        /* col > X needs max > X, col < X needs min < X */
+        return _summary_cmp(pParse, (op == TK_GT || op == TK_GE) ? max : min,
+                            op, pVal);
+    }
+    return NULL;
+}
+
+static Expr *_summary_str_expr(sqlite3 *db, const char *str)
+{
+    Token tok;
+
+    sqlite3TokenInit(&tok, (char *)str);
+    return sqlite3ExprAlloc(db, TK_STRING, &tok, 0);
+}
+
+/* comdb2_summary_valid('<shard>', '<column>', '<min>', '<max>'); constant
+ * for the statement, so it is coded ahead of the loop with the guard */
+static Expr *_summary_valid_expr(Parse *pParse, const char *tbl,
+                                 const char *col, const char *min,
+                                 const char *max)
+{
+    sqlite3 *db = pParse->db;
+    ExprList *pList = NULL;
+    Expr *pFunc;
+    Token tok;
+
+    pList = sqlite3ExprListAppend(pParse, pList, _summary_str_expr(db, tbl));
+    pList = sqlite3ExprListAppend(pParse, pList, _summary_str_expr(db, col));
+    pList = sqlite3ExprListAppend(pParse, pList, _summary_str_expr(db, min));
+    pList = sqlite3ExprListAppend(pParse, pList, _summary_str_expr(db, max));
+
+    sqlite3TokenInit(&tok, "comdb2_summary_valid");
+    pFunc = sqlite3ExprFunction(pParse, pList, &tok, 0);
+    if (pFunc)
+        ExprSetProperty(pFunc, EP_ConstFunc);
+    return pFunc;
+}
+
+void comdb2_summary_prune(Parse *pParse, Select *p)
+{
+    struct SrcList_item *pItem = &p->pSrc->a[0];
+    Table *pTab = pItem->pTab;
+    struct dbtable *db;
+    char *col = NULL;
+    char *min = NULL;
+    char *max = NULL;
+    Expr *pGuard;
+    int iCol = -1;
+    int i;
+
+    if (!pTab || pItem->pSelect || IsVirtual(pTab) ||
+        pTab->pSchema != pParse->db->aDb[0].pSchema)
+        return;
+
+    db = get_dbtable_by_name(pTab->zName);
+    if (!db || !db->timepartition_name ||
+        db->summary_state != SUMMARY_FROZEN)
+        return;
+
+    Pthread_mutex_lock(&summary_lk);
+    if (db->summary_state == SUMMARY_FROZEN) {
+        for (i = 0; i < pTab->nCol; i++) {
+            if (strcasecmp(pTab->aCol[i].zName, db->summary_col) == 0) {
+                iCol = i;
+                break;
+            }
+        }
+        if (iCol >= 0) {
+            col = strdup(db->summary_col);
+            min = strdup(db->summary_min);
+            max = strdup(db->summary_max);
+        }
+    }
+    Pthread_mutex_unlock(&summary_lk);
+
+    if (col && min && max) {
+        pGuard = _summary_guard(pParse, p->pWhere, pItem->iCursor, iCol, min,
+                                max);
+        if (pGuard) {
+            pGuard = sqlite3PExpr(
+                pParse, TK_OR,
+                sqlite3PExpr(pParse, TK_NOT,
+                             _summary_valid_expr(pParse, db->tablename, col,
+                                                 min, max),
+                             0),
+                pGuard);
+            p->pWhere = sqlite3ExprAnd(pParse->db, p->pWhere, pGuard);
+        }
+    }
+    free(col);
+    free(min);
+    free(max);
+}
@@ -67,6 +67,8 @@
 #include <sql_stmt_cache.h>
 #include <debug_switches.h>
 #include <string_ref.h>
+#include <epochlib.h>
+#include <plhash_glue.h>
 #include "comdb2_atomic.h"
 #include "sql_stmt_cache.h"
 #include "util.h"
@@ -96,6 +98,16 @@ extern int gbl_lua_prepare_retry_sleep;
 
 pthread_t gbl_break_lua;
 int gbl_break_all_lua = 0;
+
+/* Lua VMs of closed connections kept for reuse, and compiled chunks of
+ * procedure source */
+int gbl_lua_sp_pool_size = 32;
+int gbl_lua_sp_bytecode_cache_size = 256;
+int64_t gbl_lua_sp_pool_hits;
+int64_t gbl_lua_sp_pool_misses;
+int64_t gbl_lua_sp_bytecode_hits;
+int64_t gbl_lua_sp_bytecode_misses;
+int64_t gbl_lua_sp_setup_us_saved;
 char *gbl_break_spname;
 void *debug_clnt;
 
@@ -1824,6 +1836,7 @@ static int load_debugging_information(struct stored_proc *sp, char **err)
     char *sp_source;
     int source_size;
 
+    sp->no_pool = 1;
     enable_global_variables(sp->lua);
 
     sp_source = load_src(sp->spname, &sp->spversion, 0, err);
@@ -3080,10 +3093,144 @@ static int get_func_by_name(Lua L, const char *func, char **err)
     return 0;
 }
 
+/* Compiled procedure source, keyed by the source text itself so that a new
+ * version or a lua_version bump never finds a stale chunk.  Chunks are
+ * dumped with debug information, which db:bootstrap() and error messages
+ * rely on. */
+struct sp_bytecode {
+    char *src;
+    char *code;
+    size_t len;
+    size_t cap;
+    int64_t parse_us; /* cost of compiling from source */
+    int refs;
+    int evicted;
+};
+
+static pthread_mutex_t sp_bytecode_lk = PTHREAD_MUTEX_INITIALIZER;
+static hash_t *sp_bytecode_hash;
+
+static void free_sp_bytecode(struct sp_bytecode *bc)
+{
+    free(bc->src);
+    free(bc->code);
+    free(bc);
+}
+
+static int sp_bytecode_writer(Lua L, const void *p, size_t sz, void *ud)
+{
+    struct sp_bytecode *bc = ud;
+    if (bc->len + sz > bc->cap) {
+        size_t cap = (bc->len + sz) * 2;
+        char *code = realloc(bc->code, cap);
+        if (code == NULL)
+            return 1;
+        bc->code = code;
+        bc->cap = cap;
+    }
+    memcpy(bc->code + bc->len, p, sz);
+    bc->len += sz;
+    return 0;
+}
+
+static struct sp_bytecode *sp_bytecode_get(const char *src)
+{
+    struct sp_bytecode *bc = NULL;
+    Pthread_mutex_lock(&sp_bytecode_lk);
+    if (sp_bytecode_hash && (bc = hash_find_readonly(sp_bytecode_hash, &src)))
+        bc->refs++;
+    Pthread_mutex_unlock(&sp_bytecode_lk);
+    return bc;
+}
+
+static void sp_bytecode_put(struct sp_bytecode *bc)
+{
+    Pthread_mutex_lock(&sp_bytecode_lk);
+    int done = --bc->refs == 0 && bc->evicted;
+    Pthread_mutex_unlock(&sp_bytecode_lk);
+    if (done)
+        free_sp_bytecode(bc);
+}
+
+static int sp_bytecode_evict(void *obj, void *arg)
+{
+    struct sp_bytecode *bc = obj;
+    bc->evicted = 1;
+    if (bc->refs == 0)
+        free_sp_bytecode(bc);
+    return 0;
+}
+
+/* Dump the chunk on top of the stack and cache it */
+static void sp_bytecode_add(Lua L, const char *src, int64_t parse_us)
+{
+    struct sp_bytecode *bc = calloc(1, sizeof(*bc));
+    if (bc == NULL)
+        return;
+    if (lua_dump(L, sp_bytecode_writer, bc) != 0 ||
+        (bc->src = strdup(src)) == NULL) {
+        free_sp_bytecode(bc);
+        return;
+    }
+    bc->parse_us = parse_us;
+
+    Pthread_mutex_lock(&sp_bytecode_lk);
+    if (sp_bytecode_hash == NULL)
+        sp_bytecode_hash =
+            hash_init_strptr(offsetof(struct sp_bytecode, src));
+    if (hash_find_readonly(sp_bytecode_hash, &bc->src)) {
+        /* compiled by someone else meanwhile */
+        Pthread_mutex_unlock(&sp_bytecode_lk);
+        free_sp_bytecode(bc);
+        return;
+    }
+    if (hash_get_num_entries(sp_bytecode_hash) >=
+        gbl_lua_sp_bytecode_cache_size) {
+        /* Procedure sources seldom change, so a full cache is rare; start
+         * over rather than track recency on every hit */
+        hash_for(sp_bytecode_hash, sp_bytecode_evict, NULL);
+        hash_clear(sp_bytecode_hash);
+    }
+    hash_add(sp_bytecode_hash, bc);
+    Pthread_mutex_unlock(&sp_bytecode_lk);
+}
+
+/* Push the compiled chunk for src, from the cache if we have it */
+static int load_src_chunk(Lua L, const char *src)
+{
+    int64_t start;
+    int rc;
+
+    if (gbl_lua_sp_bytecode_cache_size <= 0)
+        return luaL_loadstring(L, src);
+
+    struct sp_bytecode *bc = sp_bytecode_get(src);
+    if (bc) {
+        start = comdb2_time_epochus();
+        rc = luaL_loadbuffer(L, bc->code, bc->len, src);
+        int64_t saved = bc->parse_us - (comdb2_time_epochus() - start);
+        sp_bytecode_put(bc);
+        if (rc == 0) {
+            ATOMIC_ADD64(gbl_lua_sp_bytecode_hits, 1);
+            if (saved > 0)
+                ATOMIC_ADD64(gbl_lua_sp_setup_us_saved, saved);
+            return 0;
+        }
+        lua_pop(L, 1);
+    }
+
+    ATOMIC_ADD64(gbl_lua_sp_bytecode_misses, 1);
+    start = comdb2_time_epochus();
+    if ((rc = luaL_loadstring(L, src)) == 0)
+        sp_bytecode_add(L, src, comdb2_time_epochus() - start);
+    return rc;
+}
+
 static int process_src(Lua L, const char *src, char **err)
 {
     int rc;
-    if ((rc = luaL_dostring(L, src)) != 0) {
+    if ((rc = load_src_chunk(L, src)) != 0 ||
+        (rc = lua_pcall(L, 0, LUA_MULTRET, 0)) != 0) {
         *err = strdup(lua_tostring(L, -1));
         return -1;
     }
@@ -3191,6 +3338,89 @@ static void close_sp_int(SP sp, int freesp)
     free(sp);
 }
 
+/* Warm VMs of closed connections.  A VM is only handed to a connection of
+ * the same user running the same procedure; setup_sp_int() then checks its
+ * version like it does for a connection's own VM, and the source is run
+ * again before use, so nothing a previous run left on the stack or in its
+ * locals is visible. */
+static pthread_mutex_t sp_pool_lk = PTHREAD_MUTEX_INITIALIZER;
+static SP sp_pool;
+static int sp_pool_count;
+static int64_t sp_create_us; /* average cost of create_sp_int() */
+
+static void destroy_pooled_sp(SP sp)
+{
+    lua_close(sp->lua);
+    comdb2ma mspace = sp->mspace;
+    free_spversion(sp);
+    comdb2ma_destroy(mspace);
+    free(sp);
+}
+
+static SP sp_pool_get(const char *spname, struct sqlclntstate *clnt)
+{
+    SP sp, *prev;
+    if (gbl_lua_sp_pool_size <= 0 || sp_pool == NULL)
+        return NULL;
+    Pthread_mutex_lock(&sp_pool_lk);
+    for (prev = &sp_pool; (sp = *prev) != NULL; prev = &sp->pool_next) {
+        if (strcmp(sp->spname, spname) == 0 &&
+            strcmp(sp->pool_user, clnt->current_user.name) == 0) {
+            *prev = sp->pool_next;
+            sp->pool_next = NULL;
+            --sp_pool_count;
+            break;
+        }
+    }
+    Pthread_mutex_unlock(&sp_pool_lk);
+    if (sp) {
+        ATOMIC_ADD64(gbl_lua_sp_pool_hits, 1);
+        ATOMIC_ADD64(gbl_lua_sp_setup_us_saved, sp_create_us);
+    }
+    return sp;
+}
+
+/* Returns 0 if the pool took sp */
+static int sp_pool_put(SP sp, struct sqlclntstate *clnt)
+{
+    if (gbl_lua_sp_pool_size <= 0 || sp->no_pool || sp->lua == NULL ||
+        sp->src == NULL || sp->spname[0] == 0 ||
+        sp->lua_version != gbl_lua_version ||
+        sp->had_allow_lua_dynamic_libs != gbl_allow_lua_dynamic_libs ||
+        !LIST_EMPTY(&sp->dbthds) || db_is_exiting())
+        return -1;
+
+    reset_sp(sp);
+    lua_settop(sp->lua, 0);
+    lua_newtable(sp->lua);
+    lua_setglobal(sp->lua, "_SP");
+    lua_gc(sp->lua, LUA_GCCOLLECT, 0);
+    strncpy0(sp->pool_user, clnt->current_user.name, sizeof(sp->pool_user));
+    sp->clnt = NULL;
+    sp->debug_clnt = NULL;
+    sp->thd = NULL;
+    sp->emit_mutex = NULL;
+    sp->prev_dbstmt = NULL;
+
+    SP evict = NULL;
+    Pthread_mutex_lock(&sp_pool_lk);
+    sp->pool_next = sp_pool;
+    sp_pool = sp;
+    if (++sp_pool_count > gbl_lua_sp_pool_size) {
+        /* drop the one that has been idle the longest */
+        SP *prev = &sp_pool;
+        while ((*prev)->pool_next)
+            prev = &(*prev)->pool_next;
+        evict = *prev;
+        *prev = NULL;
+        --sp_pool_count;
+    }
+    Pthread_mutex_unlock(&sp_pool_lk);
+    if (evict)
+        destroy_pooled_sp(evict);
+    return 0;
+}
+
 static void free_dbthread_type(dbthread_type *thd)
 {
     if (!thd) return;
@@ -5268,6 +5498,7 @@ static void *lua_alloc(void *ud, void *ptr, size_t osize, size_t nsize)
 static int create_sp_int(SP sp, char **err)
 {
     Lua lua;
+    int64_t start = comdb2_time_epochus();
 
     sp->mspace = lua_mem_init();
     lua = lua_newstate(lua_alloc, sp->mspace);
@@ -5307,6 +5538,9 @@ static int create_sp_int(SP sp, char **err)
 
     /* To be given as lrl value. */
     lua_sethook(lua, InstructionCountHook, LUA_MASKCOUNT, 1);
+
+    int64_t us = comdb2_time_epochus() - start;
+    sp_create_us = sp_create_us ? (sp_create_us * 7 + us) / 8 : us;
     return 0;
 }
 
@@ -6314,6 +6548,7 @@ static int setup_sp_int(char *spname, struct sqlthdstate *thd, struct sqlclntsta
                         int trigger, int *new_vm /*out param*/, char **err /*out param*/)
 {
     SP sp = clnt->sp;
+    int pooled = 0;
     if (sp) {
         if (clnt->want_stored_procedure_trace ||
             clnt->want_stored_procedure_debug ||
@@ -6322,6 +6557,14 @@ static int setup_sp_int(char *spname, struct sqlthdstate *thd, struct sqlclntsta
             sp = NULL;
         }
     }
+    if (sp == NULL && !trigger && !clnt->want_stored_procedure_trace &&
+        !clnt->want_stored_procedure_debug &&
+        (sp = sp_pool_get(spname, clnt)) != NULL) {
+        // Warm vm from a closed connection
+        pooled = 1;
+        clnt->sp = sp;
+        sp->clnt = clnt;
+    }
     if (sp && sp->lua) {
         // Have lua vm
         if (strcmp(spname, clnt->spname) == 0) {
@@ -6358,6 +6601,7 @@ static int setup_sp_int(char *spname, struct sqlthdstate *thd, struct sqlclntsta
         }
     } else {
         // Create lua vm
+        ATOMIC_ADD64(gbl_lua_sp_pool_misses, 1);
         if (sp) {
             free_spversion(sp);
             if (create_sp_int(sp, err) != 0) {
@@ -6378,8 +6622,11 @@ static int setup_sp_int(char *spname, struct sqlthdstate *thd, struct sqlclntsta
     sp->thd = thd;
     sp->parent = sp;
     sp->initial = 1;
+    if (trigger)
+        sp->no_pool = 1;
 
-    *new_vm = 0;
+    // A pooled vm is new to this connection
+    *new_vm = pooled;
     if (sp->src == NULL) {
         int locked=0;
         if (!IS_SYS(spname)) {
@@ -7282,6 +7529,7 @@ static int exec_procedure_int(struct sqlthdstate *thd,
         if (getqueuebyname(qname)) {
             consumer = 1;
             sp->can_consume = 1;
+            sp->no_pool = 1;
         }
         unlock_schema_lk();
         if (consumer) add_consumer_funcs(L);
@@ -7352,8 +7600,11 @@ int can_consume(struct sqlclntstate *clnt)
 
 void close_sp(struct sqlclntstate *clnt)
 {
-    close_sp_int(clnt->sp, 1);
+    SP sp = clnt->sp;
     clnt->sp = NULL;
+    if (sp && sp_pool_put(sp, clnt) == 0)
+        return;
+    close_sp_int(sp, 1);
 }
 
 void lua_final(sqlite3_context *context)
@@ -71,6 +71,9 @@ struct stored_proc {
     dbstmt_t *prev_dbstmt; // for db_bind -- deprecated
     dbconsumer_t *consumer; // commit/rollback need to clear
 
+    SP pool_next; // pooled VMs only
+    char pool_user[MAX_USERNAME_LEN]; // user that last ran the VM
+
     unsigned initial           : 1;
     /*
     pingpong = 0 -- not waiting to hear from client
@@ -81,6 +84,7 @@ struct stored_proc {
     unsigned in_parent_trans   : 1;
     unsigned make_parent_trans : 1;
     unsigned can_consume : 1;
+    unsigned no_pool : 1; // VM can't be reused by another connection
 };
 
 #define getsp(x) ((SP)lua_getsp(x))
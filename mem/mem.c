@@ -92,6 +92,21 @@
     ((p)[COMDB2MA_SENTINEL_OFS] ==                                             \
      COMDB2MA_SENTINEL((p) + COMDB2MA_SENTINEL_OFS, (p)[COMDB2MA_ALLOC_OFS]))
 
+/* Arena blocks have the regular 2-word header with a different sentinel and
+   their chunk in place of the allocator, and their size in one more word in
+   front of it */
+#define COMDB2AR_SIZE_OFS (-3)
+#define COMDB2AR_OVERHEAD (sizeof(void *) * 3)
+#define COMDB2AR_ALIGN 16
+#define COMDB2AR_SENTINEL(p, c)                                                \
+    (void *)(((uintptr_t)(p) + (uintptr_t)(c)) ^ 0xCDB2A7EL)
+#define COMDB2AR_OK_SENTINEL(p)                                                \
+    ((p)[COMDB2MA_SENTINEL_OFS] ==                                             \
+     COMDB2AR_SENTINEL((p) + COMDB2MA_SENTINEL_OFS, (p)[COMDB2MA_ALLOC_OFS]))
+#define COMDB2AR_CHUNK(p)                                                      \
+    ((struct comdb2arena_chunk *)((p)[COMDB2MA_ALLOC_OFS]))
+#define COMDB2AR_SIZE(p) (*(size_t *)((p) + COMDB2AR_SIZE_OFS))
+
 #define COMDB2MA_MALLINFO_SAFE(cm)                                             \
     ((cm)->use_lock ? mspace_mallinfo((cm)->m) : mspace_mallinfo_fast((cm)->m))
 
@@ -166,10 +181,46 @@ struct comdb2mspace {
                              may be reused by another type of thread later on */
     unsigned int debug : 1; /* Debugging flag. */
 
+    size_t nallocs; /* number of allocations */
+
     size_t len;   /* length of name */
     char name[1]; /* name of the mspace */
 };
 
+struct comdb2arena_chunk {
+    struct comdb2arena_chunk *next;
+    char *end;
+    comdb2arena ar;   /* NULL once the arena is destroyed; owner only */
+    comdb2ma parent;  /* where the chunk, and grown blocks, come from */
+    pthread_t owner;  /* thread of the arena */
+    int refs;         /* live blocks, plus one while the arena has the chunk */
+    /* data follows */
+};
+
+struct comdb2arena {
+    LINKC_T(struct comdb2arena) lnk; /* linkedlist node */
+    comdb2ma parent;                 /* chunks come from here */
+    pthread_t owner;                 /* the only thread that may allocate */
+
+    struct comdb2arena_chunk *first; /* first chunk, where a reset rewinds */
+    struct comdb2arena_chunk *cur;   /* chunk we are bumping from */
+    struct comdb2arena_chunk *held;  /* chunks with live blocks at a reset */
+    char *pos;                       /* next free byte in cur */
+    char *last;                      /* most recent block, may grow in place */
+
+    size_t chunksz;  /* default chunk size */
+    size_t cap;      /* max bytes of chunks */
+    size_t total;    /* bytes of chunks */
+    size_t used;     /* bytes bumped since the last reset */
+    size_t peak;     /* high-water mark of used */
+    size_t nallocs;  /* number of allocations */
+    size_t nresets;  /* number of resets */
+    size_t nbusy;    /* resets which held chunks back for live blocks */
+    size_t nfull;    /* allocations refused because of cap */
+
+    char name[16];
+};
+
 struct comdb2bmspace {
     LINKC_T(struct comdb2bmspace) lnk; /* linkedlist node */
     comdb2ma alloc;                    /* comdb2ma */
@@ -234,6 +285,7 @@ typedef void (*trc_t)(const char *, ...);
 static struct {
     mspacelist list; /* list of mspaces */
     LISTC_T(struct comdb2bmspace) blist; /* list of blocking mspaces */
+    LISTC_T(struct comdb2arena) alist;   /* list of arenas */
     mspace m;             /* mspace for managing all other mspaces */
     pthread_mutex_t lock; /* mutex */
     int use_lock; /* make me compatible with COMDB2MA_LOCK/COMDB2MA_UNLOCK.
@@ -268,6 +320,10 @@ static comdb2ma comdb2ma_create_int(void *base, size_t init_sz, size_t max_cap,
 /* internal comdb2ma deletion */
 static int comdb2ma_destroy_int(comdb2ma cm);
 
+/* arena block operations, see comdb2_free() and comdb2_realloc() */
+static void comdb2arena_free(void **p);
+static void *comdb2arena_realloc(comdb2ma cm, void **p, size_t n);
+
 #ifdef PER_THREAD_MALLOC
 __thread const char *thread_type_key;
 static __thread comdb2ma *t_zone;
@@ -425,6 +481,7 @@ int comdb2ma_init(size_t init_sz, size_t max_cap)
 
             listc_init(&(root.list), offsetof(struct comdb2mspace, lnk));
             listc_init(&(root.blist), offsetof(struct comdb2bmspace, lnk));
+            listc_init(&(root.alist), offsetof(struct comdb2arena, lnk));
 
 #ifdef PER_THREAD_MALLOC
             /* create freelists for threaded allocators */
@@ -577,7 +634,8 @@ int comdb2ma_usages(comdb2ma_usage **pusages, int *n)
     if (root.m == NULL)
         rc = EPERM;
     else {
-        *n = cnt = listc_size(&(root.list));
+        comdb2arena ar;
+        *n = cnt = listc_size(&(root.list)) + listc_size(&(root.alist));
         *pusages = usages = comdb2_calloc_static(1, cnt, sizeof(comdb2ma_usage));
 
         LISTC_FOR_EACH(&(root.list), curr, lnk) {
@@ -590,6 +648,23 @@ int comdb2ma_usages(comdb2ma_usage **pusages, int *n)
             usages->total = info.fordblks + info.uordblks;
             usages->used = info.uordblks;
             usages->unused = info.fordblks;
+            usages->nallocs = curr->nallocs;
+            ++usages;
+        }
+
+        /* arenas are read without their owners' knowledge; the numbers
+           are only approximate */
+        LISTC_FOR_EACH(&(root.alist), ar, lnk) {
+            strncpy(usages->name_str, ar->name, sizeof(usages->name_str) - 1);
+            usages->name = usages->name_str;
+            strncpy(usages->scope_str, ar->parent->thr_type,
+                    sizeof(usages->scope_str) - 1);
+            usages->scope = usages->scope_str;
+            usages->peak = ar->peak;
+            usages->total = ar->total;
+            usages->used = ar->used < ar->total ? ar->used : ar->total;
+            usages->unused = usages->total - usages->used;
+            usages->nallocs = ar->nallocs;
             ++usages;
         }
     }
@@ -646,6 +721,8 @@ int comdb2_mallopt(int opt, int val) { return mspace_mallopt(opt, val); }
 
 size_t comdb2_malloc_usable_size(void *ptr)
 {
+    if (ptr != NULL && COMDB2AR_OK_SENTINEL((void **)ptr))
+        return COMDB2AR_SIZE((void **)ptr);
     return (ptr == NULL)
                ? 0
                : (dlmalloc_usable_size((void **)ptr + COMDB2MA_SENTINEL_OFS) -
@@ -800,6 +877,7 @@ void *comdb2_malloc(comdb2ma cm, size_t size)
 #ifdef PER_THREAD_MALLOC
             ++cm->refs;
 #endif
+            ++cm->nallocs;
             out[0] = COMDB2MA_SENTINEL(out, cm);
             out[1] = (void *)cm;
             out -= COMDB2MA_SENTINEL_OFS;
@@ -846,6 +924,7 @@ void *comdb2_calloc(comdb2ma cm, size_t n, size_t size)
 #ifdef PER_THREAD_MALLOC
             ++cm->refs;
 #endif
+            ++cm->nallocs;
             out[0] = COMDB2MA_SENTINEL(out, cm);
             out[1] = (void *)cm;
             out -= COMDB2MA_SENTINEL_OFS;
@@ -909,7 +988,9 @@ void *comdb2_realloc(comdb2ma cm, void *ptr, size_t n)
         comdb2_free(ptr);
     } else {
         out = (void **)ptr;
-        if (!COMDB2MA_OK_SENTINEL(out)) {
+        if (COMDB2AR_OK_SENTINEL(out)) {
+            out = comdb2arena_realloc(cm, out, n);
+        } else if (!COMDB2MA_OK_SENTINEL(out)) {
             /* sentinel does not match. ptr could be allocated by system call.
                hand it over to system realloc. */
             out = realloc(ptr, n);
@@ -938,7 +1019,9 @@ void *comdb2_resize(comdb2ma cm, void *ptr, size_t n)
         comdb2_free(ptr);
     } else {
         out = (void **)ptr;
-        if (!COMDB2MA_OK_SENTINEL(out)) {
+        if (COMDB2AR_OK_SENTINEL(out)) {
+            out = comdb2arena_realloc(cm, out, n);
+        } else if (!COMDB2MA_OK_SENTINEL(out)) {
             /* sentinel does not match. ptr could be allocated by system call.
                hand it over to system realloc. */
             out = realloc(ptr, n);
@@ -1032,7 +1115,9 @@ void comdb2_free(void *ptr)
     void **p = (void **)ptr;
 
     if (p != NULL) {
-        if (!COMDB2MA_OK_SENTINEL(p)) {
+        if (COMDB2AR_OK_SENTINEL(p)) {
+            comdb2arena_free(p);
+        } else if (!COMDB2MA_OK_SENTINEL(p)) {
             /* sentinel corruption. possible reasons-
                1) memory corruption. this will fail regardless which free we
                call.
@@ -1118,6 +1203,273 @@ int comdb2_malloc_trim(comdb2ma cm, size_t pad)
 }
 // dynamic$
 
+//^arena
+comdb2arena comdb2arena_create(comdb2ma parent, size_t chunksz, size_t cap,
+                               const char *name)
+{
+    comdb2arena ar;
+
+    ar = comdb2_calloc(parent, 1, sizeof(struct comdb2arena));
+    if (ar == NULL)
+        return NULL;
+
+    ar->parent = parent;
+    ar->owner = pthread_self();
+    ar->chunksz = chunksz;
+    ar->cap = cap;
+    strncpy(ar->name, name, sizeof(ar->name) - 1);
+
+    if (COMDB2MA_LOCK(&root) == 0) {
+        listc_abl(&(root.alist), ar);
+        COMDB2MA_UNLOCK(&root);
+    }
+    return ar;
+}
+
+/* Move on to the next chunk that can hold `need' bytes, allocating one if
+   there is none. Chunks are kept in the order they are bumped from. */
+static int comdb2arena_next_chunk(comdb2arena ar, size_t need)
+{
+    struct comdb2arena_chunk *chunk, *prev;
+    size_t sz;
+
+    for (prev = ar->cur, chunk = prev ? prev->next : ar->first; chunk != NULL;
+         prev = chunk, chunk = chunk->next) {
+        if ((size_t)(chunk->end - (char *)(chunk + 1)) >= need)
+            break;
+    }
+
+    if (chunk == NULL) {
+        sz = sizeof(struct comdb2arena_chunk) + need;
+        if (sz < ar->chunksz)
+            sz = ar->chunksz;
+        if (ar->total + sz > ar->cap) {
+            ++ar->nfull;
+            return ENOMEM;
+        }
+        chunk = comdb2_malloc(ar->parent, sz);
+        if (chunk == NULL)
+            return ENOMEM;
+        chunk->end = (char *)chunk + sz;
+        chunk->ar = ar;
+        chunk->parent = ar->parent;
+        chunk->owner = ar->owner;
+        chunk->refs = 1;
+        ar->total += sz;
+        /* insert behind the current chunk so that it is reused in order */
+        if (prev == NULL) {
+            chunk->next = ar->first;
+            ar->first = chunk;
+        } else {
+            chunk->next = prev->next;
+            prev->next = chunk;
+        }
+    }
+
+    if (ar->cur != NULL)
+        ar->used += ar->cur->end - ar->pos;
+    ar->cur = chunk;
+    ar->pos = (char *)(chunk + 1);
+    ar->last = NULL;
+    return 0;
+}
+
+void *comdb2arena_malloc(comdb2arena ar, size_t n)
+{
+    uintptr_t start;
+    void **out;
+
+    if (n > COMDB2MA_MAX_MEM - COMDB2AR_OVERHEAD - COMDB2AR_ALIGN)
+        return NULL;
+
+    if (ar->cur == NULL ||
+        (size_t)(ar->cur->end - ar->pos) <
+            n + COMDB2AR_OVERHEAD + COMDB2AR_ALIGN) {
+        if (comdb2arena_next_chunk(ar, n + COMDB2AR_OVERHEAD + COMDB2AR_ALIGN))
+            return NULL;
+    }
+
+    start = ((uintptr_t)ar->pos + COMDB2AR_OVERHEAD + COMDB2AR_ALIGN - 1) &
+            ~(uintptr_t)(COMDB2AR_ALIGN - 1);
+    out = (void **)start;
+    out[COMDB2MA_ALLOC_OFS] = (void *)ar->cur;
+    out[COMDB2MA_SENTINEL_OFS] =
+        COMDB2AR_SENTINEL(out + COMDB2MA_SENTINEL_OFS, ar->cur);
+    COMDB2AR_SIZE(out) = n;
+
+    ar->used += (char *)out + n - ar->pos;
+    if (ar->used > ar->peak)
+        ar->peak = ar->used;
+    ar->pos = (char *)out + n;
+    ar->last = (char *)out;
+    ++ar->nallocs;
+    __atomic_add_fetch(&ar->cur->refs, 1, __ATOMIC_RELAXED);
+    return out;
+}
+
+/* Drop a reference to a chunk; the last one frees it */
+static void comdb2arena_chunk_release(struct comdb2arena_chunk *chunk)
+{
+    if (__atomic_sub_fetch(&chunk->refs, 1, __ATOMIC_ACQ_REL) == 0)
+        comdb2_free(chunk);
+}
+
+static void comdb2arena_free(void **p)
+{
+    struct comdb2arena_chunk *chunk = COMDB2AR_CHUNK(p);
+    comdb2arena ar;
+
+    /* give the space back if this is the latest block of the owner */
+    if (pthread_equal(chunk->owner, pthread_self()) &&
+        (ar = chunk->ar) != NULL && (char *)p == ar->last) {
+        char *start = (char *)(p + COMDB2AR_SIZE_OFS);
+        ar->used -= ar->pos - start;
+        ar->pos = start;
+        ar->last = NULL;
+    }
+    /* poison the sentinel so that a double free is not taken for a block */
+    p[COMDB2MA_SENTINEL_OFS] = NULL;
+    comdb2arena_chunk_release(chunk);
+}
+
+static void *comdb2arena_realloc(comdb2ma cm, void **p, size_t n)
+{
+    struct comdb2arena_chunk *chunk = COMDB2AR_CHUNK(p);
+    comdb2arena ar;
+    size_t sz = COMDB2AR_SIZE(p);
+    void *out;
+
+    if (n <= sz)
+        return p;
+
+    if (pthread_equal(chunk->owner, pthread_self()) &&
+        (ar = chunk->ar) != NULL) {
+        /* grow the latest block in place */
+        if ((char *)p == ar->last &&
+            (size_t)(ar->cur->end - (char *)p) >= n) {
+            ar->used += n - sz;
+            if (ar->used > ar->peak)
+                ar->peak = ar->used;
+            ar->pos = (char *)p + n;
+            COMDB2AR_SIZE(p) = n;
+            return p;
+        }
+        out = comdb2arena_malloc(ar, n);
+    } else {
+        out = NULL;
+    }
+
+    if (out == NULL)
+        out = comdb2_malloc(cm ? cm : chunk->parent, n);
+    if (out != NULL) {
+        memcpy(out, p, sz);
+        comdb2arena_free(p);
+    }
+    return out;
+}
+
+static int comdb2arena_chunk_busy(struct comdb2arena_chunk *chunk)
+{
+    return __atomic_load_n(&chunk->refs, __ATOMIC_ACQUIRE) != 1;
+}
+
+int comdb2arena_reset(comdb2arena ar)
+{
+    struct comdb2arena_chunk **pp, *chunk;
+    int held = 0;
+
+    /* chunks held back earlier come back once their blocks are gone */
+    for (pp = &ar->held; (chunk = *pp) != NULL;) {
+        if (comdb2arena_chunk_busy(chunk)) {
+            pp = &chunk->next;
+        } else {
+            *pp = chunk->next;
+            chunk->next = ar->first;
+            ar->first = chunk;
+        }
+    }
+
+    /* set aside the chunks that still have live blocks, and rewind over
+       the rest */
+    for (pp = &ar->first; (chunk = *pp) != NULL;) {
+        if (comdb2arena_chunk_busy(chunk)) {
+            *pp = chunk->next;
+            chunk->next = ar->held;
+            ar->held = chunk;
+            held = 1;
+        } else {
+            pp = &chunk->next;
+        }
+    }
+
+    ar->cur = ar->first;
+    ar->pos = ar->first ? (char *)(ar->first + 1) : NULL;
+    ar->last = NULL;
+    ar->used = 0;
+    ++ar->nresets;
+    if (held) {
+        ++ar->nbusy;
+        return EBUSY;
+    }
+    return 0;
+}
+
+static int comdb2arena_chunks_live(struct comdb2arena_chunk *chunk)
+{
+    int live = 0;
+    for (; chunk != NULL; chunk = chunk->next)
+        live += __atomic_load_n(&chunk->refs, __ATOMIC_RELAXED) - 1;
+    return live;
+}
+
+void comdb2arena_stats(comdb2arena ar, comdb2arena_stats_t *stats)
+{
+    stats->total = ar->total;
+    stats->used = ar->used;
+    stats->peak = ar->peak;
+    stats->live =
+        comdb2arena_chunks_live(ar->first) + comdb2arena_chunks_live(ar->held);
+    stats->nallocs = ar->nallocs;
+    stats->nresets = ar->nresets;
+    stats->nbusy = ar->nbusy;
+    stats->nfull = ar->nfull;
+}
+
+void comdb2arena_destroy(comdb2arena ar)
+{
+    struct comdb2arena_chunk *chunk, *next;
+    int live;
+
+    if (ar == NULL)
+        return;
+
+    if (COMDB2MA_LOCK(&root) == 0) {
+        listc_rfl(&(root.alist), ar);
+        COMDB2MA_UNLOCK(&root);
+    }
+
+    live = comdb2arena_chunks_live(ar->first) + comdb2arena_chunks_live(ar->held);
+    if (live != 0)
+        logmsg(LOGMSG_WARN,
+               "%s: arena %s destroyed with %d live blocks, their chunks "
+               "are freed with the last of them\n",
+               __func__, ar->name, live);
+
+    /* a chunk with live blocks is freed by comdb2arena_free() instead */
+    for (chunk = ar->first; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        chunk->ar = NULL;
+        comdb2arena_chunk_release(chunk);
+    }
+    for (chunk = ar->held; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        chunk->ar = NULL;
+        comdb2arena_chunk_release(chunk);
+    }
+    comdb2_free(ar);
+}
+// arena$
+
 //^static mspaces
 int comdb2ma_attach_static(int indx, comdb2ma child)
 {
@@ -189,6 +189,7 @@ typedef struct comdb2ma_usage {
     size_t used;
     size_t unused;
     size_t total;
+    size_t nallocs;
 } comdb2ma_usage;
 
 /*
@@ -478,6 +479,58 @@ int comdb2_malloc_stats(comdb2ma ma, int verbose, int human_readable,
 */
 int comdb2_malloc_trim(comdb2ma ma, size_t pad);
 
+/*
+** Arenas.
+**
+** An arena hands out memory by bumping a pointer through large chunks taken
+** from a parent allocator, and gives it all back at once in
+** comdb2arena_reset(). Only the thread which created the arena may allocate
+** from it. Blocks may be passed to comdb2_free(), comdb2_realloc() and
+** comdb2_malloc_usable_size() from any thread; comdb2_free() only marks the
+** block dead. A chunk goes back to its parent allocator when the arena is
+** destroyed and the last block in it is freed, whichever comes last.
+*/
+typedef struct comdb2arena *comdb2arena;
+
+typedef struct comdb2arena_stats {
+    size_t total;   /* bytes of chunks */
+    size_t used;    /* bytes handed out since the last reset */
+    size_t peak;    /* high-water mark of used */
+    int live;       /* blocks not freed yet */
+    size_t nallocs; /* number of allocations */
+    size_t nresets; /* number of resets */
+    size_t nbusy;   /* resets which held chunks back for live blocks */
+    size_t nfull;   /* allocations refused because of cap */
+} comdb2arena_stats_t;
+
+/*
+** Create an arena.
+**
+** PARAMETERS
+** parent  - allocator of the chunks
+** chunksz - chunk size
+** cap     - maximum number of bytes in chunks
+** name    - name, reported by comdb2ma_usages()
+*/
+comdb2arena comdb2arena_create(comdb2ma parent, size_t chunksz, size_t cap,
+                               const char *name);
+
+/*
+** Allocate from an arena. Returns NULL if the arena is at its cap.
+*/
+void *comdb2arena_malloc(comdb2arena ar, size_t n);
+
+/*
+** Rewind an arena to its first chunk. Chunks which still have blocks that
+** have not been freed are held back, and reused by a later reset once those
+** blocks are gone; EBUSY is returned if any chunk was held back.
+*/
+int comdb2arena_reset(comdb2arena ar);
+
+void comdb2arena_stats(comdb2arena ar, comdb2arena_stats_t *stats);
+
+void comdb2arena_destroy(comdb2arena ar);
+
 #endif /* COMDB2MA_OMIT_DYNAMIC */
 
 #ifndef COMDB2MA_OMIT_STATIC
@@ -35,11 +35,15 @@ extern SSL_CTX *gbl_ssl_ctx;
 extern ssl_mode gbl_client_ssl_mode;
 extern uint64_t gbl_ssl_num_full_handshakes;
 extern uint64_t gbl_ssl_num_partial_handshakes;
+extern uint64_t gbl_ssl_num_ktls_send;
+extern uint64_t gbl_ssl_num_ktls_recv;
+extern int gbl_ssl_ktls;
 
 struct ssl_data {
     struct event *ev;
     int fd;
     int do_shutdown;
+    int ktls_send; /* kernel encrypts records: write plaintext to fd */
     char *origin;
     SSL *ssl;
     X509 *cert;
@@ -53,6 +57,24 @@ struct ssl_handshake_arg {
     void *data;
 };
 
+/* With ssl_ktls, OpenSSL installs the session keys in the kernel once the
+ * handshake completes, if the kernel and cipher allow it. Reads still go
+ * through SSL_read, which then only has to handle control records; writes
+ * can bypass OpenSSL altogether. */
+static void ktls_check(struct ssl_data *ssl_data)
+{
+#ifdef SSL_OP_ENABLE_KTLS
+    if (!gbl_ssl_ktls) return;
+    if (BIO_get_ktls_send(SSL_get_wbio(ssl_data->ssl))) {
+        ssl_data->ktls_send = 1;
+        ATOMIC_ADD64(gbl_ssl_num_ktls_send, 1);
+    }
+    if (BIO_get_ktls_recv(SSL_get_rbio(ssl_data->ssl))) {
+        ATOMIC_ADD64(gbl_ssl_num_ktls_recv, 1);
+    }
+#endif
+}
+
 static void ssl_handshake_evbuffer(int fd, short what, void *data)
 {
     struct ssl_handshake_arg *arg = data;
@@ -73,6 +95,7 @@ static void ssl_handshake_evbuffer(int fd, short what, void *data)
         }
         ssl_data->cert = SSL_get_peer_certificate(ssl);
         ssl_data->do_shutdown = 1;
+        ktls_check(ssl_data);
         arg->success_cb(arg->data); /* newsql_accept_ssl_success, net_accept_ssl_success, net_connect_ssl_success */
         free(arg);
         return;
@@ -106,6 +129,9 @@ static struct ssl_handshake_arg *new_ssl_handshake(struct ssl_data *ssl_data, st
     if (!ssl_data->ssl) return NULL;
 
     SSL_set_mode(ssl_data->ssl, SSL_MODE_ENABLE_PARTIAL_WRITE);
+#ifdef SSL_OP_ENABLE_KTLS
+    if (gbl_ssl_ktls) SSL_set_options(ssl_data->ssl, SSL_OP_ENABLE_KTLS);
+#endif
     SSL_set_fd(ssl_data->ssl, ssl_data->fd);
 
     struct ssl_handshake_arg *arg = malloc(sizeof(*arg));
@@ -179,6 +205,10 @@ int rd_ssl_evbuffer(struct evbuffer *rd_buf, struct ssl_data *ssl_data, int *eof
 
 int wr_ssl_evbuffer(struct ssl_data *ssl_data, struct evbuffer *wr_buf)
 {
+    if (ssl_data->ktls_send) {
+        /* no 16KB pullup: hand every chain to writev, kernel frames records */
+        return evbuffer_write(wr_buf, ssl_data->fd);
+    }
     SSL *ssl = ssl_data->ssl;
     int len = evbuffer_get_length(wr_buf);
     if (len > KB(16)) len = KB(16);
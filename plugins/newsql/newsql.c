@@ -30,6 +30,7 @@
 #include "fdb_fend.h"
 #include "sqlquery.pb-c.h"
 #include "newsql.h"
+#include <mem_protobuf.h> /* pb_alloc of sqlquery */
 
 void free_original_normalized_sql(struct sqlclntstate *);
 
@@ -303,6 +304,17 @@ static struct query_effects *newsql_get_query_effects(struct sqlclntstate *clnt)
         }                                                                      \
     }
 
+#define _has_commit_lsn(clnt, sql_response)                                    \
+    CDB2SQLRESPONSE__Snapshotinfo commit_lsn =                                 \
+        CDB2__SQLRESPONSE__SNAPSHOTINFO__INIT;                                 \
+                                                                               \
+    if (clnt->commit_lsn_file) {                                               \
+        commit_lsn.file = clnt->commit_lsn_file;                               \
+        commit_lsn.offset = clnt->commit_lsn_offset;                           \
+        sql_response.commit_lsn = &commit_lsn;                                 \
+        clnt->commit_lsn_file = clnt->commit_lsn_offset = 0;                   \
+    }
+
 int gbl_abort_on_unset_ha_flag = 0;
 static int is_snap_uid_retry(struct sqlclntstate *clnt)
 {
@@ -438,6 +450,79 @@ static int get_col_type(struct sqlclntstate *clnt, sqlite3_stmt *stmt, int col,
         }                                                                                                              \
     } while (0)
 
+struct newsql_prepared {
+    int id;
+    char *sql;
+};
+
+int gbl_newsql_max_prepared = 128;
+
+static int free_prepared(void *obj, void *arg)
+{
+    struct newsql_prepared *p = obj;
+    free(p->sql);
+    free(p);
+    return 0;
+}
+
+static void newsql_clear_prepared(struct newsql_appdata *appdata)
+{
+    appdata->prepare = 0;
+    if (!appdata->prepared) return;
+    hash_for(appdata->prepared, free_prepared, NULL);
+    hash_free(appdata->prepared);
+    hash_free(appdata->prepared_sql);
+    appdata->prepared = NULL;
+    appdata->prepared_sql = NULL;
+    appdata->last_stmt_id = 0;
+}
+
+/* Statement was prepared fine: remember its text under a new id, or find
+ * the id it already has, and hand the id back with the column names. */
+static void newsql_add_prepared(struct sqlclntstate *clnt, CDB2SQLRESPONSE *resp)
+{
+    struct newsql_appdata *appdata = clnt->appdata;
+    appdata->prepare = 0;
+    if (!appdata->prepared) {
+        appdata->prepared = hash_init_o(offsetof(struct newsql_prepared, id), sizeof(int));
+        appdata->prepared_sql = hash_init_strptr(offsetof(struct newsql_prepared, sql));
+    }
+    struct newsql_prepared *p = hash_find(appdata->prepared_sql, &clnt->sql);
+    if (!p) {
+        if (hash_get_num_entries(appdata->prepared) >= gbl_newsql_max_prepared) return;
+        if ((p = malloc(sizeof(*p))) == NULL) return;
+        if ((p->sql = strdup(clnt->sql)) == NULL) {
+            free(p);
+            return;
+        }
+        p->id = ++appdata->last_stmt_id;
+        hash_add(appdata->prepared, p);
+        hash_add(appdata->prepared_sql, p);
+    }
+    resp->has_stmt_id = 1;
+    resp->stmt_id = p->id;
+}
+
+/* Query by stmt_id: put the prepared text back into the request so that
+ * everything downstream (reqlogs, in-trans replay) sees a regular query.
+ * Ids are refused once newsql_max_prepared is turned down to 0; clients
+ * then resend the text. */
+static int newsql_resolve_prepared(struct sqlclntstate *clnt, CDB2SQLQUERY *sql_query)
+{
+    struct newsql_appdata *appdata = clnt->appdata;
+    if (!sql_query->has_stmt_id) {
+        appdata->prepare = sql_query->has_prepare && sql_query->prepare && gbl_newsql_max_prepared > 0;
+        return 0;
+    }
+    appdata->prepare = 0;
+    struct newsql_prepared *p = NULL;
+    if (appdata->prepared && gbl_newsql_max_prepared > 0) p = hash_find(appdata->prepared, &sql_query->stmt_id);
+    if (!p) return -1;
+    comdb2_free_protobuf(sql_query->sql_query);
+    sql_query->sql_query = comdb2_strdup_protobuf(p->sql);
+    return 0;
+}
+
 static int newsql_columns(struct sqlclntstate *clnt, sqlite3_stmt *stmt)
 {
     int ncols = column_count(clnt, stmt);
@@ -479,6 +564,9 @@ static int newsql_columns(struct sqlclntstate *clnt, sqlite3_stmt *stmt)
         resp.fp.data = clnt->work.aFingerprint;
         resp.fp.len = FINGERPRINTSZ;
     }
+    if (appdata->prepare) {
+        newsql_add_prepared(clnt, &resp);
+    }
     resp.has_flat_col_vals = 1;
     return newsql_response(clnt, &resp, 0);
 }
@@ -878,6 +966,7 @@ static int newsql_row_last(struct sqlclntstate *clnt)
     _has_effects(clnt, resp);
     _has_snapshot(clnt, resp);
     _has_features(clnt, resp);
+    _has_commit_lsn(clnt, resp);
     return newsql_response(clnt, &resp, 1);
 }
 
@@ -1390,6 +1479,18 @@ static int newsql_get_snapshot(struct sqlclntstate *clnt, int *file,
     return 0;
 }
 
+static int newsql_get_read_lsn(struct sqlclntstate *clnt, int *file,
+                               int *offset)
+{
+    struct newsql_appdata *appdata = clnt->appdata;
+    CDB2SQLQUERY *sqlquery = appdata->sqlquery;
+    if (!sqlquery || !sqlquery->read_lsn)
+        return -1;
+    *file = sqlquery->read_lsn->file;
+    *offset = sqlquery->read_lsn->offset;
+    return 0;
+}
+
 static int newsql_upd_snapshot(struct sqlclntstate *clnt)
 {
     struct newsql_appdata *appdata = clnt->appdata;
@@ -2256,6 +2357,7 @@ int leader_is_new(void)
 
 newsql_loop_result newsql_loop(struct sqlclntstate *clnt, CDB2SQLQUERY *sql_query)
 {
+    int unknown_stmt = newsql_resolve_prepared(clnt, sql_query);
     Pthread_mutex_lock(&clnt->sql_lk);
     clnt->sql = sql_query->sql_query;
     Pthread_mutex_unlock(&clnt->sql_lk);
@@ -2270,6 +2372,14 @@ newsql_loop_result newsql_loop(struct sqlclntstate *clnt, CDB2SQLQUERY *sql_quer
         clnt->had_errors = 0;
         clnt->ctrl_sqlengine = SQLENG_NORMAL_PROCESS;
     }
+    if (unknown_stmt) {
+        /* Not fatal to the connection: client resends the text */
+        char errstr[64];
+        snprintf(errstr, sizeof(errstr), "unknown statement id %d", sql_query->stmt_id);
+        write_response(clnt, RESPONSE_ERROR, errstr, CDB2__ERROR_CODE__NOSTATEMENT);
+        clnt->had_errors = 1;
+        return NEWSQL_SUCCESS;
+    }
     if (clnt->dbtran.mode < TRANLEVEL_SOSQL) {
         clnt->dbtran.mode = TRANLEVEL_SOSQL;
     }
@@ -2370,6 +2480,7 @@ void newsql_reset(struct sqlclntstate *clnt)
         handle_sql_intrans_unrecoverable_error(clnt);
     }
     reset_clnt(clnt, 0);
+    newsql_clear_prepared(clnt->appdata);
     clnt->tzname[0] = 0;
     clnt->osql.count_changes = 1;
     clnt->heartbeat = 1;
@@ -2386,6 +2497,7 @@ void free_newsql_appdata(struct sqlclntstate *clnt)
         appdata->postponed = NULL;
     }
     free(appdata->col_info.type);
+    newsql_clear_prepared(appdata);
 }
 
 void *(*externalMakeNewsqlAuthData)(void *, CDB2SQLQUERY__IdentityBlob *id) = NULL;
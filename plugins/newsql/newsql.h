@@ -66,7 +66,11 @@ typedef enum {
     int8_t send_intrans_response;                                              \
     int8_t protocol_version;                                              \
     struct newsql_postponed_data *postponed;                                   \
-    struct sql_col_info col_info;
+    struct sql_col_info col_info;                                              \
+    struct hash *prepared; /* stmt_id -> sql prepared on this connection */    \
+    struct hash *prepared_sql; /* sql -> stmt_id, same entries */              \
+    int last_stmt_id;                                                          \
+    int8_t prepare; /* client wants a stmt_id for the current query */
 
 void newsql_setup_clnt(struct sqlclntstate *);
 void newsql_destroy_clnt(struct sqlclntstate *);
@@ -50,6 +50,7 @@ extern const sqlite3_module systblReplStatsModule;
 extern const sqlite3_module systblLogicalOpsModule;
 extern const sqlite3_module systblSystabsModule;
 extern const sqlite3_module systblFdbInfoModule;
+extern const sqlite3_module systblFdbRowcacheModule;
 extern const sqlite3_module systblFilesModule;
 extern const sqlite3_module systblFilenamesModule;
 extern sqlite3_module systblSchemaVersionsModule;
@@ -78,6 +79,9 @@ int systblTablePropertiesInit(sqlite3 *db);
 int systblTimepartInit(sqlite3*db);
 int systblCronInit(sqlite3*db);
 int systblFingerprintsInit(sqlite3 *);
+int systblFingerprintLatencyInit(sqlite3 *db);
+int systblTableLatencyInit(sqlite3 *db);
+int systblIndexBloomFiltersInit(sqlite3 *db);
 int systblSampleQueriesInit(sqlite3 *db);
 int systblQueryPlansInit(sqlite3 *db);
 int systblViewsInit(sqlite3 *);
@@ -97,6 +101,7 @@ int systblAutoAnalyzeTablesInit(sqlite3 *db);
 int systblSystabPermissionsInit(sqlite3 *db);
 int systblTimepartPermissionsInit(sqlite3 *db);
 int systblFdbInfoInit(sqlite3 *db);
+int systblFdbRowcacheInit(sqlite3 *db);
 int systblTranCommitInit(sqlite3 *db);
 int systblTransactionStateInit(sqlite3 *db);
 int systblMemstatsInit(sqlite3 *db);
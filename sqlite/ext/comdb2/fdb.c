@@ -45,5 +45,28 @@ int systblFdbInfoInit(sqlite3 *db)
         SYSTABLE_END_OF_FIELDS);
 }
 
+sqlite3_module systblFdbRowcacheModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+int systblFdbRowcacheInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_fdb_rowcache", &systblFdbRowcacheModule,
+        fdb_rowcache_systable_collect, fdb_rowcache_systable_free,
+        sizeof(fdb_rowcache_systable_ent_t),
+        CDB2_CSTRING, "dbname", -1, offsetof(fdb_rowcache_systable_ent_t, dbname),
+        CDB2_CSTRING, "tablename", -1, offsetof(fdb_rowcache_systable_ent_t, tablename),
+        CDB2_INTEGER, "version", -1, offsetof(fdb_rowcache_systable_ent_t, version),
+        CDB2_INTEGER, "entries", -1, offsetof(fdb_rowcache_systable_ent_t, entries),
+        CDB2_INTEGER, "rows", -1, offsetof(fdb_rowcache_systable_ent_t, rows),
+        CDB2_INTEGER, "bytes", -1, offsetof(fdb_rowcache_systable_ent_t, bytes),
+        CDB2_INTEGER, "hits", -1, offsetof(fdb_rowcache_systable_ent_t, hits),
+        CDB2_INTEGER, "misses", -1, offsetof(fdb_rowcache_systable_ent_t, misses),
+        CDB2_INTEGER, "evictions", -1, offsetof(fdb_rowcache_systable_ent_t, evictions),
+        CDB2_INTEGER, "invalidations", -1, offsetof(fdb_rowcache_systable_ent_t, invalidations),
+        SYSTABLE_END_OF_FIELDS);
+}
+
 #endif /* (!defined(SQLITE_CORE) || defined(SQLITE_BUILDING_FOR_COMDB2)) \
           && !defined(SQLITE_OMIT_VIRTUALTABLE) */
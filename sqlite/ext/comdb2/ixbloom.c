@@ -0,0 +1,116 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#define SQLITE_CORE 1
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include <comdb2systblInt.h>
+#include <ezsystables.h>
+#include "comdb2.h"
+#include "sql.h"
+#include "bdb_api.h"
+
+/* Index Bloom filters of this node (the master), see bdb/ix_bloom.c */
+
+struct ix_bloom_row {
+    char *tablename;
+    char *keyname;
+    const char *state;
+    int64_t keys;
+    int64_t bits;
+    int64_t checks;
+    int64_t negatives;
+    int64_t false_positives;
+    double fp_rate;
+};
+
+static void release_ix_bloom(void *data, int nrows)
+{
+    struct ix_bloom_row *rows = data;
+    for (int i = 0; i < nrows; i++) {
+        free(rows[i].tablename);
+        free(rows[i].keyname);
+    }
+    free(rows);
+}
+
+static int ix_bloom_callback(void **data, int *nrows)
+{
+    struct ix_bloom_row *rows = NULL;
+    int n = 0, cap = 0;
+
+    for (int i = 0; i < thedb->num_dbs; i++) {
+        struct dbtable *db = thedb->dbs[i];
+        if (db->handle == NULL)
+            continue;
+        for (int ix = 0; ix < db->nix; ix++) {
+            struct bdb_ix_bloom_stat st = {0};
+            if (bdb_ix_bloom_stat(db->handle, ix, &st))
+                continue;
+            if (n == cap) {
+                int newcap = cap ? cap * 2 : 16;
+                struct ix_bloom_row *r = realloc(rows, newcap * sizeof(*r));
+                if (r == NULL) {
+                    release_ix_bloom(rows, n);
+                    return SQLITE_NOMEM;
+                }
+                rows = r;
+                cap = newcap;
+            }
+            struct ix_bloom_row *r = &rows[n++];
+            r->tablename = strdup(db->tablename);
+            r->keyname = strdup(db->schema->ix[ix]->csctag);
+            r->state = st.state;
+            r->keys = st.keys;
+            r->bits = st.bits;
+            r->checks = st.checks;
+            r->negatives = st.negatives;
+            r->false_positives = st.false_positives;
+            /* share of the absent keys the filter failed to rule out */
+            int64_t absent = st.negatives + st.false_positives;
+            r->fp_rate = absent ? (double)st.false_positives / absent : 0;
+        }
+    }
+    *data = rows;
+    *nrows = n;
+    return SQLITE_OK;
+}
+
+sqlite3_module systblIndexBloomFiltersModule = {
+    .access_flag = CDB2_ALLOW_USER,
+    .systable_lock = "comdb2_tables",
+};
+
+int systblIndexBloomFiltersInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_index_bloom_filters", &systblIndexBloomFiltersModule,
+        ix_bloom_callback, release_ix_bloom, sizeof(struct ix_bloom_row),
+        CDB2_CSTRING, "tablename", -1, offsetof(struct ix_bloom_row, tablename),
+        CDB2_CSTRING, "keyname", -1, offsetof(struct ix_bloom_row, keyname),
+        CDB2_CSTRING, "state", -1, offsetof(struct ix_bloom_row, state),
+        CDB2_INTEGER, "keys", -1, offsetof(struct ix_bloom_row, keys),
+        CDB2_INTEGER, "bits", -1, offsetof(struct ix_bloom_row, bits),
+        CDB2_INTEGER, "checks", -1, offsetof(struct ix_bloom_row, checks),
+        CDB2_INTEGER, "negatives", -1, offsetof(struct ix_bloom_row, negatives),
+        CDB2_INTEGER, "false_positives", -1,
+        offsetof(struct ix_bloom_row, false_positives),
+        CDB2_REAL, "fp_rate", -1, offsetof(struct ix_bloom_row, fp_rate),
+        SYSTABLE_END_OF_FIELDS);
+}
@@ -0,0 +1,190 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#define SQLITE_CORE 1
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include <comdb2systblInt.h>
+#include <ezsystables.h>
+#include "comdb2.h"
+#include "sql.h"
+#include "plhash.h"
+#include "tohex.h"
+#include "latency_hist.h"
+
+/* Query latency percentiles, per fingerprint and per table */
+
+static const struct {
+    const char *name;
+    int minutes;
+} windows[] = {{"1m", 1}, {"10m", 10}, {"total", 0}};
+#define NWINDOWS (sizeof(windows) / sizeof(windows[0]))
+
+struct latency_row {
+    char *name; /* fingerprint or table name */
+    char *op;   /* tables only */
+    const char *period;
+    int64_t count;
+    int64_t p50;
+    int64_t p95;
+    int64_t p99;
+    int64_t p999;
+};
+
+extern struct dbenv *thedb;
+extern hash_t *gbl_fingerprint_hash;
+extern pthread_mutex_t gbl_fingerprint_hash_mu;
+
+/* Append one row per window with values in it */
+static int add_rows(struct latency_hist *h, const char *name, const char *op,
+                    struct latency_row **rows, int *nrows, int *cap)
+{
+    for (int w = 0; w < NWINDOWS; w++) {
+        struct latency_snap snap = {0};
+        latency_hist_snap(h, windows[w].minutes, &snap);
+        if (snap.count == 0)
+            continue;
+        if (*nrows == *cap) {
+            int newcap = *cap ? *cap * 2 : 64;
+            struct latency_row *r = realloc(*rows, newcap * sizeof(*r));
+            if (r == NULL)
+                return SQLITE_NOMEM;
+            *rows = r;
+            *cap = newcap;
+        }
+        struct latency_row *r = &(*rows)[*nrows];
+        r->name = strdup(name);
+        r->op = op ? strdup(op) : NULL;
+        r->period = windows[w].name;
+        r->count = snap.count;
+        r->p50 = latency_snap_percentile(&snap, 50);
+        r->p95 = latency_snap_percentile(&snap, 95);
+        r->p99 = latency_snap_percentile(&snap, 99);
+        r->p999 = latency_snap_percentile(&snap, 99.9);
+        (*nrows)++;
+    }
+    return SQLITE_OK;
+}
+
+static void release_latency(void *data, int nrows)
+{
+    struct latency_row *rows = data;
+    for (int i = 0; i < nrows; i++) {
+        free(rows[i].name);
+        free(rows[i].op);
+    }
+    free(rows);
+}
+
+static int fingerprint_latency_callback(void **data, int *nrows)
+{
+    struct latency_row *rows = NULL;
+    int n = 0, cap = 0, rc = SQLITE_OK;
+
+    Pthread_mutex_lock(&gbl_fingerprint_hash_mu);
+    if (gbl_fingerprint_hash != NULL) {
+        void *ent;
+        unsigned int bkt;
+        struct fingerprint_track *t;
+        for (t = hash_first(gbl_fingerprint_hash, &ent, &bkt);
+             t && rc == SQLITE_OK;
+             t = hash_next(gbl_fingerprint_hash, &ent, &bkt)) {
+            char fp[FINGERPRINTSZ * 2 + 1];
+            if (t->latency == NULL)
+                continue;
+            util_tohex(fp, (char *)t->fingerprint, FINGERPRINTSZ);
+            rc = add_rows(t->latency, fp, NULL, &rows, &n, &cap);
+        }
+    }
+    Pthread_mutex_unlock(&gbl_fingerprint_hash_mu);
+
+    if (rc != SQLITE_OK) {
+        release_latency(rows, n);
+        return rc;
+    }
+    *data = rows;
+    *nrows = n;
+    return SQLITE_OK;
+}
+
+static int table_latency_callback(void **data, int *nrows)
+{
+    static const char *ops[TABLE_LATENCY_MAX] = {"read", "write"};
+    struct latency_row *rows = NULL;
+    int n = 0, cap = 0, rc = SQLITE_OK;
+
+    for (int i = 0; i < thedb->num_dbs && rc == SQLITE_OK; i++) {
+        struct dbtable *db = thedb->dbs[i];
+        for (int op = 0; op < TABLE_LATENCY_MAX && rc == SQLITE_OK; op++) {
+            if (db->latency[op])
+                rc = add_rows(db->latency[op], db->tablename, ops[op], &rows,
+                              &n, &cap);
+        }
+    }
+
+    if (rc != SQLITE_OK) {
+        release_latency(rows, n);
+        return rc;
+    }
+    *data = rows;
+    *nrows = n;
+    return SQLITE_OK;
+}
+
+sqlite3_module systblFingerprintLatencyModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+sqlite3_module systblTableLatencyModule = {
+    .access_flag = CDB2_ALLOW_USER,
+    .systable_lock = "comdb2_tables",
+};
+
+int systblFingerprintLatencyInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_fingerprint_latency", &systblFingerprintLatencyModule,
+        fingerprint_latency_callback, release_latency,
+        sizeof(struct latency_row),
+        CDB2_CSTRING, "fingerprint", -1, offsetof(struct latency_row, name),
+        CDB2_CSTRING, "period", -1, offsetof(struct latency_row, period),
+        CDB2_INTEGER, "count", -1, offsetof(struct latency_row, count),
+        CDB2_INTEGER, "p50_us", -1, offsetof(struct latency_row, p50),
+        CDB2_INTEGER, "p95_us", -1, offsetof(struct latency_row, p95),
+        CDB2_INTEGER, "p99_us", -1, offsetof(struct latency_row, p99),
+        CDB2_INTEGER, "p999_us", -1, offsetof(struct latency_row, p999),
+        SYSTABLE_END_OF_FIELDS);
+}
+
+int systblTableLatencyInit(sqlite3 *db)
+{
+    return create_system_table(
+        db, "comdb2_table_latency", &systblTableLatencyModule,
+        table_latency_callback, release_latency, sizeof(struct latency_row),
+        CDB2_CSTRING, "tablename", -1, offsetof(struct latency_row, name),
+        CDB2_CSTRING, "operation", -1, offsetof(struct latency_row, op),
+        CDB2_CSTRING, "period", -1, offsetof(struct latency_row, period),
+        CDB2_INTEGER, "count", -1, offsetof(struct latency_row, count),
+        CDB2_INTEGER, "p50_us", -1, offsetof(struct latency_row, p50),
+        CDB2_INTEGER, "p95_us", -1, offsetof(struct latency_row, p95),
+        CDB2_INTEGER, "p99_us", -1, offsetof(struct latency_row, p99),
+        CDB2_INTEGER, "p999_us", -1, offsetof(struct latency_row, p999),
+        SYSTABLE_END_OF_FIELDS);
+}
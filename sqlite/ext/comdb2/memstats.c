@@ -50,5 +50,6 @@ int systblMemstatsInit(sqlite3 *db) {
             CDB2_INTEGER, "used", -1, offsetof(comdb2ma_usage, used),
             CDB2_INTEGER, "free", -1, offsetof(comdb2ma_usage, unused),
             CDB2_INTEGER, "peak", -1, offsetof(comdb2ma_usage, peak),
+            CDB2_INTEGER, "allocs", -1, offsetof(comdb2ma_usage, nallocs),
             SYSTABLE_END_OF_FIELDS);
 }
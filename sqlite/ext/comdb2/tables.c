@@ -192,6 +192,12 @@ int comdb2SystblInit(
     rc = systblBlkseqInit(db);
   if (rc == SQLITE_OK)
     rc = systblFingerprintsInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblFingerprintLatencyInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblTableLatencyInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblIndexBloomFiltersInit(db);
   if (rc == SQLITE_OK)
     rc = systblSampleQueriesInit(db);
   if (rc == SQLITE_OK)
@@ -222,6 +228,8 @@ int comdb2SystblInit(
     rc = systblTimepartPermissionsInit(db);
   if (rc == SQLITE_OK)
     rc = systblFdbInfoInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblFdbRowcacheInit(db);
   if (rc == SQLITE_OK)
     rc = sqlite3_carray_init(db, 0, 0);
   if (rc == SQLITE_OK)
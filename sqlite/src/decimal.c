@@ -21,3 +21,60 @@ int sqlite3DecimalToString( sql_decimal_t * dec, char *str, int len){
    return 0;
 }
 
+
+#ifdef SQLITE_DECIMAL_COEF
+/* 10^34, one more than the largest decQuad coefficient */
+#define DECIMAL_COEF_LIMIT \
+   ((sql_decimal_coef_t)10000000000000000LL * 1000000000000000000LL)
+
+/*
+** Split a decimal into coefficient and exponent.  Returns -1 for values the
+** integer form cannot carry (infinities, NaNs and negative zero), which
+** callers leave to decNumber.
+*/
+int sqlite3DecimalToCoef(const sql_decimal_t *dec, sql_decimal_coef_t *coef,
+                         int *exp){
+   const decQuad *quad = (const decQuad *)dec;
+   uint8_t bcd[DECQUAD_Pmax];
+   sql_decimal_coef_t c = 0;
+   int32_t sign;
+   int i;
+
+   if( !decQuadIsFinite(quad) ) return -1;
+   sign = decQuadGetCoefficient(quad, bcd);
+   for(i=0; i<DECQUAD_Pmax && bcd[i]==0; i++);
+   if( i==DECQUAD_Pmax && sign ) return -1;
+   for(; i<DECQUAD_Pmax; i++){
+      c = c*10 + bcd[i];
+   }
+   *coef = sign ? -c : c;
+   *exp = decQuadGetExponent(quad);
+   return 0;
+}
+
+/* Inverse of sqlite3DecimalToCoef(); coef must satisfy
+** sqlite3DecimalCoefFits() and exp come from a finite decimal */
+void sqlite3DecimalFromCoef(sql_decimal_t *dec, sql_decimal_coef_t coef,
+                            int exp){
+   uint8_t bcd[DECQUAD_Pmax];
+   unsigned __int128 u;
+   int32_t sign = 0;
+   int i;
+
+   if( coef<0 ){
+      sign = DECFLOAT_Sign;
+      u = -(unsigned __int128)coef;
+   }else{
+      u = coef;
+   }
+   for(i=DECQUAD_Pmax-1; i>=0; i--){
+      bcd[i] = u % 10;
+      u /= 10;
+   }
+   decQuadFromBCD((decQuad *)dec, exp, bcd, sign);
+}
+
+int sqlite3DecimalCoefFits(sql_decimal_coef_t coef){
+   return coef<DECIMAL_COEF_LIMIT && coef>-DECIMAL_COEF_LIMIT;
+}
+#endif
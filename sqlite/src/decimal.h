@@ -4,4 +4,21 @@
 typedef decQuad   sql_decimal_t;
 int sqlite3DecimalToString(sql_decimal_t * dec, char *str, int len);
 
+#ifdef __SIZEOF_INT128__
+/*
+** Fixed point view of a finite decimal: value == coef * 10^exp.  A decQuad
+** holds at most DECQUAD_Pmax (34) digits, so the coefficient always fits in
+** an __int128; values sharing an exponent can be added as plain integers,
+** exactly like decQuadAdd would, as long as the result keeps to 34 digits.
+*/
+#define SQLITE_DECIMAL_COEF 1
+/* sqlite memory (lookaside slots) is only 8 byte aligned */
+typedef __int128 sql_decimal_coef_t __attribute__((aligned(8)));
+int sqlite3DecimalToCoef(const sql_decimal_t *dec, sql_decimal_coef_t *coef,
+                         int *exp);
+void sqlite3DecimalFromCoef(sql_decimal_t *dec, sql_decimal_coef_t coef,
+                            int exp);
+int sqlite3DecimalCoefFits(sql_decimal_coef_t coef);
+#endif
+
 #endif
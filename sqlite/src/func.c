@@ -1088,6 +1088,34 @@ static void partitionInfoFunc(
   }
 }
 
+extern int comdb2_summary_valid(const char *tablename, const char *column,
+                                const char *min, const char *max);
+/*
+** Implementation of the comdb2_summary_valid() SQL function.  This returns
+** 1 if the committed min/max summary of a time partition shard is still
+** the one given, 0 otherwise; it guards the terms that prune the shard
+*/
+static void summaryValidFunc(
+  sqlite3_context *context,
+  int argc,
+  sqlite3_value **argv
+){
+  const char *zArg[4];
+  int i;
+
+  assert( argc==4 );
+  for(i=0; i<4; i++){
+    if( sqlite3_value_type(argv[i]) != SQLITE_TEXT ){
+      sqlite3_result_int(context, 0);
+      return;
+    }
+    zArg[i] = (const char *)sqlite3_value_text(argv[i]);
+  }
+
+  sqlite3_result_int(context,
+                     comdb2_summary_valid(zArg[0], zArg[1], zArg[2], zArg[3]));
+}
+
 /*
 ** Implementation of the comdb2_starttime() SQL function.
 */
@@ -2388,9 +2416,64 @@ struct SumCtx {
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
   u8 decs;          /* True if summing decimals */
   decQuad decSum;   /* decQuad aggregation */
+#if defined(SQLITE_DECIMAL_COEF)
+  u8 decFast;       /* True if the sum is in decCoef/decExp, not decSum */
+  int decExp;       /* Exponent shared by all decimals summed so far */
+  sql_decimal_coef_t decCoef; /* Integer sum of their coefficients */
+#endif
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 };
 
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+/* Bring decSum up to date before it is read.  The integer sum is kept, a
+** window function may go on adding to it. */
+static void sumDecimalFlush(SumCtx *p){
+#if defined(SQLITE_DECIMAL_COEF)
+  if( p->decFast ){
+    sqlite3DecimalFromCoef(&p->decSum, p->decCoef, p->decExp);
+  }
+#endif
+}
+
+/*
+** Decimal columns have a fixed scale, so a SUM() usually adds values that
+** all share one exponent.  Those are summed as integer coefficients, which
+** gives the same result as decQuadAdd() without going through decNumber
+** for every row.  The first value with a different exponent, or a sum that
+** would no longer fit in 34 digits, moves the sum to decSum and decQuadAdd()
+** for the rest of the aggregate.
+**
+** Returns 1 if the value was added, 0 if the caller has to add it to
+** decSum.  Rounding down turns x + -x into -0, which the integer sum cannot
+** express, so that mode always uses decNumber.
+*/
+static int sumDecimalFast(SumCtx *p, const decQuad *pDec){
+#if defined(SQLITE_DECIMAL_COEF)
+  sql_decimal_coef_t coef;
+  int exp;
+
+  if( p->decs && !p->decFast ) return 0;
+  if( gbl_decimal_rounding!=DEC_ROUND_FLOOR
+   && sqlite3DecimalToCoef(pDec, &coef, &exp)==0 ){
+    if( p->decs==0 ){
+      p->decs = p->decFast = 1;
+      p->decCoef = coef;
+      p->decExp = exp;
+      return 1;
+    }
+    /* both are below 10^34, the sum cannot overflow an __int128 */
+    if( exp==p->decExp && sqlite3DecimalCoefFits(p->decCoef + coef) ){
+      p->decCoef += coef;
+      return 1;
+    }
+  }
+  sumDecimalFlush(p);
+  p->decFast = 0;
+#endif
+  return 0;
+}
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
+
 /*
 ** Routines used to compute the sum, average, and total.
 **
@@ -2420,7 +2503,9 @@ static void sumStep(sqlite3_context *context, int argc, sqlite3_value **argv){
     }else if( type==SQLITE_DECIMAL ){
       intv_t v = *(intv_t*)sqlite3_value_interval(argv[0], SQLITE_DECIMAL);
 
-      if( p->decs==0 ){
+      if( sumDecimalFast(p, &v.u.dec) ){
+        /* added to the integer sum */
+      }else if( p->decs==0 ){
         p->decSum = v.u.dec;
         p->decs = 1;
 
@@ -2502,6 +2587,7 @@ static void sumFinalize(sqlite3_context *context){
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
     }else if( p->decs){
        intv_t res;
+       sumDecimalFlush(p);
        res.type = INTV_DECIMAL_TYPE;
        res.sign = 0;
        res.u.dec = p->decSum;
@@ -2523,6 +2609,7 @@ static void avgFinalize(sqlite3_context *context){
       decQuad res;
       intv_t  tv;
 
+      sumDecimalFlush(p);
       dec_ctx_init( &ctx, DEC_INIT_DECQUAD, gbl_decimal_rounding);
       decQuadFromInt32( &denom, p->cnt);
       decQuadDivide( &res, &p->decSum, &denom, &ctx);
@@ -2547,6 +2634,7 @@ static void totalFinalize(sqlite3_context *context){
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
   if( p && p->decs ){
     intv_t res;
+    sumDecimalFlush(p);
     res.type = INTV_DECIMAL_TYPE;
     res.sign = 0;
     res.u.dec = p->decSum;
@@ -3085,6 +3173,7 @@ void sqlite3RegisterBuiltinFunctions(void){
     FUNCTION(comdb2_semver,         0, 0, 0, comdb2SemVerFunc),
     FUNCTION(table_version,         1, 0, 0, tableVersionFunc),
     FUNCTION(partition_info,        2, 0, 0, partitionInfoFunc),
+    FUNCTION(comdb2_summary_valid,  4, 0, 0, summaryValidFunc),
     FUNCTION(comdb2_host,           0, 0, 0, comdb2HostFunc),
     FUNCTION(comdb2_node,           0, 0, 0, comdb2HostFunc),
     FUNCTION(comdb2_port,           0, 0, 0, comdb2PortFunc),
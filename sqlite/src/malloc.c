@@ -639,6 +639,27 @@ void *sqlite3DbReallocWithMutex(sqlite3 *db, void *p, u64 n, int bZero){
   }
   return pNew;
 }
+
+/*
+** Non-zero while allocating memory that is released by the time the
+** running statement is reset.  The memory methods may serve such requests
+** from a statement arena.
+*/
+__thread int sqlite3StmtAllocScope = 0;
+
+/*
+** Allocate memory which does not outlive the running statement, such as
+** register contents and unpacked records.  Outside of sqlite3VdbeExec()
+** this is plain sqlite3DbMallocRaw().
+*/
+void *sqlite3DbMallocRawStmt(sqlite3 *db, u64 n){
+  void *p;
+  if( db==0 || db->nVdbeExec==0 ) return sqlite3DbMallocRaw(db, n);
+  sqlite3StmtAllocScope++;
+  p = sqlite3DbMallocRaw(db, n);
+  sqlite3StmtAllocScope--;
+  return p;
+}
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
 /*
@@ -87,6 +87,7 @@ extern int comdb2_register_limit(int, int);
 extern void comdb2_register_offset(int, int, int);
 extern const char *comdb2_get_dbname(void);
 extern void comdb2_set_verify_remote_schemas(void);
+extern void comdb2_summary_prune(Parse *, Select *);
 
 static void _set_src_recording(
   Parse *pParse,
@@ -6166,6 +6167,13 @@ int sqlite3Select(
 #endif
   }
 
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  /* Skip time partition shards whose summary rules out the WHERE clause */
+  if( pTabList->nSrc==1 && p->pWhere ){
+    comdb2_summary_prune(pParse, p);
+  }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
+
   /* Various elements of the SELECT copied into local variables for
   ** convenience */
   pEList = p->pEList;
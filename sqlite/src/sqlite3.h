@@ -4860,6 +4860,13 @@ void stmt_set_vlock_tables(sqlite3_stmt *, char **, int, int, int);
 void stmt_set_has_scalar_func(sqlite3_stmt *, int);
 int stmt_do_column_names_match(sqlite3_stmt *);
 int stmt_do_column_decltypes_match(sqlite3_stmt *pStmt);
+int stmt_inserts_rows(sqlite3_stmt *);
+int stmt_reads_vtab_module(sqlite3_stmt *, const char *);
+int stmt_set_array_loop(sqlite3_stmt *, int (*)(void *), void *);
+int stmt_rebind_int64(sqlite3_stmt *, int, sqlite3_int64);
+int stmt_rebind_double(sqlite3_stmt *, int, double);
+int stmt_rebind_text(sqlite3_stmt *, int, const char *, int);
+int stmt_rebind_blob(sqlite3_stmt *, int, const void *, int);
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
@@ -3987,6 +3987,8 @@ int sqlite3DbMallocSize(sqlite3*, void*);
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
 void *sqlite3DbMallocWithMutex(sqlite3 *, u64, int);
 void *sqlite3DbReallocWithMutex(sqlite3 *, void *, u64, int);
+void *sqlite3DbMallocRawStmt(sqlite3 *, u64);
+extern __thread int sqlite3StmtAllocScope;
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 void *sqlite3PageMalloc(int);
 void sqlite3PageFree(void*);
@@ -1363,6 +1363,21 @@ case OP_Halt: {
 #ifdef SQLITE_DEBUG
   if( pOp->p2==OE_Abort ){ sqlite3VdbeAssertAbortable(p); }
 #endif
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  if( pOp->p1==SQLITE_OK && p->pFrame==0 && p->xArrayRow ){
+    /* Array insert: run the row segment again while xArrayRow binds the
+    ** next element (see stmt_set_array_loop). */
+    rc = p->xArrayRow(p->pArrayArg);
+    if( rc==SQLITE_ROW ){
+      rc = SQLITE_OK;
+      pOp = &aOp[p->iArrayLoop - 1];
+      break;
+    }
+    p->xArrayRow = 0;
+    if( rc!=SQLITE_DONE ) goto abort_due_to_error;
+    rc = SQLITE_OK;
+  }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   if( pOp->p1==SQLITE_OK && p->pFrame ){
     /* Halt the sub-program. Return control to the parent frame. */
     pFrame = p->pFrame;
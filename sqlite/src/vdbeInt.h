@@ -606,6 +606,9 @@ struct Vdbe {
   int oldColCount;        /* Column count (refer: sqlitex)*/
   u8 fingerprint_added;   /* Whether fingerprint was added? Only used in SP code */
   int fdb_warn_this_op;   /* Warn about this opcode which is ineligible for cursor hint */
+  int (*xArrayRow)(void*);/* Array insert: bind the next row at OP_Halt */
+  void *pArrayArg;        /* First argument to xArrayRow */
+  int iArrayLoop;         /* Array insert: first op of the row segment */
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 };
 
@@ -234,6 +234,145 @@ int stmt_do_column_decltypes_match(sqlite3_stmt *pStmt) {
   return 1;
 }
 
+/* Return 1 if the program inserts rows into a table: an OP_Insert that is
+** not part of an UPDATE, on a cursor opened for writing. */
+int stmt_inserts_rows(sqlite3_stmt *pStmt) {
+  Vdbe *vdbe = (Vdbe *)pStmt;
+  int i, j;
+  if (!vdbe || vdbe->readOnly)
+    return 0;
+  for(i=0; i<vdbe->nOp; i++){
+    Op *pOp = &vdbe->aOp[i];
+    if( pOp->opcode!=OP_Insert || (pOp->p5 & OPFLAG_ISUPDATE) )
+      continue;
+    for(j=0; j<vdbe->nOp; j++){
+      if( vdbe->aOp[j].opcode==OP_OpenWrite && vdbe->aOp[j].p1==pOp->p1 )
+        return 1;
+    }
+  }
+  return 0;
+}
+
+/* Return 1 if the program reads a virtual table of module zModule. */
+int stmt_reads_vtab_module(sqlite3_stmt *pStmt, const char *zModule) {
+  Vdbe *vdbe = (Vdbe *)pStmt;
+  int i;
+  if (!vdbe)
+    return 0;
+  for(i=0; i<vdbe->nOp; i++){
+    Op *pOp = &vdbe->aOp[i];
+    if( pOp->opcode==OP_VOpen && pOp->p4type==P4_VTAB &&
+        sqlite3StrICmp(pOp->p4.pVtab->pMod->zName, zModule)==0 )
+      return 1;
+  }
+  return 0;
+}
+
+/* Return 1 if pOp may be part of the row segment of an array insert:
+** it only computes, checks or inserts the row being added. */
+static int arrayLoopOp(const Op *pOp) {
+  switch( pOp->opcode ){
+    case OP_Variable: case OP_SCopy: case OP_Copy: case OP_IntCopy:
+    case OP_Move: case OP_Null: case OP_SoftNull: case OP_Integer:
+    case OP_Int64: case OP_Real: case OP_String8: case OP_String:
+    case OP_Blob: case OP_NewRowid: case OP_HaltIfNull: case OP_Affinity:
+    case OP_Cast: case OP_RealAffinity: case OP_MustBeInt: case OP_AddImm:
+    case OP_IsNull: case OP_NotNull: case OP_Add: case OP_Subtract:
+    case OP_Multiply: case OP_Divide: case OP_Remainder: case OP_Concat:
+    case OP_MakeRecord: case OP_IdxInsert: case OP_Noop: case OP_Explain:
+      return 1;
+    case OP_Insert:
+      return (pOp->p5 & OPFLAG_ISUPDATE)==0;
+    case OP_Halt:
+      return pOp->p1!=SQLITE_OK;
+  }
+  return 0;
+}
+
+/* Make the program run its insert once per element of an array binding.
+** The instructions ahead of the final OP_Halt that build and insert the
+** row form the row segment; it must hold every OP_Variable and an
+** OP_Insert, and jumps may not cross its bounds.  Each time the segment
+** reaches OP_Halt, xRow rebinds the parameters with stmt_rebind_*() and
+** returns SQLITE_ROW to run it again, or SQLITE_DONE to halt.  Returns 1
+** if the loop is set, 0 if the statement has to be stepped once per
+** element instead.  A NULL xRow clears the loop. */
+int stmt_set_array_loop(sqlite3_stmt *pStmt, int (*xRow)(void *), void *pArg) {
+  Vdbe *vdbe = (Vdbe *)pStmt;
+  int i, iHalt, iStart, nInsert = 0;
+  vdbe->xArrayRow = 0;
+  vdbe->pArrayArg = 0;
+  vdbe->iArrayLoop = 0;
+  if( xRow==0 || vdbe->readOnly )
+    return 0;
+  for(iHalt=0; iHalt<vdbe->nOp; iHalt++){
+    Op *pOp = &vdbe->aOp[iHalt];
+    if( pOp->opcode==OP_Halt && pOp->p1==SQLITE_OK ) break;
+  }
+  if( iHalt>=vdbe->nOp )
+    return 0;
+  for(iStart=iHalt; iStart>0 && arrayLoopOp(&vdbe->aOp[iStart-1]); iStart--){}
+  for(i=0; i<vdbe->nOp; i++){
+    Op *pOp = &vdbe->aOp[i];
+    int inLoop = i>=iStart && i<iHalt;
+    if( pOp->opcode==OP_Variable && !inLoop )
+      return 0;
+    if( pOp->opcode==OP_Insert && inLoop )
+      nInsert++;
+    if( (sqlite3OpcodeProperty[pOp->opcode] & OPFLG_JUMP)!=0 && pOp->p2>0 ){
+      int toLoop = pOp->p2>iStart && pOp->p2<=iHalt;
+      if( inLoop ? (pOp->p2<iStart || pOp->p2>iHalt) : toLoop )
+        return 0;
+    }
+  }
+  if( nInsert==0 )
+    return 0;
+  vdbe->xArrayRow = xRow;
+  vdbe->pArrayArg = pArg;
+  vdbe->iArrayLoop = iStart;
+  return 1;
+}
+
+/* Clear parameter i of a statement for stmt_rebind_*(), which may run
+** while the statement does, from the xRow callback of an array loop. */
+static Mem *stmtRebindVar(sqlite3_stmt *pStmt, int i) {
+  Vdbe *vdbe = (Vdbe *)pStmt;
+  Mem *pVar;
+  if( i<1 || i>vdbe->nVar )
+    return 0;
+  pVar = &vdbe->aVar[i-1];
+  sqlite3VdbeMemRelease(pVar);
+  pVar->flags = MEM_Null;
+  return pVar;
+}
+
+int stmt_rebind_int64(sqlite3_stmt *pStmt, int i, sqlite3_int64 iValue) {
+  Mem *pVar = stmtRebindVar(pStmt, i);
+  if( pVar==0 ) return SQLITE_RANGE;
+  sqlite3VdbeMemSetInt64(pVar, iValue);
+  return SQLITE_OK;
+}
+
+int stmt_rebind_double(sqlite3_stmt *pStmt, int i, double rValue) {
+  Mem *pVar = stmtRebindVar(pStmt, i);
+  if( pVar==0 ) return SQLITE_RANGE;
+  sqlite3VdbeMemSetDouble(pVar, rValue);
+  return SQLITE_OK;
+}
+
+/* Text and blobs are not copied; they must outlive the row. */
+int stmt_rebind_text(sqlite3_stmt *pStmt, int i, const char *z, int n) {
+  Mem *pVar = stmtRebindVar(pStmt, i);
+  if( pVar==0 ) return SQLITE_RANGE;
+  return sqlite3VdbeMemSetStr(pVar, z, n, SQLITE_UTF8, SQLITE_STATIC);
+}
+
+int stmt_rebind_blob(sqlite3_stmt *pStmt, int i, const void *z, int n) {
+  Mem *pVar = stmtRebindVar(pStmt, i);
+  if( pVar==0 ) return SQLITE_RANGE;
+  return sqlite3VdbeMemSetStr(pVar, z, n, 0, SQLITE_STATIC);
+}
+
 void stmt_set_vlock_tables(sqlite3_stmt *pStmt, char **vTableLocks, int numVTableLocks, int hasVTables, int flags){
   Vdbe *vdbe = (Vdbe *)pStmt;
   stmt_free_vtable_locks(pStmt);
@@ -4465,7 +4465,11 @@ UnpackedRecord *sqlite3VdbeAllocUnpackedRecord(
   UnpackedRecord *p;              /* Unpacked record to return */
   int nByte;                      /* Number of bytes required for *p */
   nByte = ROUND8(sizeof(UnpackedRecord)) + sizeof(Mem)*(pKeyInfo->nKeyField+1);
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  p = (UnpackedRecord *)sqlite3DbMallocRawStmt(pKeyInfo->db, nByte);
+#else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   p = (UnpackedRecord *)sqlite3DbMallocRaw(pKeyInfo->db, nByte);
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   if( !p ) return 0;
   p->aMem = (Mem*)&((char*)p)[ROUND8(sizeof(UnpackedRecord))];
   assert( pKeyInfo->aSortOrder!=0 );
@@ -227,7 +227,11 @@ SQLITE_NOINLINE int sqlite3VdbeMemGrow(Mem *pMem, int n, int bPreserve){
     bPreserve = 0;
   }else{
     if( pMem->szMalloc>0 ) sqlite3DbFreeNN(pMem->db, pMem->zMalloc);
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+    pMem->zMalloc = sqlite3DbMallocRawStmt(pMem->db, n);
+#else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
     pMem->zMalloc = sqlite3DbMallocRaw(pMem->db, n);
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   }
   if( pMem->zMalloc==0 ){
     sqlite3VdbeMemSetNull(pMem);
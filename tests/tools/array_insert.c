@@ -0,0 +1,258 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <libgen.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <cdb2api.h>
+
+static char *file;
+
+#define FAIL(db, what, rc)                                                                                             \
+    do {                                                                                                               \
+        fprintf(stderr, "%s:%d %s rc=%d:%s\n", file, __LINE__, what, rc, cdb2_errstr(db));                             \
+        abort();                                                                                                       \
+    } while (0)
+
+/* Run sql and drain it; returns the first non-zero rc. */
+static int run(cdb2_hndl_tp *db, const char *sql)
+{
+    int rc = cdb2_run_statement(db, sql);
+    if (rc == 0) {
+        while ((rc = cdb2_next_record(db)) == CDB2_OK)
+            ;
+        if (rc == CDB2_OK_DONE)
+            rc = 0;
+    }
+    cdb2_clearbindings(db);
+    return rc;
+}
+
+static int64_t select_int(cdb2_hndl_tp *db, const char *sql)
+{
+    int rc;
+
+    if ((rc = cdb2_run_statement(db, sql)) != 0)
+        FAIL(db, "cdb2_run_statement", rc);
+    if ((rc = cdb2_next_record(db)) != CDB2_OK)
+        FAIL(db, "cdb2_next_record", rc);
+    int64_t v = *(int64_t *)cdb2_column_value(db, 0);
+    if ((rc = cdb2_next_record(db)) != CDB2_OK_DONE)
+        FAIL(db, "cdb2_next_record", rc);
+    return v;
+}
+
+static int64_t count(cdb2_hndl_tp *db, const char *where)
+{
+    char sql[256];
+
+    snprintf(sql, sizeof(sql), "select count(*) from t where %s", where);
+    return select_int(db, sql);
+}
+
+static int64_t metric(cdb2_hndl_tp *db, const char *name)
+{
+    char sql[256];
+
+    snprintf(sql, sizeof(sql), "select cast(value as integer) from comdb2_metrics where name = '%s'", name);
+    return select_int(db, sql);
+}
+
+static int64_t now_ms(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+static void expect_count(cdb2_hndl_tp *db, const char *where, int64_t want)
+{
+    int64_t cnt = count(db, where);
+    printf("%s:%d count where %s is %lld\n", file, __LINE__, where, (long long)cnt);
+    if (cnt != want) {
+        fprintf(stderr, "%s:%d expected %lld\n", file, __LINE__, (long long)want);
+        abort();
+    }
+}
+
+static void bind_ints(cdb2_hndl_tp *db, const char *name, int64_t *v, int n)
+{
+    int rc = cdb2_bind_array(db, name, CDB2_INTEGER, v, n, sizeof(v[0]));
+    if (rc)
+        FAIL(db, "cdb2_bind_array", rc);
+}
+
+static void multi_row(cdb2_hndl_tp *db)
+{
+    int32_t a[] = {1, 2, 3, 4, 5};
+    double b[] = {1.5, 2.5, 3.5, 4.5, 5.5};
+    char *c[] = {"one", "two", "three", "four", "five"};
+    struct {
+        size_t len;
+        void *data;
+    } d[5];
+    int rc;
+
+    for (int i = 0; i < 5; ++i) {
+        d[i].data = c[i];
+        d[i].len = strlen(c[i]);
+    }
+    if ((rc = cdb2_bind_array(db, "a", CDB2_INTEGER, a, 5, sizeof(a[0]))) != 0 ||
+        (rc = cdb2_bind_array(db, "b", CDB2_REAL, b, 5, 0)) != 0 ||
+        (rc = cdb2_bind_array(db, "c", CDB2_CSTRING, c, 5, 0)) != 0 ||
+        (rc = cdb2_bind_array(db, "d", CDB2_BLOB, d, 5, 0)) != 0)
+        FAIL(db, "cdb2_bind_array", rc);
+    if ((rc = run(db, "insert into t(a, b, c, d) values(@a, @b, @c, @d)")) != 0)
+        FAIL(db, "multi-row insert", rc);
+
+    cdb2_effects_tp effects;
+    if ((rc = cdb2_get_effects(db, &effects)) != 0)
+        FAIL(db, "cdb2_get_effects", rc);
+    if (effects.num_inserted != 5) {
+        fprintf(stderr, "%s:%d num_inserted %d, expected 5\n", file, __LINE__, effects.num_inserted);
+        abort();
+    }
+    expect_count(db, "a between 1 and 5", 5);
+    expect_count(db, "b = a + 0.5 and cast(d as text) = c", 5);
+}
+
+static void mixed(cdb2_hndl_tp *db)
+{
+    int64_t a[] = {6, 7, 8, 9, 10};
+    int rc;
+
+    bind_ints(db, "a", a, 5);
+    if ((rc = cdb2_bind_param(db, "c", CDB2_CSTRING, "mixed", 5)) != 0)
+        FAIL(db, "cdb2_bind_param", rc);
+    if ((rc = run(db, "insert into t(a, c) values(@a, @c)")) != 0)
+        FAIL(db, "mixed insert", rc);
+    expect_count(db, "c = 'mixed'", 5);
+}
+
+/* an element failing in the middle takes the earlier ones with it */
+static void middle_fails(cdb2_hndl_tp *db)
+{
+    int64_t dup[] = {11, 12, 3, 13};
+    int64_t a[] = {21, 22, 23};
+    char *c[] = {"ok", "this string is far too long for a cstring(16)", "ok"};
+    int rc;
+
+    bind_ints(db, "a", dup, 4);
+    if ((rc = run(db, "insert into t(a) values(@a)")) == 0) {
+        fprintf(stderr, "%s:%d insert with a duplicate succeeded\n", file, __LINE__);
+        abort();
+    }
+    printf("%s:%d duplicate failed rc=%d:%s\n", file, __LINE__, rc, cdb2_errstr(db));
+    expect_count(db, "a between 11 and 13", 0);
+
+    bind_ints(db, "a", a, 3);
+    if ((rc = cdb2_bind_array(db, "c", CDB2_CSTRING, c, 3, 0)) != 0)
+        FAIL(db, "cdb2_bind_array", rc);
+    if ((rc = run(db, "insert into t(a, c) values(@a, @c)")) == 0) {
+        fprintf(stderr, "%s:%d insert with a bad value succeeded\n", file, __LINE__);
+        abort();
+    }
+    printf("%s:%d bad value failed rc=%d:%s\n", file, __LINE__, rc, cdb2_errstr(db));
+    expect_count(db, "a between 21 and 23", 0);
+}
+
+static void in_transaction(cdb2_hndl_tp *db)
+{
+    int64_t a[] = {31, 32, 33};
+    int rc;
+
+    if ((rc = run(db, "begin")) != 0)
+        FAIL(db, "begin", rc);
+    bind_ints(db, "a", a, 3);
+    if ((rc = run(db, "insert into t(a) values(@a)")) != 0)
+        FAIL(db, "insert in transaction", rc);
+    if ((rc = run(db, "insert into t(a) values(34)")) != 0)
+        FAIL(db, "insert in transaction", rc);
+    if ((rc = run(db, "rollback")) != 0)
+        FAIL(db, "rollback", rc);
+    expect_count(db, "a between 31 and 34", 0);
+
+    if ((rc = run(db, "begin")) != 0)
+        FAIL(db, "begin", rc);
+    bind_ints(db, "a", a, 3);
+    if ((rc = run(db, "insert into t(a) values(@a)")) != 0)
+        FAIL(db, "insert in transaction", rc);
+    if ((rc = run(db, "insert into t(a) values(34)")) != 0)
+        FAIL(db, "insert in transaction", rc);
+    if ((rc = run(db, "commit")) != 0)
+        FAIL(db, "commit", rc);
+    expect_count(db, "a between 31 and 34", 4);
+}
+
+#define NBATCH 20000
+
+/* a table without blobs takes the packed OSQL_INSERT path (osql_insert_batch
+ * in lrl.options); report the time against the same rows through carray() */
+static void batched(cdb2_hndl_tp *db)
+{
+    static int64_t a[NBATCH];
+    static char *c[NBATCH];
+    static char cs[NBATCH][16];
+    int rc;
+
+    for (int i = 0; i < NBATCH; ++i) {
+        a[i] = i;
+        snprintf(cs[i], sizeof(cs[i]), "row %d", i);
+        c[i] = cs[i];
+    }
+
+    int64_t loops = metric(db, "sql_array_insert_loops");
+    int64_t batches = metric(db, "osql_insert_batches");
+    int64_t start = now_ms();
+    bind_ints(db, "a", a, NBATCH);
+    if ((rc = cdb2_bind_array(db, "c", CDB2_CSTRING, c, NBATCH, 0)) != 0)
+        FAIL(db, "cdb2_bind_array", rc);
+    if ((rc = run(db, "insert into u(a, c) values(@a, @c)")) != 0)
+        FAIL(db, "batched insert", rc);
+    int64_t array_ms = now_ms() - start;
+
+    start = now_ms();
+    bind_ints(db, "a", a, NBATCH);
+    if ((rc = run(db, "insert into v(a) select value from carray(@a)")) != 0)
+        FAIL(db, "carray insert", rc);
+    int64_t carray_ms = now_ms() - start;
+
+    loops = metric(db, "sql_array_insert_loops") - loops;
+    batches = metric(db, "osql_insert_batches") - batches;
+    printf("%s:%d %d rows: array insert %lld ms, carray insert %lld ms, %lld loops, %lld packed messages\n", file,
+           __LINE__, NBATCH, (long long)array_ms, (long long)carray_ms, (long long)loops, (long long)batches);
+    if (loops != 1 || batches < 2) {
+        fprintf(stderr, "%s:%d expected 1 loop and several packed messages\n", file, __LINE__);
+        abort();
+    }
+    if (select_int(db, "select count(*) from u where c = 'row ' || a") != NBATCH ||
+        select_int(db, "select sum(a) from u") != (int64_t)NBATCH * (NBATCH - 1) / 2 ||
+        select_int(db, "select count(*) from v") != NBATCH) {
+        fprintf(stderr, "%s:%d batched rows do not match\n", file, __LINE__);
+        abort();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    cdb2_hndl_tp *db;
+    char *conf = getenv("CDB2_CONFIG");
+    int rc;
+
+    file = basename(__FILE__);
+    if (conf)
+        cdb2_set_comdb2db_config(conf);
+    if ((rc = cdb2_open(&db, argv[1], conf ? "default" : "local", 0)) != 0)
+        FAIL(db, "cdb2_open", rc);
+
+    multi_row(db);
+    mixed(db);
+    middle_fails(db);
+    in_transaction(db);
+    expect_count(db, "1", 14);
+    batched(db);
+
+    cdb2_close(db);
+    printf("%s:%d pass\n", file, __LINE__);
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cdb2api.h>
+
+/* Each step prints a "> step" line; with the handle's debug trace on the
+ * caller can tell from stderr whether statements went by id or as text. */
+
+static const char *db;
+static const char *tier = "local";
+
+static cdb2_hndl_tp *open_hndl(const char *host, int trace)
+{
+    cdb2_hndl_tp *hndl = NULL;
+    int rc;
+
+    if (host)
+        rc = cdb2_open(&hndl, db, host, CDB2_DIRECT_CPU);
+    else
+        rc = cdb2_open(&hndl, db, tier, 0);
+    if (rc) {
+        fprintf(stderr, "cdb2_open rc %d %s\n", rc, cdb2_errstr(hndl));
+        exit(1);
+    }
+    if (trace) {
+        cdb2_use_prepared(hndl);
+        cdb2_set_debug_trace(hndl);
+    }
+    return hndl;
+}
+
+static void step(const char *name)
+{
+    fflush(stderr);
+    printf("> %s\n", name);
+    fflush(stdout);
+}
+
+/* run sql returning one integer; 'a' is bound to @a if not 0 */
+static long long run(cdb2_hndl_tp *hndl, const char *sql, int a)
+{
+    long long val = 0;
+    int rc;
+
+    if (a)
+        cdb2_bind_param(hndl, "a", CDB2_INTEGER, &a, sizeof(a));
+    rc = cdb2_run_statement(hndl, sql);
+    cdb2_clearbindings(hndl);
+    if (rc) {
+        fprintf(stderr, "'%s' rc %d %s\n", sql, rc, cdb2_errstr(hndl));
+        exit(1);
+    }
+    while ((rc = cdb2_next_record(hndl)) == CDB2_OK) {
+        if (cdb2_column_type(hndl, 0) == CDB2_INTEGER)
+            val = *(long long *)cdb2_column_value(hndl, 0);
+    }
+    if (rc != CDB2_OK_DONE) {
+        fprintf(stderr, "'%s' next rc %d %s\n", sql, rc, cdb2_errstr(hndl));
+        exit(1);
+    }
+    return val;
+}
+
+static void expect(cdb2_hndl_tp *hndl, const char *sql, int a, long long want)
+{
+    long long got = run(hndl, sql, a);
+    if (got != want) {
+        fprintf(stderr, "'%s' @a=%d returned %lld, expected %lld\n", sql, a,
+                got, want);
+        exit(1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *byval = "select a from t where a = @a";
+    const char *count = "select count(*) from t";
+    cdb2_hndl_tp *hndl, *admin;
+    char sql[128];
+    long long maxprep;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <dbname>\n", argv[0]);
+        return 1;
+    }
+    db = argv[1];
+    if (getenv("CDB2_CONFIG")) {
+        cdb2_set_comdb2db_config(getenv("CDB2_CONFIG"));
+        tier = "default";
+    }
+
+    admin = open_hndl(NULL, 0);
+    run(admin, "drop table if exists t", 0);
+    run(admin, "create table t(a int)", 0);
+    run(admin, "insert into t select value from generate_series(1, 10)", 0);
+    cdb2_close(admin);
+
+    step("execute by id");
+    hndl = open_hndl(NULL, 1);
+    for (int i = 1; i <= 5; i++)
+        expect(hndl, byval, i, i);
+
+    step("unknown id");
+    /* tunables are per node: change it where the handle is connected */
+    admin = open_hndl(cdb2_host(hndl), 0);
+    maxprep = run(admin, "select cast(value as int) from comdb2_tunables "
+                         "where name = 'newsql_max_prepared'", 0);
+    run(admin, "put tunable newsql_max_prepared 0", 0);
+    expect(hndl, byval, 6, 6);
+    expect(hndl, byval, 7, 7);
+
+    step("same text, same id");
+    snprintf(sql, sizeof(sql), "put tunable newsql_max_prepared %lld", maxprep);
+    run(admin, sql, 0);
+    cdb2_close(admin);
+    expect(hndl, byval, 8, 8);
+    expect(hndl, count, 0, 10);
+
+    step("transaction");
+    run(hndl, "begin", 0);
+    expect(hndl, byval, 9, 9);
+    run(hndl, "commit", 0);
+
+    step("reset");
+    /* the connection goes to the sockpool and is reset on its way out */
+    cdb2_close(hndl);
+    hndl = open_hndl(NULL, 1);
+    expect(hndl, count, 0, 10);
+    cdb2_close(hndl);
+
+    step("done");
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <stdlib.h>
+#include <libgen.h>
+#include <string.h>
+
+#include <cdb2api.h>
+
+static char *file;
+
+#define FAIL(db, what, rc)                                                                                             \
+    do {                                                                                                               \
+        fprintf(stderr, "%s:%d %s rc=%d:%s\n", file, __LINE__, what, rc, cdb2_errstr(db));                             \
+        exit(1);                                                                                                       \
+    } while (0)
+
+static cdb2_hndl_tp *open_node(const char *db, const char *node, int flags)
+{
+    cdb2_hndl_tp *hndl = NULL;
+    int rc = cdb2_open(&hndl, db, node, CDB2_DIRECT_CPU | flags);
+    if (rc)
+        FAIL(hndl, "cdb2_open", rc);
+    return hndl;
+}
+
+/* Run sql; returns the single integer it selects, or 0. */
+static int64_t run(cdb2_hndl_tp *hndl, const char *sql, int *rcp)
+{
+    int64_t val = 0;
+    int rc = cdb2_run_statement(hndl, sql);
+    if (rc == 0) {
+        while ((rc = cdb2_next_record(hndl)) == CDB2_OK) {
+            if (cdb2_column_type(hndl, 0) == CDB2_INTEGER)
+                val = *(int64_t *)cdb2_column_value(hndl, 0);
+        }
+        if (rc == CDB2_OK_DONE)
+            rc = 0;
+    }
+    if (rcp)
+        *rcp = rc;
+    else if (rc)
+        FAIL(hndl, sql, rc);
+    return val;
+}
+
+int main(int argc, char *argv[])
+{
+    cdb2_hndl_tp *writer, *reader, *stale;
+    char sql[128];
+    int file_no, offset, rc;
+
+    file = basename(__FILE__);
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s <dbname> <write-node> <read-node>\n", argv[0]);
+        return 1;
+    }
+    if (getenv("CDB2_CONFIG"))
+        cdb2_set_comdb2db_config(getenv("CDB2_CONFIG"));
+
+    /* writes through one node, reads on another right after */
+    writer = open_node(argv[1], argv[2], 0);
+    reader = open_node(argv[1], argv[3], CDB2_READ_YOUR_WRITES);
+    for (int i = 1; i <= 50; i++) {
+        snprintf(sql, sizeof(sql), "insert into t values(%d)", i);
+        run(writer, sql, NULL);
+        if (cdb2_commit_lsn(writer, &file_no, &offset) != 0 || file_no <= 0) {
+            fprintf(stderr, "%s:%d no commit lsn after '%s'\n", file, __LINE__, sql);
+            return 1;
+        }
+        cdb2_set_read_lsn(reader, file_no, offset);
+        snprintf(sql, sizeof(sql), "select count(*) from t where a = %d", i);
+        if (run(reader, sql, NULL) != 1) {
+            fprintf(stderr, "%s:%d write %d at %d:%d not seen on %s\n", file, __LINE__, i, file_no, offset, argv[3]);
+            return 1;
+        }
+    }
+    printf("%s:%d 50 writes seen on %s, last at %d:%d\n", file, __LINE__, argv[3], file_no, offset);
+
+    /* the handle's own writes are carried forward without help */
+    run(reader, "insert into t values(1000)", NULL);
+    if (run(reader, "select count(*) from t where a = 1000", NULL) != 1) {
+        fprintf(stderr, "%s:%d own write not seen\n", file, __LINE__);
+        return 1;
+    }
+
+    /* a node that cannot reach the lsn in time tells the client to change
+     * nodes; a handle held to that node runs out of retries */
+    stale = open_node(argv[1], argv[3], 0);
+    cdb2_set_debug_trace(stale);
+    cdb2_hndl_set_max_retries(stale, 3);
+    cdb2_set_read_lsn(stale, file_no + 1000, 0);
+    run(stale, "select 1", &rc);
+    printf("%s:%d unreachable lsn rc=%d:%s\n", file, __LINE__, rc, cdb2_errstr(stale));
+    if (rc == 0) {
+        fprintf(stderr, "%s:%d read with an unreachable lsn succeeded\n", file, __LINE__);
+        return 1;
+    }
+
+    cdb2_close(stale);
+    cdb2_close(reader);
+    cdb2_close(writer);
+    printf("%s:%d pass\n", file, __LINE__);
+    return 0;
+}
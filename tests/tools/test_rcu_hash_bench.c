@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "plhash.h"
+#include "rcu_hash.h"
+#include "comdb2_atomic.h"
+#include "sys_wrap.h"
+#include "mem.h"
+
+/* Look up a fixed set of interned-string-like keys from many threads, once
+ * through a plhash behind a mutex (what intern_strings used to do) and once
+ * through an rcu_hash, and report the throughput of each.  While the
+ * readers run, a writer keeps adding and deleting other keys so resizes and
+ * reclamation happen underneath them; a lookup of a stable key that misses
+ * fails the test. */
+
+struct ent {
+    char *str;
+    int ix;
+};
+
+static int nthds = 16;
+static int nkeys = 1000;
+static int nlookups = 1000000;
+static int nchurn = 1000;
+
+static struct ent *stable;
+static struct ent *churn;
+
+static pthread_mutex_t plhash_lk = PTHREAD_MUTEX_INITIALIZER;
+static hash_t *plh;
+static rcu_hash_t *rh;
+
+static uint32_t misses;
+static int stop_writer;
+
+static void *plhash_reader(void *arg)
+{
+    unsigned int seed = (uintptr_t)arg;
+    for (int i = 0; i < nlookups; i++) {
+        struct ent *k = &stable[rand_r(&seed) % nkeys], *e;
+        Pthread_mutex_lock(&plhash_lk);
+        e = hash_find_readonly(plh, &k->str);
+        Pthread_mutex_unlock(&plhash_lk);
+        if (e != k)
+            ATOMIC_ADD32(misses, 1);
+    }
+    return NULL;
+}
+
+static void *rcu_reader(void *arg)
+{
+    unsigned int seed = (uintptr_t)arg;
+    for (int i = 0; i < nlookups; i++) {
+        struct ent *k = &stable[rand_r(&seed) % nkeys];
+        if (rcu_hash_find(rh, &k->str) != k)
+            ATOMIC_ADD32(misses, 1);
+    }
+    return NULL;
+}
+
+static void *plhash_writer(void *arg)
+{
+    while (!ATOMIC_LOAD32(stop_writer)) {
+        for (int i = 0; i < nchurn; i++) {
+            Pthread_mutex_lock(&plhash_lk);
+            hash_add(plh, &churn[i]);
+            Pthread_mutex_unlock(&plhash_lk);
+        }
+        for (int i = 0; i < nchurn; i++) {
+            Pthread_mutex_lock(&plhash_lk);
+            hash_del(plh, &churn[i]);
+            Pthread_mutex_unlock(&plhash_lk);
+        }
+    }
+    return NULL;
+}
+
+static void *rcu_writer(void *arg)
+{
+    while (!ATOMIC_LOAD32(stop_writer)) {
+        for (int i = 0; i < nchurn; i++)
+            rcu_hash_add(rh, &churn[i]);
+        for (int i = 0; i < nchurn; i++)
+            rcu_hash_del(rh, &churn[i]);
+    }
+    return NULL;
+}
+
+static long long now_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static int run(const char *name, void *(*reader)(void *),
+               void *(*writer)(void *))
+{
+    pthread_t tids[nthds], wtid;
+    long long start, elapsed;
+    uint32_t nmisses;
+
+    XCHANGE32(misses, 0);
+    XCHANGE32(stop_writer, 0);
+    pthread_create(&wtid, NULL, writer, NULL);
+    start = now_us();
+    for (int i = 0; i < nthds; i++)
+        pthread_create(&tids[i], NULL, reader, (void *)(uintptr_t)(i + 1));
+    for (int i = 0; i < nthds; i++)
+        pthread_join(tids[i], NULL);
+    elapsed = now_us() - start;
+    XCHANGE32(stop_writer, 1);
+    pthread_join(wtid, NULL);
+
+    nmisses = ATOMIC_LOAD32(misses);
+    printf("%-8s %d threads x %d lookups: %lld us, %.0f lookups/s, %u misses\n",
+           name, nthds, nlookups, elapsed,
+           (double)nthds * nlookups * 1000000.0 / (elapsed ? elapsed : 1),
+           nmisses);
+    return nmisses ? 1 : 0;
+}
+
+static struct ent *make_keys(const char *prefix, int n)
+{
+    struct ent *e = calloc(n, sizeof(struct ent));
+    char buf[64];
+    for (int i = 0; i < n; i++) {
+        snprintf(buf, sizeof(buf), "%s%d.example.com", prefix, i);
+        e[i].str = strdup(buf);
+        e[i].ix = i;
+    }
+    return e;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "Usage: %s [-t threads] [-k keys] [-n lookups per thread] "
+                    "[-c churn keys]\n",
+            argv0);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    int c, rc = 0;
+
+    while ((c = getopt(argc, argv, "t:k:n:c:")) != -1) {
+        switch (c) {
+        case 't': nthds = atoi(optarg); break;
+        case 'k': nkeys = atoi(optarg); break;
+        case 'n': nlookups = atoi(optarg); break;
+        case 'c': nchurn = atoi(optarg); break;
+        default: usage(argv[0]);
+        }
+    }
+    if (nthds <= 0 || nkeys <= 0 || nlookups <= 0 || nchurn <= 0)
+        usage(argv[0]);
+
+    comdb2ma_init(0, 0);
+    stable = make_keys("host", nkeys);
+    churn = make_keys("churn", nchurn);
+
+    plh = hash_init_strptr(offsetof(struct ent, str));
+    rh = rcu_hash_init_strptr(offsetof(struct ent, str));
+    for (int i = 0; i < nkeys; i++) {
+        hash_add(plh, &stable[i]);
+        rcu_hash_add(rh, &stable[i]);
+    }
+
+    rc |= run("mutex", plhash_reader, plhash_writer);
+    rc |= run("rcu", rcu_reader, rcu_writer);
+
+    if (rcu_hash_get_num_entries(rh) != nkeys) {
+        fprintf(stderr, "rcu_hash has %d entries, expected %d\n",
+                rcu_hash_get_num_entries(rh), nkeys);
+        rc = 1;
+    }
+    if (rc)
+        fprintf(stderr, "lookups of stable keys missed\n");
+
+    hash_free(plh);
+    rcu_hash_free(rh);
+    return rc;
+}
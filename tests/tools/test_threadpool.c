@@ -41,10 +41,347 @@ static void handler_work_pp(struct thdpool *pool, void *work, void *thddata, int
     free(work);
 }
 
+/* scalable mode: blockers hold the workers so the rest stays queued in
+ * their mailboxes */
+static int gate;
+static uint32_t sq_started, sq_run, sq_freed;
+
+static void handler_sq_work(struct thdpool *pool, void *work, void *thddata, int op)
+{
+    if (op == THD_FREE) {
+        ATOMIC_ADD32(sq_freed, 1);
+        return;
+    }
+    ATOMIC_ADD32(sq_started, 1);
+    if (work) {
+        while (!ATOMIC_LOAD32(gate))
+            usleep(1000);
+    }
+    ATOMIC_ADD32(sq_run, 1);
+}
+
+static void count_queued(struct thdpool *pool, struct workitem *item, void *user)
+{
+    (*(int *)user)++;
+}
+
+static void sq_enqueue_or_die(struct thdpool *pool, void *work)
+{
+    if (thdpool_enqueue(pool, handler_sq_work, work, 0, NULL,
+                        THDPOOL_FORCE_QUEUE)) {
+        fprintf(stderr, "Error from thdpool_enqueue\n");
+        exit(1);
+    }
+}
+
+static void wait_for(const char *what, int (*cond)(struct thdpool *),
+                     struct thdpool *pool)
+{
+    for (int i = 0; !cond(pool); i++) {
+        if (i == 1000) {
+            fprintf(stderr, "Timed out waiting for %s\n", what);
+            abort();
+        }
+        usleep(10000);
+    }
+}
+
+static int started_one(struct thdpool *pool) { return ATOMIC_LOAD32(sq_started) >= 1; }
+static int started_two(struct thdpool *pool) { return ATOMIC_LOAD32(sq_started) >= 2; }
+static int ran_eleven(struct thdpool *pool) { return ATOMIC_LOAD32(sq_run) >= 11; }
+static int ran_all(struct thdpool *pool) { return ATOMIC_LOAD32(sq_run) >= 13; }
+static int ran_last(struct thdpool *pool) { return ATOMIC_LOAD32(sq_run) >= 14; }
+static int one_thread(struct thdpool *pool) { return thdpool_get_nthds(pool) <= 1; }
+static int no_threads(struct thdpool *pool) { return thdpool_get_nthds(pool) == 0; }
+
+static void test_scalable(void)
+{
+    struct thdpool *pool = thdpool_create("my_sq_pool", 0);
+    int nqueued = 0;
+
+    assert(pool);
+    thdpool_set_minthds(pool, 0);
+    thdpool_set_maxthds(pool, 2);
+    thdpool_set_linger(pool, 100);
+    thdpool_set_longwaitms(pool, 1000000);
+    thdpool_set_maxqueue(pool, 100);
+    thdpool_set_mem_size(pool, 4 * 1024);
+    thdpool_set_scalable(pool, 1);
+
+    sq_enqueue_or_die(pool, &gate);
+    wait_for("first blocker", started_one, pool);
+    sq_enqueue_or_die(pool, &gate);
+    wait_for("second blocker", started_two, pool);
+    for (int i = 0; i < 10; i++)
+        sq_enqueue_or_die(pool, NULL);
+
+    thdpool_foreach(pool, count_queued, &nqueued);
+    printf("Scalable pool queue depth %d, visited %d\n",
+           thdpool_get_queue_depth(pool), nqueued);
+    if (nqueued != 10 || thdpool_get_queue_depth(pool) != 10)
+        abort();
+
+    /* raising maxt after the first enqueue adds a worker that steals the
+     * queued work from the blocked ones */
+    thdpool_set_maxthds(pool, 8);
+    sq_enqueue_or_die(pool, NULL);
+    wait_for("queued work behind the blockers", ran_eleven, pool);
+    if (thdpool_get_nthds(pool) < 3)
+        abort();
+
+    /* lowering it retires the extra workers once they are idle */
+    thdpool_set_maxthds(pool, 1);
+    XCHANGE32(gate, 1);
+    wait_for("the blockers", ran_all, pool);
+    wait_for("workers above maxt to retire", one_thread, pool);
+
+    /* and the linger time set now applies to the worker that is left */
+    thdpool_set_linger(pool, 1);
+    wait_for("idle workers to linger out", no_threads, pool);
+
+    /* work after that starts a worker again */
+    sq_enqueue_or_die(pool, NULL);
+    wait_for("work after the workers retired", ran_last, pool);
+
+    printf("Scalable pool run %u freed %u\n", sq_run, sq_freed);
+    if (ATOMIC_LOAD32(sq_run) + ATOMIC_LOAD32(sq_freed) != 14)
+        abort();
+
+    thdpool_destroy(&pool, 10000000);
+}
+
+/* enqueue flags in scalable mode: forced work runs even with every worker
+ * busy and the queue full, queue-only work never adds a worker */
+static int fl_gate;
+static uint32_t fl_started, fl_run;
+
+static void handler_fl_work(struct thdpool *pool, void *work, void *thddata, int op)
+{
+    if (op == THD_FREE)
+        return;
+    ATOMIC_ADD32(fl_started, 1);
+    if (work) {
+        while (!ATOMIC_LOAD32(fl_gate))
+            usleep(1000);
+    }
+    ATOMIC_ADD32(fl_run, 1);
+}
+
+static int fl_started_one(struct thdpool *pool) { return ATOMIC_LOAD32(fl_started) >= 1; }
+static int fl_ran_one(struct thdpool *pool) { return ATOMIC_LOAD32(fl_run) >= 1; }
+static int fl_ran_all(struct thdpool *pool) { return ATOMIC_LOAD32(fl_run) >= 4; }
+
+static void test_scalable_flags(void)
+{
+    struct thdpool *pool = thdpool_create("my_fl_pool", 0);
+
+    assert(pool);
+    thdpool_set_minthds(pool, 0);
+    thdpool_set_maxthds(pool, 1);
+    thdpool_set_linger(pool, 100);
+    thdpool_set_longwaitms(pool, 1000000);
+    thdpool_set_maxqueue(pool, 1);
+    thdpool_set_mem_size(pool, 4 * 1024);
+    thdpool_set_scalable(pool, 1);
+
+    if (thdpool_enqueue(pool, handler_fl_work, &fl_gate, 0, NULL, 0))
+        abort();
+    wait_for("flag blocker", fl_started_one, pool);
+    if (thdpool_enqueue(pool, handler_fl_work, NULL, 0, NULL, 0))
+        abort();
+    /* the one worker is busy and the queue is full */
+    if (thdpool_enqueue(pool, handler_fl_work, NULL, 0, NULL, 0) == 0)
+        abort();
+
+    if (thdpool_enqueue(pool, handler_fl_work, NULL, 0, NULL,
+                        THDPOOL_FORCE_DISPATCH))
+        abort();
+    wait_for("forced work", fl_ran_one, pool);
+    printf("Scalable pool forced dispatch past a full queue\n");
+
+    wait_for("the forced worker to retire", one_thread, pool);
+    if (thdpool_enqueue(pool, handler_fl_work, NULL, 0, NULL,
+                        THDPOOL_QUEUE_ONLY | THDPOOL_FORCE_QUEUE))
+        abort();
+    if (thdpool_get_nthds(pool) != 1)
+        abort();
+
+    XCHANGE32(fl_gate, 1);
+    wait_for("the flagged work", fl_ran_all, pool);
+
+    thdpool_destroy(&pool, 10000000);
+}
+
+/* fair queuing: a class of long items capped at two running must not keep
+ * cheap items from running on the other threads */
+enum { NLONG = 10, NSHORT = 40, LONG_MAXRUN = 2 };
+static uint32_t long_running, long_max, long_done, short_done;
+static uint32_t long_done_at_last_short;
+
+static void handler_long_work(struct thdpool *pool, void *work, void *thddata, int op)
+{
+    uint32_t running, max;
+
+    if (op == THD_FREE)
+        return;
+    running = ATOMIC_ADD32(long_running, 1);
+    while ((max = ATOMIC_LOAD32(long_max)) < running &&
+           !CAS32(long_max, max, running))
+        ;
+    usleep(200000);
+    ATOMIC_ADD32(long_running, -1);
+    ATOMIC_ADD32(long_done, 1);
+}
+
+static void handler_short_work(struct thdpool *pool, void *work, void *thddata, int op)
+{
+    if (op == THD_FREE)
+        return;
+    usleep(1000);
+    if (ATOMIC_ADD32(short_done, 1) == NSHORT)
+        XCHANGE32(long_done_at_last_short, ATOMIC_LOAD32(long_done));
+}
+
+static void sched_enqueue_or_die(struct thdpool *pool, thdpool_work_fn fn,
+                                 const struct thdpool_sched *sched)
+{
+    if (thdpool_enqueue_sched(pool, fn, NULL, 0, NULL, 0, sched)) {
+        fprintf(stderr, "Error from thdpool_enqueue_sched\n");
+        exit(1);
+    }
+}
+
+static int shorts_done(struct thdpool *pool) { return ATOMIC_LOAD32(short_done) >= NSHORT; }
+static int longs_done(struct thdpool *pool) { return ATOMIC_LOAD32(long_done) >= NLONG; }
+
+static void test_sched(void)
+{
+    struct thdpool *pool = thdpool_create("my_sched_pool", 0);
+    struct thdpool_sched long_sched = {.flow = 1, .cost = 1000, .cls = 1,
+                                       .maxrun = LONG_MAXRUN};
+    struct thdpool_sched short_sched = {.flow = 2, .cost = 1, .cls = 0};
+
+    assert(pool);
+    thdpool_set_minthds(pool, 0);
+    thdpool_set_maxthds(pool, 4);
+    thdpool_set_linger(pool, 10);
+    thdpool_set_longwaitms(pool, 1000000);
+    thdpool_set_maxqueue(pool, 1000);
+    thdpool_set_mem_size(pool, 4 * 1024);
+
+    /* the long items go first and would fill every thread without the cap */
+    for (int i = 0; i < NLONG; i++)
+        sched_enqueue_or_die(pool, handler_long_work, &long_sched);
+    for (int i = 0; i < NSHORT; i++)
+        sched_enqueue_or_die(pool, handler_short_work, &short_sched);
+
+    wait_for("short work", shorts_done, pool);
+    wait_for("long work", longs_done, pool);
+
+    printf("Scheduled pool long max running %u, long done at last short %u\n",
+           long_max, long_done_at_last_short);
+    if (ATOMIC_LOAD32(long_max) > LONG_MAXRUN)
+        abort();
+    /* the short items ran beside the first long ones, not after all of them */
+    if (ATOMIC_LOAD32(long_done_at_last_short) > LONG_MAXRUN)
+        abort();
+
+    thdpool_destroy(&pool, 10000000);
+}
+
+/* fair queuing across many flows: with one thread held busy, queued items
+ * must run in order of their finish tags, equal tags in arrival order */
+enum { NFLOW_ITEMS = 4, NFLOWS = 64, NFLOW_WORK = NFLOWS * NFLOW_ITEMS };
+static uint32_t flow_release, flow_nran;
+static int flow_order[NFLOW_WORK];
+
+static void handler_flow_blocker(struct thdpool *pool, void *work, void *thddata, int op)
+{
+    if (op == THD_FREE)
+        return;
+    while (!ATOMIC_LOAD32(flow_release))
+        usleep(1000);
+}
+
+static void handler_flow_work(struct thdpool *pool, void *work, void *thddata, int op)
+{
+    if (op == THD_FREE)
+        return;
+    flow_order[ATOMIC_ADD32(flow_nran, 1) - 1] = (int)(intptr_t)work;
+}
+
+static int flows_done(struct thdpool *pool) { return ATOMIC_LOAD32(flow_nran) >= NFLOW_WORK; }
+
+static double flow_tag(int n) { return (double)(n / NFLOWS + 1) * (n % NFLOWS + 1); }
+
+static int flow_cmp(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    if (flow_tag(x) != flow_tag(y))
+        return flow_tag(x) < flow_tag(y) ? -1 : 1;
+    return x - y;
+}
+
+static void test_sched_flows(void)
+{
+    struct thdpool *pool = thdpool_create("my_flow_pool", 0);
+    int expected[NFLOW_WORK];
+
+    assert(pool);
+    thdpool_set_minthds(pool, 0);
+    thdpool_set_maxthds(pool, 1);
+    thdpool_set_linger(pool, 10);
+    thdpool_set_longwaitms(pool, 1000000);
+    thdpool_set_maxqueue(pool, NFLOW_WORK);
+    thdpool_set_mem_size(pool, 4 * 1024);
+
+    if (thdpool_enqueue(pool, handler_flow_blocker, NULL, 0, NULL, 0)) {
+        fprintf(stderr, "Error from thdpool_enqueue\n");
+        exit(1);
+    }
+    /* item n is the (n / NFLOWS)th of flow n % NFLOWS, which costs
+     * flow + 1: its tag is flow_tag(n) */
+    for (int n = 0; n < NFLOW_WORK; n++) {
+        struct thdpool_sched sched = {.flow = n % NFLOWS,
+                                      .cost = n % NFLOWS + 1,
+                                      .cls = n % THDPOOL_SCHED_NCLASS};
+        expected[n] = n;
+        if (thdpool_enqueue_sched(pool, handler_flow_work, (void *)(intptr_t)n,
+                                  0, NULL, 0, &sched)) {
+            fprintf(stderr, "Error from thdpool_enqueue_sched\n");
+            exit(1);
+        }
+    }
+    XCHANGE32(flow_release, 1);
+    wait_for("flow work", flows_done, pool);
+
+    qsort(expected, NFLOW_WORK, sizeof(int), flow_cmp);
+    for (int n = 0; n < NFLOW_WORK; n++) {
+        if (flow_order[n] != expected[n]) {
+            fprintf(stderr, "flow work %d ran item %d, expected %d\n", n,
+                    flow_order[n], expected[n]);
+            abort();
+        }
+    }
+    printf("Scheduled pool ran %d items of %d flows in tag order\n",
+           NFLOW_WORK, NFLOWS);
+
+    thdpool_destroy(&pool, 10000000);
+}
+
 int main()
 {
     comdb2ma_init(0, 0);
     thread_util_init();
+    if (sysconf(_SC_NPROCESSORS_ONLN) > 1) {
+        test_scalable();
+        test_scalable_flags();
+    } else {
+        printf("Single cpu, scalable mode not used\n");
+    }
+    test_sched();
+    test_sched_flows();
+
     struct thdpool *my_thdpool = thdpool_create("my_pool", 0);
 
     assert(my_thdpool);
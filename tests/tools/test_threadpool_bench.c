@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "thread_util.h"
+#include "list.h"
+#include "thdpool.h"
+#include "comdb2_atomic.h"
+#include "mem.h"
+
+/* Enqueue many tiny work items from several producers into a thread pool,
+ * once with the locked queue and once in scalable mode, and report the
+ * throughput of each. */
+
+int gbl_disable_exit_on_thread_error;
+int gbl_throttle_sql_overload_dump_sec;
+
+void register_tunable(void *tunable)
+{
+}
+void thdpool_alarm_on_queing(int len)
+{
+}
+
+static int nproducers = 4;
+static int nitems = 100000;
+static int nthds = 8;
+
+static uint32_t completed;
+
+typedef struct {
+    struct thdpool *pool;
+    int failed;
+} producer_t;
+
+static void tiny_work(struct thdpool *pool, void *work, void *thddata, int op)
+{
+    ATOMIC_ADD32(completed, 1);
+}
+
+static void *producer(void *arg)
+{
+    producer_t *p = arg;
+    for (int i = 0; i < nitems; i++) {
+        if (thdpool_enqueue(p->pool, tiny_work, NULL, 0, NULL,
+                            THDPOOL_FORCE_QUEUE))
+            p->failed++;
+    }
+    return NULL;
+}
+
+static long long now_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static int run(const char *name, int scalable)
+{
+    struct thdpool *pool = thdpool_create(name, 0);
+    pthread_t tids[nproducers];
+    producer_t prod[nproducers];
+    uint32_t expected = 0;
+    long long start, elapsed;
+
+    thdpool_set_minthds(pool, 0);
+    thdpool_set_maxthds(pool, nthds);
+    thdpool_set_linger(pool, 1);
+    thdpool_set_longwaitms(pool, 1000000);
+    thdpool_set_maxqueue(pool, nproducers * nitems);
+    thdpool_set_mem_size(pool, 4 * 1024);
+    thdpool_set_scalable(pool, scalable);
+
+    XCHANGE32(completed, 0);
+    start = now_us();
+    for (int i = 0; i < nproducers; i++) {
+        prod[i].pool = pool;
+        prod[i].failed = 0;
+        pthread_create(&tids[i], NULL, producer, &prod[i]);
+    }
+    for (int i = 0; i < nproducers; i++) {
+        pthread_join(tids[i], NULL);
+        expected += nitems - prod[i].failed;
+    }
+    while (ATOMIC_LOAD32(completed) < expected)
+        usleep(100);
+    elapsed = now_us() - start;
+
+    printf("%-10s %d producers x %d items, %d threads: %lld us, %.0f items/s\n",
+           name, nproducers, nitems, nthds, elapsed,
+           expected * 1000000.0 / (elapsed ? elapsed : 1));
+    thdpool_print_stats(stdout, pool);
+
+    /* wait for the workers to go away */
+    thdpool_destroy(&pool, -1);
+    return expected == (uint32_t)nproducers * nitems ? 0 : 1;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "Usage: %s [-p producers] [-n items per producer] "
+                    "[-t threads]\n",
+            argv0);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    int c, rc = 0;
+
+    while ((c = getopt(argc, argv, "p:n:t:")) != -1) {
+        switch (c) {
+        case 'p': nproducers = atoi(optarg); break;
+        case 'n': nitems = atoi(optarg); break;
+        case 't': nthds = atoi(optarg); break;
+        default: usage(argv[0]);
+        }
+    }
+    if (nproducers <= 0 || nitems <= 0 || nthds <= 0)
+        usage(argv[0]);
+
+    comdb2ma_init(0, 0);
+    thread_util_init();
+
+    rc |= run("locked", 0);
+    rc |= run("scalable", 1);
+
+    if (rc)
+        fprintf(stderr, "some work items were not dispatched\n");
+    return rc;
+}
@@ -0,0 +1,642 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * cdb2_bench: in-process micro-benchmarks for the storage and type hot
+ * paths.  Everything runs against a private berkdb environment in a
+ * scratch directory, so no database or cluster is needed.  Each result is
+ * printed as one JSON object per line on stdout so runs can be collected
+ * and compared across commits.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bdb_int.h"
+#include <comdb2rle.h>
+#include <crc32c.h>
+#include <flibc.h>
+#include "types.h"
+#include "sys_wrap.h"
+
+extern int comdb2ma_init(size_t init_sz, size_t max_cap);
+extern void tz_hash_init(void);
+
+static const char *progname = "cdb2_bench";
+
+struct bench_opts {
+    int nops;         /* operations per benchmark */
+    int bufsz;        /* buffer size for crc32c */
+    const char *only; /* run benchmarks with this name prefix only */
+    char *dir;        /* scratch directory for the environments */
+};
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int wanted(const struct bench_opts *o, const char *name)
+{
+    return o->only == NULL || strncmp(name, o->only, strlen(o->only)) == 0;
+}
+
+/* bytes is the payload handled per operation, 0 if throughput is not
+ * meaningful */
+static void report(const char *name, int64_t ops, int64_t ns, int64_t bytes)
+{
+    printf("{\"name\":\"%s\",\"ops\":%" PRId64 ",\"ns\":%" PRId64
+           ",\"ns_per_op\":%.1f",
+           name, ops, ns, ops ? (double)ns / ops : 0.0);
+    if (bytes && ns)
+        printf(",\"mb_per_sec\":%.1f",
+               (double)bytes * ops / (1024.0 * 1024.0) / (ns / 1e9));
+    printf("}\n");
+    fflush(stdout);
+}
+
+static void report_error(const char *name, const char *what, int rc)
+{
+    printf("{\"name\":\"%s\",\"error\":\"%s\",\"rc\":%d}\n", name, what, rc);
+    fflush(stdout);
+}
+
+/* A row the way it sits in a data file: the server forms of
+ * (id int, price double, name cstring(32), ts datetime, pad byte[64]),
+ * with the pad left zero like a mostly empty column.  hints are the field
+ * sizes as the CRLE compressor expects them. */
+enum {
+    ROW_ID = 0,
+    ROW_PRICE = ROW_ID + 9,
+    ROW_NAME = ROW_PRICE + 9,
+    ROW_TS = ROW_NAME + 33,
+    ROW_PAD = ROW_TS + SERVER_DATETIME_LEN,
+    ROW_LEN = ROW_PAD + 65
+};
+static uint16_t row_hints[] = {9, 9, 33, SERVER_DATETIME_LEN, 65, 0};
+
+static int make_row(uint8_t *row, int64_t id)
+{
+    struct field_conv_opts_tz tzopts = {0};
+    int64_t bid = flibc_htonll(id);
+    double price = flibc_htond(id * 0.25);
+    char name[32];
+    int outdtsz, rc;
+
+    memset(row, 0, ROW_LEN);
+    snprintf(name, sizeof(name), "row number %" PRId64, id);
+
+    rc = CLIENT_to_SERVER(&bid, sizeof(bid), CLIENT_INT, 0, NULL, NULL,
+                          row + ROW_ID, 9, SERVER_BINT, 0, &outdtsz, NULL,
+                          NULL);
+    if (rc == 0)
+        rc = CLIENT_to_SERVER(&price, sizeof(price), CLIENT_REAL, 0, NULL,
+                              NULL, row + ROW_PRICE, 9, SERVER_BREAL, 0,
+                              &outdtsz, NULL, NULL);
+    if (rc == 0)
+        rc = CLIENT_to_SERVER(name, strlen(name) + 1, CLIENT_CSTR, 0, NULL,
+                              NULL, row + ROW_NAME, 33, SERVER_BCSTR, 0,
+                              &outdtsz, NULL, NULL);
+    if (rc == 0) {
+        const char *ts = "2026-01-01T00:00:00.000";
+        tzopts.flags = FLD_CONV_TZONE;
+        strcpy(tzopts.tzname, "UTC");
+        rc = CLIENT_to_SERVER(ts, strlen(ts) + 1, CLIENT_CSTR, 0,
+                              (struct field_conv_opts *)&tzopts, NULL,
+                              row + ROW_TS, SERVER_DATETIME_LEN,
+                              SERVER_DATETIME, 0, &outdtsz, NULL, NULL);
+    }
+    if (rc == 0) {
+        uint8_t pad[64] = {0};
+        rc = CLIENT_to_SERVER(pad, sizeof(pad), CLIENT_BYTEARRAY, 0, NULL,
+                              NULL, row + ROW_PAD, 65, SERVER_BYTEARRAY, 0,
+                              &outdtsz, NULL, NULL);
+    }
+    return rc;
+}
+
+/* results of loops that would otherwise be dead code */
+static volatile uint32_t crc32c_sink;
+
+static void bench_crc32c(const struct bench_opts *o)
+{
+    uint8_t *buf;
+    uint32_t sum = 0;
+    int64_t start;
+
+    if (!wanted(o, "crc32c"))
+        return;
+    buf = malloc(o->bufsz);
+    for (int i = 0; i < o->bufsz; i++)
+        buf[i] = (uint8_t)(i * 31);
+    start = now_ns();
+    for (int i = 0; i < o->nops; i++)
+        sum += crc32c(buf, o->bufsz);
+    report("crc32c", o->nops, now_ns() - start, o->bufsz);
+    crc32c_sink = sum;
+    free(buf);
+}
+
+static void bench_rle(const struct bench_opts *o, const uint8_t *row)
+{
+    uint8_t out[ROW_LEN * 2], back[ROW_LEN];
+    size_t outsz = 0;
+    int64_t start;
+
+    if (wanted(o, "comdb2rle_compress")) {
+        start = now_ns();
+        for (int i = 0; i < o->nops; i++) {
+            Comdb2RLE c = {.in = (uint8_t *)row,
+                           .insz = ROW_LEN,
+                           .out = out,
+                           .outsz = sizeof(out)};
+            if (compressComdb2RLE_hints(&c, row_hints) != 0) {
+                report_error("comdb2rle_compress", "compress failed", 1);
+                return;
+            }
+            outsz = c.outsz;
+        }
+        report("comdb2rle_compress", o->nops, now_ns() - start, ROW_LEN);
+    }
+
+    if (wanted(o, "comdb2rle_decompress")) {
+        Comdb2RLE c = {.in = (uint8_t *)row,
+                       .insz = ROW_LEN,
+                       .out = out,
+                       .outsz = sizeof(out)};
+        if (compressComdb2RLE_hints(&c, row_hints) != 0) {
+            report_error("comdb2rle_decompress", "compress failed", 1);
+            return;
+        }
+        outsz = c.outsz;
+        start = now_ns();
+        for (int i = 0; i < o->nops; i++) {
+            Comdb2RLE d = {
+                .in = out, .insz = outsz, .out = back, .outsz = sizeof(back)};
+            if (decompressComdb2RLE(&d) != 0 || d.outsz != ROW_LEN) {
+                report_error("comdb2rle_decompress", "decompress failed", 1);
+                return;
+            }
+        }
+        report("comdb2rle_decompress", o->nops, now_ns() - start, ROW_LEN);
+    }
+}
+
+/* bdb_pack/bdb_unpack only look at the compression settings, the
+ * attributes and the allocation threshold of the table */
+static void bench_odh(const struct bench_opts *o, const uint8_t *row)
+{
+    static const struct {
+        const char *name;
+        int alg;
+    } algs[] = {{"none", BDB_COMPRESS_NONE},
+                {"zlib", BDB_COMPRESS_ZLIB},
+                {"rle8", BDB_COMPRESS_RLE8},
+                {"crle", BDB_COMPRESS_CRLE},
+                {"lz4", BDB_COMPRESS_LZ4}};
+    static char bench_name[] = "cdb2_bench";
+    bdb_state_type *bdb_state = calloc(1, sizeof(bdb_state_type));
+    uint8_t packed[ROW_LEN + ODH_SIZE_RESERVE], unpacked[ROW_LEN];
+    char name[64];
+
+    bdb_state->name = bench_name;
+    bdb_state->attr = bdb_attr_create();
+    bdb_state->ondisk_header = 1;
+    bdb_state->bmaszthresh = UINT_MAX;
+    bdb_state->fld_hints = row_hints;
+
+    for (int a = 0; a < sizeof(algs) / sizeof(algs[0]); a++) {
+        struct odh odh;
+        void *rec, *freeptr;
+        uint32_t recsize = 0;
+        int64_t start;
+        int rc;
+
+        bdb_state->compress = algs[a].alg;
+
+        snprintf(name, sizeof(name), "odh_pack_%s", algs[a].name);
+        if (wanted(o, name)) {
+            start = now_ns();
+            for (int i = 0; i < o->nops; i++) {
+                init_odh(bdb_state, &odh, (void *)row, ROW_LEN, 0);
+                rc = bdb_pack(bdb_state, &odh, packed, sizeof(packed), &rec,
+                              &recsize, &freeptr, -1);
+                if (rc) {
+                    report_error(name, "bdb_pack failed", rc);
+                    goto next;
+                }
+            }
+            report(name, o->nops, now_ns() - start, ROW_LEN);
+        }
+
+    next:
+        snprintf(name, sizeof(name), "odh_unpack_%s", algs[a].name);
+        if (wanted(o, name)) {
+            init_odh(bdb_state, &odh, (void *)row, ROW_LEN, 0);
+            rc = bdb_pack(bdb_state, &odh, packed, sizeof(packed), &rec,
+                          &recsize, &freeptr, -1);
+            if (rc) {
+                report_error(name, "bdb_pack failed", rc);
+                continue;
+            }
+            start = now_ns();
+            for (int i = 0; i < o->nops; i++) {
+                rc = bdb_unpack(bdb_state, rec, recsize, unpacked,
+                                sizeof(unpacked), &odh, &freeptr);
+                if (rc || odh.length != ROW_LEN) {
+                    report_error(name, "bdb_unpack failed", rc);
+                    break;
+                }
+                free(freeptr);
+            }
+            if (rc == 0)
+                report(name, o->nops, now_ns() - start, ROW_LEN);
+        }
+    }
+
+    free(bdb_state->attr);
+    free(bdb_state);
+}
+
+static void bench_types(const struct bench_opts *o, const uint8_t *row)
+{
+    struct field_conv_opts_tz tzopts = {.flags = FLD_CONV_TZONE};
+    const char *ts = "2026-01-01T12:34:56.789";
+    uint8_t out[64];
+    char str[64];
+    int64_t ival = 0, start;
+    double rval = 0;
+    int outdtsz, isnull, rc = 0;
+
+    strcpy(tzopts.tzname, "UTC");
+
+#define CONV_BENCH(name, call, bytes)                                          \
+    if (wanted(o, name)) {                                                     \
+        start = now_ns();                                                      \
+        for (int i = 0; i < o->nops && rc == 0; i++)                           \
+            rc = (call);                                                       \
+        if (rc)                                                                \
+            report_error(name, "conversion failed", rc);                       \
+        else                                                                   \
+            report(name, o->nops, now_ns() - start, bytes);                    \
+        rc = 0;                                                                \
+    }
+
+    CONV_BENCH("types_client_int_to_server_bint",
+               CLIENT_to_SERVER(&ival, sizeof(ival), CLIENT_INT, 0, NULL, NULL,
+                                out, 9, SERVER_BINT, 0, &outdtsz, NULL, NULL),
+               0)
+    CONV_BENCH("types_server_bint_to_client_int",
+               SERVER_to_CLIENT(row + ROW_ID, 9, SERVER_BINT, NULL, NULL, 0,
+                                &ival, sizeof(ival), CLIENT_INT, &isnull,
+                                &outdtsz, NULL, NULL),
+               0)
+    CONV_BENCH("types_client_real_to_server_breal",
+               CLIENT_to_SERVER(&rval, sizeof(rval), CLIENT_REAL, 0, NULL,
+                                NULL, out, 9, SERVER_BREAL, 0, &outdtsz, NULL,
+                                NULL),
+               0)
+    CONV_BENCH("types_server_breal_to_client_real",
+               SERVER_to_CLIENT(row + ROW_PRICE, 9, SERVER_BREAL, NULL, NULL,
+                                0, &rval, sizeof(rval), CLIENT_REAL, &isnull,
+                                &outdtsz, NULL, NULL),
+               0)
+    CONV_BENCH("types_client_cstr_to_server_bcstr",
+               CLIENT_to_SERVER("row number 42", 14, CLIENT_CSTR, 0, NULL,
+                                NULL, out, 33, SERVER_BCSTR, 0, &outdtsz, NULL,
+                                NULL),
+               0)
+    CONV_BENCH("types_server_bcstr_to_client_cstr",
+               SERVER_to_CLIENT(row + ROW_NAME, 33, SERVER_BCSTR, NULL, NULL,
+                                0, str, 33, CLIENT_CSTR, &isnull, &outdtsz,
+                                NULL, NULL),
+               0)
+    CONV_BENCH("types_client_cstr_to_server_datetime",
+               CLIENT_to_SERVER(ts, strlen(ts) + 1, CLIENT_CSTR, 0,
+                                (struct field_conv_opts *)&tzopts, NULL, out,
+                                SERVER_DATETIME_LEN, SERVER_DATETIME, 0,
+                                &outdtsz, NULL, NULL),
+               0)
+    CONV_BENCH("types_server_datetime_to_client_cstr",
+               SERVER_to_CLIENT(row + ROW_TS, SERVER_DATETIME_LEN,
+                                SERVER_DATETIME, NULL, NULL, 0, str,
+                                sizeof(str), CLIENT_CSTR, &isnull, &outdtsz,
+                                (struct field_conv_opts *)&tzopts, NULL),
+               0)
+
+#undef CONV_BENCH
+}
+
+static int open_env(const struct bench_opts *o, const char *sub, int is_tmp,
+                    DB_ENV **dbenvp)
+{
+    char path[PATH_MAX];
+    DB_ENV *dbenv;
+    int ret;
+
+    snprintf(path, sizeof(path), "%s/%s", o->dir, sub);
+    if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "%s: mkdir %s: %s\n", progname, path, strerror(errno));
+        return -1;
+    }
+    if ((ret = db_env_create(&dbenv, 0)) != 0) {
+        fprintf(stderr, "%s: db_env_create: %s\n", progname, db_strerror(ret));
+        return -1;
+    }
+    dbenv->set_errfile(dbenv, stderr);
+    dbenv->set_errpfx(dbenv, progname);
+    if (is_tmp)
+        dbenv->set_is_tmp_tbl(dbenv, 1);
+    if ((ret = dbenv->set_cachesize(dbenv, 0, 64 * 1024 * 1024, 1)) != 0 ||
+        (ret = dbenv->open(dbenv, path, DB_CREATE | DB_INIT_MPOOL | DB_PRIVATE,
+                           0)) != 0) {
+        dbenv->err(dbenv, ret, "open %s", path);
+        dbenv->close(dbenv, 0);
+        return -1;
+    }
+    *dbenvp = dbenv;
+    return 0;
+}
+
+/* rows read after each seek of btree_range_scan */
+enum { RANGE_ROWS = 100 };
+
+/* Point puts, point gets, short range scans and a full scan on a btree the
+ * way data files use them: big-endian genid-like keys, packed rows as data */
+static void bench_btree(const struct bench_opts *o, const uint8_t *row)
+{
+    DB_ENV *dbenv;
+    DB *dbp;
+    DBC *dbc;
+    DBT key, data;
+    uint64_t k;
+    uint8_t buf[ROW_LEN];
+    int64_t start;
+    int ret;
+
+    if (!wanted(o, "btree_"))
+        return;
+    if (open_env(o, "btree", 0, &dbenv))
+        return;
+    if ((ret = db_create(&dbp, dbenv, 0)) != 0 ||
+        (ret = dbp->open(dbp, NULL, "bench.dta", NULL, DB_BTREE, DB_CREATE,
+                         0666)) != 0) {
+        report_error("btree_put", "open failed", ret);
+        goto done;
+    }
+
+    memset(&key, 0, sizeof(key));
+    memset(&data, 0, sizeof(data));
+    key.data = &k;
+    key.size = sizeof(k);
+
+    start = now_ns();
+    for (int i = 0; i < o->nops; i++) {
+        k = flibc_htonll(i);
+        data.data = (void *)row;
+        data.size = ROW_LEN;
+        if ((ret = dbp->put(dbp, NULL, &key, &data, 0)) != 0) {
+            report_error("btree_put", "put failed", ret);
+            goto close;
+        }
+    }
+    if (wanted(o, "btree_put"))
+        report("btree_put", o->nops, now_ns() - start, ROW_LEN);
+
+    if (wanted(o, "btree_get")) {
+        srandom(o->nops);
+        data.data = buf;
+        data.ulen = sizeof(buf);
+        data.flags = DB_DBT_USERMEM;
+        start = now_ns();
+        for (int i = 0; i < o->nops; i++) {
+            k = flibc_htonll(random() % o->nops);
+            if ((ret = dbp->get(dbp, NULL, &key, &data, 0)) != 0) {
+                report_error("btree_get", "get failed", ret);
+                goto close;
+            }
+        }
+        report("btree_get", o->nops, now_ns() - start, ROW_LEN);
+        data.flags = 0;
+    }
+
+    /* what an index range lookup does: seek to a random key with
+     * DB_SET_RANGE, then walk at most RANGE_ROWS rows with DB_NEXT */
+    if (wanted(o, "btree_range_scan")) {
+        int64_t n = 0;
+        int nseeks = o->nops / RANGE_ROWS;
+        if (nseeks == 0)
+            nseeks = 1;
+        if ((ret = dbp->cursor(dbp, NULL, &dbc, 0)) != 0) {
+            report_error("btree_range_scan", "cursor failed", ret);
+            goto close;
+        }
+        srandom(o->nops + 2);
+        start = now_ns();
+        for (int i = 0; i < nseeks; i++) {
+            k = flibc_htonll(random() % o->nops);
+            ret = dbc->c_get(dbc, &key, &data, DB_SET_RANGE);
+            for (int r = 1; ret == 0; r++) {
+                n++;
+                if (r == RANGE_ROWS)
+                    break;
+                ret = dbc->c_get(dbc, &key, &data, DB_NEXT);
+            }
+            if (ret != 0 && ret != DB_NOTFOUND) {
+                report_error("btree_range_scan", "c_get failed", ret);
+                dbc->c_close(dbc);
+                goto close;
+            }
+            /* c_get pointed key.data at the key it found */
+            key.data = &k;
+            key.size = sizeof(k);
+        }
+        report("btree_range_scan", n, now_ns() - start, ROW_LEN);
+        dbc->c_close(dbc);
+    }
+
+    if (wanted(o, "btree_scan")) {
+        int n = 0;
+        if ((ret = dbp->cursor(dbp, NULL, &dbc, 0)) != 0) {
+            report_error("btree_scan", "cursor failed", ret);
+            goto close;
+        }
+        start = now_ns();
+        while ((ret = dbc->c_get(dbc, &key, &data, DB_NEXT)) == 0)
+            n++;
+        if (ret == DB_NOTFOUND)
+            report("btree_scan", n, now_ns() - start, ROW_LEN);
+        else
+            report_error("btree_scan", "c_get failed", ret);
+        dbc->c_close(dbc);
+    }
+
+close:
+    dbp->close(dbp, 0);
+done:
+    dbenv->close(dbenv, 0);
+}
+
+/* Sorter-style use of a temp table: rows arrive in random key order and
+ * are read back in key order, in an environment set up the way
+ * bdb/temptable.c sets up its own */
+static void bench_temptable(const struct bench_opts *o, const uint8_t *row)
+{
+    DB_ENV *dbenv;
+    DB *dbp;
+    DBC *dbc;
+    DBT key, data;
+    uint64_t k;
+    int64_t start;
+    int ret;
+
+    if (!wanted(o, "temptable_"))
+        return;
+    if (open_env(o, "temptable", 1, &dbenv))
+        return;
+    if ((ret = db_create(&dbp, dbenv, 0)) != 0 ||
+        (ret = dbp->set_pagesize(dbp, 65536)) != 0 ||
+        (ret = dbp->open(dbp, NULL, NULL, NULL, DB_BTREE,
+                         DB_CREATE | DB_TRUNCATE | DB_TEMPTABLE, 0666)) != 0) {
+        report_error("temptable_insert", "open failed", ret);
+        goto done;
+    }
+
+    memset(&key, 0, sizeof(key));
+    memset(&data, 0, sizeof(data));
+    key.data = &k;
+    key.size = sizeof(k);
+
+    srandom(o->nops + 1);
+    start = now_ns();
+    for (int i = 0; i < o->nops; i++) {
+        k = ((uint64_t)random() << 32) | (uint32_t)i;
+        data.data = (void *)row;
+        data.size = ROW_LEN;
+        if ((ret = dbp->put(dbp, NULL, &key, &data, 0)) != 0) {
+            report_error("temptable_insert", "put failed", ret);
+            goto close;
+        }
+    }
+    if (wanted(o, "temptable_insert"))
+        report("temptable_insert", o->nops, now_ns() - start, ROW_LEN);
+
+    if (wanted(o, "temptable_sorted_scan")) {
+        int n = 0;
+        if ((ret = dbp->cursor(dbp, NULL, &dbc, 0)) != 0) {
+            report_error("temptable_sorted_scan", "cursor failed", ret);
+            goto close;
+        }
+        start = now_ns();
+        while ((ret = dbc->c_get(dbc, &key, &data, DB_NEXT)) == 0)
+            n++;
+        if (ret == DB_NOTFOUND)
+            report("temptable_sorted_scan", n, now_ns() - start, ROW_LEN);
+        else
+            report_error("temptable_sorted_scan", "c_get failed", ret);
+        dbc->c_close(dbc);
+    }
+
+close:
+    dbp->close(dbp, 0);
+done:
+    dbenv->close(dbenv, 0);
+}
+
+static void remove_dir(const char *dir)
+{
+    char cmd[PATH_MAX + 16];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", dir);
+    if (system(cmd) != 0)
+        fprintf(stderr, "%s: couldn't remove %s\n", progname, dir);
+}
+
+static int cdb2_bench_usage(void)
+{
+    fprintf(stderr,
+            "usage: %s [-n ops] [-s crc32c buffer size] [-b name prefix] "
+            "[-d scratch dir]\n",
+            progname);
+    return EXIT_FAILURE;
+}
+
+int tool_cdb2_bench_main(int argc, char *argv[])
+{
+    struct bench_opts o = {.nops = 100000, .bufsz = 4096};
+    const char *parent = "/tmp";
+    char dir[PATH_MAX];
+    uint8_t row[ROW_LEN];
+    int ch;
+
+    crc32c_init(0);
+    comdb2ma_init(0, 0);
+    Pthread_key_create(&DBG_FREE_CURSOR, NULL);
+    tz_hash_init();
+
+    while ((ch = getopt(argc, argv, "n:s:b:d:")) != EOF) {
+        switch (ch) {
+        case 'n':
+            o.nops = atoi(optarg);
+            break;
+        case 's':
+            o.bufsz = atoi(optarg);
+            break;
+        case 'b':
+            o.only = optarg;
+            break;
+        case 'd':
+            parent = optarg;
+            break;
+        default:
+            return cdb2_bench_usage();
+        }
+    }
+    if (o.nops <= 0 || o.bufsz <= 0)
+        return cdb2_bench_usage();
+
+    snprintf(dir, sizeof(dir), "%s/cdb2_bench.XXXXXX", parent);
+    if ((o.dir = mkdtemp(dir)) == NULL) {
+        fprintf(stderr, "%s: mkdtemp %s: %s\n", progname, dir,
+                strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    if (make_row(row, 42) != 0) {
+        fprintf(stderr, "%s: couldn't build the sample row\n", progname);
+        remove_dir(o.dir);
+        return EXIT_FAILURE;
+    }
+
+    bench_crc32c(&o);
+    bench_rle(&o, row);
+    bench_odh(&o, row);
+    bench_types(&o, row);
+    bench_btree(&o, row);
+    bench_temptable(&o, row);
+
+    remove_dir(o.dir);
+    return EXIT_SUCCESS;
+}
@@ -21,6 +21,8 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <cctype>
+#include <strings.h>
 
 #include <iostream>
 #include <fstream>
@@ -31,6 +33,12 @@
 #include <map>
 #include <list>
 #include <algorithm>
+#include <deque>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <unistd.h>
 #include <ctime>
 #include <sys/time.h>
@@ -38,9 +46,11 @@
 #include <cinttypes>
 #include <cassert>
 #include <limits.h>
+#include <zlib.h>
 
 #include "cdb2api.h"
 #include "cson.h"
+#include "eventlog_bin.h"
 
 static cdb2_hndl_tp *cdb2h = nullptr;
 char *dbname;
@@ -50,7 +60,11 @@ std::map<std::string, std::list<cson_value*>> transactions;
 
 bool diffs = false;
 bool verbose = false;
+bool tojson = false;
+bool concurrent = false;
+double speed = 1.0;
 int threshold_percent = 5;
+int idle_secs = 60;
 
 int64_t maxevents = 0;
 
@@ -58,12 +72,26 @@ void replay(cdb2_hndl_tp *db, cson_value *val);
 
 static const char *usage_text =
     "Usage: cdb2sqlreplay [options] dbname FILE [FILE]\n"
+    "       cdb2sqlreplay --tojson FILE [FILE]\n"
     "\n"
     "Basic options:\n"
     "  --diff                 Dump performance/cost diffs\n"
     "  --verbose              Lots of verbose output\n"
     "  --threshold N          Set diff threshold to N% (default 5)\n"
     "  --stopat N             Stop after N events processed\n"
+    "  --tojson               Print the events of binary event logs as json\n"
+    "                         instead of replaying them\n"
+    "  --concurrent           Replay every original connection on its own\n"
+    "                         handle and thread, at the original arrival\n"
+    "                         times, and report latencies by fingerprint\n"
+    "  --speed F              With --concurrent, replay F times faster than\n"
+    "                         the original (default 1, 0 for no waits)\n"
+    "  --idle-secs N          With --concurrent, close the handle and thread\n"
+    "                         of a connection that had no events for N\n"
+    "                         seconds of log time outside a transaction\n"
+    "                         (default 60)\n"
+    "\n"
+    "FILE is a json event log, or a binary one (events binary on).\n"
     "\n"
     ;
 
@@ -306,12 +334,12 @@ bool do_bindings(cdb2_hndl_tp *db, cson_value *event_val, std::vector<uint8_t *>
             blobs_vect.push_back((uint8_t *)varaddr);
             if (name[0] == '?') {
                 int idx = atoi(name + 1);
-                if ((ret = cdb2_bind_array_index(cdb2h, idx, cdb2_type, varaddr, count, length)) != 0) {
+                if ((ret = cdb2_bind_array_index(db, idx, cdb2_type, varaddr, count, length)) != 0) {
                     std::cerr << "cdb2_bind_array_index failed for parameter index:" << idx
                               << " type:" << type << " count:" << count << " ret:" << ret << std::endl;
                     return false;
                 }
-            } else if ((ret = cdb2_bind_array(cdb2h, name, cdb2_type, varaddr, count, length)) != 0) {
+            } else if ((ret = cdb2_bind_array(db, name, cdb2_type, varaddr, count, length)) != 0) {
                 std::cerr << "cdb2_bind_array failed for parameter name:" << name
                           << " type:" << type << " count:" << count << " ret:" << ret << std::endl;
                 return false;
@@ -396,13 +424,13 @@ bool do_bindings(cdb2_hndl_tp *db, cson_value *event_val, std::vector<uint8_t *>
 
         if (name[0] == '?') {
             int idx = atoi(name + 1);
-            if ((ret = cdb2_bind_index(cdb2h, idx, cdb2_type, varaddr, length)) != 0) {
+            if ((ret = cdb2_bind_index(db, idx, cdb2_type, varaddr, length)) != 0) {
                 std::cerr << "Error from cdb2_bind_index() column " << name << ", ret=" << ret << std::endl;
                 return false;
             }
         }
         else {
-            if ((ret = cdb2_bind_param(cdb2h, name, cdb2_type, varaddr, length)) != 0) {
+            if ((ret = cdb2_bind_param(db, name, cdb2_type, varaddr, length)) != 0) {
                 std::cerr << "Error from cdb2_bind_param column " << name << ", ret=" << ret << std::endl;
                 return false;
             }
@@ -948,35 +976,205 @@ void handle(cdb2_hndl_tp *db, const char *event, cson_value *event_val) {
         h->second(db, event_val);
 }
 
+static cson_value *evb_decode_value(int type, const uint8_t *&p, const uint8_t *end);
+
+/* Decode items up to EVB_END into an object or array */
+static bool evb_decode_items(cson_value *container, const uint8_t *&p, const uint8_t *end)
+{
+    bool is_object = cson_value_is_object(container);
+    while (p < end) {
+        int type = *p++;
+        if (type == EVB_END)
+            return true;
+        std::string key;
+        if (is_object) {
+            if (p >= end)
+                return false;
+            int k = *p++;
+            if (k == EVB_KEY_INLINE) {
+                uint64_t n;
+                int h = evb_get_varint(p, end, &n);
+                if (h == 0 || n > (uint64_t)(end - p - h))
+                    return false;
+                key.assign((const char *)p + h, n);
+                p += h + n;
+            } else {
+                const char *name = evb_key_name(k);
+                if (name == nullptr)
+                    return false;
+                key = name;
+            }
+        }
+        cson_value *v = evb_decode_value(type, p, end);
+        if (v == nullptr)
+            return false;
+        if (is_object)
+            cson_object_set(cson_value_get_object(container), key.c_str(), v);
+        else
+            cson_array_append(cson_value_get_array(container), v);
+    }
+    return false;
+}
+
+static cson_value *evb_decode_value(int type, const uint8_t *&p, const uint8_t *end)
+{
+    cson_value *v = nullptr;
+    uint64_t n;
+    int h;
+
+    switch (type) {
+    case EVB_INT:
+        if ((h = evb_get_varint(p, end, &n)) == 0)
+            return nullptr;
+        p += h;
+        return cson_value_new_integer(evb_unzigzag(n));
+    case EVB_DBL: {
+        if (end - p < 8)
+            return nullptr;
+        uint64_t u = 0;
+        double d;
+        for (int i = 0; i < 8; i++)
+            u = (u << 8) | *p++;
+        memcpy(&d, &u, sizeof(d));
+        return cson_value_new_double(d);
+    }
+    case EVB_STR:
+    case EVB_JSON:
+        if ((h = evb_get_varint(p, end, &n)) == 0 || n > (uint64_t)(end - p - h))
+            return nullptr;
+        p += h;
+        if (type == EVB_STR)
+            v = cson_value_new_string((const char *)p, n);
+        else if (cson_parse_string(&v, (const char *)p, n) != 0)
+            v = nullptr;
+        p += n;
+        return v;
+    case EVB_OBJ:
+    case EVB_ARR:
+        v = type == EVB_OBJ ? cson_value_new_object() : cson_value_new_array();
+        if (!evb_decode_items(v, p, end)) {
+            cson_free_value(v);
+            return nullptr;
+        }
+        return v;
+    case EVB_BOOL:
+        if (p >= end)
+            return nullptr;
+        return cson_value_new_bool(*p++);
+    case EVB_NULL:
+        return cson_value_null();
+    default:
+        return nullptr;
+    }
+}
+
+/* Read the next record of a binary event log as the json object the text
+ * log would have had.  Returns false at end of file. */
+static bool evb_read(gzFile gz, std::vector<uint8_t> &buf, cson_value **value)
+{
+    uint64_t len = 0;
+    int shift = 0, c;
+    do {
+        if ((c = gzgetc(gz)) == -1 || shift > 63)
+            return false;
+        len |= (uint64_t)(c & 0x7f) << shift;
+        shift += 7;
+    } while (c & 0x80);
+
+    buf.resize(len);
+    if (len && gzread(gz, buf.data(), len) != (int)len)
+        return false;
+
+    const uint8_t *p = buf.data();
+    *value = cson_value_new_object();
+    if (!evb_decode_items(*value, p, p + len)) {
+        cson_free_value(*value);
+        *value = nullptr;
+    }
+    return true;
+}
+
+/* Binary event logs start with EVB_MAGIC; returns the open file if fname is
+ * one, nullptr otherwise. */
+static gzFile evb_open(const std::string &fname)
+{
+    char magic[EVB_MAGIC_LEN];
+    gzFile gz = gzopen(fname.c_str(), "rb");
+    if (gz == nullptr)
+        return nullptr;
+    if (gzread(gz, magic, sizeof(magic)) != sizeof(magic) ||
+        memcmp(magic, EVB_MAGIC, sizeof(magic)) != 0) {
+        gzclose(gz);
+        return nullptr;
+    }
+    return gz;
+}
+
 struct event_source {
     std::string fname;
     std::ifstream file;
+    gzFile gz;
+    std::vector<uint8_t> buf;
     bool done;
     int64_t timestamp;
     cson_value *value;
     int linenum;
 
-    event_source(const char *name) : fname(name), file(), done(false), value(nullptr), timestamp(0), linenum(0) {
-        file.open(name);
-        if (!file.is_open()) {
-            std::cerr << "can't open " << fname << std::endl;
-            done = true;
-        }
-        get();
+    event_source(const char *name, bool prime = true) : fname(name), file(), gz(nullptr), done(false), value(nullptr), timestamp(0), linenum(0) {
+        open();
+        if (prime)
+            get();
     }
 
     event_source(const event_source &from) {
         fname = from.fname;
+        gz = nullptr;
         done = false;
+        value = nullptr;
+        timestamp = 0;
+        linenum = 0;
+        open();
+        get();
+    }
+
+    ~event_source() {
+        if (gz != nullptr)
+            gzclose(gz);
+    }
+
+    void open() {
+        gz = evb_open(fname);
+        if (gz != nullptr)
+            return;
         file.open(fname);
         if (!file.is_open()) {
             std::cerr << "can't open " << fname << std::endl;
             done = true;
         }
-        value = nullptr;
-        timestamp = 0;
-        linenum = 0;
-        get();
+    }
+
+    /* next event, whatever its type */
+    bool next(cson_value **v) {
+        *v = nullptr;
+        linenum++;
+        if (gz != nullptr) {
+            if (!evb_read(gz, buf, v))
+                return false;
+            if (*v == nullptr)
+                std::cerr << "Error: Malformed record " << linenum << std::endl;
+            return true;
+        }
+        std::string line;
+        if (!std::getline(file, line))
+            return false;
+        if (line.empty())
+            return true;
+        int rc = cson_parse_string(v, line.c_str(), line.length());
+        if (rc) {
+            std::cerr << "Error: Malformed input on line " << linenum << std::endl;
+            *v = nullptr;
+        }
+        return true;
     }
 
     cson_value *consume() {
@@ -986,7 +1184,6 @@ struct event_source {
     }
 
     void get() {
-        std::string line;
         if (done)
             return;
         for (;;) {
@@ -994,23 +1191,22 @@ struct event_source {
                 cson_free_value(value);
                 value = nullptr;
             }
-            if (!std::getline(file, line)) {
+            if (!next(&value)) {
                 done = true;
                 return;
             }
-            linenum++;
-            if (line.empty())
+            if (value == nullptr)
                 continue;
-            int rc = cson_parse_string(&value, line.c_str(), line.length());
-            if (rc) {
-                std::cerr << "Error: Malformed input on line " << linenum << std::endl;
-                continue;
-            }
             if (!cson_value_is_object(value)) {
                 std::cerr << "Error: Not an object  on line " << linenum << std::endl;
                 continue;
             }
             const char *type = get_strprop(value, "type");
+            // remember the sql of fingerprints, so sql events logged without it can be replayed
+            if (type != nullptr && strcmp(type, "newsql") == 0) {
+                handle_newsql(nullptr, value);
+                continue;
+            }
             // skip anything with no type field (we don't know what it is) or timestamp (we don't know the order of replay)
             if (type == nullptr || strcmp(type, "sql") != 0)
                 continue;
@@ -1044,7 +1240,8 @@ public:
         }
         return true;
     }
-    cson_value *get() {
+    /* oldest pending event of all sources; src is set to its source */
+    cson_value *get(int *src = nullptr) {
         int64_t min_timestamp = LLONG_MAX;
         int minix = -1;
         for (int i = 0; i < sources.size(); i++) {
@@ -1058,6 +1255,8 @@ public:
         cson_value *ret = sources[minix].consume();
         if (minix != -1)
             sources[minix].get();
+        if (src)
+            *src = minix;
         return ret;
     }
 
@@ -1065,6 +1264,16 @@ protected:
     std::vector<event_source> sources;
 };
 
+/* TODO: tier should be an option */
+static int open_db(cdb2_hndl_tp **db) {
+    char *conf = getenv("CDB2_CONFIG");
+    if (conf) {
+        cdb2_set_comdb2db_config(conf);
+        return cdb2_open(db, dbname, "default", 0);
+    }
+    return cdb2_open(db, dbname, "local", 0);
+}
+
 void process_events(cdb2_hndl_tp *db, event_queue &queue) {
     std::string line;
     int linenum = 0;
@@ -1080,13 +1289,7 @@ void process_events(cdb2_hndl_tp *db, event_queue &queue) {
             if (had_errors) {
                 had_errors = 0;
                 cdb2_close(cdb2h);
-                char *conf = getenv("CDB2_CONFIG");
-                if (conf) {
-                    cdb2_set_comdb2db_config(conf);
-                    rc = cdb2_open(&cdb2h, dbname, "default", 0);
-                } else { 
-                    rc = cdb2_open(&cdb2h, dbname, "local", 0);
-                }
+                rc = open_db(&cdb2h);
                 db = cdb2h;
             }
             numevents++;
@@ -1100,6 +1303,337 @@ void process_events(cdb2_hndl_tp *db, event_queue &queue) {
         std::cout << "got " << linenum  << " lines" << std::endl;
 }
 
+/* Concurrent replay (--concurrent).  Every connection of the original
+   workload gets its own handle and thread, so statements of different
+   connections overlap as they did originally, while statements of one
+   connection (including its transactions) run in their original order.
+   The reader thread releases each statement at its original start time,
+   scaled by --speed. */
+
+struct replay_stmt {
+    cson_value *event;
+    std::string sql;
+    std::string fingerprint;
+};
+
+/* what a session saw, by fingerprint */
+struct replay_stats {
+    std::map<std::string, std::vector<int64_t>> latency_us;
+    std::map<std::string, int64_t> errors;
+};
+
+/* run one statement, discarding its rows; false on error */
+static bool run_timed(cdb2_hndl_tp *db, replay_stmt &stmt, int64_t *us) {
+    std::vector<uint8_t *> blobs_vect;
+    if (!do_bindings(db, stmt.event, blobs_vect)) {
+        cdb2_clearbindings(db);
+        free_blobs(blobs_vect);
+        return false;
+    }
+
+    int64_t start_time = hrtime();
+    int rc = cdb2_run_statement(db, stmt.sql.c_str());
+    if (rc == CDB2_OK) {
+        while ((rc = cdb2_next_record(db)) == CDB2_OK)
+            ;
+    }
+    *us = hrtime() - start_time;
+    cdb2_clearbindings(db);
+    free_blobs(blobs_vect);
+
+    if (rc != CDB2_OK && rc != CDB2_OK_DONE) {
+        fprintf(stderr, "Error: %s rc %d %s\n", stmt.sql.c_str(), rc, cdb2_errstr(db));
+        return false;
+    }
+    return true;
+}
+
+class replay_session {
+public:
+    replay_session()
+        : last_time(0), in_txn(false), closing(false), done(false), thd(&replay_session::run, this) {}
+
+    void push(replay_stmt &&stmt) {
+        std::lock_guard<std::mutex> l(lk);
+        q.push_back(std::move(stmt));
+        cv.notify_one();
+    }
+
+    /* no more statements; the thread exits once the queued ones ran */
+    void close() {
+        std::lock_guard<std::mutex> l(lk);
+        closing = true;
+        cv.notify_one();
+    }
+
+    bool is_done() const { return done.load(); }
+
+    /* wait for the queued statements to run */
+    void finish() {
+        close();
+        thd.join();
+    }
+
+    replay_stats stats;
+
+    /* owned by the dispatcher: log time of the last event, and whether
+     * the connection was inside a transaction after it */
+    int64_t last_time;
+    bool in_txn;
+
+private:
+    void run() {
+        cdb2_hndl_tp *db = nullptr;
+        if (open_db(&db)) {
+            fprintf(stderr, "Error: cdb2_open() failed: %s\n", cdb2_errstr(db));
+            cdb2_close(db);
+            db = nullptr;
+        }
+        for (;;) {
+            replay_stmt stmt;
+            {
+                std::unique_lock<std::mutex> l(lk);
+                cv.wait(l, [this] { return closing || !q.empty(); });
+                if (q.empty())
+                    break;
+                stmt = std::move(q.front());
+                q.pop_front();
+            }
+            int64_t us;
+            if (db != nullptr && run_timed(db, stmt, &us))
+                stats.latency_us[stmt.fingerprint].push_back(us);
+            else
+                stats.errors[stmt.fingerprint]++;
+            cson_free_value(stmt.event);
+        }
+        if (db != nullptr)
+            cdb2_close(db);
+        done = true;
+    }
+
+    std::mutex lk;
+    std::condition_variable cv;
+    std::deque<replay_stmt> q;
+    bool closing;
+    std::atomic<bool> done;
+    std::thread thd; /* last, it starts running in the constructor */
+};
+
+/* track begin/commit/rollback so a connection is never closed mid-transaction */
+static bool txn_state_after(bool in_txn, const char *sql) {
+    while (isspace(*sql))
+        sql++;
+    if (strncasecmp(sql, "begin", 5) == 0)
+        return true;
+    if (strncasecmp(sql, "commit", 6) == 0 || strncasecmp(sql, "rollback", 8) == 0)
+        return false;
+    return in_txn;
+}
+
+/* join a finished session and fold its statistics into all */
+static void retire_session(replay_session *s, replay_stats &all) {
+    s->finish();
+    for (auto &e : s->stats.latency_us) {
+        auto &v = all.latency_us[e.first];
+        v.insert(v.end(), e.second.begin(), e.second.end());
+    }
+    for (auto &e : s->stats.errors)
+        all.errors[e.first] += e.second;
+    delete s;
+}
+
+/* events of one original connection map to the same session */
+static std::string session_key(int src, cson_value *event) {
+    std::ostringstream key;
+    int64_t connid, pid;
+    const char *host = get_strprop(event, "host");
+
+    key << src << '/' << (host ? host : "");
+    if (get_intprop(event, "pid", &pid))
+        key << '/' << pid;
+    if (get_intprop(event, "connid", &connid)) {
+        key << '/' << connid;
+    } else {
+        const char *cnonce = get_strprop(event, "cnonce");
+        if (cnonce != nullptr)
+            key << '/' << cnonce;
+    }
+    return key.str();
+}
+
+static int64_t percentile(const std::vector<int64_t> &sorted, double pct) {
+    if (sorted.empty())
+        return 0;
+    size_t ix = (size_t)(pct / 100.0 * sorted.size() + 0.5);
+    if (ix > 0)
+        ix--;
+    if (ix >= sorted.size())
+        ix = sorted.size() - 1;
+    return sorted[ix];
+}
+
+static void report(const replay_stats &all, int64_t elapsed_us, size_t nsessions, int64_t maxlag_us) {
+    struct row {
+        std::string fingerprint;
+        std::vector<int64_t> lat;
+        int64_t errors;
+        int64_t total;
+    };
+    std::vector<row> rows;
+    int64_t nstmts = 0, nerrors = 0;
+
+    for (auto &e : all.latency_us) {
+        row r{e.first, e.second, 0, 0};
+        std::sort(r.lat.begin(), r.lat.end());
+        for (auto us : r.lat)
+            r.total += us;
+        auto err = all.errors.find(e.first);
+        if (err != all.errors.end())
+            r.errors = err->second;
+        rows.push_back(std::move(r));
+    }
+    for (auto &e : all.errors) {
+        if (all.latency_us.find(e.first) == all.latency_us.end())
+            rows.push_back(row{e.first, std::vector<int64_t>(), e.second, 0});
+    }
+    std::sort(rows.begin(), rows.end(), [](const row &a, const row &b) { return a.total > b.total; });
+
+    for (auto &r : rows) {
+        nstmts += r.lat.size();
+        nerrors += r.errors;
+    }
+    double secs = elapsed_us / 1000000.0;
+    printf("replayed %" PRId64 " statements (%" PRId64 " errors) on %zu connections in %.3f s, %.1f/s, "
+           "max dispatch lag %" PRId64 " ms\n",
+           nstmts, nerrors, nsessions, secs, secs > 0 ? nstmts / secs : 0.0, maxlag_us / 1000);
+    printf("%-32s %8s %6s %10s %10s %10s %10s %10s  %s\n", "fingerprint", "count", "errors", "p50_us", "p95_us",
+           "p99_us", "p999_us", "max_us", "sql");
+    for (auto &r : rows) {
+        std::string sql;
+        auto s = sqltrack.find(r.fingerprint);
+        if (s != sqltrack.end())
+            sql = s->second.substr(0, 60);
+        std::replace(sql.begin(), sql.end(), '\n', ' ');
+        printf("%-32s %8zu %6" PRId64 " %10" PRId64 " %10" PRId64 " %10" PRId64 " %10" PRId64 " %10" PRId64 "  %s\n",
+               r.fingerprint.c_str(), r.lat.size(), r.errors, percentile(r.lat, 50), percentile(r.lat, 95),
+               percentile(r.lat, 99), percentile(r.lat, 99.9), r.lat.empty() ? 0 : r.lat.back(), sql.c_str());
+    }
+}
+
+void replay_concurrent(event_queue &queue) {
+    std::map<std::string, replay_session *> sessions;
+    std::list<replay_session *> closing; /* idle, running what they have queued */
+    replay_stats all;
+    size_t nsessions = 0;
+    int64_t numevents = 0;
+    int64_t first_time = -1, start = hrtime(), maxlag = 0, last_sweep = 0;
+    int64_t idle_us = (int64_t)idle_secs * 1000000;
+
+    while (!queue.empty()) {
+        int src;
+        cson_value *event_val = queue.get(&src);
+        if (event_val == nullptr)
+            continue;
+        if (!is_replayable(event_val)) {
+            cson_free_value(event_val);
+            continue;
+        }
+
+        replay_stmt stmt;
+        const char *fp = get_strprop(event_val, "fingerprint");
+        const char *sql = get_strprop(event_val, "sql");
+        stmt.fingerprint = fp ? fp : "-";
+        if (sql == nullptr && fp != nullptr) {
+            auto s = sqltrack.find(fp);
+            if (s != sqltrack.end())
+                sql = s->second.c_str();
+        }
+        if (sql == nullptr) {
+            cson_free_value(event_val);
+            continue;
+        }
+        if (fp != nullptr && sqltrack.find(fp) == sqltrack.end())
+            add_fingerprint(fp, sql);
+        stmt.sql = sql;
+        stmt.event = event_val;
+
+        int64_t t;
+        bool have_time = get_intprop(event_val, "time", &t);
+        if (speed > 0 && have_time) {
+            if (first_time < 0) {
+                first_time = t;
+                start = hrtime();
+            }
+            int64_t due = start + (int64_t)((t - first_time) / speed);
+            int64_t now = hrtime();
+            if (due > now)
+                std::this_thread::sleep_for(std::chrono::microseconds(due - now));
+            else if (now - due > maxlag)
+                maxlag = now - due;
+        }
+
+        /* retire connections that went idle; their events are over, or a
+         * later one starts a new connection like the original client did */
+        if (have_time && idle_us > 0 && t - last_sweep >= idle_us / 2) {
+            last_sweep = t;
+            for (auto it = sessions.begin(); it != sessions.end();) {
+                if (!it->second->in_txn && t - it->second->last_time > idle_us) {
+                    it->second->close();
+                    closing.push_back(it->second);
+                    it = sessions.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            for (auto it = closing.begin(); it != closing.end();) {
+                if ((*it)->is_done()) {
+                    retire_session(*it, all);
+                    it = closing.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        std::string key = session_key(src, event_val);
+        auto it = sessions.find(key);
+        if (it == sessions.end()) {
+            it = sessions.insert(std::make_pair(key, new replay_session())).first;
+            nsessions++;
+        }
+        if (have_time)
+            it->second->last_time = t;
+        it->second->in_txn = txn_state_after(it->second->in_txn, sql);
+        it->second->push(std::move(stmt));
+
+        numevents++;
+        if (maxevents && numevents >= maxevents)
+            break;
+    }
+
+    for (auto &s : sessions)
+        retire_session(s.second, all);
+    for (auto s : closing)
+        retire_session(s, all);
+    report(all, hrtime() - start, nsessions, maxlag);
+}
+
+/* print every event of fname as a line of json, as the text event log has it */
+static int dump_json(const char *fname) {
+    event_source src(fname, false);
+    cson_value *v;
+
+    if (src.is_done())
+        return 1;
+    while (src.next(&v)) {
+        if (v == nullptr)
+            continue;
+        cson_output_FILE(v, stdout);
+        cson_free_value(v);
+    }
+    return 0;
+}
+
 int main(int argc, char **argv) {
     char *filename = nullptr;
 
@@ -1126,6 +1660,19 @@ int main(int argc, char **argv) {
             }
             threshold_percent = (int) strtol(argv[0], nullptr, 10);
         }
+        else if (strcmp(argv[0], "--tojson") == 0)
+            tojson = true;
+        else if (strcmp(argv[0], "--concurrent") == 0)
+            concurrent = true;
+        else if (strcmp(argv[0], "--speed") == 0) {
+            argc--;
+            argv++;
+            if (argc == 0) {
+                fprintf(stderr, "--speed expected an argument");
+                return 1;
+            }
+            speed = strtod(argv[0], nullptr);
+        }
         else if (strcmp(argv[0], "--stopat") == 0) {
             argc--;
             argv++;
@@ -1135,26 +1682,35 @@ int main(int argc, char **argv) {
             }
             maxevents = (int) strtol(argv[0], nullptr, 10);
         }
+        else if (strcmp(argv[0], "--idle-secs") == 0) {
+            argc--;
+            argv++;
+            if (argc == 0) {
+                fprintf(stderr, "--idle-secs expected an argument");
+                return 1;
+            }
+            idle_secs = (int) strtol(argv[0], nullptr, 10);
+        }
         else {
             fprintf(stderr, "Unknown option %s\n", argv[0]);
         }
         argc--;
         argv++;
     }
+    if (tojson) {
+        int rc = 0;
+        if (argc == 0)
+            usage();
+        for (; argc; argc--, argv++)
+            rc |= dump_json(argv[0]);
+        return rc ? EXIT_FAILURE : 0;
+    }
+
     dbname = argv[0];
     argc--;
     argv++;
 
-    /* TODO: tier should be an option */
-    int rc;
-    char *conf = getenv("CDB2_CONFIG");
-    if (conf) {
-        cdb2_set_comdb2db_config(conf);
-        rc = cdb2_open(&cdb2h, dbname, "default", 0);
-    } else { 
-        rc = cdb2_open(&cdb2h, dbname, "local", 0);
-    }
-
+    int rc = open_db(&cdb2h);
     if (rc) {
         std::cerr << "Error: cdb2_open() failed: " << cdb2_errstr(cdb2h) << std::endl;
         exit(EXIT_FAILURE);
@@ -1167,7 +1723,10 @@ int main(int argc, char **argv) {
         argc--;
         argv++;
     }
-    process_events(cdb2h, events);
+    if (concurrent)
+        replay_concurrent(events);
+    else
+        process_events(cdb2h, events);
 
     cdb2_close(cdb2h);
     return 0;
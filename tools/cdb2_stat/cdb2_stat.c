@@ -889,6 +889,12 @@ mpool_stats(dbenv, internal, flags)
 	    (u_long)gsp->st_ckp_pages_sync);
 	dl("The number of pages skipped using perfect checkpoint\n",
 	    (u_long)gsp->st_ckp_pages_skip);
+	dl("Duration in ms of the last checkpoint flush\n",
+	    (u_long)gsp->st_ckp_ms);
+	dl("The number of pages written by the last checkpoint\n",
+	    (u_long)gsp->st_ckp_pages_written);
+	dl("The number of pages written to bound the checkpoint distance\n",
+	    (u_long)gsp->st_page_ckp_trickle);
 
 	for (; fsp != NULL && *fsp != NULL; ++fsp) {
 		printf("%s\n", DB_LINE);
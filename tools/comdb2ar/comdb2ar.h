@@ -71,6 +71,10 @@ void listdir_abs_recursive(std::list<std::string>& output_list,
 // in directory dirname, which should be itself an absolute path.  This will
 // follow non-symbolic subdirectories and include those too.
 
+long long log_file_number(const std::string& filename);
+// Returns the number of a berkdb log file name, either log.NNNNNNNNNN or the
+// compressed log.NNNNNNNNNN.lz, or -1 if filename is neither.
+
 
 ssize_t writeall(int fd, const void *ptr, size_t nbytes);
 // Write all the bytes to the given fd.  Return the number of bytes written,
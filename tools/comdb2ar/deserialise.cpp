@@ -1073,7 +1073,7 @@ void restore_partials(
     listdir(logfiles, logpath);
     for (std::list<std::string>::const_iterator it = logfiles.begin();
             it != logfiles.end(); ++it) {
-        if (it->compare(0, 4, "log.") == 0 && it->length() == 14) {
+        if (log_file_number(*it) != -1) {
             std::string logfile = logpath + "/" + *it;
             unlink(logfile.c_str());
         }
@@ -440,6 +440,24 @@ static void serialise_page_list(const std::string &dbtxndir,
     serialise_file(fi);
 }
 
+static bool find_log_file(std::string& absfile, const std::string& dbtxndir,
+        long long log_number)
+// The database may have rewritten an older log file compressed, as
+// log.NNNNNNNNNN.lz; point absfile at whichever of the two names exists.
+// Returns false if neither does.
+{
+    char logfile[32];
+    struct stat st;
+
+    snprintf(logfile, sizeof(logfile), "log.%010lld", log_number);
+    makeabs(absfile, dbtxndir, logfile);
+    if(stat(absfile.c_str(), &st) == 0) {
+        return true;
+    }
+    absfile += ".lz";
+    return stat(absfile.c_str(), &st) == 0;
+}
+
 static void serialise_log_files(
         const std::string& dbtxndir,
         const std::string& dbdir,
@@ -448,19 +466,13 @@ static void serialise_log_files(
 // log file log_number.  If complete_only is set then we will only archive
 // completed logs (a log is complete if the next log file in the sequence
 // already exists).  Otherwise we keep going until there are no more log files.
+// Compressed log files are archived as they are, under their own name.
 {
-    char logfile[32];
     std::string absfile, storename;
-    struct stat st;
 
     // Find the highest existing log file
     long long highest_log = log_number - 1;
-    while(true) {
-        snprintf(logfile, sizeof(logfile), "log.%010lld", highest_log + 1);
-        makeabs(absfile, dbtxndir, logfile);
-        if(stat(absfile.c_str(), &st) == -1) {
-            break;
-        }
+    while(find_log_file(absfile, dbtxndir, highest_log + 1)) {
         highest_log++;
     }
 
@@ -471,11 +483,23 @@ static void serialise_log_files(
 
     // Archive whatever's in between
     while(log_number <= highest_log) {
-        snprintf(logfile, sizeof(logfile), "log.%010lld", log_number);
-        std::cerr<<"Serializing "<<logfile<<std::endl;
-        makeabs(absfile, dbtxndir, logfile);
-        FileInfo fi(FileInfo::LOG_FILE, absfile, dbdir);
-        serialise_file(fi);
+        find_log_file(absfile, dbtxndir, log_number);
+        std::cerr<<"Serializing "<<absfile<<std::endl;
+        try {
+            FileInfo fi(FileInfo::LOG_FILE, absfile, dbdir);
+            serialise_file(fi);
+        } catch(SerialiseError &err) {
+            // compressed between the lookup and the open; the compressed
+            // file is in place before the original goes away
+            std::string zfile;
+            if(!find_log_file(zfile, dbtxndir, log_number) ||
+                    zfile == absfile) {
+                throw;
+            }
+            std::cerr<<"Serializing "<<zfile<<std::endl;
+            FileInfo fi(FileInfo::LOG_FILE, zfile, dbdir);
+            serialise_file(fi);
+        }
         log_number++;
     }
 }
@@ -1012,15 +1036,8 @@ void serialise_database(
         for(std::list<std::string>::const_iterator it = dbtxndir_files.begin();
                 it != dbtxndir_files.end();
                 ++it) {
-            if(it->compare(0, 4, "log.") == 0 && it->length() == 14) {
-                int logno = 0;
-                for(int ii = 4; ii < 14; ++ii) {
-                    if(!std::isdigit((*it)[ii])) {
-                        logno = -1;
-                        break;
-                    }
-                    logno = (logno * 10) + ((*it)[ii] - '0');
-                }
+            int logno = log_file_number(*it);
+            if(logno != -1) {
                 if(logno < lowest_log || lowest_log == -1) {
                     lowest_log = logno;
                 }
@@ -1029,8 +1046,10 @@ void serialise_database(
             }
         }
 
-        // sort
+        // sort; a log file being compressed shows up under both names
         std::sort( logvec.begin(), logvec.end () );
+        logvec.erase( std::unique( logvec.begin(), logvec.end() ),
+                logvec.end() );
 
         for ( logit = logvec.begin() ; logit != logvec.end() ; logit++ )
         {
@@ -2,6 +2,7 @@
 #include "error.h"
 #include "riia.h"
 
+#include <cctype>
 #include <cstring>
 #include <sstream>
 #include <string>
@@ -153,6 +154,25 @@ void listdir_abs_recursive(std::list<std::string>& output_list,
             : dirname + "/");
 }
 
+long long log_file_number(const std::string& filename)
+// Returns the number of a berkdb log file name, either log.NNNNNNNNNN or the
+// compressed log.NNNNNNNNNN.lz, or -1 if filename is neither.
+{
+    if(filename.compare(0, 4, "log.") != 0 ||
+            (filename.length() != 14 &&
+             (filename.length() != 17 || filename.compare(14, 3, ".lz") != 0))) {
+        return -1;
+    }
+    long long logno = 0;
+    for(int ii = 4; ii < 14; ++ii) {
+        if(!std::isdigit(filename[ii])) {
+            return -1;
+        }
+        logno = (logno * 10) + (filename[ii] - '0');
+    }
+    return logno;
+}
+
 
 ssize_t writeall(int fd, const void *buf, size_t nbytes)
 // Write all the bytes to the given fd.  Return the number of bytes written,
@@ -19,7 +19,7 @@
 #include <stdlib.h>
 #include <alloca.h>
 
-#include "plhash.h"
+#include "rcu_hash.h"
 #include "intern_strings.h"
 
 #include "mem_util.h"
@@ -28,13 +28,14 @@
 #include "sys_wrap.h"
 
 static pthread_once_t once = PTHREAD_ONCE_INIT;
+/* Lookups don't lock; this only keeps ix dense when adding */
 static pthread_mutex_t intern_lk = PTHREAD_MUTEX_INITIALIZER;
-static hash_t *interned_strings = NULL;
+static rcu_hash_t *interned_strings = NULL;
 static int node_ix;
 
 static void init_interned_strings(void)
 {
-    interned_strings = hash_init_strptr(offsetof(struct interned_string, str));
+    interned_strings = rcu_hash_init_strptr(offsetof(struct interned_string, str));
     if (interned_strings == NULL) {
         logmsg(LOGMSG_FATAL, "can't create hash table for hostname strings\n");
         abort();
@@ -47,8 +48,11 @@ struct interned_string *intern_ptr(const char *str)
     struct interned_string *s;
 
     pthread_once(&once, init_interned_strings);
+    if ((s = rcu_hash_find(interned_strings, &str)) != NULL)
+        return s;
+
     Pthread_mutex_lock(&intern_lk);
-    s = hash_find_readonly(interned_strings, &str);
+    s = rcu_hash_find(interned_strings, &str);
     if (s == NULL) {
         s = malloc(sizeof(struct interned_string));
         if (s == NULL) {
@@ -64,7 +68,12 @@ struct interned_string *intern_ptr(const char *str)
             Pthread_mutex_unlock(&intern_lk);
             return NULL;
         }
-        hash_add(interned_strings, s);
+        if (rcu_hash_add(interned_strings, s) != 0) {
+            free(s->str);
+            free(s);
+            Pthread_mutex_unlock(&intern_lk);
+            return NULL;
+        }
     }
     Pthread_mutex_unlock(&intern_lk);
     return s;
@@ -96,9 +105,8 @@ int isinterned(const char *node)
 {
     struct interned_string *s;
 
-    Pthread_mutex_lock(&intern_lk);
-    s = hash_find_readonly(interned_strings, &node);
-    Pthread_mutex_unlock(&intern_lk);
+    pthread_once(&once, init_interned_strings);
+    s = rcu_hash_find(interned_strings, &node);
 
     if (s && s->str == node) {
         return 1;
@@ -118,9 +126,8 @@ static int intern_free(void *ptr, void *unused)
 
 void cleanup_interned_strings()
 {
-    hash_for(interned_strings, intern_free, NULL);
-    hash_clear(interned_strings);
-    hash_free(interned_strings);
+    rcu_hash_for(interned_strings, intern_free, NULL);
+    rcu_hash_free(interned_strings);
     interned_strings = NULL;
     Pthread_mutex_destroy(&intern_lk);
 }
@@ -135,5 +142,5 @@ static int intern_dump(void *ptr, void *unused)
 
 void dump_interned_strings()
 {
-    hash_for(interned_strings, intern_dump, NULL);
+    rcu_hash_for(interned_strings, intern_dump, NULL);
 }
@@ -0,0 +1,131 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "comdb2_atomic.h"
+#include "epochlib.h"
+#include "latency_hist.h"
+#include "mem_util.h"
+#include "mem_override.h"
+
+struct latency_slot {
+    int64_t minute; /* epoch minute the counts belong to */
+    uint32_t counts[LATENCY_HIST_NBUCKETS];
+};
+
+struct latency_hist {
+    uint64_t total[LATENCY_HIST_NBUCKETS];
+    struct latency_slot slots[LATENCY_HIST_NSLOTS];
+};
+
+static inline int latency_bucket(int64_t us)
+{
+    if (us < LATENCY_HIST_LINEAR)
+        return us < 0 ? 0 : (int)us;
+    int msb = 63 - __builtin_clzll((uint64_t)us);
+    if (msb > LATENCY_HIST_MAX_BIT)
+        return LATENCY_HIST_NBUCKETS - 1;
+    int shift = msb - LATENCY_HIST_SUB_BITS;
+    int sub = (int)(us >> shift) & ((1 << LATENCY_HIST_SUB_BITS) - 1);
+    return LATENCY_HIST_LINEAR + ((msb - 4) << LATENCY_HIST_SUB_BITS) + sub;
+}
+
+/* Highest value that falls in bucket b */
+static inline int64_t latency_bucket_max(int b)
+{
+    if (b < LATENCY_HIST_LINEAR)
+        return b;
+    b -= LATENCY_HIST_LINEAR;
+    int msb = (b >> LATENCY_HIST_SUB_BITS) + 4;
+    int shift = msb - LATENCY_HIST_SUB_BITS;
+    int64_t sub = (1 << LATENCY_HIST_SUB_BITS) +
+                  (b & ((1 << LATENCY_HIST_SUB_BITS) - 1));
+    return ((sub + 1) << shift) - 1;
+}
+
+struct latency_hist *latency_hist_new(void)
+{
+    return calloc(1, sizeof(struct latency_hist));
+}
+
+void latency_hist_free(struct latency_hist *h)
+{
+    free(h);
+}
+
+void latency_hist_add(struct latency_hist *h, int64_t us)
+{
+    int b = latency_bucket(us);
+    int64_t minute = comdb2_time_epoch() / LATENCY_HIST_SLOT_SEC;
+    struct latency_slot *s = &h->slots[minute % LATENCY_HIST_NSLOTS];
+    int64_t old = ATOMIC_LOAD64(s->minute);
+
+    /* First value of a new minute recycles the slot.  Values recorded by
+     * other threads between the swap and the memset are lost, which is
+     * fine for statistics. */
+    if (old < minute && CAS64(s->minute, old, minute))
+        memset(s->counts, 0, sizeof(s->counts));
+
+    ATOMIC_ADD32(s->counts[b], 1);
+    ATOMIC_ADD64(h->total[b], 1);
+}
+
+void latency_hist_snap(struct latency_hist *h, int window_min,
+                       struct latency_snap *snap)
+{
+    if (window_min <= 0) {
+        for (int b = 0; b < LATENCY_HIST_NBUCKETS; b++) {
+            uint64_t n = ATOMIC_LOAD64(h->total[b]);
+            snap->counts[b] += n;
+            snap->count += n;
+        }
+        return;
+    }
+
+    if (window_min > LATENCY_HIST_NSLOTS)
+        window_min = LATENCY_HIST_NSLOTS;
+    int64_t now = comdb2_time_epoch() / LATENCY_HIST_SLOT_SEC;
+    for (int i = 0; i < LATENCY_HIST_NSLOTS; i++) {
+        struct latency_slot *s = &h->slots[i];
+        int64_t minute = ATOMIC_LOAD64(s->minute);
+        if (minute > now || minute <= now - window_min)
+            continue;
+        for (int b = 0; b < LATENCY_HIST_NBUCKETS; b++) {
+            uint32_t n = ATOMIC_LOAD32(s->counts[b]);
+            snap->counts[b] += n;
+            snap->count += n;
+        }
+    }
+}
+
+int64_t latency_snap_percentile(const struct latency_snap *snap, double pct)
+{
+    if (snap->count == 0)
+        return 0;
+    uint64_t want = (uint64_t)(snap->count * pct / 100.0 + 0.5);
+    if (want == 0)
+        want = 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < LATENCY_HIST_NBUCKETS; b++) {
+        seen += snap->counts[b];
+        if (seen >= want)
+            return latency_bucket_max(b);
+    }
+    return latency_bucket_max(LATENCY_HIST_NBUCKETS - 1);
+}
@@ -0,0 +1,489 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <ctype.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "rcu_hash.h"
+#include "logmsg.h"
+#include "sys_wrap.h"
+
+#define RCU_HASH_INITIAL_BUCKETS 64
+
+/* Try to reclaim once this many nodes/tables are waiting. */
+#define RCU_HASH_RECLAIM_BATCH 32
+
+/* Something a writer unlinked, waiting for the readers to move on.  It is
+ * the first member of both nodes and tables so it can be freed as either. */
+struct rcu_garbage {
+    struct rcu_garbage *next;
+    uint64_t epoch; /* global epoch when it was unlinked */
+};
+
+struct rcu_node {
+    struct rcu_garbage gc;
+    struct rcu_node *next;
+    unsigned int hash;
+    void *obj;
+};
+
+struct rcu_table {
+    struct rcu_garbage gc;
+    unsigned int mask;
+    struct rcu_node *buckets[];
+};
+
+struct rcu_hash {
+    struct rcu_table *tbl;
+    hashfunc_t *hashfunc;
+    cmpfunc_t *cmpfunc;
+    int keyoff;
+    int keylen;
+
+    pthread_mutex_t lk; /* serializes writers */
+    int nents;
+    struct rcu_garbage *garbage;
+    int ngarbage;
+};
+
+/* One per thread that has ever done a lookup.  epoch is 0 outside of a
+ * lookup and the global epoch it started in otherwise.  Slots of threads
+ * that exit are reused, never freed. */
+struct rcu_reader {
+    struct rcu_reader *next;
+    uint64_t epoch;
+    int in_use;
+};
+
+static pthread_once_t rcu_once = PTHREAD_ONCE_INIT;
+static pthread_key_t rcu_reader_key;
+static struct rcu_reader *rcu_readers;
+static uint64_t rcu_epoch = 1;
+
+static void rcu_reader_exit(void *arg)
+{
+    struct rcu_reader *r = arg;
+    __atomic_store_n(&r->epoch, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&r->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void rcu_init_once(void)
+{
+    Pthread_key_create(&rcu_reader_key, rcu_reader_exit);
+}
+
+static struct rcu_reader *rcu_get_reader(void)
+{
+    struct rcu_reader *r;
+    int unused;
+
+    pthread_once(&rcu_once, rcu_init_once);
+    if ((r = pthread_getspecific(rcu_reader_key)) != NULL)
+        return r;
+
+    for (r = __atomic_load_n(&rcu_readers, __ATOMIC_ACQUIRE); r; r = r->next) {
+        unused = 0;
+        if (__atomic_load_n(&r->in_use, __ATOMIC_RELAXED) == 0 &&
+            __atomic_compare_exchange_n(&r->in_use, &unused, 1, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            break;
+    }
+    if (r == NULL) {
+        r = calloc(1, sizeof(*r));
+        if (r == NULL) {
+            logmsg(LOGMSG_FATAL, "%s: can't allocate reader slot\n", __func__);
+            abort();
+        }
+        r->in_use = 1;
+        r->next = __atomic_load_n(&rcu_readers, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&rcu_readers, &r->next, r, 0,
+                                            __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            ;
+    }
+    Pthread_setspecific(rcu_reader_key, r);
+    return r;
+}
+
+static inline void rcu_read_enter(struct rcu_reader *r)
+{
+    __atomic_store_n(&r->epoch, __atomic_load_n(&rcu_epoch, __ATOMIC_SEQ_CST),
+                     __ATOMIC_SEQ_CST);
+    /* Pairs with the fence in rcu_reclaim: either the writer sees this slot
+     * or we see what it unlinked as gone. */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline void rcu_read_exit(struct rcu_reader *r)
+{
+    __atomic_store_n(&r->epoch, 0, __ATOMIC_RELEASE);
+}
+
+/* Oldest epoch a running lookup started in, UINT64_MAX if there are none. */
+static uint64_t rcu_oldest_reader(void)
+{
+    struct rcu_reader *r;
+    uint64_t e, oldest = UINT64_MAX;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (r = __atomic_load_n(&rcu_readers, __ATOMIC_ACQUIRE); r; r = r->next) {
+        e = __atomic_load_n(&r->epoch, __ATOMIC_SEQ_CST);
+        if (e != 0 && e < oldest)
+            oldest = e;
+    }
+    return oldest;
+}
+
+/* Called with h->lk held, after g has been unlinked. */
+static void rcu_retire(rcu_hash_t *h, struct rcu_garbage *g)
+{
+    /* Lookups that start after the increment can't reach g. */
+    g->epoch = __atomic_fetch_add(&rcu_epoch, 1, __ATOMIC_SEQ_CST);
+    g->next = h->garbage;
+    h->garbage = g;
+    h->ngarbage++;
+}
+
+static void rcu_reclaim(rcu_hash_t *h)
+{
+    struct rcu_garbage **gp, *g;
+    uint64_t oldest;
+
+    if (h->garbage == NULL)
+        return;
+    oldest = rcu_oldest_reader();
+    gp = &h->garbage;
+    while ((g = *gp) != NULL) {
+        if (g->epoch < oldest) {
+            *gp = g->next;
+            h->ngarbage--;
+            free(g);
+        } else {
+            gp = &g->next;
+        }
+    }
+}
+
+static struct rcu_table *rcu_table_alloc(unsigned int nbuckets)
+{
+    struct rcu_table *t;
+    t = calloc(1, sizeof(*t) + nbuckets * sizeof(struct rcu_node *));
+    if (t)
+        t->mask = nbuckets - 1;
+    return t;
+}
+
+static inline const void *rcu_key(const rcu_hash_t *h, const void *obj)
+{
+    return (const char *)obj + h->keyoff;
+}
+
+void *rcu_hash_find(rcu_hash_t *h, const void *key)
+{
+    struct rcu_reader *r = rcu_get_reader();
+    struct rcu_table *t;
+    struct rcu_node *n;
+    unsigned int hash;
+    void *obj = NULL;
+
+    hash = h->hashfunc(key, h->keylen);
+    rcu_read_enter(r);
+    t = __atomic_load_n(&h->tbl, __ATOMIC_ACQUIRE);
+    for (n = __atomic_load_n(&t->buckets[hash & t->mask], __ATOMIC_ACQUIRE); n;
+         n = __atomic_load_n(&n->next, __ATOMIC_ACQUIRE)) {
+        if (n->hash == hash &&
+            h->cmpfunc(rcu_key(h, n->obj), key, h->keylen) == 0) {
+            obj = n->obj;
+            break;
+        }
+    }
+    rcu_read_exit(r);
+    return obj;
+}
+
+/* Double the bucket array.  Readers may be walking the old chains, so the
+ * nodes are copied rather than relinked.  Called with h->lk held; on
+ * allocation failure the hash just stays at its current size. */
+static void rcu_hash_grow(rcu_hash_t *h)
+{
+    struct rcu_table *old = h->tbl, *t;
+    struct rcu_node *n, *c, **tails[2];
+    unsigned int i, nbuckets = (old->mask + 1) * 2;
+    int j;
+
+    if ((t = rcu_table_alloc(nbuckets)) == NULL)
+        return;
+    /* Bucket i splits into i and i + old size; keep chain order so that
+     * duplicate keys resolve to the same object as before. */
+    for (i = 0; i <= old->mask; i++) {
+        tails[0] = &t->buckets[i];
+        tails[1] = &t->buckets[i + old->mask + 1];
+        for (n = old->buckets[i]; n; n = n->next) {
+            if ((c = malloc(sizeof(*c))) == NULL)
+                goto nomem;
+            c->hash = n->hash;
+            c->obj = n->obj;
+            c->next = NULL;
+            j = (c->hash & t->mask) != i;
+            *tails[j] = c;
+            tails[j] = &c->next;
+        }
+    }
+    __atomic_store_n(&h->tbl, t, __ATOMIC_RELEASE);
+
+    /* Lookups may still be walking the old chains: leave them intact. */
+    for (i = 0; i <= old->mask; i++) {
+        for (n = old->buckets[i]; n; n = c) {
+            c = n->next;
+            rcu_retire(h, &n->gc);
+        }
+    }
+    rcu_retire(h, &old->gc);
+    return;
+
+nomem:
+    for (i = 0; i <= t->mask; i++) {
+        while ((n = t->buckets[i]) != NULL) {
+            t->buckets[i] = n->next;
+            free(n);
+        }
+    }
+    free(t);
+}
+
+/* Called with h->lk held. */
+static struct rcu_node *rcu_hash_find_locked(rcu_hash_t *h, const void *key,
+                                             unsigned int hash,
+                                             struct rcu_node ***prevp)
+{
+    struct rcu_node **np, *n;
+
+    for (np = &h->tbl->buckets[hash & h->tbl->mask]; (n = *np) != NULL;
+         np = &n->next) {
+        if (n->hash == hash &&
+            h->cmpfunc(rcu_key(h, n->obj), key, h->keylen) == 0) {
+            if (prevp)
+                *prevp = np;
+            return n;
+        }
+    }
+    return NULL;
+}
+
+/* Called with h->lk held. */
+static int rcu_hash_add_locked(rcu_hash_t *h, void *obj, unsigned int hash)
+{
+    struct rcu_node **bucket, *n;
+
+    if ((n = malloc(sizeof(*n))) == NULL)
+        return -1;
+    n->hash = hash;
+    n->obj = obj;
+    bucket = &h->tbl->buckets[hash & h->tbl->mask];
+    n->next = *bucket;
+    __atomic_store_n(bucket, n, __ATOMIC_RELEASE);
+
+    if (++h->nents > h->tbl->mask + 1)
+        rcu_hash_grow(h);
+    if (h->ngarbage >= RCU_HASH_RECLAIM_BATCH)
+        rcu_reclaim(h);
+    return 0;
+}
+
+int rcu_hash_add(rcu_hash_t *h, void *obj)
+{
+    unsigned int hash = h->hashfunc(rcu_key(h, obj), h->keylen);
+    int rc;
+
+    Pthread_mutex_lock(&h->lk);
+    rc = rcu_hash_add_locked(h, obj, hash);
+    Pthread_mutex_unlock(&h->lk);
+    return rc;
+}
+
+void *rcu_hash_add_unique(rcu_hash_t *h, void *obj)
+{
+    const void *key = rcu_key(h, obj);
+    unsigned int hash = h->hashfunc(key, h->keylen);
+    struct rcu_node *n;
+
+    Pthread_mutex_lock(&h->lk);
+    if ((n = rcu_hash_find_locked(h, key, hash, NULL)) != NULL)
+        obj = n->obj;
+    else if (rcu_hash_add_locked(h, obj, hash) != 0)
+        obj = NULL;
+    Pthread_mutex_unlock(&h->lk);
+    return obj;
+}
+
+int rcu_hash_del(rcu_hash_t *h, void *obj)
+{
+    const void *key = rcu_key(h, obj);
+    unsigned int hash = h->hashfunc(key, h->keylen);
+    struct rcu_node **np, *n;
+
+    Pthread_mutex_lock(&h->lk);
+    if ((n = rcu_hash_find_locked(h, key, hash, &np)) == NULL) {
+        Pthread_mutex_unlock(&h->lk);
+        return -1;
+    }
+    __atomic_store_n(np, n->next, __ATOMIC_RELEASE);
+    h->nents--;
+    rcu_retire(h, &n->gc);
+    if (h->ngarbage >= RCU_HASH_RECLAIM_BATCH)
+        rcu_reclaim(h);
+    Pthread_mutex_unlock(&h->lk);
+    return 0;
+}
+
+int rcu_hash_for(rcu_hash_t *h, hashforfunc_t *func, void *arg)
+{
+    struct rcu_node *n;
+    unsigned int i;
+    int rc = 0;
+
+    Pthread_mutex_lock(&h->lk);
+    for (i = 0; i <= h->tbl->mask && rc == 0; i++) {
+        for (n = h->tbl->buckets[i]; n && rc == 0; n = n->next)
+            rc = func(n->obj, arg);
+    }
+    Pthread_mutex_unlock(&h->lk);
+    return rc;
+}
+
+int rcu_hash_get_num_entries(rcu_hash_t *h)
+{
+    return __atomic_load_n(&h->nents, __ATOMIC_RELAXED);
+}
+
+void rcu_hash_free(rcu_hash_t *h)
+{
+    struct rcu_garbage *g;
+    struct rcu_node *n;
+    unsigned int i;
+
+    if (h == NULL)
+        return;
+    for (i = 0; i <= h->tbl->mask; i++) {
+        while ((n = h->tbl->buckets[i]) != NULL) {
+            h->tbl->buckets[i] = n->next;
+            free(n);
+        }
+    }
+    free(h->tbl);
+    while ((g = h->garbage) != NULL) {
+        h->garbage = g->next;
+        free(g);
+    }
+    Pthread_mutex_destroy(&h->lk);
+    free(h);
+}
+
+rcu_hash_t *rcu_hash_init_user(hashfunc_t *hashfunc, cmpfunc_t *cmpfunc,
+                               int keyoff, int keylen)
+{
+    rcu_hash_t *h;
+
+    if ((h = calloc(1, sizeof(*h))) == NULL)
+        return NULL;
+    if ((h->tbl = rcu_table_alloc(RCU_HASH_INITIAL_BUCKETS)) == NULL) {
+        free(h);
+        return NULL;
+    }
+    h->hashfunc = hashfunc;
+    h->cmpfunc = cmpfunc;
+    h->keyoff = keyoff;
+    h->keylen = keylen;
+    Pthread_mutex_init(&h->lk, NULL);
+    return h;
+}
+
+/* FNV-1a, folded so short strings still spread over the low bits. */
+static unsigned int rcu_hash_strptr(const void *key, int len)
+{
+    const unsigned char *s = *(const unsigned char **)key;
+    unsigned int hash = 2166136261u;
+    while (*s)
+        hash = (hash ^ *s++) * 16777619u;
+    return hash ^ (hash >> 16);
+}
+
+static int rcu_cmp_strptr(const void *a, const void *b, int len)
+{
+    return strcmp(*(const char **)a, *(const char **)b);
+}
+
+static unsigned int rcu_hash_strcaseptr(const void *key, int len)
+{
+    const unsigned char *s = *(const unsigned char **)key;
+    unsigned int hash = 2166136261u;
+    while (*s)
+        hash = (hash ^ tolower(*s++)) * 16777619u;
+    return hash ^ (hash >> 16);
+}
+
+static int rcu_cmp_strcaseptr(const void *a, const void *b, int len)
+{
+    return strcasecmp(*(const char **)a, *(const char **)b);
+}
+
+static unsigned int rcu_hash_i4(const void *key, int len)
+{
+    unsigned int v = *(const unsigned int *)key;
+    v ^= v >> 16;
+    v *= 0x45d9f3b;
+    return v ^ (v >> 16);
+}
+
+static int rcu_cmp_i4(const void *a, const void *b, int len)
+{
+    return *(const int *)a != *(const int *)b;
+}
+
+static unsigned int rcu_hash_fixed(const void *key, int len)
+{
+    return hash_default_fixedwidth((const unsigned char *)key, len);
+}
+
+static int rcu_cmp_fixed(const void *a, const void *b, int len)
+{
+    return memcmp(a, b, len);
+}
+
+rcu_hash_t *rcu_hash_init_o(int keyoff, int keylen)
+{
+    return rcu_hash_init_user(rcu_hash_fixed, rcu_cmp_fixed, keyoff, keylen);
+}
+
+rcu_hash_t *rcu_hash_init_strptr(int keyoff)
+{
+    return rcu_hash_init_user(rcu_hash_strptr, rcu_cmp_strptr, keyoff,
+                              sizeof(char *));
+}
+
+rcu_hash_t *rcu_hash_init_strcaseptr(int keyoff)
+{
+    return rcu_hash_init_user(rcu_hash_strcaseptr, rcu_cmp_strcaseptr, keyoff,
+                              sizeof(char *));
+}
+
+rcu_hash_t *rcu_hash_init_i4(int keyoff)
+{
+    return rcu_hash_init_user(rcu_hash_i4, rcu_cmp_i4, keyoff, sizeof(int));
+}
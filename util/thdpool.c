@@ -30,6 +30,7 @@
 #include <stdlib.h>
 #include <sys/time.h>
 #include <strings.h>
+#include <sched.h>
 #include "ctrace.h"
 #include <epochlib.h>
 #include <segstr.h>
@@ -59,6 +60,43 @@ extern int gbl_disable_exit_on_thread_error;
 extern comdb2bma blobmem;
 
 
+/*
+ * Scalable mode: instead of one mutex protected queue, every worker owns an
+ * intrusive lock-free MPSC mailbox (Vyukov).  Producers push without locks;
+ * a mailbox is drained by whoever holds its consumer flag, which is normally
+ * its owner, or an idle worker stealing from it.  Idle workers spin for an
+ * adaptive number of rounds before going to sleep on their own condition.
+ */
+struct sq_item {
+    struct sq_item *next;
+    struct workitem work;
+};
+
+struct sq_mbox {
+    struct sq_item *head; /* producers push here */
+    struct sq_item *tail; /* owned by the holder of consumer */
+    struct sq_item stub;
+    int consumer;
+    int nitems;
+};
+
+/* sq_workers arrays replaced by bigger ones; lock-free readers may still be
+ * looking at them, so they are kept until the pool is destroyed */
+struct sq_retired {
+    struct sq_retired *next;
+    struct thd **workers;
+};
+
+enum { SQ_SPIN_MIN = 256, SQ_SPIN_INIT = 1024, SQ_SPIN_MAX = 16384 };
+
+#if defined(__x86_64__) || defined(__i386__)
+#define sq_pause() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define sq_pause() __asm__ __volatile__("yield")
+#else
+#define sq_pause() sched_yield()
+#endif
+
 struct thd {
     pthread_t tid;
     arch_tid archtid;
@@ -79,6 +117,28 @@ struct thd {
 
     LINKC_T(struct thd) thdlist_linkv;
     LINKC_T(struct thd) freelist_linkv;
+
+    /* scalable mode */
+    struct sq_mbox mbox;
+    pthread_mutex_t sleep_mtx;
+    unsigned idx;
+    int sleeping;
+    int busy;
+    int exited;
+    int spin;
+};
+
+enum { THDPOOL_SCHED_NFLOWS = 256 };
+
+/* Queued work is on pool->queue in arrival order, and on one FIFO: the
+ * front FIFO for THDPOOL_ENQUEUE_FRONT work, the plain FIFO for work without
+ * a schedule, or the FIFO of its flow bucket and class.  Tags only grow
+ * along a FIFO, so each class keeps a min-heap of its non-empty flow FIFOs
+ * keyed by their heads, and the next item is found in O(log flows). */
+struct thdpool_fifo {
+    LISTC_T(struct workitem) items;
+    int heapidx; /* position in the heap of its class, -1 if none */
+    int cls;
 };
 
 struct thdpool {
@@ -157,8 +217,67 @@ struct thdpool {
     comdb2ma stack_alloc;
 #endif
     void (*queued_callback)(void*);
+
+    /* scalable mode, requested by the tunable and latched at first enqueue */
+    int scalable;
+    int sq_latched;
+    int sq_on;
+    struct thd **sq_workers;
+    struct sq_retired *sq_retired;
+    unsigned sq_nworkers;
+    unsigned sq_capacity; /* size of sq_workers */
+    unsigned sq_defmax;   /* worker limit if neither maxt nor mint is set */
+    unsigned sq_nlive;
+    unsigned sq_rr;
+    unsigned sq_nsleeping;
+    unsigned sq_nqueued;
+    int sq_spin; /* initial spin count, 0 on a uniprocessor */
+    struct sq_mbox sq_front; /* THDPOOL_ENQUEUE_FRONT work */
+    unsigned num_steals;
+    unsigned num_spin_hits;
+    unsigned num_sleeps;
+
+    /* fair queuing: virtual time, last finish tag of each flow bucket, and
+     * running items per class */
+    double sched_vtime;
+    double sched_finish[THDPOOL_SCHED_NFLOWS];
+    unsigned sched_running[THDPOOL_SCHED_NCLASS];
+    unsigned num_sched_deferred;
+    uint64_t sched_seq;
+    struct thdpool_fifo sched_front;
+    struct thdpool_fifo sched_plain;
+    /* NCLASS x NFLOWS, allocated by the first scheduled enqueue */
+    struct thdpool_fifo *sched_flows;
+    struct thdpool_fifo **sched_heap;
+    unsigned sched_nheap[THDPOOL_SCHED_NCLASS];
 };
 
+static void sq_latch(struct thdpool *pool);
+static void sq_destroy(struct thdpool *pool);
+static void sq_wake(struct thd *thd);
+static void sq_wake_sleeper(struct thdpool *pool);
+static int sq_enqueue(struct thdpool *pool, thdpool_work_fn work_fn,
+                      void *work, int queue_override,
+                      struct string_ref *ref_persistent_info, uint32_t flags);
+
+/* Worker limit in scalable mode; maxt and mint may change after the latch.
+ * Like the locked mode, workers parked by thdpool_add_waitthd don't count. */
+static inline unsigned sq_limit(struct thdpool *pool)
+{
+    unsigned max = pool->maxnthd;
+    if (max == 0)
+        max = pool->minnthd;
+    if (max == 0)
+        max = pool->sq_defmax;
+    return max + pool->nwaitthd;
+}
+
+/* For readers not holding pool->mutex; see struct sq_retired */
+static inline struct thd *sq_worker(struct thdpool *pool, unsigned ii)
+{
+    return __atomic_load_n(&pool->sq_workers, __ATOMIC_ACQUIRE)[ii];
+}
+
 pthread_mutex_t pool_list_lk = PTHREAD_MUTEX_INITIALIZER;
 LISTC_T(struct thdpool) threadpools;
 pthread_once_t init_pool_list_once = PTHREAD_ONCE_INIT;
@@ -213,6 +332,11 @@ static void register_thdpool_tunables(char *name, struct thdpool *pool)
     REGISTER_THDPOOL_TUNABLE(name, dump_on_full, "Dump status on full queue.",
                              TUNABLE_BOOLEAN, &pool->dump_on_full, NOARG, NULL,
                              NULL, NULL, NULL);
+    REGISTER_THDPOOL_TUNABLE(
+        name, scalable,
+        "Use per-thread lock-free queues with work stealing. Must be set "
+        "before the pool is first used.",
+        TUNABLE_BOOLEAN, &pool->scalable, NOARG, NULL, NULL, NULL, NULL);
     return;
 }
 
@@ -251,6 +375,10 @@ struct thdpool *thdpool_create(const char *name, size_t per_thread_data_sz)
     listc_init(&pool->thdlist, offsetof(struct thd, thdlist_linkv));
     listc_init(&pool->freelist, offsetof(struct thd, freelist_linkv));
     listc_init(&pool->queue, offsetof(struct workitem, linkv));
+    listc_init(&pool->sched_front.items, offsetof(struct workitem, fifov));
+    pool->sched_front.heapidx = -1;
+    listc_init(&pool->sched_plain.items, offsetof(struct workitem, fifov));
+    pool->sched_plain.heapidx = -1;
 
     Pthread_mutex_init(&pool->mutex, NULL);
     Pthread_attr_init(&pool->attrs);
@@ -326,6 +454,11 @@ int thdpool_destroy(struct thdpool **pool_p, int coopWaitUs)
       free(iter);
     }
 
+    if (pool->sq_on)
+        sq_destroy(pool);
+
+    free(pool->sched_flows);
+    free(pool->sched_heap);
     free(pool->busy_hist);
     pool_free(pool->pool);
     free(pool->name);
@@ -333,6 +466,27 @@ int thdpool_destroy(struct thdpool **pool_p, int coopWaitUs)
     return 0;
 }
 
+/* Visit the work in a mailbox.  Holding its consumer flag keeps items from
+ * being popped and freed under us; an item whose push is still in progress
+ * is not linked yet and is skipped. */
+static void sq_mbox_foreach(struct thdpool *pool, struct sq_mbox *q,
+                            thdpool_foreach_fn foreach_fn, void *user)
+{
+    struct sq_item *item;
+    int unlocked = 0;
+
+    while (!CAS32(q->consumer, unlocked, 1)) {
+        unlocked = 0;
+        sq_pause();
+    }
+    for (item = q->tail; item;
+         item = __atomic_load_n(&item->next, __ATOMIC_ACQUIRE)) {
+        if (item != &q->stub)
+            (foreach_fn)(pool, &item->work, user);
+    }
+    XCHANGE32(q->consumer, 0);
+}
+
 void thdpool_foreach(struct thdpool *pool, thdpool_foreach_fn foreach_fn,
                      void *user)
 {
@@ -343,8 +497,19 @@ void thdpool_foreach(struct thdpool *pool, thdpool_foreach_fn foreach_fn,
         {
             (foreach_fn)(pool, item, user);
         }
+        if (pool->sq_on) {
+            unsigned ii;
+            sq_mbox_foreach(pool, &pool->sq_front, foreach_fn, user);
+            for (ii = 0; ii < pool->sq_nworkers; ii++)
+                sq_mbox_foreach(pool, &pool->sq_workers[ii]->mbox, foreach_fn,
+                                user);
+        }
     }
     UNLOCK(&pool->mutex);
+
+    /* workers that found a mailbox busy may have gone to sleep */
+    if (pool->sq_on && ATOMIC_LOAD32(pool->sq_nqueued) > 0)
+        sq_wake_sleeper(pool);
 }
 
 void thdpool_unset_exit(struct thdpool *pool) { pool->exit_on_create_fail = 0; }
@@ -422,6 +587,11 @@ void thdpool_set_dump_on_full(struct thdpool *pool, int onoff)
     pool->dump_on_full = onoff;
 }
 
+void thdpool_set_scalable(struct thdpool *pool, int onoff)
+{
+    pool->scalable = onoff;
+}
+
 void thdpool_print_stats(FILE *fh, struct thdpool *pool)
 {
     LOCK(&pool->mutex)
@@ -452,7 +622,7 @@ void thdpool_print_stats(FILE *fh, struct thdpool *pool)
         logmsgf(LOGMSG_USER, fh, "  Work queue peak size      : %u\n", pool->peakqueue);
         logmsgf(LOGMSG_USER, fh, "  Work queue maximum size   : %u\n", pool->maxqueue);
         logmsgf(LOGMSG_USER, fh, "  Work queue current size   : %u\n",
-                listc_size(&pool->queue));
+                thdpool_get_queue_depth(pool));
         logmsgf(LOGMSG_USER, fh, "  Long wait alarm threshold : %u ms\n", pool->longwaitms);
         logmsgf(LOGMSG_USER, fh, "  Thread linger time        : %u seconds\n",
                 pool->lingersecs);
@@ -466,6 +636,27 @@ void thdpool_print_stats(FILE *fh, struct thdpool *pool)
                 pool->exit_on_create_fail ? "yes" : "no");
         logmsgf(LOGMSG_USER, fh, "  Dump on queue full        : %s\n",
                 pool->dump_on_full ? "yes" : "no");
+        logmsgf(LOGMSG_USER, fh, "  Scalable mode             : %s\n",
+                pool->sq_on ? "yes"
+                            : (pool->scalable && !pool->sq_latched ? "pending"
+                                                                   : "no"));
+        if (pool->sq_on) {
+            logmsgf(LOGMSG_USER, fh, "  Scalable worker threads   : %u/%u\n",
+                    ATOMIC_LOAD32(pool->sq_nlive), sq_limit(pool));
+            logmsgf(LOGMSG_USER, fh, "  Num work items stolen     : %u\n",
+                    ATOMIC_LOAD32(pool->num_steals));
+            logmsgf(LOGMSG_USER, fh, "  Num work found spinning   : %u\n",
+                    ATOMIC_LOAD32(pool->num_spin_hits));
+            logmsgf(LOGMSG_USER, fh, "  Num worker sleeps         : %u\n",
+                    ATOMIC_LOAD32(pool->num_sleeps));
+        }
+        if (pool->num_sched_deferred || pool->sched_vtime > 0) {
+            logmsgf(LOGMSG_USER, fh, "  Scheduled running/class   : %u %u %u %u\n",
+                    pool->sched_running[0], pool->sched_running[1],
+                    pool->sched_running[2], pool->sched_running[3]);
+            logmsgf(LOGMSG_USER, fh, "  Num deferred at class max : %u\n",
+                    pool->num_sched_deferred);
+        }
         for (ii = 0; ii < pool->busy_hist_len; ii++) {
             if ((ii & 3) == 0) {
                 logmsgf(LOGMSG_USER, fh, "  Busy threads histogram    : ");
@@ -617,9 +808,15 @@ void thdpool_stop(struct thdpool *pool)
     {
         struct thd *thd;
         pool->stopped = 1;
-        LISTC_FOR_EACH(&pool->thdlist, thd, thdlist_linkv)
-        {
-            Pthread_cond_signal(&thd->cond);
+        if (pool->sq_on) {
+            unsigned ii;
+            for (ii = 0; ii < pool->sq_nworkers; ii++)
+                sq_wake(pool->sq_workers[ii]);
+        } else {
+            LISTC_FOR_EACH(&pool->thdlist, thd, thdlist_linkv)
+            {
+                Pthread_cond_signal(&thd->cond);
+            }
         }
     }
     UNLOCK(&pool->mutex);
@@ -631,6 +828,192 @@ void thdpool_resume(struct thdpool *pool)
     UNLOCK(&pool->mutex);
 }
 
+/* Can this work item start now, given its class limit? */
+static inline int sched_runnable(struct thdpool *pool,
+                                 const struct workitem *item)
+{
+    return !item->sched || item->maxrun == 0 ||
+           pool->sched_running[item->cls] < item->maxrun;
+}
+
+static inline void sched_start(struct thdpool *pool, struct workitem *item)
+{
+    if (item->sched) {
+        pool->sched_running[item->cls]++;
+        if (item->tag > pool->sched_vtime)
+            pool->sched_vtime = item->tag;
+    }
+}
+
+static int sched_alloc(struct thdpool *pool)
+{
+    int cls, flow;
+
+    pool->sched_flows = calloc(THDPOOL_SCHED_NCLASS * THDPOOL_SCHED_NFLOWS,
+                               sizeof(struct thdpool_fifo));
+    pool->sched_heap = calloc(THDPOOL_SCHED_NCLASS * THDPOOL_SCHED_NFLOWS,
+                              sizeof(struct thdpool_fifo *));
+    if (!pool->sched_flows || !pool->sched_heap) {
+        free(pool->sched_flows);
+        free(pool->sched_heap);
+        pool->sched_flows = NULL;
+        pool->sched_heap = NULL;
+        return -1;
+    }
+    for (cls = 0; cls < THDPOOL_SCHED_NCLASS; cls++) {
+        for (flow = 0; flow < THDPOOL_SCHED_NFLOWS; flow++) {
+            struct thdpool_fifo *fifo =
+                &pool->sched_flows[cls * THDPOOL_SCHED_NFLOWS + flow];
+            listc_init(&fifo->items, offsetof(struct workitem, fifov));
+            fifo->heapidx = -1;
+            fifo->cls = cls;
+        }
+    }
+    return 0;
+}
+
+static inline int sched_before(const struct workitem *a,
+                               const struct workitem *b)
+{
+    return a->tag < b->tag || (a->tag == b->tag && a->seq < b->seq);
+}
+
+static inline int sched_fifo_before(const struct thdpool_fifo *a,
+                                    const struct thdpool_fifo *b)
+{
+    return sched_before(LISTC_TOP(&a->items), LISTC_TOP(&b->items));
+}
+
+static inline void sched_heap_set(struct thdpool_fifo **heap, unsigned ii,
+                                  struct thdpool_fifo *fifo)
+{
+    heap[ii] = fifo;
+    fifo->heapidx = ii;
+}
+
+static void sched_sift_up(struct thdpool *pool, struct thdpool_fifo *fifo)
+{
+    struct thdpool_fifo **heap =
+        pool->sched_heap + fifo->cls * THDPOOL_SCHED_NFLOWS;
+    unsigned ii = fifo->heapidx;
+
+    while (ii > 0) {
+        unsigned parent = (ii - 1) / 2;
+        if (!sched_fifo_before(fifo, heap[parent]))
+            break;
+        sched_heap_set(heap, ii, heap[parent]);
+        ii = parent;
+    }
+    sched_heap_set(heap, ii, fifo);
+}
+
+static void sched_sift_down(struct thdpool *pool, struct thdpool_fifo *fifo)
+{
+    struct thdpool_fifo **heap =
+        pool->sched_heap + fifo->cls * THDPOOL_SCHED_NFLOWS;
+    unsigned n = pool->sched_nheap[fifo->cls];
+    unsigned ii = fifo->heapidx;
+
+    while (2 * ii + 1 < n) {
+        unsigned child = 2 * ii + 1;
+        if (child + 1 < n && sched_fifo_before(heap[child + 1], heap[child]))
+            child++;
+        if (!sched_fifo_before(heap[child], fifo))
+            break;
+        sched_heap_set(heap, ii, heap[child]);
+        ii = child;
+    }
+    sched_heap_set(heap, ii, fifo);
+}
+
+static void sched_heap_remove(struct thdpool *pool, struct thdpool_fifo *fifo)
+{
+    struct thdpool_fifo **heap =
+        pool->sched_heap + fifo->cls * THDPOOL_SCHED_NFLOWS;
+    struct thdpool_fifo *last = heap[--pool->sched_nheap[fifo->cls]];
+    unsigned ii = fifo->heapidx;
+
+    fifo->heapidx = -1;
+    if (last == fifo)
+        return;
+    sched_heap_set(heap, ii, last);
+    sched_sift_up(pool, last);
+    sched_sift_down(pool, last);
+}
+
+/* Queue an item behind the others of its flow bucket and class.  Equal
+ * tags go by arrival, so a pool that never sees scheduled work keeps its
+ * plain FIFO queue. */
+static void sched_queue(struct thdpool *pool, struct workitem *item,
+                        unsigned flow, int enqueue_front)
+{
+    struct thdpool_fifo *fifo;
+
+    item->seq = pool->sched_seq++;
+    listc_abl(&pool->queue, item);
+    if (enqueue_front) {
+        fifo = &pool->sched_front;
+        listc_atl(&fifo->items, item);
+    } else if (!item->sched) {
+        fifo = &pool->sched_plain;
+        listc_abl(&fifo->items, item);
+    } else {
+        fifo = &pool->sched_flows[item->cls * THDPOOL_SCHED_NFLOWS + flow];
+        listc_abl(&fifo->items, item);
+        if (fifo->heapidx < 0) {
+            fifo->heapidx = pool->sched_nheap[fifo->cls]++;
+            sched_sift_up(pool, fifo);
+        }
+    }
+    item->fifo = fifo;
+}
+
+static void sched_unqueue(struct thdpool *pool, struct workitem *item)
+{
+    struct thdpool_fifo *fifo = item->fifo;
+    int head = (LISTC_TOP(&fifo->items) == item);
+
+    listc_rfl(&pool->queue, item);
+    listc_rfl(&fifo->items, item);
+    item->fifo = NULL;
+    if (fifo->heapidx < 0 || !head)
+        return;
+    /* the new head has a later tag */
+    if (listc_size(&fifo->items) == 0)
+        sched_heap_remove(pool, fifo);
+    else
+        sched_sift_down(pool, fifo);
+}
+
+/* The queued item to run next: front work first, then the earliest tag
+ * among plain work and the heads of the classes below their limits. */
+static struct workitem *sched_next(struct thdpool *pool)
+{
+    struct workitem *item, *best;
+    int cls;
+
+    LISTC_FOR_EACH(&pool->sched_front.items, item, fifov)
+    {
+        if (sched_runnable(pool, item))
+            return item;
+    }
+    best = LISTC_TOP(&pool->sched_plain.items);
+    if (pool->sched_heap == NULL)
+        return best;
+    for (cls = 0; cls < THDPOOL_SCHED_NCLASS; cls++) {
+        if (pool->sched_nheap[cls] == 0)
+            continue;
+        item = LISTC_TOP(
+            &pool->sched_heap[cls * THDPOOL_SCHED_NFLOWS]->items);
+        /* leave the class for a thread finishing work of the same class */
+        if (!sched_runnable(pool, item))
+            continue;
+        if (best == NULL || sched_before(item, best))
+            best = item;
+    }
+    return best;
+}
+
 /* Get the next item of work for this thread to do.  Returns 0 if there
  * is no work. */
 static int get_work_ll(struct thd *thd, struct workitem *work)
@@ -642,7 +1025,9 @@ static int get_work_ll(struct thd *thd, struct workitem *work)
     } else {
         struct thdpool *pool = thd->pool;
         struct workitem *next;
-        while ((next = listc_rtl(&pool->queue)) != NULL) {
+        /* the queue is in arrival order, so expired work is at its head */
+        while (pool->maxqueueagems > 0 &&
+               (next = LISTC_TOP(&pool->queue)) != NULL) {
             int force_timeout = 0;
             if ((thd->pool->maxqueueagems > 0) &&
                 gbl_random_thdpool_work_timeout &&
@@ -652,28 +1037,32 @@ static int get_work_ll(struct thd *thd, struct workitem *work)
                        "%s: forcing a random work item timeout\n",
                        __func__);
             }
-            if (force_timeout || (thd->pool->maxqueueagems > 0 &&
-                comdb2_time_epochms() - next->queue_time_ms >
-                    pool->maxqueueagems)) {
-                if (pool->dque_fn)
-                    pool->dque_fn(thd->pool, next, 1);
-                if (next->ref_persistent_info) {
-                    put_ref(&next->ref_persistent_info);
-                }
-                next->work_fn(pool, next->work, NULL, THD_FREE);
-                pool_relablk(pool->pool, next);
-                thd->pool->num_timeout++;
-                continue;
-            }
-
+            if (!force_timeout &&
+                comdb2_time_epochms() - next->queue_time_ms <=
+                    pool->maxqueueagems)
+                break;
+            sched_unqueue(pool, next);
             if (pool->dque_fn)
-                pool->dque_fn(pool, next, 0);
-            memcpy(work, next, sizeof(*work));
+                pool->dque_fn(thd->pool, next, 1);
+            if (next->ref_persistent_info) {
+                put_ref(&next->ref_persistent_info);
+            }
+            next->work_fn(pool, next->work, NULL, THD_FREE);
             pool_relablk(pool->pool, next);
-            pool->num_dequeued++;
-            return 1;
+            thd->pool->num_timeout++;
         }
-        return 0;
+
+        next = sched_next(pool);
+        if (next == NULL)
+            return 0;
+        sched_unqueue(pool, next);
+        if (pool->dque_fn)
+            pool->dque_fn(pool, next, 0);
+        memcpy(work, next, sizeof(*work));
+        pool_relablk(pool->pool, next);
+        sched_start(pool, work);
+        pool->num_dequeued++;
+        return 1;
     }
 }
 
@@ -827,6 +1216,16 @@ static void *thdpool_thd(void *voidarg)
             if (work.ref_persistent_info) {
                 put_ref(&work.ref_persistent_info);
             }
+            if (work.sched) {
+                pool->sched_running[work.cls]--;
+                /* we may exit below; hand deferred work to a free thread */
+                struct thd *free_thd;
+                if (listc_size(&pool->queue) > 0 &&
+                    (free_thd = listc_rtl(&pool->freelist)) != NULL) {
+                    free_thd->on_freelist = 0;
+                    Pthread_cond_signal(&free_thd->cond);
+                }
+            }
         }
         UNLOCK(&pool->mutex);
 
@@ -879,9 +1278,682 @@ thread_exit:
     return NULL;
 }
 
-int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
-                    int queue_override, struct string_ref *ref_persistent_info,
-                    uint32_t flags)
+static void sq_mbox_init(struct sq_mbox *q)
+{
+    q->stub.next = NULL;
+    q->head = q->tail = &q->stub;
+    q->consumer = 0;
+    q->nitems = 0;
+}
+
+static void sq_mbox_link(struct sq_mbox *q, struct sq_item *item)
+{
+    struct sq_item *prev;
+
+    item->next = NULL;
+    prev = __atomic_exchange_n(&q->head, item, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&prev->next, item, __ATOMIC_RELEASE);
+}
+
+static void sq_mbox_push(struct sq_mbox *q, struct sq_item *item)
+{
+    ATOMIC_ADD32(q->nitems, 1);
+    sq_mbox_link(q, item);
+}
+
+/* Caller holds q->consumer.  Returns NULL if empty, or if a producer is in
+ * the middle of a push (it will be visible shortly). */
+static struct sq_item *sq_mbox_pop(struct sq_mbox *q)
+{
+    struct sq_item *tail = q->tail;
+    struct sq_item *next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+
+    if (tail == &q->stub) {
+        if (next == NULL)
+            return NULL;
+        q->tail = tail = next;
+        next = __atomic_load_n(&next->next, __ATOMIC_ACQUIRE);
+    }
+    if (next == NULL) {
+        if (tail != __atomic_load_n(&q->head, __ATOMIC_ACQUIRE))
+            return NULL;
+        sq_mbox_link(q, &q->stub);
+        next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+        if (next == NULL)
+            return NULL;
+    }
+    q->tail = next;
+    ATOMIC_ADD32(q->nitems, -1);
+    return tail;
+}
+
+static struct sq_item *sq_mbox_trypop(struct sq_mbox *q)
+{
+    struct sq_item *item;
+    int unlocked = 0;
+
+    if (ATOMIC_LOAD32(q->nitems) == 0)
+        return NULL;
+    if (!CAS32(q->consumer, unlocked, 1))
+        return NULL;
+    item = sq_mbox_pop(q);
+    XCHANGE32(q->consumer, 0);
+    return item;
+}
+
+static void sq_wake(struct thd *thd)
+{
+    /* plain load first so the common case does not bounce the cache line */
+    if (ATOMIC_LOAD32(thd->sleeping) && XCHANGE32(thd->sleeping, 0)) {
+        Pthread_mutex_lock(&thd->sleep_mtx);
+        Pthread_cond_signal(&thd->cond);
+        Pthread_mutex_unlock(&thd->sleep_mtx);
+    }
+}
+
+/* Decide the mode of the pool the first time it is used */
+static void sq_latch(struct thdpool *pool)
+{
+    LOCK(&pool->mutex)
+    {
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        if (!pool->sq_latched && pool->scalable && ncpu <= 1) {
+            /* nothing runs in parallel, the locked queue is cheaper */
+            logmsg(LOGMSG_INFO, "%s(%s): single cpu, scalable mode not "
+                   "used\n", __func__, pool->name);
+        } else if (!pool->sq_latched && pool->scalable) {
+            unsigned max;
+            pool->sq_defmax = ncpu;
+            pool->sq_spin = ncpu > 1 ? SQ_SPIN_INIT : 0;
+            max = sq_limit(pool);
+            pool->sq_workers = calloc(max, sizeof(struct thd *));
+            if (pool->sq_workers) {
+                pool->sq_capacity = max;
+                sq_mbox_init(&pool->sq_front);
+                pool->sq_on = 1;
+            } else {
+                logmsg(LOGMSG_ERROR, "%s(%s): out of memory, scalable mode "
+                       "disabled\n", __func__, pool->name);
+            }
+        }
+        XCHANGE32(pool->sq_latched, 1);
+    }
+    UNLOCK(&pool->mutex);
+}
+
+/* Release work that was never run, like an expired item in sq_dequeue */
+static void sq_mbox_free(struct thdpool *pool, struct sq_mbox *q)
+{
+    struct sq_item *item;
+
+    while ((item = sq_mbox_pop(q)) != NULL) {
+        if (item->work.ref_persistent_info)
+            put_ref(&item->work.ref_persistent_info);
+        item->work.work_fn(pool, item->work.work, NULL, THD_FREE);
+        free(item);
+    }
+}
+
+static void sq_destroy(struct thdpool *pool)
+{
+    struct sq_retired *old;
+    unsigned ii;
+
+    sq_mbox_free(pool, &pool->sq_front);
+    for (ii = 0; ii < pool->sq_nworkers; ii++) {
+        struct thd *thd = pool->sq_workers[ii];
+        sq_mbox_free(pool, &thd->mbox);
+        Pthread_cond_destroy(&thd->cond);
+        Pthread_mutex_destroy(&thd->sleep_mtx);
+        free(thd);
+    }
+    free(pool->sq_workers);
+    while ((old = pool->sq_retired) != NULL) {
+        pool->sq_retired = old->next;
+        free(old->workers);
+        free(old);
+    }
+}
+
+/* Make room for more workers after maxt was raised.  Caller holds
+ * pool->mutex. */
+static int sq_grow(struct thdpool *pool)
+{
+    unsigned cap = pool->sq_capacity * 2;
+    struct thd **workers;
+    struct sq_retired *old;
+
+    if (cap < sq_limit(pool))
+        cap = sq_limit(pool);
+    workers = calloc(cap, sizeof(struct thd *));
+    old = malloc(sizeof(struct sq_retired));
+    if (!workers || !old) {
+        free(workers);
+        free(old);
+        logmsg(LOGMSG_ERROR, "%s(%s): out of memory\n", __func__, pool->name);
+        return -1;
+    }
+    memcpy(workers, pool->sq_workers, pool->sq_nworkers * sizeof(struct thd *));
+    old->workers = pool->sq_workers;
+    old->next = pool->sq_retired;
+    pool->sq_retired = old;
+    __atomic_store_n(&pool->sq_workers, workers, __ATOMIC_RELEASE);
+    pool->sq_capacity = cap;
+    return 0;
+}
+
+/* Front queue first, then our own mailbox, then steal from the others */
+static struct sq_item *sq_get_work(struct thdpool *pool, struct thd *thd)
+{
+    struct sq_item *item;
+    unsigned ii, n;
+
+    if ((item = sq_mbox_trypop(&pool->sq_front)) != NULL)
+        return item;
+    if ((item = sq_mbox_trypop(&thd->mbox)) != NULL)
+        return item;
+
+    n = ATOMIC_LOAD32(pool->sq_nworkers);
+    for (ii = 1; ii < n; ii++) {
+        struct thd *victim = sq_worker(pool, (thd->idx + ii) % n);
+        if ((item = sq_mbox_trypop(&victim->mbox)) != NULL) {
+            ATOMIC_ADD32(pool->num_steals, 1);
+            return item;
+        }
+    }
+    return NULL;
+}
+
+static int sq_dequeue(struct thdpool *pool, struct thd *thd,
+                      struct workitem *work)
+{
+    struct sq_item *item;
+
+    while ((item = sq_get_work(pool, thd)) != NULL) {
+        int force_timeout = 0;
+
+        ATOMIC_ADD32(pool->sq_nqueued, -1);
+        if ((pool->maxqueueagems > 0) && gbl_random_thdpool_work_timeout &&
+            !(rand() % gbl_random_thdpool_work_timeout)) {
+            force_timeout = 1;
+            logmsg(LOGMSG_WARN, "%s: forcing a random work item timeout\n",
+                   __func__);
+        }
+        if (force_timeout ||
+            (pool->maxqueueagems > 0 &&
+             comdb2_time_epochms() - item->work.queue_time_ms >
+                 pool->maxqueueagems)) {
+            if (pool->dque_fn)
+                pool->dque_fn(pool, &item->work, 1);
+            if (item->work.ref_persistent_info)
+                put_ref(&item->work.ref_persistent_info);
+            item->work.work_fn(pool, item->work.work, NULL, THD_FREE);
+            free(item);
+            ATOMIC_ADD32(pool->num_timeout, 1);
+            continue;
+        }
+
+        if (pool->dque_fn)
+            pool->dque_fn(pool, &item->work, 0);
+        memcpy(work, &item->work, sizeof(*work));
+        free(item);
+        ATOMIC_ADD32(pool->num_dequeued, 1);
+        return 1;
+    }
+    return 0;
+}
+
+/* An idle worker goes away once it lingered long enough above mint, or at
+ * once if maxt was lowered under the number of live workers.  sq_retire
+ * checks again under pool->mutex, so concurrent retirements see each other. */
+static int sq_should_retire(struct thdpool *pool, int idle_since_ms)
+{
+    unsigned nlive = ATOMIC_LOAD32(pool->sq_nlive);
+
+    if (nlive > sq_limit(pool))
+        return 1;
+    return nlive > pool->minnthd &&
+           comdb2_time_epochms() - idle_since_ms >= pool->lingersecs * 1000;
+}
+
+/* Take a worker out of service, unconditionally if force is set.  Producers
+ * bump nitems before they check "exited" again after a push, we set
+ * "exited" before checking nitems, so work pushed to a worker as it retires
+ * is either seen here or makes the producer start another worker.  Returns
+ * 1 if retired. */
+static int sq_retire(struct thdpool *pool, struct thd *thd, int force,
+                     int idle_since_ms)
+{
+    int retired = 0;
+
+    LOCK(&pool->mutex)
+    {
+        if (force || sq_should_retire(pool, idle_since_ms)) {
+            XCHANGE32(thd->exited, 1);
+            if (!force && ATOMIC_LOAD32(thd->mbox.nitems) > 0) {
+                XCHANGE32(thd->exited, 0);
+            } else {
+                listc_rfl(&pool->thdlist, thd);
+                pool->num_exits++;
+                ATOMIC_ADD32(pool->sq_nlive, -1);
+                retired = 1;
+            }
+        }
+    }
+    UNLOCK(&pool->mutex);
+    return retired;
+}
+
+/* Get work, spinning for a while and then sleeping if there is none.
+ * Returns 0 if the pool is stopped and there is no work left, -1 if the
+ * worker was retired. */
+static int sq_wait_work(struct thdpool *pool, struct thd *thd,
+                        struct workitem *work)
+{
+    int ii, idle_since_ms;
+
+    if (sq_dequeue(pool, thd, work))
+        return 1;
+
+    /* Spin longer when spinning paid off last time, shorter otherwise */
+    for (ii = 0; ii < thd->spin; ii++) {
+        sq_pause();
+        if (sq_dequeue(pool, thd, work)) {
+            ATOMIC_ADD32(pool->num_spin_hits, 1);
+            if (thd->spin < SQ_SPIN_MAX)
+                thd->spin *= 2;
+            return 1;
+        }
+    }
+    if (thd->spin > SQ_SPIN_MIN)
+        thd->spin /= 2;
+
+    idle_since_ms = comdb2_time_epochms();
+    while (1) {
+        int found;
+        struct timespec ts;
+
+        /* Producers push before checking "sleeping", we set it before
+         * checking for work, so one of us sees the other */
+        XCHANGE32(thd->sleeping, 1);
+        ATOMIC_ADD32(pool->sq_nsleeping, 1);
+        if (sq_dequeue(pool, thd, work) || ATOMIC_LOAD32(pool->stopped)) {
+            XCHANGE32(thd->sleeping, 0);
+            ATOMIC_ADD32(pool->sq_nsleeping, -1);
+            return !ATOMIC_LOAD32(pool->stopped) || work->work_fn != NULL;
+        }
+        if (sq_should_retire(pool, idle_since_ms) &&
+            sq_retire(pool, thd, 0, idle_since_ms)) {
+            XCHANGE32(thd->sleeping, 0);
+            ATOMIC_ADD32(pool->sq_nsleeping, -1);
+            return -1;
+        }
+
+        ATOMIC_ADD32(pool->num_sleeps, 1);
+        Pthread_mutex_lock(&thd->sleep_mtx);
+        while (ATOMIC_LOAD32(thd->sleeping) && !ATOMIC_LOAD32(pool->stopped)) {
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_sec += 1;
+            if (pthread_cond_timedwait(&thd->cond, &thd->sleep_mtx, &ts) ==
+                ETIMEDOUT)
+                break;
+        }
+        Pthread_mutex_unlock(&thd->sleep_mtx);
+        XCHANGE32(thd->sleeping, 0);
+        ATOMIC_ADD32(pool->sq_nsleeping, -1);
+
+        found = sq_dequeue(pool, thd, work);
+        if (found || ATOMIC_LOAD32(pool->stopped))
+            return found;
+    }
+}
+
+static void *thdpool_sq_thd(void *voidarg)
+{
+    struct thd *thd = voidarg;
+    struct thdpool *pool = thd->pool;
+    void *thddata = NULL;
+    struct workitem work;
+    int rc;
+
+    comdb2_name_thread(pool->name);
+
+    ATOMIC_ADD32(pool->nactthd, 1);
+
+    thread_started("thdpool");
+
+    ENABLE_PER_THREAD_MALLOC(pool->name);
+    thd->archtid = getarchtid();
+
+    if (pool->per_thread_data_sz > 0) {
+        thddata = alloca(pool->per_thread_data_sz);
+        assert(thddata != NULL);
+        memset(thddata, 0, pool->per_thread_data_sz);
+    }
+
+    if (pool->init_fn)
+        pool->init_fn(pool, thddata);
+    thread_memcreate(pool->mem_sz);
+
+    while (1) {
+        int diffms;
+
+        thd->persistent_info = "looking for work...";
+        memset(&work, 0, sizeof(work));
+        if ((rc = sq_wait_work(pool, thd, &work)) <= 0)
+            break;
+
+        if (work.ref_persistent_info)
+            thd->persistent_info = string_ref_cstr(work.ref_persistent_info);
+        else
+            thd->persistent_info = "working on unknown";
+
+        diffms = comdb2_time_epochms() - work.queue_time_ms;
+        if (diffms > pool->longwaitms) {
+            logmsg(LOGMSG_WARN, "%s(%s): long wait %d ms\n", __func__,
+                   pool->name, diffms);
+        }
+
+        thd->busy = 1;
+        ATOMIC_ADD32(pool->nwrkthd, 1);
+        work.work_fn(pool, work.work, thddata, THD_RUN);
+        ATOMIC_ADD32(pool->nwrkthd, -1);
+        ATOMIC_ADD32(pool->num_completed, 1);
+        XCHANGE32(thd->busy, 0);
+        if (ATOMIC_LOAD32(pool->waiting_for_thread)) {
+            Pthread_mutex_lock(&pool->mutex);
+            Pthread_cond_broadcast(&pool->wait_for_thread);
+            Pthread_mutex_unlock(&pool->mutex);
+        }
+
+        thd->persistent_info = "work completed.";
+        if (work.ref_persistent_info)
+            put_ref(&work.ref_persistent_info);
+
+        thread_util_donework();
+        comdb2bma_yield_all();
+    }
+
+    if (pool->delt_fn)
+        pool->delt_fn(pool, thddata);
+
+    thread_memdestroy();
+
+    /* the thd stays in sq_workers, and is restarted on demand; once retired
+     * it may already be running again, so it is not touched after that */
+    if (rc == 0)
+        sq_retire(pool, thd, 1, 0);
+
+    ATOMIC_ADD32(pool->nactthd, -1);
+    return NULL;
+}
+
+/* Start a worker, reviving an exited one if possible.  Returns NULL if we
+ * are at the limit and not forced, or failed.  A worker over the limit
+ * retires as soon as it is idle, see sq_should_retire. */
+static struct thd *sq_start_worker(struct thdpool *pool, int force)
+{
+    struct thd *thd = NULL;
+    unsigned ii;
+    int rc, created = 0;
+
+    LOCK(&pool->mutex)
+    {
+        for (ii = 0; ii < pool->sq_nworkers; ii++) {
+            if (ATOMIC_LOAD32(pool->sq_workers[ii]->exited)) {
+                thd = pool->sq_workers[ii];
+                break;
+            }
+        }
+        if (!thd && (force || pool->sq_nworkers < sq_limit(pool))) {
+            if (pool->sq_nworkers == pool->sq_capacity && sq_grow(pool)) {
+                errUNLOCK(&pool->mutex);
+                return NULL;
+            }
+            thd = calloc(1, sizeof(struct thd));
+            if (!thd) {
+                errUNLOCK(&pool->mutex);
+                logmsg(LOGMSG_ERROR, "%s(%s):malloc %zu failed\n", __func__,
+                       pool->name, sizeof(struct thd));
+                return NULL;
+            }
+            thd->pool = pool;
+            thd->idx = pool->sq_nworkers;
+            thd->spin = pool->sq_spin;
+            sq_mbox_init(&thd->mbox);
+            Pthread_cond_init(&thd->cond, NULL);
+            Pthread_mutex_init(&thd->sleep_mtx, NULL);
+            created = 1;
+        }
+        if (!thd) {
+            errUNLOCK(&pool->mutex);
+            return NULL;
+        }
+
+        thd->exited = 0;
+        listc_atl(&pool->thdlist, thd);
+#ifdef MONITOR_STACK
+        rc = comdb2_pthread_create(&thd->tid, &pool->attrs, thdpool_sq_thd, thd,
+                                   pool->stack_alloc, pool->stack_sz);
+#else
+        rc = pthread_create(&thd->tid, &pool->attrs, thdpool_sq_thd, thd);
+#endif
+        if (rc != 0) {
+            if (pool->exit_on_create_fail) {
+                logmsg(LOGMSG_ERROR, "pthread_create rc %d, exiting\n", rc);
+                if (!gbl_disable_exit_on_thread_error)
+                    exit(1);
+            }
+            listc_rfl(&pool->thdlist, thd);
+            thd->exited = 1;
+            if (created) {
+                Pthread_cond_destroy(&thd->cond);
+                Pthread_mutex_destroy(&thd->sleep_mtx);
+                free(thd);
+            }
+            pool->num_failed_dispatches++;
+            errUNLOCK(&pool->mutex);
+            logmsg(LOGMSG_ERROR, "%s(%s):pthread_create: %d %s\n", __func__,
+                   pool->name, rc, strerror(rc));
+            return NULL;
+        }
+        if (created) {
+            /* publish the slot before the count, see sq_get_work */
+            pool->sq_workers[thd->idx] = thd;
+            ATOMIC_ADD32(pool->sq_nworkers, 1);
+        }
+        ATOMIC_ADD32(pool->sq_nlive, 1);
+        if (listc_size(&pool->thdlist) > pool->peaknthd)
+            pool->peaknthd = listc_size(&pool->thdlist);
+        pool->num_creates++;
+    }
+    UNLOCK(&pool->mutex);
+
+    return thd;
+}
+
+/* Pick a worker for new work: the first idle one among a few candidates,
+ * otherwise the one with the shortest mailbox */
+static struct thd *sq_pick_worker(struct thdpool *pool, int *idle)
+{
+    struct thd *best = NULL;
+    unsigned ii, n, start, nprobe;
+    int best_nitems = 0;
+
+    *idle = 0;
+    n = ATOMIC_LOAD32(pool->sq_nworkers);
+    if (n == 0)
+        return NULL;
+    start = ATOMIC_ADD32(pool->sq_rr, 1);
+    nprobe = n < 8 ? n : 8;
+    for (ii = 0; ii < nprobe; ii++) {
+        struct thd *thd = sq_worker(pool, (start + ii) % n);
+        int nitems;
+
+        if (ATOMIC_LOAD32(thd->exited))
+            continue;
+        nitems = ATOMIC_LOAD32(thd->mbox.nitems);
+        if (nitems == 0 && !ATOMIC_LOAD32(thd->busy)) {
+            *idle = 1;
+            return thd;
+        }
+        if (!best || nitems < best_nitems) {
+            best = thd;
+            best_nitems = nitems;
+        }
+    }
+    return best;
+}
+
+/* Wake some sleeping worker so it can steal work queued behind a busy one */
+static void sq_wake_sleeper(struct thdpool *pool)
+{
+    unsigned ii, n;
+
+    if (ATOMIC_LOAD32(pool->sq_nsleeping) == 0)
+        return;
+    n = ATOMIC_LOAD32(pool->sq_nworkers);
+    for (ii = 0; ii < n; ii++) {
+        struct thd *thd = sq_worker(pool, ii);
+        if (ATOMIC_LOAD32(thd->sleeping)) {
+            sq_wake(thd);
+            return;
+        }
+    }
+}
+
+/* thdpool_set_wait: block the producer until some worker is idle rather
+ * than queue behind busy ones.  Workers signal after their work is done;
+ * the timeout covers a worker that went idle between our pick and the
+ * wait. */
+static void sq_wait_idle(struct thdpool *pool)
+{
+    struct timespec ts;
+
+    LOCK(&pool->mutex)
+    {
+        ATOMIC_ADD32(pool->waiting_for_thread, 1);
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 10 * 1000000;
+        if (ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&pool->wait_for_thread, &pool->mutex, &ts);
+        ATOMIC_ADD32(pool->waiting_for_thread, -1);
+    }
+    UNLOCK(&pool->mutex);
+}
+
+static int sq_enqueue(struct thdpool *pool, thdpool_work_fn work_fn,
+                      void *work, int queue_override,
+                      struct string_ref *ref_persistent_info, uint32_t flags)
+{
+    int enqueue_front = (flags & THDPOOL_ENQUEUE_FRONT);
+    int force_queue = (flags & THDPOOL_FORCE_QUEUE);
+    int force_dispatch = (flags & THDPOOL_FORCE_DISPATCH);
+    int queue_only = (flags & THDPOOL_QUEUE_ONLY);
+    struct sq_item *item;
+    struct thd *thd;
+    int idle;
+
+again:
+    if (ATOMIC_LOAD32(pool->stopped)) {
+        ATOMIC_ADD32(pool->num_failed_dispatches, 1);
+        logmsg(LOGMSG_ERROR, "%s(%s): cannot enque to a stopped pool\n",
+               __func__, pool->name);
+        return -1;
+    }
+
+    thd = sq_pick_worker(pool, &idle);
+    /* queue-only work waits for the workers there are, as in the locked
+     * mode; forced work gets a worker even over the limit */
+    if (!idle && (!queue_only || ATOMIC_LOAD32(pool->sq_nlive) == 0) &&
+        (force_dispatch ||
+         ATOMIC_LOAD32(pool->sq_nlive) < sq_limit(pool))) {
+        struct thd *newthd = sq_start_worker(pool, force_dispatch);
+        if (newthd) {
+            thd = newthd;
+            idle = 1;
+        }
+    }
+    if (thd && !idle && !queue_only && !force_dispatch && pool->wait) {
+        sq_wait_idle(pool);
+        goto again;
+    }
+    if (queue_only)
+        idle = 0;
+    if (!thd) {
+        ATOMIC_ADD32(pool->num_failed_dispatches, 1);
+        logmsg(LOGMSG_ERROR, "%s(%s): no worker threads\n", __func__,
+               pool->name);
+        return -1;
+    }
+
+    if (!idle) {
+        /* work has to wait; apply the same queue limits as the locked mode */
+        int queue_count = ATOMIC_LOAD32(pool->sq_nqueued);
+        if (queue_count >= pool->maxqueue && !force_dispatch &&
+            !(force_queue ||
+              (queue_override &&
+               (enqueue_front || !pool->maxqueueoverride ||
+                queue_count < (pool->maxqueue + pool->maxqueueoverride))))) {
+            if (queue_override) {
+                logmsg(LOGMSG_USER, "%d FAILED to queue sql, queue "
+                                    "size=%d. max_queue=%d "
+                                    "max_queue_override=%d\n",
+                       __LINE__, queue_count, pool->maxqueue,
+                       pool->maxqueueoverride);
+            }
+            ATOMIC_ADD32(pool->num_failed_dispatches, 1);
+            if (pool->dump_on_full)
+                ctrace("%s(%s):all threads busy and queue full\n", __func__,
+                       pool->name);
+            return -1;
+        }
+        if (queue_count > pool->peakqueue)
+            pool->peakqueue = queue_count;
+    }
+
+    item = malloc(sizeof(struct sq_item));
+    if (!item) {
+        ATOMIC_ADD32(pool->num_failed_dispatches, 1);
+        logmsg(LOGMSG_ERROR, "%s(%s):malloc failed\n", __func__, pool->name);
+        return -1;
+    }
+    memset(&item->work, 0, sizeof(item->work));
+    item->work.work = work;
+    item->work.work_fn = work_fn;
+    transfer_ref(&ref_persistent_info, &item->work.ref_persistent_info);
+    item->work.queue_time_ms = comdb2_time_epochms();
+    item->work.available = 1;
+
+    if (idle) {
+        ATOMIC_ADD32(pool->num_passed, 1);
+    } else {
+        ATOMIC_ADD32(pool->num_enqueued, 1);
+        if (pool->queued_callback)
+            pool->queued_callback(work);
+    }
+
+    ATOMIC_ADD32(pool->sq_nqueued, 1);
+    sq_mbox_push(enqueue_front ? &pool->sq_front : &thd->mbox, item);
+
+    sq_wake(thd);
+    if (!idle)
+        sq_wake_sleeper(pool);
+
+    /* the worker retired after we picked it, see sq_retire */
+    if (ATOMIC_LOAD32(thd->exited))
+        sq_start_worker(pool, force_dispatch);
+
+    return 0;
+}
+
+int thdpool_enqueue_sched(struct thdpool *pool, thdpool_work_fn work_fn,
+                          void *work, int queue_override,
+                          struct string_ref *ref_persistent_info,
+                          uint32_t flags, const struct thdpool_sched *sched)
 {
     static time_t last_dump = 0;
     int enqueue_front = (flags & THDPOOL_ENQUEUE_FRONT);
@@ -894,12 +1966,22 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
 
     time_t crt_dump;
 
+    if (!ATOMIC_LOAD32(pool->sq_latched))
+        sq_latch(pool);
+    if (pool->sq_on)
+        return sq_enqueue(pool, work_fn, work, queue_override,
+                          ref_persistent_info, flags);
+
     LOCK(&pool->mutex)
     {
         struct thd *thd;
         struct workitem *item = NULL;
         unsigned nbusy;
         int did_create = 0;
+        int deferred = 0;
+        int cls = 0;
+        unsigned flow = 0;
+        double tag = pool->sched_vtime;
 
         if (pool->stopped) {
             pool->num_failed_dispatches++;
@@ -934,17 +2016,42 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
         }
         pool->busy_hist[nbusy]++;
 
+        if (sched) {
+            if (!pool->sched_flows && sched_alloc(pool)) {
+                pool->num_failed_dispatches++;
+                errUNLOCK(&pool->mutex);
+                logmsg(LOGMSG_ERROR, "%s(%s): cannot allocate flow queues\n",
+                       __func__, pool->name);
+                return -1;
+            }
+            flow = sched->flow % THDPOOL_SCHED_NFLOWS;
+            double *finish = &pool->sched_finish[flow];
+            if (*finish > tag)
+                tag = *finish;
+            tag += sched->cost;
+            *finish = tag;
+            cls = sched->cls;
+            if (cls < 0 || cls >= THDPOOL_SCHED_NCLASS)
+                cls = THDPOOL_SCHED_NCLASS - 1;
+            /* class is at its limit: queue even if a thread is free */
+            if (!force_dispatch && sched->maxrun &&
+                pool->sched_running[cls] >= sched->maxrun) {
+                deferred = 1;
+                pool->num_sched_deferred++;
+            }
+        }
+
     /* Get a free thread, creating one if necessary and if we're allowed
      * more threads.  Note that the thread cannot enter its work loop
      * until the lock is released, which gives us a window to assign the
      * work item to the new thread. */
     again:
-        thd = listc_rtl(&pool->freelist);
+        thd = deferred ? NULL : listc_rtl(&pool->freelist);
         if (thd) {
             assert(thd->on_freelist);
             thd->on_freelist = 0;
         }
-        if (!thd &&
+        if (!thd && !deferred &&
             (force_dispatch || pool->maxnthd == 0 ||
              listc_size(&pool->thdlist) < (pool->maxnthd + pool->nwaitthd))) {
             int rc;
@@ -994,7 +2101,8 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
             pool->num_creates++;
         }
 
-        if ((queue_only && did_create) || (thd == NULL && pool->wait)) {
+        if ((queue_only && did_create) ||
+            (thd == NULL && !deferred && pool->wait)) {
 
             pool->waiting_for_thread = 1;
             Pthread_cond_wait(&pool->wait_for_thread, &pool->mutex);
@@ -1005,6 +2113,11 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
 
         if (!queue_only && thd) {
             item = &thd->work;
+            item->sched = (sched != NULL);
+            item->cls = cls;
+            item->maxrun = sched ? sched->maxrun : 0;
+            item->tag = tag;
+            sched_start(pool, item);
             pool->num_passed++;
         } else {
 #ifndef NDEBUG
@@ -1100,10 +2213,11 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
                 return -1;
             }
 
-            if (enqueue_front)
-                listc_atl(&pool->queue, item);
-            else
-                listc_abl(&pool->queue, item);
+            item->sched = (sched != NULL);
+            item->cls = cls;
+            item->maxrun = sched ? sched->maxrun : 0;
+            item->tag = tag;
+            sched_queue(pool, item, flow, enqueue_front);
             pool->num_enqueued++;
 
             if (pool->queued_callback)
@@ -1133,6 +2247,14 @@ int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
     return 0;
 }
 
+int thdpool_enqueue(struct thdpool *pool, thdpool_work_fn work_fn, void *work,
+                    int queue_override, struct string_ref *ref_persistent_info,
+                    uint32_t flags)
+{
+    return thdpool_enqueue_sched(pool, work_fn, work, queue_override,
+                                 ref_persistent_info, flags, NULL);
+}
+
 /* No locks, so not 100% accurate */
 char *thdpool_get_name(struct thdpool *pool)
 {
@@ -1151,11 +2273,15 @@ int thdpool_get_nthds(struct thdpool *pool)
 
 int thdpool_get_nfreethds(struct thdpool *pool)
 {
+    if (pool->sq_on)
+        return pool->sq_nlive - pool->nwrkthd;
     return pool->freelist.count;
 }
 
 int thdpool_get_nbusythds(struct thdpool *pool)
 {
+    if (pool->sq_on)
+        return pool->nwrkthd;
     return pool->thdlist.count - pool->freelist.count;
 }
 
@@ -1236,7 +2362,7 @@ int thdpool_get_maxqueue(struct thdpool *pool)
 
 int thdpool_get_nqueuedworks(struct thdpool *pool)
 {
-    return listc_size(&pool->queue);
+    return thdpool_get_queue_depth(pool);
 }
 
 int thdpool_get_longwaitms(struct thdpool *pool)
@@ -1293,6 +2419,8 @@ struct thdpool *thdpool_next_pool(struct thdpool *pool)
 
 int thdpool_get_queue_depth(struct thdpool *pool)
 {
+    if (pool->sq_on)
+        return ATOMIC_LOAD32(pool->sq_nqueued);
     return listc_size(&pool->queue);
 }
 